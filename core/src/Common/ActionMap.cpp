@@ -0,0 +1,180 @@
+#include "ActionMap.h"
+#include <algorithm>
+
+ActionMap::ActionMap()
+{
+}
+
+void ActionMap::BindKey(Action action, KeyboardKey key)
+{
+    if (!InputSnapshot::IsValidKey(key))
+    {
+        return;
+    }
+    std::vector<Action>& actions = this->keyActions[(unsigned int)key];
+    if (std::find(actions.begin(), actions.end(), action) != actions.end())
+    {
+        return;
+    }
+    actions.push_back(action);
+    if (action >= this->bindings.size())
+    {
+        this->bindings.resize(action + 1);
+    }
+    this->bindings[action].keys.push_back(key);
+}
+
+void ActionMap::BindMouseButton(Action action, MouseButton button)
+{
+    if ((unsigned int)button >= InputSnapshot::MOUSE_BUTTON_COUNT)
+    {
+        return;
+    }
+    std::vector<Action>& actions = this->mouseButtonActions[(unsigned int)button];
+    if (std::find(actions.begin(), actions.end(), action) != actions.end())
+    {
+        return;
+    }
+    actions.push_back(action);
+    if (action >= this->bindings.size())
+    {
+        this->bindings.resize(action + 1);
+    }
+    this->bindings[action].buttons.push_back(button);
+}
+
+void ActionMap::UnbindKey(Action action, KeyboardKey key)
+{
+    if (!InputSnapshot::IsValidKey(key) || action >= this->bindings.size())
+    {
+        return;
+    }
+    ActionMap::removeAction(this->keyActions[(unsigned int)key], action);
+    std::vector<KeyboardKey>& keys = this->bindings[action].keys;
+    keys.erase(std::remove(keys.begin(), keys.end(), key), keys.end());
+}
+
+void ActionMap::UnbindMouseButton(Action action, MouseButton button)
+{
+    if ((unsigned int)button >= InputSnapshot::MOUSE_BUTTON_COUNT || action >= this->bindings.size())
+    {
+        return;
+    }
+    ActionMap::removeAction(this->mouseButtonActions[(unsigned int)button], action);
+    std::vector<MouseButton>& buttons = this->bindings[action].buttons;
+    buttons.erase(std::remove(buttons.begin(), buttons.end(), button), buttons.end());
+}
+
+void ActionMap::UnbindAction(Action action)
+{
+    if (action >= this->bindings.size())
+    {
+        return;
+    }
+    Binding& binding = this->bindings[action];
+    for (auto key = binding.keys.begin(); key != binding.keys.end(); key++)
+    {
+        ActionMap::removeAction(this->keyActions[(unsigned int)*key], action);
+    }
+    for (auto button = binding.buttons.begin(); button != binding.buttons.end(); button++)
+    {
+        ActionMap::removeAction(this->mouseButtonActions[(unsigned int)*button], action);
+    }
+    binding.keys.clear();
+    binding.buttons.clear();
+}
+
+const std::vector<ActionMap::Action>& ActionMap::GetKeyActions(KeyboardKey key) const
+{
+    if (!InputSnapshot::IsValidKey(key))
+    {
+        return this->noActions;
+    }
+    return this->keyActions[(unsigned int)key];
+}
+
+const std::vector<ActionMap::Action>& ActionMap::GetMouseButtonActions(MouseButton button) const
+{
+    if ((unsigned int)button >= InputSnapshot::MOUSE_BUTTON_COUNT)
+    {
+        return this->noActions;
+    }
+    return this->mouseButtonActions[(unsigned int)button];
+}
+
+bool ActionMap::IsActionDown(Action action, const InputSnapshot& snapshot) const
+{
+    if (action >= this->bindings.size())
+    {
+        return false;
+    }
+    const Binding& binding = this->bindings[action];
+    for (auto key = binding.keys.begin(); key != binding.keys.end(); key++)
+    {
+        if (snapshot.IsKeyDown(*key))
+        {
+            return true;
+        }
+    }
+    for (auto button = binding.buttons.begin(); button != binding.buttons.end(); button++)
+    {
+        if (snapshot.IsMouseButtonDown(*button))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ActionMap::WasActionPressed(Action action, const InputSnapshot& snapshot) const
+{
+    if (action >= this->bindings.size())
+    {
+        return false;
+    }
+    const Binding& binding = this->bindings[action];
+    for (auto key = binding.keys.begin(); key != binding.keys.end(); key++)
+    {
+        if (snapshot.WasKeyPressed(*key))
+        {
+            return true;
+        }
+    }
+    for (auto button = binding.buttons.begin(); button != binding.buttons.end(); button++)
+    {
+        if (snapshot.WasMouseButtonPressed(*button))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ActionMap::WasActionReleased(Action action, const InputSnapshot& snapshot) const
+{
+    if (action >= this->bindings.size())
+    {
+        return false;
+    }
+    const Binding& binding = this->bindings[action];
+    for (auto key = binding.keys.begin(); key != binding.keys.end(); key++)
+    {
+        if (snapshot.WasKeyReleased(*key))
+        {
+            return true;
+        }
+    }
+    for (auto button = binding.buttons.begin(); button != binding.buttons.end(); button++)
+    {
+        if (snapshot.WasMouseButtonReleased(*button))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ActionMap::removeAction(std::vector<Action>& actions, Action action)
+{
+    actions.erase(std::remove(actions.begin(), actions.end(), action), actions.end());
+}
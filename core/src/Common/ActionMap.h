@@ -0,0 +1,111 @@
+#ifndef Core_ActionMap_h
+#define Core_ActionMap_h
+
+#include <vector>
+#include "KeyboardKey.h"
+#include "MouseButton.h"
+#include "InputSnapshot.h"
+
+/**
+ * Maps the keys and mouse buttons the player uses onto the actions the game
+ * understands, such as jumping or firing.
+ *
+ * Actions are numbered by the game, typically by casting its own enum, so
+ * gameplay code can ask whether an action is down, or handle it through the
+ * InputManager, without knowing which inputs are bound to it. Several inputs
+ * can be bound to one action and one input to several actions, and bindings
+ * can change at any time, for example from a controls menu.
+ */
+class ActionMap final
+{
+public:
+    /**
+     * A game-defined action number.
+     */
+    typedef unsigned int Action;
+
+    /**
+     * Creates a map with nothing bound.
+     */
+    ActionMap();
+
+    /**
+     * Binds the given key to the given action. Binding it twice does nothing.
+     */
+    void BindKey(Action action, KeyboardKey key);
+
+    /**
+     * Binds the given mouse button to the given action. Binding it twice does
+     * nothing.
+     */
+    void BindMouseButton(Action action, MouseButton button);
+
+    /**
+     * Removes the binding of the given key to the given action.
+     */
+    void UnbindKey(Action action, KeyboardKey key);
+
+    /**
+     * Removes the binding of the given mouse button to the given action.
+     */
+    void UnbindMouseButton(Action action, MouseButton button);
+
+    /**
+     * Removes every binding of the given action.
+     */
+    void UnbindAction(Action action);
+
+    /**
+     * Obtains the actions the given key or mouse button is bound to.
+     */
+    const std::vector<Action>& GetKeyActions(KeyboardKey key) const;
+    const std::vector<Action>& GetMouseButtonActions(MouseButton button) const;
+
+    /**
+     * Obtains whether any input bound to the given action is down in the
+     * given snapshot.
+     */
+    bool IsActionDown(Action action, const InputSnapshot& snapshot) const;
+
+    /**
+     * Obtains whether any input bound to the given action went down during
+     * the given snapshot's tick.
+     */
+    bool WasActionPressed(Action action, const InputSnapshot& snapshot) const;
+
+    /**
+     * Obtains whether any input bound to the given action went up during the
+     * given snapshot's tick.
+     */
+    bool WasActionReleased(Action action, const InputSnapshot& snapshot) const;
+
+private:
+    /**
+     * The inputs bound to an action.
+     */
+    struct Binding
+    {
+        std::vector<KeyboardKey> keys;
+        std::vector<MouseButton> buttons;
+    };
+
+    /**
+     * Removes the given action from the given list, if it's there.
+     */
+    static void removeAction(std::vector<Action>& actions, Action action);
+
+    /**
+     * The actions of every key and mouse button, indexed by their enum values,
+     * and the bindings of every action, indexed by action
+     */
+    std::vector<Action> keyActions[InputSnapshot::KEY_COUNT];
+    std::vector<Action> mouseButtonActions[InputSnapshot::MOUSE_BUTTON_COUNT];
+    std::vector<Binding> bindings;
+
+    /**
+     * Returned for inputs that can't be bound
+     */
+    std::vector<Action> noActions;
+};
+
+#endif
@@ -0,0 +1,140 @@
+#include <cstring>
+#include "AffineQuadBatch.h"
+#include "Simd.h"
+
+AffineQuadBatch::AffineQuadBatch() : count(0)
+{
+
+}
+
+AffineQuadBatch::~AffineQuadBatch()
+{
+
+}
+
+void AffineQuadBatch::Clear()
+{
+    this->count = 0;
+}
+
+void AffineQuadBatch::Add(const AffineTransform& transform, float width, float height, float z)
+{
+    if (this->count == this->a.size())
+    {
+        // Grow by whole SIMD groups so the last group can always be loaded.
+        unsigned int newSize = (unsigned int)this->a.size() * 2 + CORE_SIMD_WIDTH;
+        this->a.resize(newSize, 0.0f);
+        this->b.resize(newSize, 0.0f);
+        this->c.resize(newSize, 0.0f);
+        this->d.resize(newSize, 0.0f);
+        this->tx.resize(newSize, 0.0f);
+        this->ty.resize(newSize, 0.0f);
+        this->width.resize(newSize, 0.0f);
+        this->height.resize(newSize, 0.0f);
+        this->z.resize(newSize, 0.0f);
+    }
+    this->a[this->count] = transform.a;
+    this->b[this->count] = transform.b;
+    this->c[this->count] = transform.c;
+    this->d[this->count] = transform.d;
+    this->tx[this->count] = transform.tx;
+    this->ty[this->count] = transform.ty;
+    this->width[this->count] = width;
+    this->height[this->count] = height;
+    this->z[this->count] = z;
+    this->count++;
+}
+
+unsigned int AffineQuadBatch::GetCount()
+{
+    return this->count;
+}
+
+void AffineQuadBatch::PutGLVertexInfo(float* vertexBuffer)
+{
+    unsigned int fullGroups = this->count / CORE_SIMD_WIDTH;
+    for (unsigned int group = 0; group < fullGroups; group++)
+    {
+        unsigned int first = group * CORE_SIMD_WIDTH;
+        this->expandGroup(first, vertexBuffer + first * 16);
+    }
+
+    // The last partial group is expanded into scratch space and only the
+    // rectangles that exist are copied out.
+    unsigned int remaining = this->count - fullGroups * CORE_SIMD_WIDTH;
+    if (remaining > 0)
+    {
+        float scratch[CORE_SIMD_WIDTH * 16];
+        unsigned int first = fullGroups * CORE_SIMD_WIDTH;
+        this->expandGroup(first, scratch);
+        std::memcpy(vertexBuffer + first * 16, scratch, remaining * 16 * sizeof(float));
+    }
+}
+
+void AffineQuadBatch::expandGroup(unsigned int first, float* vertexBuffer)
+{
+#ifdef CORE_SIMD_SSE
+    __m128 a = _mm_loadu_ps(&this->a[first]);
+    __m128 b = _mm_loadu_ps(&this->b[first]);
+    __m128 c = _mm_loadu_ps(&this->c[first]);
+    __m128 d = _mm_loadu_ps(&this->d[first]);
+    __m128 tx = _mm_loadu_ps(&this->tx[first]);
+    __m128 ty = _mm_loadu_ps(&this->ty[first]);
+    __m128 right = _mm_loadu_ps(&this->width[first]);
+    __m128 bottom = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&this->height[first]));
+    __m128 z = _mm_loadu_ps(&this->z[first]);
+
+    // Corner positions for the four rectangles. With u along the width and
+    // v along the height, x = a*u + c*v + tx and y = b*u + d*v + ty.
+    __m128 au = _mm_mul_ps(a, right);
+    __m128 bu = _mm_mul_ps(b, right);
+    __m128 cv = _mm_mul_ps(c, bottom);
+    __m128 dv = _mm_mul_ps(d, bottom);
+    __m128 cornerX[4];
+    __m128 cornerY[4];
+    // Top/Left
+    cornerX[0] = tx;
+    cornerY[0] = ty;
+    // Top/Right
+    cornerX[1] = _mm_add_ps(tx, au);
+    cornerY[1] = _mm_add_ps(ty, bu);
+    // Bottom/Right
+    cornerX[2] = _mm_add_ps(cornerX[1], cv);
+    cornerY[2] = _mm_add_ps(cornerY[1], dv);
+    // Bottom/Left
+    cornerX[3] = _mm_add_ps(tx, cv);
+    cornerY[3] = _mm_add_ps(ty, dv);
+
+    // Transpose each corner from one register per coordinate into one
+    // (x, y, z, 1) register per rectangle.
+    for (unsigned int corner = 0; corner < 4; corner++)
+    {
+        __m128 row0 = cornerX[corner];
+        __m128 row1 = cornerY[corner];
+        __m128 row2 = z;
+        __m128 row3 = _mm_set1_ps(1.0f);
+        _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+        _mm_storeu_ps(vertexBuffer + corner * 4, row0);
+        _mm_storeu_ps(vertexBuffer + 16 + corner * 4, row1);
+        _mm_storeu_ps(vertexBuffer + 32 + corner * 4, row2);
+        _mm_storeu_ps(vertexBuffer + 48 + corner * 4, row3);
+    }
+#else
+    for (unsigned int i = 0; i < CORE_SIMD_WIDTH; i++)
+    {
+        unsigned int sprite = first + i;
+        float right = this->width[sprite];
+        float bottom = -this->height[sprite];
+        float u[4] = { 0.0f, right, right, 0.0f };
+        float v[4] = { 0.0f, 0.0f, bottom, bottom };
+        for (unsigned int corner = 0; corner < 4; corner++)
+        {
+            float* vertex = vertexBuffer + i * 16 + corner * 4;
+            vertex[0] = this->a[sprite] * u[corner] + this->c[sprite] * v[corner] + this->tx[sprite];
+            vertex[1] = this->b[sprite] * u[corner] + this->d[sprite] * v[corner] + this->ty[sprite];
+            vertex[2] = this->z[sprite];
+            vertex[3] = 1.0f;
+        }
+    }
+#endif
+}
@@ -0,0 +1,78 @@
+#ifndef Core_AffineQuadBatch_h
+#define Core_AffineQuadBatch_h
+
+#include <vector>
+#include "AffineTransform.h"
+
+/**
+ * Expands a batch of transformed rectangles into quad vertices.
+ *
+ * Each rectangle is given as an affine transform and a width and height;
+ * its corners are (0, 0), (width, 0), (width, -height) and (0, -height)
+ * in the transform's input space, matching the Top/Left, Top/Right,
+ * Bottom/Right, Bottom/Left order used by Sprite, at the given z. The
+ * transforms are kept
+ * as a structure of arrays so PutGLVertexInfo transforms four rectangles
+ * per SIMD instruction.
+ */
+class AffineQuadBatch
+{
+public:
+    /**
+     * Creates an empty batch.
+     */
+    AffineQuadBatch();
+
+    /**
+     * Destructor
+     */
+    ~AffineQuadBatch();
+
+    /**
+     * Removes every rectangle from the batch while keeping its memory.
+     */
+    void Clear();
+
+    /**
+     * Adds a rectangle to the batch whose vertices all lie at the given z.
+     */
+    void Add(const AffineTransform& transform, float width, float height, float z);
+
+    /**
+     * Obtains the number of rectangles in the batch.
+     */
+    unsigned int GetCount();
+
+    /**
+     * Writes the vertices of every rectangle, in the order they were added,
+     * into the given array.
+     *
+     * DO NOT CALL THIS METHOD IF THERE IS NOT SPACE FOR 16 VALUES FOR
+     * EACH RECTANGLE (16 * GetCount()).
+     */
+    void PutGLVertexInfo(float* vertexBuffer);
+
+private:
+    // Private constructors to disallow access.
+    AffineQuadBatch(AffineQuadBatch const &other);
+    AffineQuadBatch operator=(AffineQuadBatch other);
+
+    /**
+     * Transforms the four rectangles starting at the given index, writing
+     * 64 values.
+     */
+    void expandGroup(unsigned int first, float* vertexBuffer);
+
+    unsigned int count;
+    std::vector<float> a;
+    std::vector<float> b;
+    std::vector<float> c;
+    std::vector<float> d;
+    std::vector<float> tx;
+    std::vector<float> ty;
+    std::vector<float> width;
+    std::vector<float> height;
+    std::vector<float> z;
+};
+
+#endif
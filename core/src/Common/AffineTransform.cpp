@@ -0,0 +1,43 @@
+#include <cmath>
+#include "AffineTransform.h"
+
+AffineTransform::AffineTransform() : a(1.0f), b(0.0f), c(0.0f), d(1.0f), tx(0.0f), ty(0.0f)
+{
+
+}
+
+AffineTransform::AffineTransform(float a, float b, float c, float d, float tx, float ty) : a(a), b(b), c(c), d(d), tx(tx), ty(ty)
+{
+
+}
+
+AffineTransform AffineTransform::FromTranslationRotationScale(float x, float y, float rotation, float scaleX, float scaleY)
+{
+    return AffineTransform::FromTranslationSinCosScale(x, y, std::sin(rotation), std::cos(rotation), scaleX, scaleY);
+}
+
+AffineTransform AffineTransform::FromTranslationSinCosScale(float x, float y, float sine, float cosine, float scaleX, float scaleY)
+{
+    return AffineTransform(cosine * scaleX, sine * scaleX, -sine * scaleY, cosine * scaleY, x, y);
+}
+
+AffineTransform AffineTransform::Multiply(const AffineTransform& second, const AffineTransform& first)
+{
+    return AffineTransform(
+        second.a * first.a + second.c * first.b,
+        second.b * first.a + second.d * first.b,
+        second.a * first.c + second.c * first.d,
+        second.b * first.c + second.d * first.d,
+        second.a * first.tx + second.c * first.ty + second.tx,
+        second.b * first.tx + second.d * first.ty + second.ty);
+}
+
+float AffineTransform::TransformX(float x, float y) const
+{
+    return this->a * x + this->c * y + this->tx;
+}
+
+float AffineTransform::TransformY(float x, float y) const
+{
+    return this->b * x + this->d * y + this->ty;
+}
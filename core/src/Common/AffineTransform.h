@@ -0,0 +1,62 @@
+#ifndef Core_AffineTransform_h
+#define Core_AffineTransform_h
+
+/**
+ * A 2D affine transform stored as the top two rows of a 3x3 matrix:
+ *
+ *     | a  c  tx |
+ *     | b  d  ty |
+ *     | 0  0  1  |
+ *
+ * Points are transformed as column vectors, so Multiply(parent, child)
+ * applies the child transform first and the parent transform second.
+ */
+class AffineTransform final
+{
+public:
+    /**
+     * Creates the identity transform.
+     */
+    AffineTransform();
+
+    /**
+     * Creates a transform from the given matrix entries.
+     */
+    AffineTransform(float a, float b, float c, float d, float tx, float ty);
+
+    /**
+     * Creates a transform that scales, then rotates counter-clockwise by the
+     * given angle in radians, then translates.
+     */
+    static AffineTransform FromTranslationRotationScale(float x, float y, float rotation, float scaleX, float scaleY);
+
+    /**
+     * Creates the same transform as FromTranslationRotationScale from an
+     * already computed sine and cosine of the rotation.
+     */
+    static AffineTransform FromTranslationSinCosScale(float x, float y, float sine, float cosine, float scaleX, float scaleY);
+
+    /**
+     * Returns the transform that applies "second" after "first".
+     */
+    static AffineTransform Multiply(const AffineTransform& second, const AffineTransform& first);
+
+    /**
+     * Obtains the x coordinate of the given point after transformation.
+     */
+    float TransformX(float x, float y) const;
+
+    /**
+     * Obtains the y coordinate of the given point after transformation.
+     */
+    float TransformY(float x, float y) const;
+
+    float a;
+    float b;
+    float c;
+    float d;
+    float tx;
+    float ty;
+};
+
+#endif
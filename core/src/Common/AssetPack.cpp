@@ -0,0 +1,257 @@
+#include <cstring>
+#include <vector>
+#include "AssetPack.h"
+#include "LZ4Block.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+    /**
+     * Compares two names byte by byte, the order the index is sorted in,
+     * returning a negative number, zero or a positive number as strcmp does.
+     */
+    int compareNames(const char* first, size_t firstLength, const char* second, size_t secondLength)
+    {
+        int comparison = std::memcmp(first, second, firstLength < secondLength ? firstLength : secondLength);
+        if (comparison != 0 || firstLength == secondLength)
+        {
+            return comparison;
+        }
+        return firstLength < secondLength ? -1 : 1;
+    }
+}
+
+std::shared_ptr<AssetPack> AssetPack::Open(const std::string& fileName)
+{
+    std::shared_ptr<AssetPack> pack = std::make_shared<AssetPack>();
+    if (!pack->open(fileName))
+    {
+        return nullptr;
+    }
+    return pack;
+}
+
+AssetPack::AssetPack() : mapping(nullptr), mappingSize(0), entries(nullptr), entryCount(0), names(nullptr)
+{
+
+}
+
+AssetPack::~AssetPack()
+{
+    if (this->mapping == nullptr)
+    {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(this->mapping);
+#else
+    munmap((void*)this->mapping, this->mappingSize);
+#endif
+}
+
+bool AssetPack::Contains(const std::string& name)
+{
+    return this->find(AssetPack::NormalizeName(name)) != nullptr;
+}
+
+bool AssetPack::Read(const std::string& name, Asset& asset)
+{
+    const AssetPackFormat::Entry* entry = this->find(AssetPack::NormalizeName(name));
+    if (entry == nullptr)
+    {
+        return false;
+    }
+    const unsigned char* stored = this->mapping + entry->dataOffset;
+    if ((entry->flags & AssetPackFormat::FLAG_LZ4) == 0)
+    {
+        asset.data = stored;
+        asset.size = (size_t)entry->size;
+        asset.owner = this->shared_from_this();
+        return true;
+    }
+
+    std::shared_ptr<std::vector<unsigned char>> buffer = std::make_shared<std::vector<unsigned char>>((size_t)entry->size);
+    if (!buffer->empty() && !LZ4Block::Decompress(stored, (size_t)entry->storedSize, &(*buffer)[0], buffer->size()))
+    {
+        return false;
+    }
+    asset.data = buffer->empty() ? nullptr : &(*buffer)[0];
+    asset.size = buffer->size();
+    asset.owner = buffer;
+    return true;
+}
+
+unsigned int AssetPack::GetEntryCount()
+{
+    return this->entryCount;
+}
+
+std::string AssetPack::GetEntryName(unsigned int index)
+{
+    if (index >= this->entryCount)
+    {
+        return "";
+    }
+    return std::string(this->names + this->entries[index].nameOffset, this->entries[index].nameLength);
+}
+
+std::string AssetPack::GetFileName()
+{
+    return this->fileName;
+}
+
+std::string AssetPack::NormalizeName(const std::string& name)
+{
+    std::string normalized = name;
+    for (size_t i = 0; i < normalized.size(); i++)
+    {
+        if (normalized[i] == '\\')
+        {
+            normalized[i] = '/';
+        }
+    }
+    while (normalized.compare(0, 2, "./") == 0)
+    {
+        normalized.erase(0, 2);
+    }
+    return normalized;
+}
+
+bool AssetPack::open(const std::string& fileName)
+{
+    this->fileName = fileName;
+#ifdef _WIN32
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE fileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (fileMapping == nullptr)
+    {
+        return false;
+    }
+    void* view = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(fileMapping);
+    if (view == nullptr)
+    {
+        return false;
+    }
+    this->mapping = (const unsigned char*)view;
+    this->mappingSize = (size_t)size.QuadPart;
+#else
+    int file = ::open(fileName.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size == 0)
+    {
+        close(file);
+        return false;
+    }
+    void* view = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (view == MAP_FAILED)
+    {
+        return false;
+    }
+    this->mapping = (const unsigned char*)view;
+    this->mappingSize = (size_t)status.st_size;
+#endif
+    return this->validate();
+}
+
+const AssetPackFormat::Entry* AssetPack::find(const std::string& name)
+{
+    // The index is sorted by name, byte by byte
+    unsigned int low = 0;
+    unsigned int high = this->entryCount;
+    while (low < high)
+    {
+        unsigned int middle = low + (high - low) / 2;
+        const AssetPackFormat::Entry& entry = this->entries[middle];
+        int comparison = compareNames(this->names + entry.nameOffset, entry.nameLength, name.data(), name.size());
+        if (comparison == 0)
+        {
+            return &entry;
+        }
+        if (comparison < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return nullptr;
+}
+
+bool AssetPack::validate()
+{
+    if (this->mappingSize < sizeof(AssetPackFormat::Header))
+    {
+        return false;
+    }
+    AssetPackFormat::Header header;
+    std::memcpy(&header, this->mapping, sizeof(header));
+    if (header.magic != AssetPackFormat::MAGIC || header.version != AssetPackFormat::VERSION || header.alignment != AssetPackFormat::ALIGNMENT)
+    {
+        return false;
+    }
+    uint64_t size = this->mappingSize;
+    uint64_t indexSize = (uint64_t)header.entryCount * sizeof(AssetPackFormat::Entry);
+    if (header.indexOffset % sizeof(uint64_t) != 0 || header.indexOffset > size || indexSize > size - header.indexOffset ||
+        header.namesOffset > size || header.namesSize > size - header.namesOffset)
+    {
+        return false;
+    }
+    this->entries = (const AssetPackFormat::Entry*)(this->mapping + header.indexOffset);
+    this->entryCount = header.entryCount;
+    this->names = (const char*)(this->mapping + header.namesOffset);
+
+    for (unsigned int i = 0; i < this->entryCount; i++)
+    {
+        const AssetPackFormat::Entry& entry = this->entries[i];
+        if (entry.nameOffset > header.namesSize || entry.nameLength > header.namesSize - entry.nameOffset ||
+            entry.dataOffset > size || entry.storedSize > size - entry.dataOffset || entry.dataOffset % AssetPackFormat::ALIGNMENT != 0)
+        {
+            return false;
+        }
+
+        // find binary searches the index, so it must be in strictly
+        // increasing order
+        if (i > 0)
+        {
+            const AssetPackFormat::Entry& previous = this->entries[i - 1];
+            if (compareNames(this->names + previous.nameOffset, previous.nameLength, this->names + entry.nameOffset, entry.nameLength) >= 0)
+            {
+                return false;
+            }
+        }
+        if ((entry.flags & AssetPackFormat::FLAG_LZ4) == 0 && entry.storedSize != entry.size)
+        {
+            return false;
+        }
+    }
+    return true;
+}
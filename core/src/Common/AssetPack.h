@@ -0,0 +1,119 @@
+#ifndef Core_AssetPack_h
+#define Core_AssetPack_h
+
+#include <cstddef>
+#include <string>
+#include <memory>
+#include "AssetPackFormat.h"
+
+/**
+ * A read-only asset pack written by the AssetPacker tool.
+ *
+ * The whole pack is memory mapped when it is opened and its file closed
+ * again, so a pack costs no file descriptor and assets are read straight
+ * out of the page cache. Uncompressed assets are handed out as pointers
+ * into the mapping; only compressed ones are copied, while decompressing.
+ *
+ * Packs never change once opened, so they may be read from any thread.
+ */
+class AssetPack : public std::enable_shared_from_this<AssetPack>
+{
+public:
+    /**
+     * The contents of an asset. The memory stays valid for as long as some
+     * copy of the Asset exists, even if the pack is closed.
+     */
+    struct Asset
+    {
+        Asset() : data(nullptr), size(0)
+        {
+
+        }
+
+        const unsigned char* data;
+        size_t size;
+
+        /**
+         * Keeps the memory data points into alive.
+         */
+        std::shared_ptr<const void> owner;
+    };
+
+    /**
+     * Opens the given pack, returning null if it can't be mapped or isn't a
+     * valid pack.
+     */
+    static std::shared_ptr<AssetPack> Open(const std::string& fileName);
+
+    /**
+     * Should NEVER be used. Only public because make_shared requires it.
+     */
+    AssetPack();
+
+    /**
+     * Destructor, unmapping the pack.
+     */
+    ~AssetPack();
+
+    /**
+     * Obtains whether the pack contains the given asset.
+     */
+    bool Contains(const std::string& name);
+
+    /**
+     * Reads the given asset, decompressing it if needed. Returns false if
+     * the pack doesn't contain it or it couldn't be decompressed.
+     */
+    bool Read(const std::string& name, Asset& asset);
+
+    /**
+     * Obtains the number of assets in the pack.
+     */
+    unsigned int GetEntryCount();
+
+    /**
+     * Obtains the name of the asset at the given position of the index.
+     */
+    std::string GetEntryName(unsigned int index);
+
+    /**
+     * Obtains the file name of the pack.
+     */
+    std::string GetFileName();
+
+    /**
+     * Converts a file name to the form assets are stored under in packs:
+     * forward slashes, without any leading "./".
+     */
+    static std::string NormalizeName(const std::string& name);
+
+private:
+    // Private constructors to disallow access.
+    AssetPack(AssetPack const &other);
+    AssetPack operator=(AssetPack other);
+
+    /**
+     * Maps the given file and checks its header and index.
+     */
+    bool open(const std::string& fileName);
+
+    /**
+     * Finds the index entry of the given normalized name, or null.
+     */
+    const AssetPackFormat::Entry* find(const std::string& name);
+
+    /**
+     * Checks that every entry lies within the mapping with its data aligned,
+     * and that the index is sorted by name without duplicates.
+     */
+    bool validate();
+
+    std::string fileName;
+    const unsigned char* mapping;
+    size_t mappingSize;
+    const AssetPackFormat::Entry* entries;
+    unsigned int entryCount;
+    const char* names;
+};
+
+#endif
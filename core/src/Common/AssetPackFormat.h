@@ -0,0 +1,53 @@
+#ifndef Core_AssetPackFormat_h
+#define Core_AssetPackFormat_h
+
+#include <cstdint>
+
+/**
+ * The layout of an asset pack file, shared by the engine's AssetPack and
+ * the AssetPacker tool. Every value is little endian.
+ *
+ * A pack starts with a Header, followed by the index: entryCount Entry
+ * records sorted by name, so an asset can be found by binary search. Then
+ * comes the name table, the names of every entry back to back without
+ * terminators. The data of each entry follows, starting on an ALIGNMENT
+ * byte boundary so it can be handed to loaders straight from the mapped
+ * file.
+ *
+ * Entries flagged with FLAG_LZ4 are stored as a single LZ4 block (see
+ * LZ4Block), which decompresses to size bytes.
+ */
+struct AssetPackFormat
+{
+    /**
+     * "EPAK", read as a little endian integer.
+     */
+    static const uint32_t MAGIC = 0x4B415045;
+    static const uint32_t VERSION = 1;
+    static const uint32_t ALIGNMENT = 64;
+    static const uint32_t FLAG_LZ4 = 1;
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t alignment;
+        uint64_t indexOffset;
+        uint64_t namesOffset;
+        uint64_t namesSize;
+    };
+
+    struct Entry
+    {
+        uint64_t dataOffset;
+        uint64_t storedSize;
+        uint64_t size;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t flags;
+        uint32_t reserved;
+    };
+};
+
+#endif
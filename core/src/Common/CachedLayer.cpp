@@ -0,0 +1,134 @@
+#include <stdexcept>
+#include "CachedLayer.h"
+
+CachedLayer::CachedLayer(float x, float y, float width, float height, unsigned int pixelWidth, unsigned int pixelHeight)
+: x(x),
+y(y),
+width(width),
+height(height),
+pixelWidth(pixelWidth),
+pixelHeight(pixelHeight),
+revision(1),
+hitCount(0),
+missCount(0)
+{
+    if (width <= 0.0f || height <= 0.0f || pixelWidth == 0 || pixelHeight == 0)
+    {
+        throw new std::invalid_argument("A cached layer must have a positive size.");
+    }
+}
+
+CachedLayer::~CachedLayer()
+{
+
+}
+
+void CachedLayer::RegisterSprite(std::shared_ptr<Sprite> sprite)
+{
+    this->contentsMutex.lock();
+    bool inserted = this->sprites.insert(sprite).second;
+    this->contentsMutex.unlock();
+    if (!inserted)
+    {
+        throw new std::invalid_argument("A sprite was registered that was already registered.");
+    }
+    this->Invalidate();
+}
+
+void CachedLayer::UnRegisterSprite(std::shared_ptr<Sprite> sprite)
+{
+    this->contentsMutex.lock();
+    bool erased = this->sprites.erase(sprite) == 1;
+    this->contentsMutex.unlock();
+    if (!erased)
+    {
+        throw new std::invalid_argument("A sprite was unregistered that wasn't registered.");
+    }
+    this->Invalidate();
+}
+
+void CachedLayer::RegisterQuadSource(std::shared_ptr<QuadSource> quadSource)
+{
+    this->contentsMutex.lock();
+    bool inserted = this->quadSources.insert(quadSource).second;
+    this->contentsMutex.unlock();
+    if (!inserted)
+    {
+        throw new std::invalid_argument("A quad source was registered that was already registered.");
+    }
+    this->Invalidate();
+}
+
+void CachedLayer::UnRegisterQuadSource(std::shared_ptr<QuadSource> quadSource)
+{
+    this->contentsMutex.lock();
+    bool erased = this->quadSources.erase(quadSource) == 1;
+    this->contentsMutex.unlock();
+    if (!erased)
+    {
+        throw new std::invalid_argument("A quad source was unregistered that wasn't registered.");
+    }
+    this->Invalidate();
+}
+
+void CachedLayer::Invalidate()
+{
+    this->revision++;
+}
+
+unsigned long CachedLayer::GetRevision()
+{
+    return this->revision;
+}
+
+float CachedLayer::GetX()
+{
+    return this->x;
+}
+
+float CachedLayer::GetY()
+{
+    return this->y;
+}
+
+float CachedLayer::GetWidth()
+{
+    return this->width;
+}
+
+float CachedLayer::GetHeight()
+{
+    return this->height;
+}
+
+unsigned int CachedLayer::GetPixelWidth()
+{
+    return this->pixelWidth;
+}
+
+unsigned int CachedLayer::GetPixelHeight()
+{
+    return this->pixelHeight;
+}
+
+unsigned long CachedLayer::GetHitCount()
+{
+    return this->hitCount;
+}
+
+unsigned long CachedLayer::GetMissCount()
+{
+    return this->missCount;
+}
+
+void CachedLayer::RecordFrame(bool hit)
+{
+    if (hit)
+    {
+        this->hitCount++;
+    }
+    else
+    {
+        this->missCount++;
+    }
+}
@@ -0,0 +1,151 @@
+#ifndef Core_CachedLayer_h
+#define Core_CachedLayer_h
+
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <memory>
+
+class Sprite;
+class QuadSource;
+class GraphicsManager;
+
+/**
+ * A group of sprites and quad sources, such as a HUD or menu, that is
+ * rendered into an offscreen texture and drawn on top of the world as a
+ * single textured quad.
+ *
+ * The texture is only re-rendered when the layer's revision changes.
+ * Registering or unregistering contents bumps the revision automatically;
+ * after moving, resizing, or recoloring anything already in the layer, or
+ * changing text drawn by one of its quad sources, call Invalidate.
+ *
+ * The layer covers a rectangle of the world given by its top-left corner
+ * and dimensions, like a Sprite, and is rendered at a fixed resolution.
+ */
+class CachedLayer
+{
+public:
+    /**
+     * Creates a layer covering the given world rectangle, rendered into a
+     * texture of pixelWidth x pixelHeight pixels.
+     */
+    CachedLayer(float x, float y, float width, float height, unsigned int pixelWidth, unsigned int pixelHeight);
+
+    /**
+     * Destructor
+     */
+    ~CachedLayer();
+
+    /**
+     * Adds a sprite to the layer.
+     *
+     * Throws an invalid_argument if the sprite was already registered.
+     */
+    void RegisterSprite(std::shared_ptr<Sprite> sprite);
+
+    /**
+     * Removes a sprite from the layer.
+     *
+     * Throws an invalid_argument if the sprite wasn't registered.
+     */
+    void UnRegisterSprite(std::shared_ptr<Sprite> sprite);
+
+    /**
+     * Adds a quad source to the layer, drawn after its sprites.
+     *
+     * Throws an invalid_argument if the quad source was already registered.
+     */
+    void RegisterQuadSource(std::shared_ptr<QuadSource> quadSource);
+
+    /**
+     * Removes a quad source from the layer.
+     *
+     * Throws an invalid_argument if the quad source wasn't registered.
+     */
+    void UnRegisterQuadSource(std::shared_ptr<QuadSource> quadSource);
+
+    /**
+     * Marks the layer's contents as changed so it is re-rendered next frame.
+     */
+    void Invalidate();
+
+    /**
+     * Obtains the layer's revision, which changes whenever it must be
+     * re-rendered.
+     */
+    unsigned long GetRevision();
+
+    /**
+     * Obtains the x coordinate of the layer's left edge
+     */
+    float GetX();
+
+    /**
+     * Obtains the y coordinate of the layer's top edge
+     */
+    float GetY();
+
+    /**
+     * Obtains the width of the layer in world units
+     */
+    float GetWidth();
+
+    /**
+     * Obtains the height of the layer in world units
+     */
+    float GetHeight();
+
+    /**
+     * Obtains the width of the layer's texture in pixels
+     */
+    unsigned int GetPixelWidth();
+
+    /**
+     * Obtains the height of the layer's texture in pixels
+     */
+    unsigned int GetPixelHeight();
+
+    /**
+     * Obtains the number of frames the cached texture was drawn as-is.
+     */
+    unsigned long GetHitCount();
+
+    /**
+     * Obtains the number of frames the texture had to be re-rendered.
+     */
+    unsigned long GetMissCount();
+
+    /**
+     * Records whether the view reused or re-rendered the texture this frame.
+     * Should be called only by GraphicsView.
+     */
+    void RecordFrame(bool hit);
+
+private:
+    // Private constructors to disallow access.
+    CachedLayer(CachedLayer const &other);
+    CachedLayer operator=(CachedLayer other);
+
+    friend class GraphicsManager;
+
+    float x;
+    float y;
+    float width;
+    float height;
+    unsigned int pixelWidth;
+    unsigned int pixelHeight;
+    std::atomic<unsigned long> revision;
+    std::atomic<unsigned long> hitCount;
+    std::atomic<unsigned long> missCount;
+
+    /**
+     * Guards the layer contents, which are changed on the game thread and
+     * rendered from the view thread.
+     */
+    std::mutex contentsMutex;
+    std::set<std::shared_ptr<Sprite>> sprites;
+    std::set<std::shared_ptr<QuadSource>> quadSources;
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef Core_DecodedTexture_h
+#define Core_DecodedTexture_h
+
+#include <vector>
+#include "ResourceHandles.h"
+#include "AssetPack.h"
+
+/**
+ * An image decoded on a worker thread, waiting in staging memory for the
+ * view thread to upload it.
+ *
+ * Uncompressed images are always RGBA with their rows already flipped
+ * bottom-up, ready for glTexSubImage2D. Cooked textures are kept as the
+ * raw contents of their DDS file, which is uploaded as-is; when it comes
+ * from an asset pack it is read straight out of the mapped pack.
+ */
+struct DecodedTexture
+{
+    /**
+     * The texture being loaded.
+     */
+    TextureHandle texture;
+
+    /**
+     * Whether the image could be read. Failed textures are still handed to
+     * the view thread so their callbacks are run.
+     */
+    bool succeeded;
+
+    /**
+     * Whether cookedFile holds a cooked DDS file instead of data holding
+     * RGBA pixels.
+     */
+    bool cooked;
+
+    int width;
+    int height;
+    std::vector<unsigned char> data;
+    AssetPack::Asset cookedFile;
+};
+
+#endif
@@ -0,0 +1,11 @@
+#include "MouseRelativeMotionEvent.h"
+
+MouseRelativeMotionEvent::MouseRelativeMotionEvent(int dx, int dy) : dx(dx), dy(dy)
+{
+
+}
+
+MouseRelativeMotionEvent::MouseRelativeMotionEvent(MouseRelativeMotionEvent const &other) : MouseRelativeMotionEvent(other.dx, other.dy)
+{
+
+}
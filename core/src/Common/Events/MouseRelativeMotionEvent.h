@@ -0,0 +1,27 @@
+#ifndef Core_MouseRelativeMotionEvent_h
+#define Core_MouseRelativeMotionEvent_h
+
+#include "InputEvent.h"
+
+/**
+ * Input event fired once per frame when the mouse moves while the cursor is locked
+ */
+class MouseRelativeMotionEvent : public InputEvent {
+public:
+    /**
+     * Event constructor
+     * @param dx how far the mouse moved to the right since the previous event, in pixels
+     * @param dy how far the mouse moved down since the previous event, in pixels
+     */
+    MouseRelativeMotionEvent(int dx, int dy);
+
+    MouseRelativeMotionEvent(MouseRelativeMotionEvent const &other);
+    
+    const int dx;
+    const int dy;
+private:
+    // Private constructors to disallow access.
+    MouseRelativeMotionEvent operator=(MouseRelativeMotionEvent other);
+};
+
+#endif
@@ -1,13 +1,23 @@
 #include <stdexcept>
 #include <thread>
 #include <chrono>
+#include <algorithm>
 #include "GraphicsManager.h"
 #include "Color.h"
 #include "Sprite.h"
+#include "QuadSource.h"
+#include "VertexStream.h"
+#include "CachedLayer.h"
+#include "ResourceManager.h"
 
-GraphicsManager::GraphicsManager() : clearColor(0.0f, 0.0f, 0.0f, 1.0f)
+GraphicsManager::GraphicsManager() : clearColor(0.0f, 0.0f, 0.0f, 1.0f), overdrawStatsEnabled(false)
 {
+    this->overdrawStats.opaqueSpriteCount = 0;
+    this->overdrawStats.blendedSpriteCount = 0;
+    this->overdrawStats.opaqueCoverage = 0.0f;
+    this->overdrawStats.blendedCoverage = 0.0f;
     this->camera = std::make_shared<Camera>();
+    this->sceneGraph = std::make_shared<SceneGraph>();
 }
 
 GraphicsManager::~GraphicsManager()
@@ -49,6 +59,82 @@ void GraphicsManager::UnRegisterSprite(std::shared_ptr<Sprite> sprite)
     this->registeredSpritesMutex.unlock();
 }
 
+void GraphicsManager::RegisterQuadSource(std::shared_ptr<QuadSource> quadSource)
+{
+    this->registeredSpritesMutex.lock();
+    bool inserted = this->registeredQuadSources.insert(quadSource).second;
+    this->registeredSpritesMutex.unlock();
+    if (!inserted)
+    {
+        throw new std::invalid_argument("A quad source was registered that was already registered.");
+    }
+}
+
+void GraphicsManager::UnRegisterQuadSource(std::shared_ptr<QuadSource> quadSource)
+{
+    this->registeredSpritesMutex.lock();
+    bool erased = this->registeredQuadSources.erase(quadSource) == 1;
+    this->registeredSpritesMutex.unlock();
+    if (!erased)
+    {
+        throw new std::invalid_argument("A quad source was unregistered that wasn't registered.");
+    }
+}
+
+void GraphicsManager::RegisterCachedLayer(std::shared_ptr<CachedLayer> layer)
+{
+    this->registeredSpritesMutex.lock();
+    bool registered = std::find(this->registeredCachedLayers.begin(), this->registeredCachedLayers.end(), layer) != this->registeredCachedLayers.end();
+    if (!registered)
+    {
+        this->registeredCachedLayers.push_back(layer);
+    }
+    this->registeredSpritesMutex.unlock();
+    if (registered)
+    {
+        throw new std::invalid_argument("A cached layer was registered that was already registered.");
+    }
+}
+
+void GraphicsManager::UnRegisterCachedLayer(std::shared_ptr<CachedLayer> layer)
+{
+    this->registeredSpritesMutex.lock();
+    auto position = std::find(this->registeredCachedLayers.begin(), this->registeredCachedLayers.end(), layer);
+    bool registered = position != this->registeredCachedLayers.end();
+    if (registered)
+    {
+        this->registeredCachedLayers.erase(position);
+    }
+    this->registeredSpritesMutex.unlock();
+    if (!registered)
+    {
+        throw new std::invalid_argument("A cached layer was unregistered that wasn't registered.");
+    }
+}
+
+std::vector<std::shared_ptr<CachedLayer>> GraphicsManager::GetCachedLayers()
+{
+    this->registeredSpritesMutex.lock();
+    std::vector<std::shared_ptr<CachedLayer>> layers = this->registeredCachedLayers;
+    this->registeredSpritesMutex.unlock();
+    return layers;
+}
+
+void GraphicsManager::SetOverdrawStatsEnabled(bool enabled)
+{
+    this->registeredSpritesMutex.lock();
+    this->overdrawStatsEnabled = enabled;
+    this->registeredSpritesMutex.unlock();
+}
+
+GraphicsManager::OverdrawStats GraphicsManager::GetOverdrawStats()
+{
+    this->registeredSpritesMutex.lock();
+    OverdrawStats stats = this->overdrawStats;
+    this->registeredSpritesMutex.unlock();
+    return stats;
+}
+
 int GraphicsManager::GetSpriteCount()
 {
     return (int)this->registeredSprites.size();
@@ -59,6 +145,11 @@ std::shared_ptr<Camera> GraphicsManager::GetCamera()
     return this->camera;
 }
 
+std::shared_ptr<SceneGraph> GraphicsManager::GetSceneGraph()
+{
+    return this->sceneGraph;
+}
+
 void GraphicsManager::PrepareToAddSprites()
 {
     this->registeredSpritesMutex.lock();
@@ -79,3 +170,155 @@ bool GraphicsManager::AddSpriteToVCIBuffer(float* vertexBuffer, float* colorBuff
     this->spriteIterator++;
     return true;
 }
+
+void GraphicsManager::FillVertexStream(VertexStream& stream)
+{
+    this->registeredSpritesMutex.lock();
+    OverdrawStats* stats = this->overdrawStatsEnabled ? &this->overdrawStats : nullptr;
+    this->addToVertexStream(this->registeredSprites, this->registeredQuadSources, stream, stats);
+    this->registeredSpritesMutex.unlock();
+}
+
+void GraphicsManager::FillCachedLayerVertexStream(std::shared_ptr<CachedLayer> layer, VertexStream& stream)
+{
+    this->registeredSpritesMutex.lock();
+    layer->contentsMutex.lock();
+    this->addToVertexStream(layer->sprites, layer->quadSources, stream, nullptr);
+    layer->contentsMutex.unlock();
+    this->registeredSpritesMutex.unlock();
+}
+
+void GraphicsManager::addToVertexStream(std::set<std::shared_ptr<Sprite>>& sprites, std::set<std::shared_ptr<QuadSource>>& quadSources, VertexStream& stream, OverdrawStats* stats)
+{
+    this->opaqueSprites.clear();
+    this->blendedSprites.clear();
+    for (auto it = sprites.begin(); it != sprites.end(); it++)
+    {
+        if ((*it)->IsOpaque())
+        {
+            this->opaqueSprites.push_back(it->get());
+        }
+        else
+        {
+            this->blendedSprites.push_back(it->get());
+        }
+    }
+    std::stable_sort(this->opaqueSprites.begin(), this->opaqueSprites.end(), [](Sprite* first, Sprite* second)
+    {
+        // Sprites at the same depth are grouped by texture so they batch
+        if (first->GetDepth() != second->GetDepth())
+        {
+            return first->GetDepth() < second->GetDepth();
+        }
+        return first->GetTexture() < second->GetTexture();
+    });
+    std::stable_sort(this->blendedSprites.begin(), this->blendedSprites.end(), [](Sprite* first, Sprite* second)
+    {
+        // Sprites at the same depth are grouped by texture so they batch
+        if (first->GetDepth() != second->GetDepth())
+        {
+            return first->GetDepth() > second->GetDepth();
+        }
+        return first->GetTexture() < second->GetTexture();
+    });
+
+    this->sceneGraph->PrepareToReadWorldTransforms();
+    stream.SetBlending(false);
+    float opaqueCoverage = this->addSortedSpritesToStream(this->opaqueSprites, stream, stats != nullptr);
+    stream.SetBlending(true);
+    float blendedCoverage = this->addSortedSpritesToStream(this->blendedSprites, stream, stats != nullptr);
+    this->sceneGraph->FinishReadingWorldTransforms();
+
+    if (stats != nullptr)
+    {
+        stats->opaqueSpriteCount = (unsigned int)this->opaqueSprites.size();
+        stats->blendedSpriteCount = (unsigned int)this->blendedSprites.size();
+        stats->opaqueCoverage = opaqueCoverage;
+        stats->blendedCoverage = blendedCoverage;
+    }
+
+    for (auto it = quadSources.begin(); it != quadSources.end(); it++)
+    {
+        // Quad sources that don't choose a texture are drawn untextured.
+        stream.SetTexture(0);
+        (*it)->PutGLQuads(stream);
+    }
+}
+
+float GraphicsManager::addSortedSpritesToStream(std::vector<Sprite*>& sprites, VertexStream& stream, bool measureCoverage)
+{
+    // Each sprite is added separately so the stream can start a new batch
+    // whenever the texture changes, but the quads are still contiguous.
+    std::shared_ptr<ResourceManager> resourceManager = ResourceManager::GetInstance();
+    TextureHandle lastTexture;
+    unsigned int textureUnit = 0;
+    unsigned int firstQuad = stream.GetQuadCount();
+    stream.SetTexture(0);
+    this->spriteBatch.Clear();
+    for (auto it = sprites.begin(); it != sprites.end(); it++)
+    {
+        Sprite* sprite = *it;
+        TextureHandle texture = sprite->GetTexture();
+        if (texture != lastTexture)
+        {
+            textureUnit = resourceManager->GetTextureUnit(texture);
+            lastTexture = texture;
+            stream.SetTexture(textureUnit);
+        }
+        unsigned int quad = stream.AddQuads(1);
+        if (textureUnit != 0)
+        {
+            sprite->PutGLTexCoordInfo(stream.GetTexCoordData(quad));
+        }
+
+        SceneGraph::NodeID node = sprite->GetNode();
+        if (node == SceneGraph::NO_NODE)
+        {
+            this->spriteBatch.Add(sprite->GetLocalTransform(), sprite->GetWidth(), sprite->GetHeight(), -sprite->GetDepth());
+        }
+        else
+        {
+            AffineTransform world = AffineTransform::Multiply(this->sceneGraph->ReadWorldTransform(node), sprite->GetLocalTransform());
+            this->spriteBatch.Add(world, sprite->GetWidth(), sprite->GetHeight(), -sprite->GetDepth());
+        }
+        sprite->PutGLColorInfo(stream.GetColorData(quad));
+    }
+    if (this->spriteBatch.GetCount() == 0)
+    {
+        return 0.0f;
+    }
+    this->spriteBatch.PutGLVertexInfo(stream.GetVertexData(firstQuad));
+    if (!measureCoverage)
+    {
+        return 0.0f;
+    }
+
+    // Estimate the covered area from each quad's bounding box, clipped to
+    // the camera.
+    float cameraLeft = this->camera->GetLeft();
+    float cameraRight = this->camera->GetRight();
+    // The camera may have its y axis reversed
+    float cameraBottom = std::min(this->camera->GetBottom(), this->camera->GetTop());
+    float cameraTop = std::max(this->camera->GetBottom(), this->camera->GetTop());
+    float cameraArea = (cameraRight - cameraLeft) * (cameraTop - cameraBottom);
+    if (cameraArea <= 0.0f)
+    {
+        return 0.0f;
+    }
+    float coveredArea = 0.0f;
+    for (unsigned int i = 0; i < this->spriteBatch.GetCount(); i++)
+    {
+        float* vertices = stream.GetVertexData(firstQuad + i);
+        float left = std::min(std::min(vertices[0], vertices[4]), std::min(vertices[8], vertices[12]));
+        float right = std::max(std::max(vertices[0], vertices[4]), std::max(vertices[8], vertices[12]));
+        float bottom = std::min(std::min(vertices[1], vertices[5]), std::min(vertices[9], vertices[13]));
+        float top = std::max(std::max(vertices[1], vertices[5]), std::max(vertices[9], vertices[13]));
+        float width = std::min(right, cameraRight) - std::max(left, cameraLeft);
+        float height = std::min(top, cameraTop) - std::max(bottom, cameraBottom);
+        if (width > 0.0f && height > 0.0f)
+        {
+            coveredArea += width * height;
+        }
+    }
+    return coveredArea / cameraArea;
+}
@@ -2,13 +2,19 @@
 #define Core_GraphicsManager_h
 
 #include <set>
+#include <vector>
 #include <iterator>
 #include <mutex>
 #include <memory>
 #include "Color.h"
 #include "Camera.h"
+#include "SceneGraph.h"
+#include "AffineQuadBatch.h"
 
 class Sprite;
+class QuadSource;
+class VertexStream;
+class CachedLayer;
 
 /**
  * Manages all graphical work provided by the engine.  Current functionality:
@@ -22,11 +28,45 @@ class Sprite;
  * moved, resized, and recolored while they're registered, and this change will
  * be reflected in the view.
  *
+ * Scene graph: Sprites may be attached to nodes of the scene graph so that
+ * groups of sprites can be moved, rotated, and scaled together.
+ *
+ * Quad sources: Systems that draw many quads at once, such as particle systems,
+ * register a QuadSource instead of individual sprites. Quad sources write
+ * straight into the view's vertex stream after the sprites each frame.
+ *
+ * Depth: Fully opaque sprites, untextured or marked with Sprite::SetOpaque,
+ * are drawn front-to-back so pixels hidden behind them are rejected by the
+ * depth test, followed by translucent sprites back-to-front and then quad
+ * sources. Enable the overdraw statistics to see how much of the screen the
+ * sprites cover each frame.
+ *
+ * Cached layers: Rarely changing groups of sprites, such as a HUD, can be put
+ * in a CachedLayer. Registered layers are drawn on top of everything else in
+ * the order they were registered, and only re-rendered when they change.
+ *
  * It also provides a few other methods used internally within the engine.
  */
 class GraphicsManager
 {
 public:
+    /**
+     * Debugging statistics on how much the sprites drawn in a frame overlap.
+     *
+     * Coverage is the total screen area of the sprites' bounding boxes,
+     * clipped to the camera, divided by the camera's area; 1.0 means the
+     * sprites would fill the screen exactly once. Opaque coverage beyond
+     * 1.0 is mostly rejected by the depth test, while translucent coverage
+     * is always paid for in full.
+     */
+    struct OverdrawStats
+    {
+        unsigned int opaqueSpriteCount;
+        unsigned int blendedSpriteCount;
+        float opaqueCoverage;
+        float blendedCoverage;
+    };
+
     /**
      * Default constructor that creates a new instance of a GraphicsManager.
      */
@@ -66,6 +106,51 @@ public:
      */
     void UnRegisterSprite(std::shared_ptr<Sprite> sprite);
 
+    /**
+     * Registers a quad source to be drawn after the sprites
+     *
+     * Throws an invalid_argument if the quad source was already registered.
+     */
+    void RegisterQuadSource(std::shared_ptr<QuadSource> quadSource);
+
+    /**
+     * Unregisters a quad source so it will no longer be drawn
+     *
+     * Throws an invalid_argument if the quad source wasn't registered.
+     */
+    void UnRegisterQuadSource(std::shared_ptr<QuadSource> quadSource);
+
+    /**
+     * Registers a cached layer to be drawn on top of the world
+     *
+     * Throws an invalid_argument if the layer was already registered.
+     */
+    void RegisterCachedLayer(std::shared_ptr<CachedLayer> layer);
+
+    /**
+     * Unregisters a cached layer so it will no longer be drawn
+     *
+     * Throws an invalid_argument if the layer wasn't registered.
+     */
+    void UnRegisterCachedLayer(std::shared_ptr<CachedLayer> layer);
+
+    /**
+     * Obtains the registered cached layers in drawing order.
+     */
+    std::vector<std::shared_ptr<CachedLayer>> GetCachedLayers();
+
+    /**
+     * Enables or disables gathering overdraw statistics each frame. They are
+     * off by default since gathering them costs time.
+     */
+    void SetOverdrawStatsEnabled(bool enabled);
+
+    /**
+     * Obtains the overdraw statistics of the last frame drawn while they
+     * were enabled.
+     */
+    OverdrawStats GetOverdrawStats();
+
     /**
      * Obtains the number of registered sprite.
      */
@@ -76,6 +161,11 @@ public:
      */
     std::shared_ptr<Camera> GetCamera();
 
+    /**
+     * Obtains a pointer to the scene graph sprites can be attached to.
+     */
+    std::shared_ptr<SceneGraph> GetSceneGraph();
+
     /**
      * Prepares to add all sprites with the AddSpriteToVCIBuffer method
      */
@@ -94,16 +184,62 @@ public:
      */
     bool AddSpriteToVCIBuffer(float* vertexBuffer, float* colorBuffer, unsigned short* indexBuffer, unsigned short dataStartIndex);
 
+    /**
+     * Appends every registered sprite, followed by every registered quad
+     * source, to the given vertex stream so they can be drawn as a single
+     * batch.
+     */
+    void FillVertexStream(VertexStream& stream);
+
+    /**
+     * Appends every sprite, followed by every quad source, of the given
+     * cached layer to the given vertex stream.
+     */
+    void FillCachedLayerVertexStream(std::shared_ptr<CachedLayer> layer, VertexStream& stream);
+
 private:
     // Private constructors to disallow access.
     GraphicsManager(GraphicsManager const &other);
     GraphicsManager operator=(GraphicsManager other);
 
+    /**
+     * Appends the given sprites, opaque ones front-to-back and then
+     * translucent ones back-to-front, followed by the given quad sources to
+     * the stream. Gathers overdraw statistics into the given stats unless
+     * it is null. Must be called with registeredSpritesMutex held.
+     */
+    void addToVertexStream(std::set<std::shared_ptr<Sprite>>& sprites, std::set<std::shared_ptr<QuadSource>>& quadSources, VertexStream& stream, OverdrawStats* stats);
+
+    /**
+     * Appends the sorted sprites to the stream as a single run, returning
+     * their coverage of the camera.
+     */
+    float addSortedSpritesToStream(std::vector<Sprite*>& sprites, VertexStream& stream, bool measureCoverage);
+
     Color clearColor;
     std::shared_ptr<Camera> camera;
+    std::shared_ptr<SceneGraph> sceneGraph;
     std::set<std::shared_ptr<Sprite>> registeredSprites;
     std::mutex registeredSpritesMutex;
     std::set<std::shared_ptr<Sprite>>::iterator spriteIterator;
+    std::set<std::shared_ptr<QuadSource>> registeredQuadSources;
+    std::vector<std::shared_ptr<CachedLayer>> registeredCachedLayers;
+
+    /**
+     * Sprite transforms gathered during FillVertexStream so that their
+     * vertices can be expanded in one vectorized pass.
+     */
+    AffineQuadBatch spriteBatch;
+
+    /**
+     * Sprites split by opacity and sorted by depth while filling the stream,
+     * kept between frames to avoid reallocating.
+     */
+    std::vector<Sprite*> opaqueSprites;
+    std::vector<Sprite*> blendedSprites;
+
+    bool overdrawStatsEnabled;
+    OverdrawStats overdrawStats;
 };
 
 #endif
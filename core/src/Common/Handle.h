@@ -0,0 +1,229 @@
+#ifndef Core_Handle_h
+#define Core_Handle_h
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * A typed reference to an entry of a HandleTable.
+ *
+ * A handle is a slot index plus the generation of the slot when the entry
+ * was inserted. Removing an entry bumps its slot's generation, so handles to
+ * removed entries can be detected even after the slot is reused. The Tag
+ * only distinguishes handle types, such as TextureHandle and SoundHandle,
+ * so that one can't be passed where the other is expected.
+ *
+ * Default constructed handles are null and never resolve to anything.
+ */
+template <typename Tag>
+class Handle final
+{
+public:
+    /**
+     * Creates a null handle.
+     */
+    Handle() : index(0), generation(0)
+    {
+    }
+
+    /**
+     * Creates a handle to the given slot and generation.
+     */
+    Handle(unsigned int index, unsigned int generation) : index(index), generation(generation)
+    {
+    }
+
+    /**
+     * Obtains the slot the handle refers to.
+     */
+    unsigned int GetIndex() const
+    {
+        return this->index;
+    }
+
+    /**
+     * Obtains the generation of the slot the handle was created for.
+     */
+    unsigned int GetGeneration() const
+    {
+        return this->generation;
+    }
+
+    /**
+     * Obtains whether this is a null handle.
+     */
+    bool IsNull() const
+    {
+        return this->generation == 0;
+    }
+
+    bool operator==(const Handle& other) const
+    {
+        return this->index == other.index && this->generation == other.generation;
+    }
+
+    bool operator!=(const Handle& other) const
+    {
+        return !(*this == other);
+    }
+
+    bool operator<(const Handle& other) const
+    {
+        return this->index < other.index || (this->index == other.index && this->generation < other.generation);
+    }
+
+    /**
+     * Hashes handles, for use as the key of an unordered_map.
+     */
+    struct Hash
+    {
+        size_t operator()(const Handle& handle) const
+        {
+            return (size_t)handle.index * 2654435761u ^ handle.generation;
+        }
+    };
+
+private:
+    unsigned int index;
+    unsigned int generation;
+};
+
+/**
+ * Stores values in a dense array of slots addressed by Handles.
+ *
+ * Inserting, removing, and resolving a handle are all O(1). Removed slots
+ * are reused by later inserts, and each removal bumps the slot's generation
+ * so stale handles resolve to nothing instead of to the slot's new value.
+ *
+ * HandleTable isn't thread safe; its owner is expected to guard it.
+ */
+template <typename T, typename Tag>
+class HandleTable final
+{
+public:
+    typedef Handle<Tag> HandleType;
+
+    /**
+     * Creates an empty table.
+     */
+    HandleTable() : count(0)
+    {
+    }
+
+    /**
+     * Stores a value, returning the handle to reach it with.
+     */
+    HandleType Insert(const T& value)
+    {
+        unsigned int index;
+        if (this->freeSlots.empty())
+        {
+            index = (unsigned int)this->slots.size();
+            Slot slot;
+            slot.generation = 1;
+            slot.occupied = false;
+            this->slots.push_back(slot);
+        }
+        else
+        {
+            index = this->freeSlots.back();
+            this->freeSlots.pop_back();
+        }
+        Slot& slot = this->slots[index];
+        slot.value = value;
+        slot.occupied = true;
+        this->count++;
+        return HandleType(index, slot.generation);
+    }
+
+    /**
+     * Removes the value the given handle refers to. Returns false if the
+     * handle was null or stale.
+     */
+    bool Remove(HandleType handle)
+    {
+        if (!this->Contains(handle))
+        {
+            return false;
+        }
+        Slot& slot = this->slots[handle.GetIndex()];
+        slot.value = T();
+        slot.occupied = false;
+        slot.generation++;
+        if (slot.generation == 0)
+        {
+            // Generation 0 is reserved for null handles
+            slot.generation = 1;
+        }
+        this->freeSlots.push_back(handle.GetIndex());
+        this->count--;
+        return true;
+    }
+
+    /**
+     * Obtains the value the given handle refers to, or null if the handle
+     * is null or stale. The pointer is invalidated by the next Insert.
+     */
+    T* Get(HandleType handle)
+    {
+        if (!this->Contains(handle))
+        {
+            return nullptr;
+        }
+        return &this->slots[handle.GetIndex()].value;
+    }
+
+    /**
+     * Obtains whether the given handle refers to a value in the table.
+     */
+    bool Contains(HandleType handle) const
+    {
+        return handle.GetIndex() < this->slots.size() &&
+            this->slots[handle.GetIndex()].occupied &&
+            this->slots[handle.GetIndex()].generation == handle.GetGeneration();
+    }
+
+    /**
+     * Obtains the number of values in the table.
+     */
+    unsigned int GetCount() const
+    {
+        return this->count;
+    }
+
+    /**
+     * Obtains the number of slots, occupied or not. Together with
+     * GetHandleAt, this allows iterating over every value.
+     */
+    unsigned int GetSlotCount() const
+    {
+        return (unsigned int)this->slots.size();
+    }
+
+    /**
+     * Obtains the handle of the value in the given slot, or a null handle
+     * if the slot is empty.
+     */
+    HandleType GetHandleAt(unsigned int index) const
+    {
+        if (index >= this->slots.size() || !this->slots[index].occupied)
+        {
+            return HandleType();
+        }
+        return HandleType(index, this->slots[index].generation);
+    }
+
+private:
+    struct Slot
+    {
+        T value;
+        unsigned int generation;
+        bool occupied;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<unsigned int> freeSlots;
+    unsigned int count;
+};
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef Core_HandlerList_h
+#define Core_HandlerList_h
+
+#include <vector>
+#include <utility>
+
+/**
+ * Identifies a handler added to the InputManager, so it can be removed
+ * again. 0 is never a valid id.
+ */
+typedef unsigned int HandlerId;
+
+/**
+ * The handlers registered for one input, called in the order they were
+ * added.
+ *
+ * A handler may add or remove handlers, including itself, while it's being
+ * called. Handlers added meanwhile are first called on the next Invoke, and
+ * removed ones aren't called again; the list is only rearranged once every
+ * handler has returned, so none is moved while it runs.
+ */
+template <typename Handler>
+class HandlerList final
+{
+public:
+    HandlerList() : invoking(false), removedWhileInvoking(false)
+    {
+    }
+
+    /**
+     * Adds a handler with the given id.
+     */
+    void Add(HandlerId id, Handler handler)
+    {
+        Entry entry = { id, std::move(handler) };
+        if (this->invoking)
+        {
+            this->added.push_back(std::move(entry));
+        }
+        else
+        {
+            this->entries.push_back(std::move(entry));
+        }
+    }
+
+    /**
+     * Removes the handler with the given id, returning false if it isn't in
+     * this list.
+     */
+    bool Remove(HandlerId id)
+    {
+        for (auto it = this->added.begin(); it != this->added.end(); it++)
+        {
+            if (it->id == id)
+            {
+                this->added.erase(it);
+                return true;
+            }
+        }
+        for (auto it = this->entries.begin(); it != this->entries.end(); it++)
+        {
+            if (it->id == id)
+            {
+                if (this->invoking)
+                {
+                    it->id = 0;
+                    this->removedWhileInvoking = true;
+                }
+                else
+                {
+                    this->entries.erase(it);
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Removes every handler.
+     */
+    void Clear()
+    {
+        this->added.clear();
+        if (this->invoking)
+        {
+            for (auto it = this->entries.begin(); it != this->entries.end(); it++)
+            {
+                it->id = 0;
+            }
+            this->removedWhileInvoking = true;
+        }
+        else
+        {
+            this->entries.clear();
+        }
+    }
+
+    /**
+     * Obtains whether there are no handlers.
+     */
+    bool IsEmpty() const
+    {
+        if (!this->added.empty())
+        {
+            return false;
+        }
+        for (auto it = this->entries.begin(); it != this->entries.end(); it++)
+        {
+            if (it->id != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Calls every handler with the given arguments.
+     */
+    template <typename... Args>
+    void Invoke(const Args&... args)
+    {
+        // Already invoking means a handler raised the same input again;
+        // the outer call tidies up once everything has returned
+        bool outermost = !this->invoking;
+        this->invoking = true;
+        size_t count = this->entries.size();
+        for (size_t i = 0; i < count; i++)
+        {
+            if (this->entries[i].id != 0 && this->entries[i].handler)
+            {
+                this->entries[i].handler(args...);
+            }
+        }
+        if (!outermost)
+        {
+            return;
+        }
+        this->invoking = false;
+
+        if (this->removedWhileInvoking)
+        {
+            size_t kept = 0;
+            for (size_t i = 0; i < this->entries.size(); i++)
+            {
+                if (this->entries[i].id != 0)
+                {
+                    if (kept != i)
+                    {
+                        this->entries[kept] = std::move(this->entries[i]);
+                    }
+                    kept++;
+                }
+            }
+            this->entries.resize(kept);
+            this->removedWhileInvoking = false;
+        }
+        for (auto it = this->added.begin(); it != this->added.end(); it++)
+        {
+            this->entries.push_back(std::move(*it));
+        }
+        this->added.clear();
+    }
+
+private:
+    struct Entry
+    {
+        HandlerId id;
+        Handler handler;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<Entry> added;
+    bool invoking;
+    bool removedWhileInvoking;
+};
+
+#endif
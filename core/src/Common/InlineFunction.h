@@ -0,0 +1,300 @@
+#ifndef Core_InlineFunction_h
+#define Core_InlineFunction_h
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+template <typename Signature>
+class InlineFunction;
+
+/**
+ * A callable wrapper like std::function that stores small callables inside
+ * itself rather than on the heap.
+ *
+ * Lambdas capturing up to BUFFER_SIZE bytes, such as a this pointer and a
+ * few values, and plain function pointers are stored in place, so creating,
+ * copying and calling them never allocates. Larger callables still work,
+ * but are allocated on the heap like std::function would.
+ *
+ * Like std::function, one created from a null function pointer or an empty
+ * std::function is empty. Calling an empty InlineFunction is undefined;
+ * check it first.
+ */
+template <typename Result, typename... Args>
+class InlineFunction<Result (Args...)> final
+{
+public:
+    /**
+     * The most bytes of callable stored in place.
+     */
+    static const size_t BUFFER_SIZE = 32;
+
+    /**
+     * Creates an empty function.
+     */
+    InlineFunction() : operations(nullptr)
+    {
+    }
+
+    InlineFunction(std::nullptr_t) : operations(nullptr)
+    {
+    }
+
+    /**
+     * Creates a function calling the given callable.
+     */
+    template <typename Function, typename = typename std::enable_if<
+        !std::is_same<typename std::decay<Function>::type, InlineFunction>::value>::type>
+    InlineFunction(Function&& function) : operations(nullptr)
+    {
+        typedef typename std::decay<Function>::type Stored;
+        if (InlineFunction::isNull<Stored>(function, IsNullable<Stored>()))
+        {
+            return;
+        }
+        this->store<Stored>(std::forward<Function>(function), std::integral_constant<bool, InlineFunction::fitsInline<Stored>()>());
+    }
+
+    InlineFunction(const InlineFunction& other) : operations(other.operations)
+    {
+        if (this->operations != nullptr)
+        {
+            this->operations->copy(&this->buffer, &other.buffer);
+        }
+    }
+
+    InlineFunction(InlineFunction&& other) : operations(other.operations)
+    {
+        if (this->operations != nullptr)
+        {
+            this->operations->move(&this->buffer, &other.buffer);
+            other.operations = nullptr;
+        }
+    }
+
+    ~InlineFunction()
+    {
+        this->reset();
+    }
+
+    InlineFunction& operator=(const InlineFunction& other)
+    {
+        if (this != &other)
+        {
+            this->reset();
+            if (other.operations != nullptr)
+            {
+                other.operations->copy(&this->buffer, &other.buffer);
+                this->operations = other.operations;
+            }
+        }
+        return *this;
+    }
+
+    InlineFunction& operator=(InlineFunction&& other)
+    {
+        if (this != &other)
+        {
+            this->reset();
+            if (other.operations != nullptr)
+            {
+                other.operations->move(&this->buffer, &other.buffer);
+                this->operations = other.operations;
+                other.operations = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    InlineFunction& operator=(std::nullptr_t)
+    {
+        this->reset();
+        return *this;
+    }
+
+    /**
+     * Obtains whether there is a callable to call.
+     */
+    explicit operator bool() const
+    {
+        return this->operations != nullptr;
+    }
+
+    /**
+     * Calls the callable with the given arguments.
+     */
+    Result operator()(Args... args) const
+    {
+        return this->operations->invoke(const_cast<Storage*>(&this->buffer), std::forward<Args>(args)...);
+    }
+
+private:
+    typedef typename std::aligned_storage<BUFFER_SIZE, alignof(std::max_align_t)>::type Storage;
+
+    /**
+     * How to call, copy, move and destroy the stored callable's type.
+     */
+    struct Operations
+    {
+        Result (*invoke)(Storage* storage, Args&&... args);
+        void (*copy)(Storage* destination, const Storage* source);
+        void (*move)(Storage* destination, Storage* source);
+        void (*destroy)(Storage* storage);
+    };
+
+    /**
+     * Whether values of the given callable type can be null.
+     */
+    template <typename Function>
+    struct IsNullable : std::is_pointer<Function>
+    {
+    };
+
+    template <typename Signature>
+    struct IsNullable<std::function<Signature>> : std::true_type
+    {
+    };
+
+    template <typename Function>
+    static bool isNull(const Function& function, std::true_type)
+    {
+        return function == nullptr;
+    }
+
+    template <typename Function>
+    static bool isNull(const Function&, std::false_type)
+    {
+        return false;
+    }
+
+    template <typename Function>
+    static constexpr bool fitsInline()
+    {
+        return sizeof(Function) <= BUFFER_SIZE && alignof(std::max_align_t) % alignof(Function) == 0 &&
+            std::is_nothrow_move_constructible<Function>::value;
+    }
+
+    /**
+     * Operations for callables stored in the buffer itself.
+     */
+    template <typename Function>
+    struct InlineOperations
+    {
+        static Function* get(Storage* storage)
+        {
+            return reinterpret_cast<Function*>(storage);
+        }
+
+        static Result invoke(Storage* storage, Args&&... args)
+        {
+            return (*get(storage))(std::forward<Args>(args)...);
+        }
+
+        static void copy(Storage* destination, const Storage* source)
+        {
+            new (destination) Function(*reinterpret_cast<const Function*>(source));
+        }
+
+        static void move(Storage* destination, Storage* source)
+        {
+            new (destination) Function(std::move(*get(source)));
+            get(source)->~Function();
+        }
+
+        static void destroy(Storage* storage)
+        {
+            get(storage)->~Function();
+        }
+
+        static const Operations operations;
+    };
+
+    /**
+     * Operations for callables too large for the buffer, which holds a
+     * pointer to them instead.
+     */
+    template <typename Function>
+    struct HeapOperations
+    {
+        static Function*& get(Storage* storage)
+        {
+            return *reinterpret_cast<Function**>(storage);
+        }
+
+        static Result invoke(Storage* storage, Args&&... args)
+        {
+            return (*get(storage))(std::forward<Args>(args)...);
+        }
+
+        static void copy(Storage* destination, const Storage* source)
+        {
+            new (destination) Function*(new Function(**reinterpret_cast<Function* const*>(source)));
+        }
+
+        static void move(Storage* destination, Storage* source)
+        {
+            new (destination) Function*(get(source));
+        }
+
+        static void destroy(Storage* storage)
+        {
+            delete get(storage);
+        }
+
+        static const Operations operations;
+    };
+
+    template <typename Function, typename Argument>
+    void store(Argument&& function, std::true_type)
+    {
+        new (&this->buffer) Function(std::forward<Argument>(function));
+        this->operations = &InlineOperations<Function>::operations;
+    }
+
+    template <typename Function, typename Argument>
+    void store(Argument&& function, std::false_type)
+    {
+        new (&this->buffer) Function*(new Function(std::forward<Argument>(function)));
+        this->operations = &HeapOperations<Function>::operations;
+    }
+
+    void reset()
+    {
+        if (this->operations != nullptr)
+        {
+            this->operations->destroy(&this->buffer);
+            this->operations = nullptr;
+        }
+    }
+
+    Storage buffer;
+    const Operations* operations;
+};
+
+template <typename Result, typename... Args>
+template <typename Function>
+const typename InlineFunction<Result (Args...)>::Operations InlineFunction<Result (Args...)>::InlineOperations<Function>::operations =
+{
+    &InlineFunction<Result (Args...)>::InlineOperations<Function>::invoke,
+    &InlineFunction<Result (Args...)>::InlineOperations<Function>::copy,
+    &InlineFunction<Result (Args...)>::InlineOperations<Function>::move,
+    &InlineFunction<Result (Args...)>::InlineOperations<Function>::destroy,
+};
+
+template <typename Result, typename... Args>
+template <typename Function>
+const typename InlineFunction<Result (Args...)>::Operations InlineFunction<Result (Args...)>::HeapOperations<Function>::operations =
+{
+    &InlineFunction<Result (Args...)>::HeapOperations<Function>::invoke,
+    &InlineFunction<Result (Args...)>::HeapOperations<Function>::copy,
+    &InlineFunction<Result (Args...)>::HeapOperations<Function>::move,
+    &InlineFunction<Result (Args...)>::HeapOperations<Function>::destroy,
+};
+
+template <typename Result, typename... Args>
+const size_t InlineFunction<Result (Args...)>::BUFFER_SIZE;
+
+#endif
@@ -4,9 +4,15 @@
 #include "KeyboardKeyReleaseEvent.h"
 #include "MouseButtonPressEvent.h"
 #include "MouseButtonReleaseEvent.h"
+#include "MouseRelativeMotionEvent.h"
+#include "InputState.h"
 
-InputManager::InputManager()
+const unsigned int InputManager::EVENT_QUEUE_CAPACITY;
+const ActionMap::Action InputManager::MAX_ACTION;
+
+InputManager::InputManager() : nextHandlerId(1), events(InputManager::EVENT_QUEUE_CAPACITY)
 {
+    this->tickEvents.reserve(InputManager::EVENT_QUEUE_CAPACITY);
 }
 
 InputManager::~InputManager()
@@ -30,115 +36,473 @@ MouseInputMode InputManager::GetMouseInputMode()
 
 void InputManager::RegisterMouseMotionHandler(MouseMotionHandler handler)
 {
-    this->mouseMotionHandler = handler;
+    this->mouseMotionHandlers.Clear();
+    this->AddMouseMotionHandler(handler);
+}
+
+void InputManager::RegisterMouseRelativeMotionHandler(MouseRelativeMotionHandler handler)
+{
+    this->mouseRelativeMotionHandlers.Clear();
+    this->AddMouseRelativeMotionHandler(handler);
 }
 
 void InputManager::RegisterMouseButtonPressHandler(MouseButton button, MouseButtonPressHandler handler)
 {
-    this->mouseButtonPressHandlers[button] = handler;
+    this->DeregisterMouseButtonPressHandler(button);
+    this->AddMouseButtonPressHandler(button, handler);
 }
 
 void InputManager::RegisterMouseButtonReleaseHandler(MouseButton button, MouseButtonReleaseHandler handler)
 {
-    this->mouseButtonReleaseHandlers[button] = handler;
+    this->DeregisterMouseButtonReleaseHandler(button);
+    this->AddMouseButtonReleaseHandler(button, handler);
 }
 
 void InputManager::RegisterKeyboardKeyPressHandler(KeyboardKey key, KeyboardKeyPressHandler handler)
 {
-    this->keyboardKeyPressHandlers[key] = handler;
+    this->DeregisterKeyboardKeyPressHandler(key);
+    this->AddKeyboardKeyPressHandler(key, handler);
 }
 
 void InputManager::RegisterKeyboardKeyReleaseHandler(KeyboardKey key, KeyboardKeyReleaseHandler handler)
 {
-    this->keyboardKeyReleaseHandlers[key] = handler;
+    this->DeregisterKeyboardKeyReleaseHandler(key);
+    this->AddKeyboardKeyReleaseHandler(key, handler);
+}
+
+HandlerId InputManager::AddMouseMotionHandler(MouseMotionHandler handler)
+{
+    HandlerId id = this->nextHandlerId++;
+    this->mouseMotionHandlers.Add(id, std::move(handler));
+    return id;
+}
+
+HandlerId InputManager::AddMouseRelativeMotionHandler(MouseRelativeMotionHandler handler)
+{
+    HandlerId id = this->nextHandlerId++;
+    this->mouseRelativeMotionHandlers.Add(id, std::move(handler));
+    return id;
+}
+
+HandlerId InputManager::AddMouseButtonPressHandler(MouseButton button, MouseButtonPressHandler handler)
+{
+    unsigned int index;
+    if (!InputManager::buttonIndex(button, index))
+    {
+        return 0;
+    }
+    HandlerId id = this->nextHandlerId++;
+    this->mouseButtonPressHandlers[index].Add(id, std::move(handler));
+    return id;
+}
+
+HandlerId InputManager::AddMouseButtonReleaseHandler(MouseButton button, MouseButtonReleaseHandler handler)
+{
+    unsigned int index;
+    if (!InputManager::buttonIndex(button, index))
+    {
+        return 0;
+    }
+    HandlerId id = this->nextHandlerId++;
+    this->mouseButtonReleaseHandlers[index].Add(id, std::move(handler));
+    return id;
+}
+
+HandlerId InputManager::AddKeyboardKeyPressHandler(KeyboardKey key, KeyboardKeyPressHandler handler)
+{
+    if (!InputSnapshot::IsValidKey(key))
+    {
+        return 0;
+    }
+    HandlerId id = this->nextHandlerId++;
+    this->keyboardKeyPressHandlers[(unsigned int)key].Add(id, std::move(handler));
+    return id;
+}
+
+HandlerId InputManager::AddKeyboardKeyReleaseHandler(KeyboardKey key, KeyboardKeyReleaseHandler handler)
+{
+    if (!InputSnapshot::IsValidKey(key))
+    {
+        return 0;
+    }
+    HandlerId id = this->nextHandlerId++;
+    this->keyboardKeyReleaseHandlers[(unsigned int)key].Add(id, std::move(handler));
+    return id;
+}
+
+HandlerId InputManager::AddActionPressHandler(ActionMap::Action action, ActionHandler handler)
+{
+    if (action > InputManager::MAX_ACTION)
+    {
+        return 0;
+    }
+    if (action >= this->actionPressHandlers.size())
+    {
+        this->actionPressHandlers.resize(action + 1);
+    }
+    HandlerId id = this->nextHandlerId++;
+    this->actionPressHandlers[action].Add(id, std::move(handler));
+    return id;
+}
+
+HandlerId InputManager::AddActionReleaseHandler(ActionMap::Action action, ActionHandler handler)
+{
+    if (action > InputManager::MAX_ACTION)
+    {
+        return 0;
+    }
+    if (action >= this->actionReleaseHandlers.size())
+    {
+        this->actionReleaseHandlers.resize(action + 1);
+    }
+    HandlerId id = this->nextHandlerId++;
+    this->actionReleaseHandlers[action].Add(id, std::move(handler));
+    return id;
+}
+
+bool InputManager::RemoveHandler(HandlerId id)
+{
+    // Removal is rare, so searching every table is cheaper than keeping an
+    // index of where each handler lives
+    if (id == 0)
+    {
+        return false;
+    }
+    if (this->mouseMotionHandlers.Remove(id) || this->mouseRelativeMotionHandlers.Remove(id))
+    {
+        return true;
+    }
+    for (unsigned int i = 0; i < InputSnapshot::MOUSE_BUTTON_COUNT; i++)
+    {
+        if (this->mouseButtonPressHandlers[i].Remove(id) || this->mouseButtonReleaseHandlers[i].Remove(id))
+        {
+            return true;
+        }
+    }
+    for (unsigned int i = 0; i < InputSnapshot::KEY_COUNT; i++)
+    {
+        if (this->keyboardKeyPressHandlers[i].Remove(id) || this->keyboardKeyReleaseHandlers[i].Remove(id))
+        {
+            return true;
+        }
+    }
+    for (auto it = this->actionPressHandlers.begin(); it != this->actionPressHandlers.end(); it++)
+    {
+        if (it->Remove(id))
+        {
+            return true;
+        }
+    }
+    for (auto it = this->actionReleaseHandlers.begin(); it != this->actionReleaseHandlers.end(); it++)
+    {
+        if (it->Remove(id))
+        {
+            return true;
+        }
+    }
+    return false;
 }
 
 void InputManager::DeregisterMouseMotionHandler()
 {
-    this->mouseMotionHandler = nullptr;
+    this->mouseMotionHandlers.Clear();
+}
+
+void InputManager::DeregisterMouseRelativeMotionHandler()
+{
+    this->mouseRelativeMotionHandlers.Clear();
 }
 
 void InputManager::DeregisterMouseButtonPressHandler(MouseButton button)
 {
-    this->mouseButtonPressHandlers.erase(button);
+    unsigned int index;
+    if (InputManager::buttonIndex(button, index))
+    {
+        this->mouseButtonPressHandlers[index].Clear();
+    }
 }
 
 void InputManager::DeregisterMouseButtonReleaseHandler(MouseButton button)
 {
-    this->mouseButtonReleaseHandlers.erase(button);
+    unsigned int index;
+    if (InputManager::buttonIndex(button, index))
+    {
+        this->mouseButtonReleaseHandlers[index].Clear();
+    }
 }
 
 void InputManager::DeregisterKeyboardKeyPressHandler(KeyboardKey key)
 {
-    this->keyboardKeyPressHandlers.erase(key);
+    if (InputSnapshot::IsValidKey(key))
+    {
+        this->keyboardKeyPressHandlers[(unsigned int)key].Clear();
+    }
 }
 
 void InputManager::DeregisterKeyboardKeyReleaseHandler(KeyboardKey key)
 {
-    this->keyboardKeyReleaseHandlers.erase(key);
+    if (InputSnapshot::IsValidKey(key))
+    {
+        this->keyboardKeyReleaseHandlers[(unsigned int)key].Clear();
+    }
 }
 
 bool InputManager::IsRegisteredEventHandler(KeyboardKey key)
 {
-    return (this->keyboardKeyPressHandlers[key]) || (this->keyboardKeyReleaseHandlers[key]);
+    return InputSnapshot::IsValidKey(key) &&
+        (!this->keyboardKeyPressHandlers[(unsigned int)key].IsEmpty() || !this->keyboardKeyReleaseHandlers[(unsigned int)key].IsEmpty());
+}
+
+ActionMap& InputManager::GetActionMap()
+{
+    return this->actionMap;
+}
+
+bool InputManager::IsActionDown(ActionMap::Action action)
+{
+    return this->actionMap.IsActionDown(action, this->snapshot);
+}
+
+bool InputManager::WasActionPressed(ActionMap::Action action)
+{
+    return this->actionMap.WasActionPressed(action, this->snapshot);
+}
+
+bool InputManager::WasActionReleased(ActionMap::Action action)
+{
+    return this->actionMap.WasActionReleased(action, this->snapshot);
 }
 
 InputState InputManager::GetKeyState(KeyboardKey key)
 {
-    return inputView.lock()->GetKeyboardKeyState(key);
+    if (!InputSnapshot::IsValidKey(key))
+    {
+        return InputState::INVALID;
+    }
+    return this->snapshot.IsKeyDown(key) ? InputState::PRESSED : InputState::RELEASED;
 }
 
 InputState InputManager::GetMouseButtonState(MouseButton button)
 {
-    return inputView.lock()->GetMouseButtonState(button);
+    return this->snapshot.IsMouseButtonDown(button) ? InputState::PRESSED : InputState::RELEASED;
+}
+
+bool InputManager::WasKeyPressed(KeyboardKey key)
+{
+    return this->snapshot.WasKeyPressed(key);
+}
+
+bool InputManager::WasKeyReleased(KeyboardKey key)
+{
+    return this->snapshot.WasKeyReleased(key);
+}
+
+bool InputManager::WasMouseButtonPressed(MouseButton button)
+{
+    return this->snapshot.WasMouseButtonPressed(button);
+}
+
+bool InputManager::WasMouseButtonReleased(MouseButton button)
+{
+    return this->snapshot.WasMouseButtonReleased(button);
+}
+
+const InputSnapshot& InputManager::GetSnapshot()
+{
+    return this->snapshot;
 }
 
 int InputManager::GetMouseX()
 {
-    return inputView.lock()->GetMouseX();
+    return this->snapshot.GetMouseX();
 }
 
 int InputManager::GetMouseY()
 {
-    return inputView.lock()->GetMouseY();
+    return this->snapshot.GetMouseY();
+}
+
+int InputManager::GetMouseDeltaX()
+{
+    return this->snapshot.GetMouseDeltaX();
+}
+
+int InputManager::GetMouseDeltaY()
+{
+    return this->snapshot.GetMouseDeltaY();
+}
+
+bool InputManager::QueueEvent(const QueuedInputEvent& event)
+{
+    if (!this->events.TryPush(event))
+    {
+        // Only happens if the game thread has stalled; unlike sound commands,
+        // input that old isn't worth waiting to deliver
+        this->eventStats.RecordDropped();
+        return false;
+    }
+    this->eventStats.RecordPush(this->events.GetSize());
+    return true;
+}
+
+void InputManager::DispatchEvents()
+{
+    // Bounded by the queue's capacity so a view thread that keeps queueing
+    // can't hold up the rest of the tick
+    this->tickEvents.clear();
+    this->snapshot.BeginTick();
+    QueuedInputEvent event;
+    for (unsigned int i = 0; i < InputManager::EVENT_QUEUE_CAPACITY && this->events.TryPop(event); i++)
+    {
+        std::chrono::duration<double, std::milli> latency = std::chrono::steady_clock::now() - event.time;
+        this->eventStats.RecordLatency(latency.count());
+        this->snapshot.Apply(event);
+        this->tickEvents.push_back(event);
+    }
+
+    this->dispatchTickEvents();
+}
+
+void InputManager::ReplayEvents(const std::vector<QueuedInputEvent>& events)
+{
+    // Live input would make the run differ from the recording
+    QueuedInputEvent event;
+    for (unsigned int i = 0; i < InputManager::EVENT_QUEUE_CAPACITY && this->events.TryPop(event); i++)
+    {
+    }
+
+    this->tickEvents.assign(events.begin(), events.end());
+    this->snapshot.BeginTick();
+    for (auto it = this->tickEvents.begin(); it != this->tickEvents.end(); it++)
+    {
+        this->snapshot.Apply(*it);
+    }
+    this->dispatchTickEvents();
+}
+
+void InputManager::RestoreSnapshot(const InputSnapshot& snapshot)
+{
+    this->snapshot = snapshot;
+    this->snapshot.BeginTick();
+}
+
+const std::vector<QueuedInputEvent>& InputManager::GetTickEvents()
+{
+    return this->tickEvents;
+}
+
+InputManager::EventStats InputManager::GetEventStats()
+{
+    EventStats stats;
+    stats.queueDepth = this->events.GetSize();
+    stats.maxQueueDepth = this->eventStats.GetMaxDepth();
+    stats.queueCapacity = this->events.GetCapacity();
+    stats.eventCount = this->eventStats.GetTakenCount();
+    stats.overflowCount = this->eventStats.GetDroppedCount();
+    stats.averageLatencyMilliseconds = this->eventStats.GetAverageLatencyMilliseconds();
+    stats.maxLatencyMilliseconds = this->eventStats.GetMaxLatencyMilliseconds();
+    return stats;
+}
+
+void InputManager::dispatchTickEvents()
+{
+    // Handlers see the whole update's state, the same as polling does
+    for (auto it = this->tickEvents.begin(); it != this->tickEvents.end(); it++)
+    {
+        this->dispatch(*it);
+    }
+}
+
+void InputManager::dispatch(const QueuedInputEvent& event)
+{
+    switch (event.type)
+    {
+    case QueuedInputEventType::KEYBOARD_KEY_PRESS:
+        this->OnKeyboardKeyPress(KeyboardKeyPressEvent(event.key));
+        break;
+    case QueuedInputEventType::KEYBOARD_KEY_RELEASE:
+        this->OnKeyboardKeyRelease(KeyboardKeyReleaseEvent(event.key));
+        break;
+    case QueuedInputEventType::MOUSE_MOVE:
+        this->OnMouseInput(MouseEvent(event.x, event.y));
+        break;
+    case QueuedInputEventType::MOUSE_BUTTON_PRESS:
+        this->OnMouseButtonPress(MouseButtonPressEvent(event.x, event.y, event.button));
+        break;
+    case QueuedInputEventType::MOUSE_BUTTON_RELEASE:
+        this->OnMouseButtonRelease(MouseButtonReleaseEvent(event.x, event.y, event.button));
+        break;
+    case QueuedInputEventType::FOCUS_LOST:
+        break;
+    case QueuedInputEventType::MOUSE_RELATIVE_MOVE:
+        this->OnMouseRelativeMotion(MouseRelativeMotionEvent(event.x, event.y));
+        break;
+    }
 }
 
 void InputManager::OnKeyboardKeyPress(KeyboardKeyPressEvent event) 
 {
-    if (this->keyboardKeyPressHandlers[event.key])
+    if (InputSnapshot::IsValidKey(event.key))
     {
-        this->keyboardKeyPressHandlers[event.key](event);
+        this->keyboardKeyPressHandlers[(unsigned int)event.key].Invoke(event);
+        InputManager::dispatchActions(this->actionMap.GetKeyActions(event.key), this->actionPressHandlers);
     }
 }
 
 void InputManager::OnKeyboardKeyRelease(KeyboardKeyReleaseEvent event) 
 {
-    if (this->keyboardKeyReleaseHandlers[event.key])
+    if (InputSnapshot::IsValidKey(event.key))
     {
-        this->keyboardKeyReleaseHandlers[event.key](event);
+        this->keyboardKeyReleaseHandlers[(unsigned int)event.key].Invoke(event);
+        InputManager::dispatchActions(this->actionMap.GetKeyActions(event.key), this->actionReleaseHandlers);
     }
 }
 
 void InputManager::OnMouseInput(MouseEvent event)
 {
-    if (this->mouseMotionHandler)
-    {
-        this->mouseMotionHandler(event);
-    }
+    this->mouseMotionHandlers.Invoke(event);
+}
+
+void InputManager::OnMouseRelativeMotion(MouseRelativeMotionEvent event)
+{
+    this->mouseRelativeMotionHandlers.Invoke(event);
 }
 
 void InputManager::OnMouseButtonPress(MouseButtonPressEvent event)
 {
-    if (this->mouseButtonPressHandlers[event.button])
+    unsigned int index;
+    if (InputManager::buttonIndex(event.button, index))
     {
-        this->mouseButtonPressHandlers[event.button](event);
+        this->mouseButtonPressHandlers[index].Invoke(event);
+        InputManager::dispatchActions(this->actionMap.GetMouseButtonActions(event.button), this->actionPressHandlers);
     }
 }
 
 void InputManager::OnMouseButtonRelease(MouseButtonReleaseEvent event)
 {
-    if (this->mouseButtonReleaseHandlers[event.button])
+    unsigned int index;
+    if (InputManager::buttonIndex(event.button, index))
     {
-        this->mouseButtonReleaseHandlers[event.button](event);
+        this->mouseButtonReleaseHandlers[index].Invoke(event);
+        InputManager::dispatchActions(this->actionMap.GetMouseButtonActions(event.button), this->actionReleaseHandlers);
     }
 }
+
+void InputManager::dispatchActions(const std::vector<ActionMap::Action>& actions, std::deque<HandlerList<ActionHandler>>& handlers)
+{
+    // Indexed rather than iterated, since a handler may rebind the input
+    for (size_t i = 0; i < actions.size(); i++)
+    {
+        ActionMap::Action action = actions[i];
+        if (action < handlers.size())
+        {
+            handlers[action].Invoke(action);
+        }
+    }
+}
+
+bool InputManager::buttonIndex(MouseButton button, unsigned int& index)
+{
+    index = (unsigned int)button;
+    return index < InputSnapshot::MOUSE_BUTTON_COUNT;
+}
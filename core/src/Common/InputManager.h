@@ -3,14 +3,23 @@
 
 #include "KeyboardKey.h"
 #include "MouseButton.h"
-#include <map>
-#include <functional>
+#include "QueuedInputEvent.h"
+#include "InputSnapshot.h"
+#include "InlineFunction.h"
+#include "HandlerList.h"
+#include "ActionMap.h"
+#include "SpscQueue.h"
+#include "QueueStats.h"
 #include <memory>
+#include <atomic>
+#include <vector>
+#include <deque>
 
 class InputView;
 class KeyboardKeyPressEvent;
 class KeyboardKeyReleaseEvent;
 class MouseEvent;
+class MouseRelativeMotionEvent;
 class MouseButtonPressEvent;
 class MouseButtonReleaseEvent;
 enum class InputState;
@@ -22,16 +31,63 @@ enum class MouseInputMode
     HIDE_AND_LOCK
 };
 
+/**
+ * Gives the game access to input, through handlers for input events and by polling input state.
+ *
+ * Input events arrive on the view thread. The InputView queues them, with the time they arrived, on a bounded
+ * lock-free ring, and DispatchEvents runs the handlers for them on the game thread at the start of each update,
+ * so handlers never race with GameState::Update and a slow handler never holds up rendering. If the game thread
+ * falls so far behind that the ring fills up, further events are dropped and counted.
+ *
+ * The polled state is an InputSnapshot built from the same events, once per update before any handler runs, so
+ * polling never queries the operating system and gives the same answer throughout an update.
+ *
+ * Handlers are kept in flat tables indexed by key and button, so dispatching an event is an array lookup that
+ * never allocates. Each input may have several handlers; the Add methods add one more and return an id to remove
+ * it with, while the Register methods replace them all. Handlers store small lambdas in place rather than on the
+ * heap. Gameplay should generally bind actions on the ActionMap and handle or poll those instead of raw keys, so
+ * controls can be remapped.
+ *
+ * Since handlers and polling only ever see whole updates' worth of events, the GameStateManager can record them
+ * with an InputRecorder and later dispatch them again from an InputReplay instead of the InputView.
+ */
 class InputManager
 {
 public:
-    // Use traditional pointers here because C++ does not support shared function pointers
-    // How does this work if the object that owns the function is destroyed?
-    typedef std::function<void (MouseEvent)> MouseMotionHandler;
-    typedef std::function<void (MouseButtonPressEvent)> MouseButtonPressHandler;
-    typedef std::function<void (MouseButtonReleaseEvent)> MouseButtonReleaseHandler;
-    typedef std::function<void (KeyboardKeyPressEvent)> KeyboardKeyPressHandler;
-    typedef std::function<void (KeyboardKeyReleaseEvent)> KeyboardKeyReleaseHandler;
+    // Handlers are called as long as they're registered, so one capturing an object must be removed before the
+    // object is destroyed.
+    typedef InlineFunction<void (MouseEvent)> MouseMotionHandler;
+    typedef InlineFunction<void (MouseRelativeMotionEvent)> MouseRelativeMotionHandler;
+    typedef InlineFunction<void (MouseButtonPressEvent)> MouseButtonPressHandler;
+    typedef InlineFunction<void (MouseButtonReleaseEvent)> MouseButtonReleaseHandler;
+    typedef InlineFunction<void (KeyboardKeyPressEvent)> KeyboardKeyPressHandler;
+    typedef InlineFunction<void (KeyboardKeyReleaseEvent)> KeyboardKeyReleaseHandler;
+    typedef InlineFunction<void (ActionMap::Action)> ActionHandler;
+
+    /**
+     * Statistics about the queue of events waiting to be dispatched.
+     */
+    struct EventStats
+    {
+        unsigned int queueDepth;
+        unsigned int maxQueueDepth;
+        unsigned int queueCapacity;
+        unsigned long long eventCount;
+        unsigned long long overflowCount;
+        double averageLatencyMilliseconds;
+        double maxLatencyMilliseconds;
+    };
+
+    /**
+     * The most events that can wait to be dispatched at once.
+     */
+    static const unsigned int EVENT_QUEUE_CAPACITY = 1024;
+
+    /**
+     * The largest action that can have handlers. Handlers are kept in a table indexed by action, so actions
+     * should be numbered from 0 upwards.
+     */
+    static const ActionMap::Action MAX_ACTION = 4095;
 
     /**
      * Default constructor that creates a new instance of a InputManager.
@@ -55,6 +111,8 @@ public:
      * * MouseInputMode::SHOW - Draw the operating system cursor.
      * * MouseInputMode::HIDE - Hide the operating system cursor.
      * * MouseInputMode::HIDE_AND_LOCK - Hide the operating system cursor and lock the cursor to the game window.
+     * While locked, the mouse's motion is reported once per frame through relative motion handlers and
+     * GetMouseDeltaX and GetMouseDeltaY, and mouse motion handlers aren't called.
      */
     void SetMouseInputMode(MouseInputMode mode);
 
@@ -70,15 +128,23 @@ public:
     /**
      * Register a function to handle mouse input.
      * @param handler A function which will receive and handler MouseEvents when the mouse cursor is moved.
-     * Any existing handler will be overwritten.
+     * Any existing handlers will be overwritten.
      */
     void RegisterMouseMotionHandler(MouseMotionHandler handler);
 
+    /**
+     * Register a function to handle the mouse's motion while the cursor is locked.
+     * @param handler A function which will receive and handle MouseRelativeMotionEvents, summing the mouse's
+     * motion over a frame, when the mouse is moved while the mouse input mode is MouseInputMode::HIDE_AND_LOCK.
+     * Any existing handlers will be overwritten.
+     */
+    void RegisterMouseRelativeMotionHandler(MouseRelativeMotionHandler handler);
+
     /**
      * Register a function to handle mouse button presses.
      * @param button A mouse button.
      * @param handler A function which will receive and handle MouseButtonPressEvents when the specified mouse button is pressed.
-     * Any existing button press handler for the specified mouse button will be overwritten.
+     * Any existing button press handlers for the specified mouse button will be overwritten.
      */
     void RegisterMouseButtonPressHandler(MouseButton button, MouseButtonPressHandler handler);
 
@@ -86,7 +152,7 @@ public:
      * Register a function to handle mouse button releases.
      * @param button A mouse button.
      * @param handler A function which will receive and handle MouseButtonReleaseEvents when the specified mouse button is released.
-     * Any existing button released handler for the specified mouse button will be overwritten.
+     * Any existing button release handlers for the specified mouse button will be overwritten.
      */
     void RegisterMouseButtonReleaseHandler(MouseButton button, MouseButtonReleaseHandler handler);
 
@@ -94,7 +160,7 @@ public:
      * Register a function to handle keyboard key presses.
      * @param key A keyboard key.
      * @param handler A function which will receive and handle KeyboardKeyPressEvents when the specified key is pressed.
-     * Any existing key press handler for the specified key will be overwritten.
+     * Any existing key press handlers for the specified key will be overwritten.
      */
     void RegisterKeyboardKeyPressHandler(KeyboardKey key, KeyboardKeyPressHandler handler);
 
@@ -102,14 +168,77 @@ public:
      * Register a function to handle keyboard key presses.
      * @param key A keyboard key.
      * @param handler A function which will receive and handle KeyboardKeyPressEvents when the specified key is released.
-     * Any existing key release handler for the specified key will be overwritten.
+     * Any existing key release handlers for the specified key will be overwritten.
      */
     void RegisterKeyboardKeyReleaseHandler(KeyboardKey key, KeyboardKeyReleaseHandler handler);
     
+    /**
+     * Add a function to handle mouse input, alongside any existing handlers.
+     * @param handler A function which will receive and handler MouseEvents when the mouse cursor is moved.
+     * @return an id to remove the handler with.
+     */
+    HandlerId AddMouseMotionHandler(MouseMotionHandler handler);
+
+    /**
+     * Add a function to handle the mouse's motion while the cursor is locked, alongside any existing handlers.
+     * @return an id to remove the handler with.
+     */
+    HandlerId AddMouseRelativeMotionHandler(MouseRelativeMotionHandler handler);
+
+    /**
+     * Add a function to handle mouse button presses, alongside any existing handlers for the button.
+     * @return an id to remove the handler with.
+     */
+    HandlerId AddMouseButtonPressHandler(MouseButton button, MouseButtonPressHandler handler);
+
+    /**
+     * Add a function to handle mouse button releases, alongside any existing handlers for the button.
+     * @return an id to remove the handler with.
+     */
+    HandlerId AddMouseButtonReleaseHandler(MouseButton button, MouseButtonReleaseHandler handler);
+
+    /**
+     * Add a function to handle keyboard key presses, alongside any existing handlers for the key.
+     * Key repeats are passed on as presses too.
+     * @return an id to remove the handler with, or 0 if the key can't have handlers.
+     */
+    HandlerId AddKeyboardKeyPressHandler(KeyboardKey key, KeyboardKeyPressHandler handler);
+
+    /**
+     * Add a function to handle keyboard key releases, alongside any existing handlers for the key.
+     * @return an id to remove the handler with, or 0 if the key can't have handlers.
+     */
+    HandlerId AddKeyboardKeyReleaseHandler(KeyboardKey key, KeyboardKeyReleaseHandler handler);
+
+    /**
+     * Add a function called with the action whenever a key or mouse button bound to it on the ActionMap is
+     * pressed, including key repeats.
+     * @return an id to remove the handler with, or 0 if the action is above MAX_ACTION.
+     */
+    HandlerId AddActionPressHandler(ActionMap::Action action, ActionHandler handler);
+
+    /**
+     * Add a function called with the action whenever a key or mouse button bound to it on the ActionMap is
+     * released.
+     * @return an id to remove the handler with, or 0 if the action is above MAX_ACTION.
+     */
+    HandlerId AddActionReleaseHandler(ActionMap::Action action, ActionHandler handler);
+
+    /**
+     * Remove the handler with the given id. May be called from within a handler, even the one being removed.
+     * @return false if there is no such handler.
+     */
+    bool RemoveHandler(HandlerId id);
+
     /**
      * Remove any existing mouse input handler.
      */
     void DeregisterMouseMotionHandler();   
+
+    /**
+     * Remove any existing handlers for the mouse's motion while the cursor is locked.
+     */
+    void DeregisterMouseRelativeMotionHandler();
  
     /**
      * Remove any existing mouse button press handler for the specified button.
@@ -132,25 +261,70 @@ public:
     void DeregisterKeyboardKeyReleaseHandler(KeyboardKey key);
 
     /**
-     * True if the given KeyboardKey has at least one registered release event handler. False otherwise.
+     * True if the given KeyboardKey has at least one registered press or release event handler. False otherwise.
      */
     bool IsRegisteredEventHandler(KeyboardKey key);
 
     /**
-     * Poll the current state of a key.
+     * Obtains the bindings of keys and mouse buttons to the game's actions.
+     */
+    ActionMap& GetActionMap();
+
+    /**
+     * True if any input bound to the given action is down, as of the start of this update.
+     */
+    bool IsActionDown(ActionMap::Action action);
+
+    /**
+     * True if any input bound to the given action went down since the previous update.
+     */
+    bool WasActionPressed(ActionMap::Action action);
+
+    /**
+     * True if any input bound to the given action went up since the previous update.
+     */
+    bool WasActionReleased(ActionMap::Action action);
+
+    /**
+     * Poll the state of a key as of the start of this update.
      * @param key The keyboard key to poll.
-     * @return the current state of the keyboard key.
-     * If an invalid key code was passed, KeyState::Invalid is returned.
+     * @return the state of the keyboard key.
+     * If an invalid key code was passed, InputState::INVALID is returned.
      */
     InputState GetKeyState(KeyboardKey key);
 
     /**
-     * Poll the current state of a mouse button.
+     * Poll the state of a mouse button as of the start of this update.
      * @param button The mouse button to poll.
-     * @return the current state of the mouse button
+     * @return the state of the mouse button
      */
     InputState GetMouseButtonState(MouseButton button);
 
+    /**
+     * True if the given key went down since the previous update. Key repeats don't count.
+     */
+    bool WasKeyPressed(KeyboardKey key);
+
+    /**
+     * True if the given key went up since the previous update.
+     */
+    bool WasKeyReleased(KeyboardKey key);
+
+    /**
+     * True if the given mouse button went down since the previous update.
+     */
+    bool WasMouseButtonPressed(MouseButton button);
+
+    /**
+     * True if the given mouse button went up since the previous update.
+     */
+    bool WasMouseButtonReleased(MouseButton button);
+
+    /**
+     * Obtains the input state as of the start of this update, for polling many keys at once.
+     */
+    const InputSnapshot& GetSnapshot();
+
     /**
      * Poll the horizontal coordinate of the mouse cursor. 
      * @return the x coordinate of the mouse cursor within the game window. The left edge of the game window is the origin.
@@ -164,31 +338,88 @@ public:
     int GetMouseY();
 
     /**
-     * Distributes event to registered event handlers. Should be called only by InputView.
+     * Poll how far the mouse moved horizontally since the previous update while the cursor was locked.
+     * @return the motion in pixels, positive to the right.
+     */
+    int GetMouseDeltaX();
+
+    /**
+     * Poll how far the mouse moved vertically since the previous update while the cursor was locked.
+     * @return the motion in pixels, positive downwards.
+     */
+    int GetMouseDeltaY();
+
+    /**
+     * Queues an event to be dispatched on the game thread. Should be called only by InputView, on the view thread.
+     * @param event event to queue.
+     * @return false if the queue was full and the event was dropped.
+     */
+    bool QueueEvent(const QueuedInputEvent& event);
+
+    /**
+     * Builds this update's snapshot from the events queued since the last call, then distributes them to
+     * registered event handlers in the order they arrived. Called by the GameStateManager on the game thread at
+     * the start of each update.
+     */
+    void DispatchEvents();
+
+    /**
+     * Builds this update's snapshot from the given events and distributes them, as DispatchEvents does, in place
+     * of the events queued since the last call, which are discarded. Used to replay recorded input.
+     * @param events the events of this update.
+     */
+    void ReplayEvents(const std::vector<QueuedInputEvent>& events);
+
+    /**
+     * Sets the keys and buttons that are down and the cursor position, with nothing pressed or released, and
+     * without calling any handlers. Used to start replaying recorded input from the state it was recorded in.
+     * @param snapshot the input state to take on.
+     */
+    void RestoreSnapshot(const InputSnapshot& snapshot);
+
+    /**
+     * Obtains the events dispatched this update, in the order they were dispatched, for recording.
+     */
+    const std::vector<QueuedInputEvent>& GetTickEvents();
+
+    /**
+     * Obtains how many events are waiting to be dispatched, how many have been dispatched or dropped, and how
+     * long they waited in the queue.
+     */
+    EventStats GetEventStats();
+
+    /**
+     * Distributes event to registered event handlers. Called by DispatchEvents.
      * @param event event to distribute.
      */
     void OnKeyboardKeyPress(KeyboardKeyPressEvent event);
     
     /**
-     * Distributes event to registered event handlers. Should be called only by InputView.
+     * Distributes event to registered event handlers. Called by DispatchEvents.
      * @param event event to distribute.
      */
     void OnKeyboardKeyRelease(KeyboardKeyReleaseEvent event);
 
     /**
-     * Distributes event to registered event handlers. Should be called only by InputView.
+     * Distributes event to registered event handlers. Called by DispatchEvents.
      * @param event event to distribute.
      */
     void OnMouseInput(MouseEvent event);
 
     /**
-     * Distributes event to registered event handlers. Should be called only by InputView.
+     * Distributes event to registered event handlers. Called by DispatchEvents.
+     * @param event event to distribute.
+     */
+    void OnMouseRelativeMotion(MouseRelativeMotionEvent event);
+
+    /**
+     * Distributes event to registered event handlers. Called by DispatchEvents.
      * @param event event to distribute.
      */
     void OnMouseButtonPress(MouseButtonPressEvent event);
 
     /**
-     * Distributes event to registered event handlers. Should be called only by InputView.
+     * Distributes event to registered event handlers. Called by DispatchEvents.
      * @param event event to distribute.
      */
     void OnMouseButtonRelease(MouseButtonReleaseEvent event);
@@ -201,12 +432,55 @@ private:
     // InputView which is polled for ondemand input.
     std::weak_ptr<InputView> inputView;
     
-    // Registered event handlers
-    MouseMotionHandler mouseMotionHandler;
-    std::map<MouseButton, MouseButtonPressHandler> mouseButtonPressHandlers;
-    std::map<MouseButton, MouseButtonReleaseHandler> mouseButtonReleaseHandlers;
-    std::map<KeyboardKey, KeyboardKeyPressHandler> keyboardKeyPressHandlers;
-    std::map<KeyboardKey, KeyboardKeyReleaseHandler> keyboardKeyReleaseHandlers;
+    // Registered event handlers, indexed by the enum values of their keys and buttons, or by action. Actions are
+    // in deques so adding one from a handler doesn't move the list being invoked.
+    HandlerList<MouseMotionHandler> mouseMotionHandlers;
+    HandlerList<MouseRelativeMotionHandler> mouseRelativeMotionHandlers;
+    HandlerList<MouseButtonPressHandler> mouseButtonPressHandlers[InputSnapshot::MOUSE_BUTTON_COUNT];
+    HandlerList<MouseButtonReleaseHandler> mouseButtonReleaseHandlers[InputSnapshot::MOUSE_BUTTON_COUNT];
+    HandlerList<KeyboardKeyPressHandler> keyboardKeyPressHandlers[InputSnapshot::KEY_COUNT];
+    HandlerList<KeyboardKeyReleaseHandler> keyboardKeyReleaseHandlers[InputSnapshot::KEY_COUNT];
+    std::deque<HandlerList<ActionHandler>> actionPressHandlers;
+    std::deque<HandlerList<ActionHandler>> actionReleaseHandlers;
+
+    // The id of the next handler added
+    HandlerId nextHandlerId;
+
+    // Bindings of inputs to actions
+    ActionMap actionMap;
+
+    // Events from the view thread to the game thread
+    SpscQueue<QueuedInputEvent> events;
+
+    // The events taken from the queue this update, kept so they're only allocated once
+    std::vector<QueuedInputEvent> tickEvents;
+
+    // Input state as of the start of this update
+    InputSnapshot snapshot;
+
+    // Queue statistics. Latencies are only written by the game thread
+    QueueStats eventStats;
+
+    /**
+     * Distributes a dequeued event to registered event handlers.
+     * @param event event to distribute.
+     */
+    void dispatch(const QueuedInputEvent& event);
+
+    /**
+     * Distributes this update's events, once all of them are in the snapshot.
+     */
+    void dispatchTickEvents();
+
+    /**
+     * Calls the handlers in the given tables for each of the given actions.
+     */
+    static void dispatchActions(const std::vector<ActionMap::Action>& actions, std::deque<HandlerList<ActionHandler>>& handlers);
+
+    /**
+     * Obtains the mouse button's slot in the handler tables, returning false if it has none.
+     */
+    static bool buttonIndex(MouseButton button, unsigned int& index);
 };
 
 #endif
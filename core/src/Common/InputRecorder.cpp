@@ -0,0 +1,140 @@
+#include <stdexcept>
+#include "InputRecorder.h"
+
+namespace
+{
+    /**
+     * Appends the given value to the buffer in little endian order.
+     */
+    void putLittleEndian(std::vector<unsigned char>& buffer, uint32_t value, unsigned int byteCount)
+    {
+        for (unsigned int i = 0; i < byteCount; i++)
+        {
+            buffer.push_back((unsigned char)(value >> (i * 8)));
+        }
+    }
+
+    void putVarint(std::vector<unsigned char>& buffer, uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            buffer.push_back((unsigned char)(value | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back((unsigned char)value);
+    }
+
+    void putZigzag(std::vector<unsigned char>& buffer, int32_t value)
+    {
+        putVarint(buffer, value < 0 ? ~((uint32_t)value << 1) : (uint32_t)value << 1);
+    }
+}
+
+InputRecorder::InputRecorder(const std::string& fileName) : started(false), tickCount(0), mouseX(0), mouseY(0)
+{
+    this->file = fopen(fileName.c_str(), "wb");
+    if (this->file == nullptr)
+    {
+        throw new std::invalid_argument("Could not create input recording " + fileName);
+    }
+}
+
+InputRecorder::~InputRecorder()
+{
+    fclose(this->file);
+}
+
+void InputRecorder::Start(const InputSnapshot& snapshot)
+{
+    if (this->started)
+    {
+        throw new std::invalid_argument("The input recording was already started.");
+    }
+    this->started = true;
+    this->mouseX = snapshot.GetMouseX();
+    this->mouseY = snapshot.GetMouseY();
+
+    InputRecordingFormat::Header header = {};
+    header.magic = InputRecordingFormat::MAGIC;
+    header.version = InputRecordingFormat::VERSION;
+    header.mouseX = snapshot.GetMouseX();
+    header.mouseY = snapshot.GetMouseY();
+    const std::bitset<InputSnapshot::KEY_COUNT>& keysDown = snapshot.GetKeysDown();
+    for (unsigned int i = 0; i < InputSnapshot::KEY_COUNT; i++)
+    {
+        if (keysDown[i])
+        {
+            header.keysDown[i / 8] |= (uint8_t)(1 << (i % 8));
+        }
+    }
+    header.buttonsDown = (uint8_t)snapshot.GetMouseButtonsDown().to_ulong();
+
+    this->bytes.clear();
+    putLittleEndian(this->bytes, header.magic, 4);
+    putLittleEndian(this->bytes, header.version, 4);
+    putLittleEndian(this->bytes, (uint32_t)header.mouseX, 4);
+    putLittleEndian(this->bytes, (uint32_t)header.mouseY, 4);
+    this->bytes.insert(this->bytes.end(), header.keysDown, header.keysDown + InputRecordingFormat::KEY_BYTES);
+    this->bytes.push_back(header.buttonsDown);
+    fwrite(this->bytes.data(), 1, this->bytes.size(), this->file);
+}
+
+bool InputRecorder::IsStarted() const
+{
+    return this->started;
+}
+
+void InputRecorder::RecordTick(const std::vector<QueuedInputEvent>& events)
+{
+    if (!this->started)
+    {
+        throw new std::invalid_argument("An input tick was recorded before the recording was started.");
+    }
+    this->bytes.clear();
+    putVarint(this->bytes, (uint32_t)events.size());
+    for (auto it = events.begin(); it != events.end(); it++)
+    {
+        this->bytes.push_back((unsigned char)it->type);
+        switch (it->type)
+        {
+        case QueuedInputEventType::KEYBOARD_KEY_PRESS:
+        case QueuedInputEventType::KEYBOARD_KEY_RELEASE:
+            this->bytes.push_back((unsigned char)((int)it->key + 1));
+            break;
+        case QueuedInputEventType::MOUSE_MOVE:
+            this->putMouseMotion(it->x, it->y);
+            break;
+        case QueuedInputEventType::MOUSE_BUTTON_PRESS:
+        case QueuedInputEventType::MOUSE_BUTTON_RELEASE:
+            this->bytes.push_back((unsigned char)it->button);
+            this->putMouseMotion(it->x, it->y);
+            break;
+        case QueuedInputEventType::FOCUS_LOST:
+            break;
+        case QueuedInputEventType::MOUSE_RELATIVE_MOVE:
+            putZigzag(this->bytes, it->x);
+            putZigzag(this->bytes, it->y);
+            break;
+        }
+    }
+    fwrite(this->bytes.data(), 1, this->bytes.size(), this->file);
+    this->tickCount++;
+}
+
+void InputRecorder::Flush()
+{
+    fflush(this->file);
+}
+
+unsigned long long InputRecorder::GetTickCount() const
+{
+    return this->tickCount;
+}
+
+void InputRecorder::putMouseMotion(int x, int y)
+{
+    putZigzag(this->bytes, (int32_t)((uint32_t)x - (uint32_t)this->mouseX));
+    putZigzag(this->bytes, (int32_t)((uint32_t)y - (uint32_t)this->mouseY));
+    this->mouseX = x;
+    this->mouseY = y;
+}
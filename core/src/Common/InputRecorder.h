@@ -0,0 +1,87 @@
+#ifndef Core_InputRecorder_h
+#define Core_InputRecorder_h
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "QueuedInputEvent.h"
+#include "InputSnapshot.h"
+#include "InputRecordingFormat.h"
+
+/**
+ * Writes the input events dispatched each tick into a file, so an
+ * InputReplay can feed the very same events to the game again later, such
+ * as to reproduce a bug or check that a change didn't alter gameplay.
+ *
+ * Events are recorded per tick rather than with the times they arrived, so
+ * a replay delivers them on the same ticks however fast it runs. As long as
+ * the game only advances in its fixed-length ticks and seeds any randomness
+ * the same way, the replayed run is identical to the recorded one.
+ *
+ * Recordings are buffered, and complete up to the last recorded tick once
+ * the recorder is destroyed or Flush is called.
+ */
+class InputRecorder final
+{
+public:
+    /**
+     * Creates the given file to record into. Throws an exception if it
+     * can't be created.
+     */
+    InputRecorder(const std::string& fileName);
+
+    /**
+     * Flushes and closes the file.
+     */
+    ~InputRecorder();
+
+    /**
+     * Records the input state the recording starts from, which must be done
+     * before the first tick is recorded.
+     * @param snapshot the input state before the first recorded tick's events.
+     */
+    void Start(const InputSnapshot& snapshot);
+
+    /**
+     * Obtains whether the recording has started.
+     */
+    bool IsStarted() const;
+
+    /**
+     * Records the events dispatched during a tick, which may be none.
+     */
+    void RecordTick(const std::vector<QueuedInputEvent>& events);
+
+    /**
+     * Writes everything recorded so far to the file.
+     */
+    void Flush();
+
+    /**
+     * Obtains how many ticks have been recorded.
+     */
+    unsigned long long GetTickCount() const;
+
+private:
+    // Private constructors to disallow access.
+    InputRecorder(InputRecorder const &other);
+    InputRecorder operator=(InputRecorder other);
+
+    /**
+     * Appends the given mouse position as the movement since the last one.
+     */
+    void putMouseMotion(int x, int y);
+
+    FILE* file;
+    bool started;
+    unsigned long long tickCount;
+
+    // The cursor position the next mouse event's movement is relative to
+    int mouseX;
+    int mouseY;
+
+    // The encoded tick, kept so it's only allocated once
+    std::vector<unsigned char> bytes;
+};
+
+#endif
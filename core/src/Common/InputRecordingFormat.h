@@ -0,0 +1,56 @@
+#ifndef Core_InputRecordingFormat_h
+#define Core_InputRecordingFormat_h
+
+#include <cstdint>
+
+/**
+ * The layout of an input recording, shared by the InputRecorder and the
+ * InputReplay. Every fixed-size value is little endian.
+ *
+ * A recording starts with a Header, whose fields are written one after the
+ * other without padding, holding the input state before the first recorded
+ * tick: the cursor's position and a bit for every key and mouse button that
+ * was down, indexed by their enum values.
+ *
+ * A record for every tick follows, until the end of the file: the number
+ * of events dispatched during the tick as a varint, then each event as its
+ * QueuedInputEventType in one byte followed by
+ * * for the keyboard events, the KeyboardKey plus one in one byte, so
+ *   KeyboardKey::KEYBOARD_UNKNOWN is 0.
+ * * for MOUSE_MOVE, the cursor's movement since the previous mouse event,
+ *   or since the Header, as two zigzag varints.
+ * * for the mouse button events, the MouseButton in one byte, then the
+ *   cursor's movement as for MOUSE_MOVE.
+ * * for FOCUS_LOST, nothing.
+ * * for MOUSE_RELATIVE_MOVE, the mouse's motion as two zigzag varints.
+ *   It leaves the cursor where it was, so the next mouse event's movement
+ *   isn't relative to it.
+ *
+ * A varint stores 7 bits per byte, least significant first, with the top
+ * bit set on every byte but the last. A zigzag varint stores n as 2n if it
+ * isn't negative and -2n - 1 if it is, so small movements either way take
+ * one byte. A tick without input takes one byte altogether.
+ */
+struct InputRecordingFormat
+{
+    /**
+     * "EINP", read as a little endian integer.
+     */
+    static const uint32_t MAGIC = 0x504E4945;
+    static const uint32_t VERSION = 1;
+
+    static const unsigned int KEY_BYTES = 32;
+    static const unsigned int HEADER_SIZE = 4 + 4 + 4 + 4 + KEY_BYTES + 1;
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        int32_t mouseX;
+        int32_t mouseY;
+        uint8_t keysDown[KEY_BYTES];
+        uint8_t buttonsDown;
+    };
+};
+
+#endif
@@ -0,0 +1,207 @@
+#include <cstdio>
+#include "InputReplay.h"
+
+namespace
+{
+    uint32_t getLittleEndian(const unsigned char* bytes)
+    {
+        return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+    }
+}
+
+std::shared_ptr<InputReplay> InputReplay::Open(const std::string& fileName)
+{
+    std::shared_ptr<InputReplay> replay = std::make_shared<InputReplay>();
+    if (!replay->open(fileName))
+    {
+        return nullptr;
+    }
+    return replay;
+}
+
+InputReplay::InputReplay() : position(0), tickCount(0), mouseX(0), mouseY(0)
+{
+
+}
+
+const InputSnapshot& InputReplay::GetInitialSnapshot() const
+{
+    return this->initialSnapshot;
+}
+
+bool InputReplay::IsAtStart() const
+{
+    return this->tickCount == 0;
+}
+
+bool InputReplay::NextTick(std::vector<QueuedInputEvent>& events)
+{
+    // A tick is only handed out once all of it has been read, so a
+    // truncated last tick ends the replay rather than half playing
+    events.clear();
+    size_t tickStart = this->position;
+    int tickMouseX = this->mouseX;
+    int tickMouseY = this->mouseY;
+    uint32_t eventCount;
+    bool complete = this->getVarint(eventCount);
+    for (uint32_t i = 0; complete && i < eventCount; i++)
+    {
+        QueuedInputEvent event = {};
+        unsigned char type;
+        unsigned char value;
+        complete = this->getByte(type);
+        if (!complete)
+        {
+            break;
+        }
+        event.type = (QueuedInputEventType)type;
+        event.key = KeyboardKey::KEYBOARD_UNKNOWN;
+        event.x = this->mouseX;
+        event.y = this->mouseY;
+        switch (event.type)
+        {
+        case QueuedInputEventType::KEYBOARD_KEY_PRESS:
+        case QueuedInputEventType::KEYBOARD_KEY_RELEASE:
+            complete = this->getByte(value);
+            event.key = (KeyboardKey)((int)value - 1);
+            break;
+        case QueuedInputEventType::MOUSE_MOVE:
+            complete = this->getMouseMotion(event.x, event.y);
+            break;
+        case QueuedInputEventType::MOUSE_BUTTON_PRESS:
+        case QueuedInputEventType::MOUSE_BUTTON_RELEASE:
+            complete = this->getByte(value) && this->getMouseMotion(event.x, event.y);
+            event.button = (MouseButton)value;
+            break;
+        case QueuedInputEventType::FOCUS_LOST:
+            break;
+        case QueuedInputEventType::MOUSE_RELATIVE_MOVE:
+            complete = this->getZigzag(event.x) && this->getZigzag(event.y);
+            break;
+        default:
+            complete = false;
+            break;
+        }
+        events.push_back(event);
+    }
+
+    if (!complete)
+    {
+        events.clear();
+        this->position = tickStart;
+        this->mouseX = tickMouseX;
+        this->mouseY = tickMouseY;
+        return false;
+    }
+    this->tickCount++;
+    return true;
+}
+
+unsigned long long InputReplay::GetTickCount() const
+{
+    return this->tickCount;
+}
+
+bool InputReplay::open(const std::string& fileName)
+{
+    FILE* file = fopen(fileName.c_str(), "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    unsigned char buffer[4096];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        this->bytes.insert(this->bytes.end(), buffer, buffer + count);
+    }
+    fclose(file);
+    if (this->bytes.size() < InputRecordingFormat::HEADER_SIZE)
+    {
+        return false;
+    }
+
+    const unsigned char* data = &this->bytes[0];
+    InputRecordingFormat::Header header;
+    header.magic = getLittleEndian(data);
+    header.version = getLittleEndian(data + 4);
+    header.mouseX = (int32_t)getLittleEndian(data + 8);
+    header.mouseY = (int32_t)getLittleEndian(data + 12);
+    for (unsigned int i = 0; i < InputRecordingFormat::KEY_BYTES; i++)
+    {
+        header.keysDown[i] = data[16 + i];
+    }
+    header.buttonsDown = data[16 + InputRecordingFormat::KEY_BYTES];
+    if (header.magic != InputRecordingFormat::MAGIC || header.version != InputRecordingFormat::VERSION)
+    {
+        return false;
+    }
+
+    std::bitset<InputSnapshot::KEY_COUNT> keysDown;
+    for (unsigned int i = 0; i < InputSnapshot::KEY_COUNT; i++)
+    {
+        keysDown[i] = (header.keysDown[i / 8] >> (i % 8)) & 1;
+    }
+    std::bitset<InputSnapshot::MOUSE_BUTTON_COUNT> buttonsDown(header.buttonsDown);
+    this->initialSnapshot.Restore(keysDown, buttonsDown, header.mouseX, header.mouseY);
+    this->mouseX = header.mouseX;
+    this->mouseY = header.mouseY;
+    this->position = InputRecordingFormat::HEADER_SIZE;
+    return true;
+}
+
+bool InputReplay::getByte(unsigned char& value)
+{
+    if (this->position >= this->bytes.size())
+    {
+        return false;
+    }
+    value = this->bytes[this->position++];
+    return true;
+}
+
+bool InputReplay::getVarint(uint32_t& value)
+{
+    value = 0;
+    for (unsigned int shift = 0; shift < 32; shift += 7)
+    {
+        unsigned char byte;
+        if (!this->getByte(byte))
+        {
+            return false;
+        }
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool InputReplay::getZigzag(int& value)
+{
+    uint32_t encoded;
+    if (!this->getVarint(encoded))
+    {
+        return false;
+    }
+    value = (int32_t)((encoded >> 1) ^ (0 - (encoded & 1)));
+    return true;
+}
+
+bool InputReplay::getMouseMotion(int& x, int& y)
+{
+    int dx;
+    int dy;
+    if (!this->getZigzag(dx) || !this->getZigzag(dy))
+    {
+        return false;
+    }
+    // Wrap the same way the recorder did
+    this->mouseX = (int32_t)((uint32_t)this->mouseX + (uint32_t)dx);
+    this->mouseY = (int32_t)((uint32_t)this->mouseY + (uint32_t)dy);
+    x = this->mouseX;
+    y = this->mouseY;
+    return true;
+}
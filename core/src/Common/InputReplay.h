@@ -0,0 +1,85 @@
+#ifndef Core_InputReplay_h
+#define Core_InputReplay_h
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <memory>
+#include "QueuedInputEvent.h"
+#include "InputSnapshot.h"
+#include "InputRecordingFormat.h"
+
+/**
+ * Reads back a recording made by an InputRecorder, one tick at a time, to
+ * dispatch in place of the input arriving from the InputView.
+ *
+ * The whole recording is read into memory when it's opened, so replaying
+ * never waits on the disk. A recording cut short, such as by the game
+ * crashing while recording, replays up to its last complete tick.
+ */
+class InputReplay final
+{
+public:
+    /**
+     * Opens the given recording, returning null if it can't be read or isn't
+     * an input recording.
+     */
+    static std::shared_ptr<InputReplay> Open(const std::string& fileName);
+
+    /**
+     * Should NEVER be used. Only public because make_shared requires it.
+     */
+    InputReplay();
+
+    /**
+     * Obtains the input state the recording starts from.
+     */
+    const InputSnapshot& GetInitialSnapshot() const;
+
+    /**
+     * Obtains whether no tick has been read yet.
+     */
+    bool IsAtStart() const;
+
+    /**
+     * Reads the events of the next tick into the given list, replacing its
+     * contents.
+     * @return false if every tick has been read.
+     */
+    bool NextTick(std::vector<QueuedInputEvent>& events);
+
+    /**
+     * Obtains how many ticks have been read.
+     */
+    unsigned long long GetTickCount() const;
+
+private:
+    // Private constructors to disallow access.
+    InputReplay(InputReplay const &other);
+    InputReplay operator=(InputReplay other);
+
+    /**
+     * Reads the file and its header, returning false if either fails.
+     */
+    bool open(const std::string& fileName);
+
+    /**
+     * Reads a value at the read position, returning false at the end of the
+     * recording.
+     */
+    bool getByte(unsigned char& value);
+    bool getVarint(uint32_t& value);
+    bool getZigzag(int& value);
+    bool getMouseMotion(int& x, int& y);
+
+    std::vector<unsigned char> bytes;
+    size_t position;
+    unsigned long long tickCount;
+    InputSnapshot initialSnapshot;
+
+    // The cursor position the next mouse event's movement is relative to
+    int mouseX;
+    int mouseY;
+};
+
+#endif
@@ -0,0 +1,154 @@
+#include "InputSnapshot.h"
+
+const unsigned int InputSnapshot::KEY_COUNT;
+const unsigned int InputSnapshot::MOUSE_BUTTON_COUNT;
+
+InputSnapshot::InputSnapshot() : mouseX(0), mouseY(0), mouseDeltaX(0), mouseDeltaY(0)
+{
+}
+
+void InputSnapshot::BeginTick()
+{
+    this->keysPressed.reset();
+    this->keysReleased.reset();
+    this->buttonsPressed.reset();
+    this->buttonsReleased.reset();
+    this->mouseDeltaX = 0;
+    this->mouseDeltaY = 0;
+}
+
+void InputSnapshot::Apply(const QueuedInputEvent& event)
+{
+    switch (event.type)
+    {
+    case QueuedInputEventType::KEYBOARD_KEY_PRESS:
+        if (InputSnapshot::IsValidKey(event.key))
+        {
+            // Key repeat sends presses for a key that's already down
+            if (!this->keysDown[(unsigned int)event.key])
+            {
+                this->keysPressed.set((unsigned int)event.key);
+            }
+            this->keysDown.set((unsigned int)event.key);
+        }
+        break;
+    case QueuedInputEventType::KEYBOARD_KEY_RELEASE:
+        if (InputSnapshot::IsValidKey(event.key))
+        {
+            this->keysReleased.set((unsigned int)event.key);
+            this->keysDown.reset((unsigned int)event.key);
+        }
+        break;
+    case QueuedInputEventType::MOUSE_MOVE:
+        this->mouseX = event.x;
+        this->mouseY = event.y;
+        break;
+    case QueuedInputEventType::MOUSE_BUTTON_PRESS:
+        if ((unsigned int)event.button < InputSnapshot::MOUSE_BUTTON_COUNT)
+        {
+            this->buttonsPressed.set((unsigned int)event.button);
+            this->buttonsDown.set((unsigned int)event.button);
+        }
+        this->mouseX = event.x;
+        this->mouseY = event.y;
+        break;
+    case QueuedInputEventType::MOUSE_BUTTON_RELEASE:
+        if ((unsigned int)event.button < InputSnapshot::MOUSE_BUTTON_COUNT)
+        {
+            this->buttonsReleased.set((unsigned int)event.button);
+            this->buttonsDown.reset((unsigned int)event.button);
+        }
+        this->mouseX = event.x;
+        this->mouseY = event.y;
+        break;
+    case QueuedInputEventType::FOCUS_LOST:
+        this->ReleaseAll();
+        break;
+    case QueuedInputEventType::MOUSE_RELATIVE_MOVE:
+        this->mouseDeltaX += event.x;
+        this->mouseDeltaY += event.y;
+        break;
+    }
+}
+
+void InputSnapshot::ReleaseAll()
+{
+    this->keysReleased |= this->keysDown;
+    this->keysDown.reset();
+    this->buttonsReleased |= this->buttonsDown;
+    this->buttonsDown.reset();
+}
+
+void InputSnapshot::Restore(const std::bitset<InputSnapshot::KEY_COUNT>& keysDown, const std::bitset<InputSnapshot::MOUSE_BUTTON_COUNT>& buttonsDown, int mouseX, int mouseY)
+{
+    this->BeginTick();
+    this->keysDown = keysDown;
+    this->buttonsDown = buttonsDown;
+    this->mouseX = mouseX;
+    this->mouseY = mouseY;
+}
+
+const std::bitset<InputSnapshot::KEY_COUNT>& InputSnapshot::GetKeysDown() const
+{
+    return this->keysDown;
+}
+
+const std::bitset<InputSnapshot::MOUSE_BUTTON_COUNT>& InputSnapshot::GetMouseButtonsDown() const
+{
+    return this->buttonsDown;
+}
+
+bool InputSnapshot::IsKeyDown(KeyboardKey key) const
+{
+    return InputSnapshot::IsValidKey(key) && this->keysDown[(unsigned int)key];
+}
+
+bool InputSnapshot::WasKeyPressed(KeyboardKey key) const
+{
+    return InputSnapshot::IsValidKey(key) && this->keysPressed[(unsigned int)key];
+}
+
+bool InputSnapshot::WasKeyReleased(KeyboardKey key) const
+{
+    return InputSnapshot::IsValidKey(key) && this->keysReleased[(unsigned int)key];
+}
+
+bool InputSnapshot::IsMouseButtonDown(MouseButton button) const
+{
+    return (unsigned int)button < InputSnapshot::MOUSE_BUTTON_COUNT && this->buttonsDown[(unsigned int)button];
+}
+
+bool InputSnapshot::WasMouseButtonPressed(MouseButton button) const
+{
+    return (unsigned int)button < InputSnapshot::MOUSE_BUTTON_COUNT && this->buttonsPressed[(unsigned int)button];
+}
+
+bool InputSnapshot::WasMouseButtonReleased(MouseButton button) const
+{
+    return (unsigned int)button < InputSnapshot::MOUSE_BUTTON_COUNT && this->buttonsReleased[(unsigned int)button];
+}
+
+int InputSnapshot::GetMouseX() const
+{
+    return this->mouseX;
+}
+
+int InputSnapshot::GetMouseY() const
+{
+    return this->mouseY;
+}
+
+int InputSnapshot::GetMouseDeltaX() const
+{
+    return this->mouseDeltaX;
+}
+
+int InputSnapshot::GetMouseDeltaY() const
+{
+    return this->mouseDeltaY;
+}
+
+bool InputSnapshot::IsValidKey(KeyboardKey key)
+{
+    return (int)key >= 0 && (int)key < (int)InputSnapshot::KEY_COUNT;
+}
@@ -0,0 +1,125 @@
+#ifndef Core_InputSnapshot_h
+#define Core_InputSnapshot_h
+
+#include <bitset>
+#include "KeyboardKey.h"
+#include "MouseButton.h"
+#include "QueuedInputEvent.h"
+
+/**
+ * The state of the keyboard and mouse as of the start of a game tick.
+ *
+ * The InputManager builds one snapshot per tick from the events queued
+ * since the last one, so every query within a tick sees the same values and
+ * none of them ask the operating system anything. Keys and buttons are kept
+ * in bitsets indexed by their enum values, along with which of them went
+ * down or up during the tick; a key pressed and released within one tick
+ * counts as both pressed and released, but isn't down.
+ */
+class InputSnapshot final
+{
+public:
+    /**
+     * One more than the largest KeyboardKey and MouseButton values.
+     */
+    static const unsigned int KEY_COUNT = 256;
+    static const unsigned int MOUSE_BUTTON_COUNT = 8;
+
+    /**
+     * Creates a snapshot with nothing down and the cursor at the origin.
+     */
+    InputSnapshot();
+
+    /**
+     * Forgets which keys and buttons went down or up, starting a new tick.
+     */
+    void BeginTick();
+
+    /**
+     * Updates the snapshot with an event that happened during this tick.
+     */
+    void Apply(const QueuedInputEvent& event);
+
+    /**
+     * Releases every key and button, as happens when the window loses
+     * focus and their releases would never arrive.
+     */
+    void ReleaseAll();
+
+    /**
+     * Sets which keys and buttons are down and where the cursor is, with
+     * nothing pressed or released this tick, such as when replaying input
+     * recorded from that state.
+     */
+    void Restore(const std::bitset<KEY_COUNT>& keysDown, const std::bitset<MOUSE_BUTTON_COUNT>& buttonsDown, int mouseX, int mouseY);
+
+    /**
+     * Obtains every key and mouse button that is down, indexed by their
+     * enum values.
+     */
+    const std::bitset<KEY_COUNT>& GetKeysDown() const;
+    const std::bitset<MOUSE_BUTTON_COUNT>& GetMouseButtonsDown() const;
+
+    /**
+     * Obtains whether the given key is down. Unknown keys never are.
+     */
+    bool IsKeyDown(KeyboardKey key) const;
+
+    /**
+     * Obtains whether the given key went down during this tick.
+     */
+    bool WasKeyPressed(KeyboardKey key) const;
+
+    /**
+     * Obtains whether the given key went up during this tick.
+     */
+    bool WasKeyReleased(KeyboardKey key) const;
+
+    /**
+     * Obtains whether the given mouse button is down.
+     */
+    bool IsMouseButtonDown(MouseButton button) const;
+
+    /**
+     * Obtains whether the given mouse button went down during this tick.
+     */
+    bool WasMouseButtonPressed(MouseButton button) const;
+
+    /**
+     * Obtains whether the given mouse button went up during this tick.
+     */
+    bool WasMouseButtonReleased(MouseButton button) const;
+
+    /**
+     * Obtains the cursor's position, relative to the top left of the game
+     * window, as of its last movement.
+     */
+    int GetMouseX() const;
+    int GetMouseY() const;
+
+    /**
+     * Obtains how far the mouse moved while the cursor was locked during
+     * this tick.
+     */
+    int GetMouseDeltaX() const;
+    int GetMouseDeltaY() const;
+
+    /**
+     * Obtains whether the given key has a slot in the snapshot's bitsets.
+     */
+    static bool IsValidKey(KeyboardKey key);
+
+private:
+    std::bitset<KEY_COUNT> keysDown;
+    std::bitset<KEY_COUNT> keysPressed;
+    std::bitset<KEY_COUNT> keysReleased;
+    std::bitset<MOUSE_BUTTON_COUNT> buttonsDown;
+    std::bitset<MOUSE_BUTTON_COUNT> buttonsPressed;
+    std::bitset<MOUSE_BUTTON_COUNT> buttonsReleased;
+    int mouseX;
+    int mouseY;
+    int mouseDeltaX;
+    int mouseDeltaY;
+};
+
+#endif
@@ -0,0 +1,217 @@
+#include <cstring>
+#include <vector>
+#include "LZ4Block.h"
+
+namespace
+{
+    // Limits imposed by the block format: every match is at least 4 bytes,
+    // the last 5 bytes are always literals, and the last match starts at
+    // least 12 bytes before the end.
+    const size_t MIN_MATCH = 4;
+    const size_t LAST_LITERALS = 5;
+    const size_t MATCH_FIND_LIMIT = 12;
+    const size_t MAX_OFFSET = 65535;
+    const unsigned int HASH_BITS = 12;
+
+    unsigned int read32(const unsigned char* bytes)
+    {
+        unsigned int value;
+        std::memcpy(&value, bytes, 4);
+        return value;
+    }
+
+    unsigned int hash(unsigned int sequence)
+    {
+        return (sequence * 2654435761u) >> (32 - HASH_BITS);
+    }
+}
+
+size_t LZ4Block::GetMaxCompressedSize(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+size_t LZ4Block::Compress(const unsigned char* source, size_t sourceSize, unsigned char* destination, size_t destinationCapacity)
+{
+    size_t written = 0;
+    size_t anchor = 0;
+    size_t position = 0;
+
+    if (sourceSize >= MATCH_FIND_LIMIT + 1)
+    {
+        // Positions of the last 4-byte sequence seen with each hash, plus one
+        // so that 0 means none.
+        std::vector<size_t> table((size_t)1 << HASH_BITS, 0);
+        size_t matchStartLimit = sourceSize - MATCH_FIND_LIMIT;
+        size_t matchEndLimit = sourceSize - LAST_LITERALS;
+        while (position < matchStartLimit)
+        {
+            unsigned int sequence = read32(source + position);
+            unsigned int bucket = hash(sequence);
+            size_t candidate = table[bucket];
+            table[bucket] = position + 1;
+            if (candidate == 0 || position - (candidate - 1) > MAX_OFFSET || read32(source + candidate - 1) != sequence)
+            {
+                position++;
+                continue;
+            }
+
+            size_t reference = candidate - 1;
+            size_t length = MIN_MATCH;
+            while (position + length < matchEndLimit && source[reference + length] == source[position + length])
+            {
+                length++;
+            }
+            if (!LZ4Block::writeSequence(source + anchor, position - anchor, position - reference, length, destination, destinationCapacity, written))
+            {
+                return 0;
+            }
+            position += length;
+            anchor = position;
+        }
+    }
+
+    if (!LZ4Block::writeSequence(source + anchor, sourceSize - anchor, 0, 0, destination, destinationCapacity, written))
+    {
+        return 0;
+    }
+    return written;
+}
+
+bool LZ4Block::Decompress(const unsigned char* source, size_t sourceSize, unsigned char* destination, size_t destinationSize)
+{
+    size_t read = 0;
+    size_t written = 0;
+    while (read < sourceSize)
+    {
+        unsigned char token = source[read++];
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !LZ4Block::readLength(source, sourceSize, read, literalLength))
+        {
+            return false;
+        }
+        if (literalLength > sourceSize - read || literalLength > destinationSize - written)
+        {
+            return false;
+        }
+        if (literalLength != 0)
+        {
+            std::memcpy(destination + written, source + read, literalLength);
+        }
+        read += literalLength;
+        written += literalLength;
+
+        // The last sequence has no match
+        if (read == sourceSize)
+        {
+            break;
+        }
+
+        if (sourceSize - read < 2)
+        {
+            return false;
+        }
+        size_t offset = source[read] | (source[read + 1] << 8);
+        read += 2;
+        if (offset == 0 || offset > written)
+        {
+            return false;
+        }
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !LZ4Block::readLength(source, sourceSize, read, matchLength))
+        {
+            return false;
+        }
+        matchLength += MIN_MATCH;
+        if (matchLength > destinationSize - written)
+        {
+            return false;
+        }
+
+        // Matches may overlap the bytes they produce, so copy one at a time
+        const unsigned char* match = destination + written - offset;
+        for (size_t i = 0; i < matchLength; i++)
+        {
+            destination[written + i] = match[i];
+        }
+        written += matchLength;
+    }
+    return written == destinationSize;
+}
+
+bool LZ4Block::writeSequence(const unsigned char* literals, size_t literalLength, size_t matchOffset, size_t matchLength, unsigned char* destination, size_t destinationCapacity, size_t& written)
+{
+    if (written >= destinationCapacity)
+    {
+        return false;
+    }
+    size_t tokenIndex = written++;
+    unsigned char token = (unsigned char)((literalLength >= 15 ? 15 : literalLength) << 4);
+    if (literalLength >= 15 && !LZ4Block::writeLength(literalLength - 15, destination, destinationCapacity, written))
+    {
+        return false;
+    }
+    if (literalLength > destinationCapacity - written)
+    {
+        return false;
+    }
+    if (literalLength != 0)
+    {
+        std::memcpy(destination + written, literals, literalLength);
+    }
+    written += literalLength;
+
+    if (matchLength != 0)
+    {
+        if (destinationCapacity - written < 2)
+        {
+            return false;
+        }
+        destination[written++] = (unsigned char)(matchOffset & 0xFF);
+        destination[written++] = (unsigned char)(matchOffset >> 8);
+        size_t length = matchLength - MIN_MATCH;
+        token |= (unsigned char)(length >= 15 ? 15 : length);
+        if (length >= 15 && !LZ4Block::writeLength(length - 15, destination, destinationCapacity, written))
+        {
+            return false;
+        }
+    }
+    destination[tokenIndex] = token;
+    return true;
+}
+
+bool LZ4Block::writeLength(size_t length, unsigned char* destination, size_t destinationCapacity, size_t& written)
+{
+    while (length >= 255)
+    {
+        if (written >= destinationCapacity)
+        {
+            return false;
+        }
+        destination[written++] = 255;
+        length -= 255;
+    }
+    if (written >= destinationCapacity)
+    {
+        return false;
+    }
+    destination[written++] = (unsigned char)length;
+    return true;
+}
+
+bool LZ4Block::readLength(const unsigned char* source, size_t sourceSize, size_t& read, size_t& length)
+{
+    unsigned char byte;
+    do
+    {
+        if (read >= sourceSize)
+        {
+            return false;
+        }
+        byte = source[read++];
+        length += byte;
+    }
+    while (byte == 255);
+    return true;
+}
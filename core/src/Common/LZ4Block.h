@@ -0,0 +1,59 @@
+#ifndef Core_LZ4Block_h
+#define Core_LZ4Block_h
+
+#include <cstddef>
+
+/**
+ * A minimal implementation of the LZ4 block format, used to compress the
+ * entries of asset packs.
+ *
+ * The compressor is a simple greedy one; it is only run offline by the
+ * AssetPacker tool. The decompressor checks every length and offset
+ * against the buffers it was given, so a damaged pack can't make it read
+ * or write out of bounds.
+ */
+class LZ4Block
+{
+public:
+    /**
+     * Obtains the largest size the given number of bytes can compress to.
+     */
+    static size_t GetMaxCompressedSize(size_t size);
+
+    /**
+     * Compresses the given data into the destination, returning the
+     * compressed size, or 0 if it didn't fit in the given capacity.
+     */
+    static size_t Compress(const unsigned char* source, size_t sourceSize, unsigned char* destination, size_t destinationCapacity);
+
+    /**
+     * Decompresses the given block, which must decompress to exactly
+     * destinationSize bytes. Returns false if the block is malformed.
+     */
+    static bool Decompress(const unsigned char* source, size_t sourceSize, unsigned char* destination, size_t destinationSize);
+
+private:
+    // Private constructors to disallow access.
+    LZ4Block();
+    LZ4Block(LZ4Block const &other);
+    LZ4Block operator=(LZ4Block other);
+
+    /**
+     * Appends a sequence of the given literals followed by a match of the
+     * given offset and length, or just the literals if matchLength is 0.
+     * Returns false if it doesn't fit.
+     */
+    static bool writeSequence(const unsigned char* literals, size_t literalLength, size_t matchOffset, size_t matchLength, unsigned char* destination, size_t destinationCapacity, size_t& written);
+
+    /**
+     * Appends the extra bytes of a length that didn't fit in its token.
+     */
+    static bool writeLength(size_t length, unsigned char* destination, size_t destinationCapacity, size_t& written);
+
+    /**
+     * Reads the extra bytes of a length that didn't fit in its token.
+     */
+    static bool readLength(const unsigned char* source, size_t sourceSize, size_t& read, size_t& length);
+};
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef Core_QuadSource_h
+#define Core_QuadSource_h
+
+class VertexStream;
+
+/**
+ * Interface for anything that draws batches of quads without going
+ * through individual Sprites, such as particle systems or text.
+ *
+ * QuadSources are registered with the GraphicsManager and asked to write
+ * their quads into the view's VertexStream once per frame, after all
+ * registered sprites.
+ */
+class QuadSource
+{
+public:
+    virtual ~QuadSource() {}
+
+    /**
+     * Appends this source's quads to the given stream.
+     *
+     * Called from the view thread, so implementations must guard any state
+     * that the game thread modifies.
+     */
+    virtual void PutGLQuads(VertexStream& stream) = 0;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include "QueueStats.h"
+
+QueueStats::QueueStats() : maxDepth(0), fullCount(0), droppedCount(0), takenCount(0), totalLatency(0), maxLatency(0)
+{
+}
+
+void QueueStats::RecordPush(unsigned int depth)
+{
+    // Only the producer writes the depth, so there's no race to lose
+    if (depth > this->maxDepth.load(std::memory_order_relaxed))
+    {
+        this->maxDepth.store(depth);
+    }
+}
+
+void QueueStats::RecordFull()
+{
+    this->fullCount++;
+}
+
+void QueueStats::RecordDropped()
+{
+    this->droppedCount++;
+}
+
+void QueueStats::RecordLatency(double milliseconds)
+{
+    unsigned long long latency = (unsigned long long)(milliseconds * 1000.0);
+    this->totalLatency += latency;
+    this->takenCount++;
+    if (latency > this->maxLatency.load(std::memory_order_relaxed))
+    {
+        this->maxLatency.store(latency);
+    }
+}
+
+unsigned int QueueStats::GetMaxDepth()
+{
+    return this->maxDepth.load();
+}
+
+unsigned long long QueueStats::GetFullCount()
+{
+    return this->fullCount.load();
+}
+
+unsigned long long QueueStats::GetDroppedCount()
+{
+    return this->droppedCount.load();
+}
+
+unsigned long long QueueStats::GetTakenCount()
+{
+    return this->takenCount.load();
+}
+
+double QueueStats::GetAverageLatencyMilliseconds()
+{
+    unsigned long long count = this->takenCount.load();
+    return count == 0 ? 0.0 : this->totalLatency.load() / 1000.0 / count;
+}
+
+double QueueStats::GetMaxLatencyMilliseconds()
+{
+    return this->maxLatency.load() / 1000.0;
+}
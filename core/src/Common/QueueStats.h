@@ -0,0 +1,87 @@
+#ifndef Core_QueueStats_h
+#define Core_QueueStats_h
+
+#include <atomic>
+
+/**
+ * Statistics about a queue passing work from one thread to another, such
+ * as an SpscQueue: how deep it got, how often it was full, how many values
+ * were dropped, and how long values waited in it.
+ *
+ * Depths and full or dropped values are recorded by the producer thread and
+ * latencies by the consumer thread. Any thread may read them.
+ */
+class QueueStats
+{
+public:
+    /**
+     * Creates statistics with nothing recorded.
+     */
+    QueueStats();
+
+    /**
+     * Records that a value was pushed, leaving the queue at the given depth.
+     */
+    void RecordPush(unsigned int depth);
+
+    /**
+     * Records that a value found the queue full.
+     */
+    void RecordFull();
+
+    /**
+     * Records that a value was dropped.
+     */
+    void RecordDropped();
+
+    /**
+     * Records that a value was taken after waiting the given number of
+     * milliseconds.
+     */
+    void RecordLatency(double milliseconds);
+
+    /**
+     * Obtains the deepest the queue has been after a push.
+     */
+    unsigned int GetMaxDepth();
+
+    /**
+     * Obtains how many values have found the queue full.
+     */
+    unsigned long long GetFullCount();
+
+    /**
+     * Obtains how many values have been dropped.
+     */
+    unsigned long long GetDroppedCount();
+
+    /**
+     * Obtains how many values have been taken.
+     */
+    unsigned long long GetTakenCount();
+
+    /**
+     * Obtains how long taken values waited on average, in milliseconds.
+     */
+    double GetAverageLatencyMilliseconds();
+
+    /**
+     * Obtains the longest a taken value waited, in milliseconds.
+     */
+    double GetMaxLatencyMilliseconds();
+
+private:
+    // Private constructors to disallow access.
+    QueueStats(QueueStats const &other);
+    QueueStats operator=(QueueStats other);
+
+    // Latencies are in microseconds
+    std::atomic<unsigned int> maxDepth;
+    std::atomic<unsigned long long> fullCount;
+    std::atomic<unsigned long long> droppedCount;
+    std::atomic<unsigned long long> takenCount;
+    std::atomic<unsigned long long> totalLatency;
+    std::atomic<unsigned long long> maxLatency;
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef Core_QueuedInputEvent_h
+#define Core_QueuedInputEvent_h
+
+#include <chrono>
+#include "KeyboardKey.h"
+#include "MouseButton.h"
+
+/**
+ * Enumeration of the input events the InputView queues for the InputManager
+ */
+enum class QueuedInputEventType {
+    KEYBOARD_KEY_PRESS,
+    KEYBOARD_KEY_RELEASE,
+    MOUSE_MOVE,
+    MOUSE_BUTTON_PRESS,
+    MOUSE_BUTTON_RELEASE,
+    FOCUS_LOST,
+    MOUSE_RELATIVE_MOVE,
+};
+
+/**
+ * An input event received by the InputView on the view thread, to be
+ * dispatched to handlers by the InputManager on the game thread.
+ */
+struct QueuedInputEvent
+{
+    QueuedInputEventType type;
+
+    /**
+     * The key, for the keyboard events
+     */
+    KeyboardKey key;
+
+    /**
+     * The button, for the mouse button events
+     */
+    MouseButton button;
+
+    /**
+     * The cursor's position in the window, for the mouse events, or how far
+     * the mouse moved, for MOUSE_RELATIVE_MOVE
+     */
+    int x;
+    int y;
+
+    /**
+     * When the InputView received the event
+     */
+    std::chrono::steady_clock::time_point time;
+};
+
+#endif
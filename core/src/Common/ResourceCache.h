@@ -0,0 +1,189 @@
+#ifndef Core_ResourceCache_h
+#define Core_ResourceCache_h
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include <unordered_map>
+
+/**
+ * Shares loaded resources between everything that loads the same file.
+ *
+ * Acquire loads a resource the first time its file is asked for and hands
+ * out the same object after that, counting references; each Acquire must
+ * be matched by a Release. A resource nobody references isn't destroyed
+ * right away but kept for a grace period, so that the next GameState
+ * reuses it instantly if it loads the same file. Collect destroys the ones
+ * whose grace period has run out.
+ *
+ * May be used from any thread. The loader is run with the cache locked, so
+ * slow loads that should run in parallel are better done outside the cache
+ * and handed over with Insert.
+ */
+template <typename T>
+class ResourceCache final
+{
+public:
+    typedef std::function<std::shared_ptr<T> (const std::string& fileName)> Loader;
+
+    /**
+     * Creates an empty cache.
+     */
+    ResourceCache() : hitCount(0), missCount(0)
+    {
+    }
+
+    /**
+     * Obtains the resource loaded from the given file, loading it with the
+     * given loader if it isn't cached, and adds a reference to it. Returns
+     * null, without adding a reference, if the loader fails.
+     */
+    std::shared_ptr<T> Acquire(const std::string& fileName, Loader loader)
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto existing = this->entries.find(fileName);
+        if (existing != this->entries.end())
+        {
+            existing->second.references++;
+            this->hitCount++;
+            return existing->second.value;
+        }
+
+        std::shared_ptr<T> value = loader(fileName);
+        if (value == nullptr)
+        {
+            return nullptr;
+        }
+        Entry& entry = this->entries[fileName];
+        entry.value = value;
+        entry.references = 1;
+        this->missCount++;
+        return value;
+    }
+
+    /**
+     * Obtains the resource loaded from the given file and adds a reference
+     * to it, or returns null if it isn't cached.
+     */
+    std::shared_ptr<T> AcquireCached(const std::string& fileName)
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto existing = this->entries.find(fileName);
+        if (existing == this->entries.end())
+        {
+            return nullptr;
+        }
+        existing->second.references++;
+        this->hitCount++;
+        return existing->second.value;
+    }
+
+    /**
+     * Caches a resource loaded without the cache locked, such as on a worker
+     * thread, and adds a reference to it. If the file was cached meanwhile,
+     * the cached resource is referenced and returned instead.
+     */
+    std::shared_ptr<T> Insert(const std::string& fileName, std::shared_ptr<T> value)
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto existing = this->entries.find(fileName);
+        if (existing != this->entries.end())
+        {
+            existing->second.references++;
+            this->hitCount++;
+            return existing->second.value;
+        }
+        Entry& entry = this->entries[fileName];
+        entry.value = value;
+        entry.references = 1;
+        this->missCount++;
+        return value;
+    }
+
+    /**
+     * Removes a reference to the resource loaded from the given file. Once
+     * it has none left, its grace period starts.
+     */
+    void Release(const std::string& fileName)
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto existing = this->entries.find(fileName);
+        if (existing == this->entries.end() || existing->second.references == 0)
+        {
+            return;
+        }
+        existing->second.references--;
+        if (existing->second.references == 0)
+        {
+            existing->second.releaseTime = std::chrono::steady_clock::now();
+        }
+    }
+
+    /**
+     * Destroys every resource that has had no references for longer than
+     * the given number of seconds.
+     */
+    void Collect(double gracePeriodSeconds)
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        for (auto it = this->entries.begin(); it != this->entries.end();)
+        {
+            std::chrono::duration<double> unused = now - it->second.releaseTime;
+            if (it->second.references == 0 && unused.count() >= gracePeriodSeconds)
+            {
+                it = this->entries.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+    }
+
+    /**
+     * Obtains the number of cached resources, referenced or not.
+     */
+    unsigned int GetCount()
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return (unsigned int)this->entries.size();
+    }
+
+    /**
+     * Obtains the number of times the resource was found cached, and the
+     * number of times it had to be loaded.
+     */
+    unsigned long long GetHitCount()
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->hitCount;
+    }
+
+    unsigned long long GetMissCount()
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->missCount;
+    }
+
+private:
+    // Private constructors to disallow access.
+    ResourceCache(ResourceCache const &other);
+    ResourceCache operator=(ResourceCache other);
+
+    struct Entry
+    {
+        std::shared_ptr<T> value;
+        unsigned int references;
+        std::chrono::steady_clock::time_point releaseTime;
+    };
+
+    std::unordered_map<std::string, Entry> entries;
+    std::mutex mutex;
+    unsigned long long hitCount;
+    unsigned long long missCount;
+};
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef Core_ResourceHandles_h
+#define Core_ResourceHandles_h
+
+#include "Handle.h"
+
+/**
+ * Tags distinguishing the handle types of each kind of resource.
+ */
+struct TextureTag;
+struct SoundTag;
+struct MusicTag;
+
+/**
+ * A texture loaded by the ResourceManager.
+ */
+typedef Handle<TextureTag> TextureHandle;
+
+/**
+ * A sound effect loaded by the SoundManager.
+ */
+typedef Handle<SoundTag> SoundHandle;
+
+/**
+ * A piece of music opened by the SoundManager.
+ */
+typedef Handle<MusicTag> MusicHandle;
+
+#endif
@@ -1,10 +1,29 @@
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
 #include "ResourceManager.h"
+#include "WorkerPool.h"
 
+// SOIL2's helper for matching SOIL_FLAG_NTSC_SAFE_RGB when decoding by hand
+extern "C" int scale_image_RGB_to_NTSC_safe(unsigned char* orig, int width, int height, int channels);
 
 // Global static pointer used to ensure a single instance of the class.
 std::shared_ptr<ResourceManager> ResourceManager::instance = nullptr;
+std::mutex ResourceManager::instanceMutex;
 
-ResourceManager::ResourceManager()
+const size_t ResourceManager::DEFAULT_TEXTURE_MEMORY_BUDGET = 256 * 1024 * 1024;
+const double ResourceManager::DEFAULT_UNLOAD_GRACE_PERIOD = 5.0;
+
+ResourceManager::ResourceManager() :
+    placeholderTextureUnit(0),
+    pendingTextureCount(0),
+    textureMemoryBudget(DEFAULT_TEXTURE_MEMORY_BUDGET),
+    residentTextureBytes(0),
+    frame(0),
+    evictionCount(0),
+    reloadCount(0),
+    unloadGracePeriod(DEFAULT_UNLOAD_GRACE_PERIOD)
 {
 
 }
@@ -16,32 +35,615 @@ ResourceManager::~ResourceManager()
 
 void ResourceManager::Initialize()
 {
+    std::lock_guard<std::mutex> lock(ResourceManager::instanceMutex);
     ResourceManager::instance = std::make_shared<ResourceManager>();
 }
 
 std::shared_ptr<ResourceManager> ResourceManager::GetInstance()
 {
+    std::lock_guard<std::mutex> lock(ResourceManager::instanceMutex);
+    if (ResourceManager::instance == nullptr)
+    {
+        ResourceManager::instance = std::make_shared<ResourceManager>();
+    }
     return ResourceManager::instance;
 }
 
+bool ResourceManager::MountAssetPack(const std::string& fileName)
+{
+    std::shared_ptr<AssetPack> pack = AssetPack::Open(fileName);
+    if (pack == nullptr)
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(this->assetPacksMutex);
+    this->assetPacks.push_back(pack);
+    return true;
+}
+
+void ResourceManager::UnmountAssetPacks()
+{
+    std::lock_guard<std::mutex> lock(this->assetPacksMutex);
+    this->assetPacks.clear();
+}
+
+bool ResourceManager::ReadAsset(const std::string& fileName, AssetPack::Asset& asset)
+{
+    // Packs are immutable, so they're searched without the lock, which is
+    // only needed to copy the list.
+    this->assetPacksMutex.lock();
+    std::vector<std::shared_ptr<AssetPack>> packs = this->assetPacks;
+    this->assetPacksMutex.unlock();
+
+    for (auto pack = packs.rbegin(); pack != packs.rend(); pack++)
+    {
+        if ((*pack)->Read(fileName, asset))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 void ResourceManager::LoadTexture(int textureID, const char *fileName)
-{    
-    this->textureList.push_back(std::make_shared<Texture>(textureID, fileName));
+{
+    {
+        // A file already loaded under another ID, or by name, is shared
+        // rather than decoded and uploaded again
+        std::lock_guard<std::mutex> lock(this->texturesMutex);
+        auto existing = this->texturesByName.find(fileName);
+        if (existing != this->texturesByName.end())
+        {
+            this->addLoadReference(existing->second, nullptr);
+            this->mapTextureID(textureID, existing->second);
+            return;
+        }
+    }
+
+    TextureRecord record;
+    AssetPack::Asset asset;
+    if (this->ReadAsset(Texture::GetCookedFileName(fileName), asset))
+    {
+        record.texture = std::make_shared<Texture>(textureID, asset.data, asset.size, true);
+    }
+    else if (this->ReadAsset(fileName, asset))
+    {
+        record.texture = std::make_shared<Texture>(textureID, asset.data, asset.size, false);
+    }
+    else
+    {
+        record.texture = std::make_shared<Texture>(textureID, fileName);
+    }
+    record.fileName = fileName;
+    record.textureID = textureID;
+    record.pending = false;
+    record.failed = !record.texture->IsLoaded();
+    record.byteSize = Texture::MeasureByteSize(record.texture->GetTextureUnit());
+    record.spriteReferences = 0;
+    record.loadReferences = 1;
+
+    std::lock_guard<std::mutex> lock(this->texturesMutex);
+    auto existing = this->texturesByName.find(record.fileName);
+    if (existing != this->texturesByName.end())
+    {
+        // Another thread started loading the file meanwhile
+        if (record.texture->IsLoaded())
+        {
+            this->textureUnitsToDelete.push_back(record.texture->GetTextureUnit());
+        }
+        this->addLoadReference(existing->second, nullptr);
+        this->mapTextureID(textureID, existing->second);
+        return;
+    }
+    record.lastUsedFrame = this->frame;
+    this->residentTextureBytes += record.byteSize;
+    TextureHandle handle = this->textures.Insert(record);
+    this->texturesByName[record.fileName] = handle;
+    this->mapTextureID(textureID, handle);
+}
+
+TextureHandle ResourceManager::LoadTextureAsync(const std::string& fileName, TextureCallback callback)
+{
+    std::lock_guard<std::mutex> lock(this->texturesMutex);
+    auto existing = this->texturesByName.find(fileName);
+    if (existing != this->texturesByName.end())
+    {
+        this->addLoadReference(existing->second, callback);
+        return existing->second;
+    }
+    return this->startLoading(fileName, -1, callback);
+}
+
+TextureHandle ResourceManager::LoadTextureAsync(int textureID, const char* fileName, TextureCallback callback)
+{
+    this->texturesMutex.lock();
+    bool exists = this->texturesByID.find(textureID) != this->texturesByID.end();
+    TextureHandle handle;
+    if (!exists)
+    {
+        auto existing = this->texturesByName.find(fileName);
+        if (existing != this->texturesByName.end())
+        {
+            handle = existing->second;
+            this->addLoadReference(handle, callback);
+        }
+        else
+        {
+            handle = this->startLoading(fileName, textureID, callback);
+        }
+        this->texturesByID[textureID] = handle;
+    }
+    this->texturesMutex.unlock();
+    if (exists)
+    {
+        throw new std::invalid_argument("A texture was loaded with an ID that is already in use.");
+    }
+    return handle;
+}
+
+TextureHandle ResourceManager::startLoading(const std::string& fileName, int textureID, TextureCallback callback)
+{
+    TextureRecord record;
+    record.texture = std::make_shared<Texture>(textureID);
+    record.fileName = fileName;
+    record.textureID = textureID;
+    record.pending = true;
+    record.failed = false;
+    record.byteSize = 0;
+    record.lastUsedFrame = this->frame;
+    record.spriteReferences = 0;
+    record.loadReferences = 1;
+    if (callback)
+    {
+        record.callbacks.push_back(callback);
+    }
+    TextureHandle handle = this->textures.Insert(record);
+    this->texturesByName[fileName] = handle;
+    this->pendingTextureCount++;
+    this->decodeInBackground(handle, fileName);
+    return handle;
+}
+
+void ResourceManager::addLoadReference(TextureHandle texture, TextureCallback callback)
+{
+    TextureRecord* record = this->textures.Get(texture);
+    record->loadReferences++;
+    this->reloadIfEvicted(texture, record);
+    if (record->pending)
+    {
+        if (callback)
+        {
+            record->callbacks.push_back(callback);
+        }
+    }
+    else if (callback)
+    {
+        // Already loaded, so the callback runs with the next dispatch
+        record->callbacks.push_back(callback);
+        this->completedTextures.push_back(std::make_pair(texture, !record->failed));
+    }
+}
+
+void ResourceManager::releaseLoadReference(TextureHandle texture)
+{
+    TextureRecord* record = this->textures.Get(texture);
+    if (record == nullptr || record->loadReferences == 0)
+    {
+        return;
+    }
+    record->loadReferences--;
+    if (record->loadReferences == 0)
+    {
+        // UpdateTextureResidency unloads it once no sprite uses it either
+        record->releaseTime = std::chrono::steady_clock::now();
+    }
+}
+
+void ResourceManager::mapTextureID(int textureID, TextureHandle texture)
+{
+    // Loading over an ID replaces what it was loaded with, so the reference
+    // that load took is given up
+    auto existing = this->texturesByID.find(textureID);
+    if (existing != this->texturesByID.end())
+    {
+        this->releaseLoadReference(existing->second);
+    }
+    this->texturesByID[textureID] = texture;
+}
+
+void ResourceManager::decodeInBackground(TextureHandle texture, const std::string& fileName)
+{
+    WorkerPool::GetInstance()->Submit([this, texture, fileName]()
+    {
+        std::shared_ptr<DecodedTexture> decoded = this->decodeTexture(texture, fileName);
+        this->texturesMutex.lock();
+        this->decodedTextures.push_back(decoded);
+        this->texturesMutex.unlock();
+    });
+}
+
+void ResourceManager::reloadIfEvicted(TextureHandle texture, TextureRecord* record)
+{
+    if (record->pending || record->failed || record->texture->IsLoaded())
+    {
+        return;
+    }
+    record->pending = true;
+    this->pendingTextureCount++;
+    this->reloadCount++;
+    this->decodeInBackground(texture, record->fileName);
+}
+
+void ResourceManager::evictTexture(TextureRecord* record)
+{
+    this->textureUnitsToDelete.push_back(record->texture->GetTextureUnit());
+    record->texture->SetTextureUnit(0);
+    this->residentTextureBytes -= record->byteSize;
+    record->byteSize = 0;
+    this->evictionCount++;
+}
+
+void ResourceManager::UnloadTexture(TextureHandle texture)
+{
+    std::lock_guard<std::mutex> lock(this->texturesMutex);
+    this->releaseLoadReference(texture);
+}
+
+void ResourceManager::SetUnloadGracePeriod(double seconds)
+{
+    std::lock_guard<std::mutex> lock(this->texturesMutex);
+    this->unloadGracePeriod = seconds;
+}
+
+double ResourceManager::GetUnloadGracePeriod()
+{
+    std::lock_guard<std::mutex> lock(this->texturesMutex);
+    return this->unloadGracePeriod;
+}
+
+void ResourceManager::unloadTexture(TextureHandle texture)
+{
+    TextureRecord* record = this->textures.Get(texture);
+    if (record == nullptr)
+    {
+        return;
+    }
+    if (record->texture->IsLoaded())
+    {
+        this->textureUnitsToDelete.push_back(record->texture->GetTextureUnit());
+        this->residentTextureBytes -= record->byteSize;
+    }
+    if (record->pending)
+    {
+        this->pendingTextureCount--;
+    }
+    auto byName = this->texturesByName.find(record->fileName);
+    if (byName != this->texturesByName.end() && byName->second == texture)
+    {
+        this->texturesByName.erase(byName);
+    }
+    // A shared texture may be mapped from several IDs
+    for (auto byID = this->texturesByID.begin(); byID != this->texturesByID.end();)
+    {
+        if (byID->second == texture)
+        {
+            byID = this->texturesByID.erase(byID);
+        }
+        else
+        {
+            byID++;
+        }
+    }
+    this->textures.Remove(texture);
+}
+
+TextureHandle ResourceManager::FindTexture(const std::string& fileName)
+{
+    std::lock_guard<std::mutex> lock(this->texturesMutex);
+    auto texture = this->texturesByName.find(fileName);
+    return texture == this->texturesByName.end() ? TextureHandle() : texture->second;
+}
+
+TextureHandle ResourceManager::FindTexture(int textureID)
+{
+    std::lock_guard<std::mutex> lock(this->texturesMutex);
+    auto texture = this->texturesByID.find(textureID);
+    return texture == this->texturesByID.end() ? TextureHandle() : texture->second;
+}
+
+bool ResourceManager::IsTextureLoaded(TextureHandle texture)
+{
+    std::lock_guard<std::mutex> lock(this->texturesMutex);
+    TextureRecord* record = this->textures.Get(texture);
+    return record != nullptr && record->texture->IsLoaded();
+}
+
+unsigned int ResourceManager::GetTextureCount()
+{
+    std::lock_guard<std::mutex> lock(this->texturesMutex);
+    return this->textures.GetCount();
+}
+
+unsigned int ResourceManager::GetPendingTextureCount()
+{
+    std::lock_guard<std::mutex> lock(this->texturesMutex);
+    return this->pendingTextureCount;
+}
+
+unsigned int ResourceManager::GetTextureUnit(TextureHandle texture)
+{
+    std::lock_guard<std::mutex> lock(this->texturesMutex);
+    TextureRecord* record = this->textures.Get(texture);
+    if (record == nullptr)
+    {
+        return 0;
+    }
+    record->lastUsedFrame = this->frame;
+    if (!record->texture->IsLoaded())
+    {
+        this->reloadIfEvicted(texture, record);
+        return this->placeholderTextureUnit;
+    }
+    return record->texture->GetTextureUnit();
 }
 
 unsigned int ResourceManager::GetTextureUnitFromTextureID(int textureID)
 {
-    std::shared_ptr<Texture> tempTexture;
-    unsigned int i;
-    for (i = 0; i < this->textureList.size(); i++)
+    return this->GetTextureUnit(this->FindTexture(textureID));
+}
+
+void ResourceManager::SetTextureMemoryBudget(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(this->texturesMutex);
+    this->textureMemoryBudget = bytes;
+}
+
+size_t ResourceManager::GetTextureMemoryBudget()
+{
+    std::lock_guard<std::mutex> lock(this->texturesMutex);
+    return this->textureMemoryBudget;
+}
+
+ResourceManager::ResidencyStats ResourceManager::GetResidencyStats()
+{
+    std::lock_guard<std::mutex> lock(this->texturesMutex);
+    ResidencyStats stats;
+    stats.budgetBytes = this->textureMemoryBudget;
+    stats.residentBytes = this->residentTextureBytes;
+    stats.residentTextureCount = 0;
+    for (unsigned int i = 0; i < this->textures.GetSlotCount(); i++)
+    {
+        TextureRecord* record = this->textures.Get(this->textures.GetHandleAt(i));
+        if (record != nullptr && record->texture->IsLoaded())
+        {
+            stats.residentTextureCount++;
+        }
+    }
+    stats.evictionCount = this->evictionCount;
+    stats.reloadCount = this->reloadCount;
+    return stats;
+}
+
+void ResourceManager::AddTextureReference(TextureHandle texture)
+{
+    std::lock_guard<std::mutex> lock(this->texturesMutex);
+    TextureRecord* record = this->textures.Get(texture);
+    if (record != nullptr)
+    {
+        record->spriteReferences++;
+        this->reloadIfEvicted(texture, record);
+    }
+}
+
+void ResourceManager::RemoveTextureReference(TextureHandle texture)
+{
+    std::lock_guard<std::mutex> lock(this->texturesMutex);
+    TextureRecord* record = this->textures.Get(texture);
+    if (record != nullptr && record->spriteReferences > 0)
+    {
+        record->spriteReferences--;
+        if (record->spriteReferences == 0 && record->loadReferences == 0)
+        {
+            // The grace period starts when the last user lets go
+            record->releaseTime = std::chrono::steady_clock::now();
+        }
+    }
+}
+
+void ResourceManager::UpdateTextureResidency()
+{
+    std::lock_guard<std::mutex> lock(this->texturesMutex);
+    this->frame++;
+
+    // Unload textures nobody has loaded again within the grace period
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < this->textures.GetSlotCount(); i++)
+    {
+        TextureHandle handle = this->textures.GetHandleAt(i);
+        TextureRecord* record = this->textures.Get(handle);
+        if (record != nullptr && record->loadReferences == 0 && record->spriteReferences == 0)
+        {
+            std::chrono::duration<double> unused = now - record->releaseTime;
+            if (unused.count() >= this->unloadGracePeriod)
+            {
+                this->unloadTexture(handle);
+            }
+        }
+    }
+
+    if (this->residentTextureBytes <= this->textureMemoryBudget)
+    {
+        return;
+    }
+
+    // Only textures no sprite uses, and that weren't drawn last frame, may
+    // be evicted; the least recently drawn go first.
+    std::vector<std::pair<unsigned long long, TextureHandle>> candidates;
+    for (unsigned int i = 0; i < this->textures.GetSlotCount(); i++)
+    {
+        TextureHandle handle = this->textures.GetHandleAt(i);
+        TextureRecord* record = this->textures.Get(handle);
+        if (record != nullptr && record->texture->IsLoaded() && !record->pending &&
+            record->spriteReferences == 0 && record->lastUsedFrame + 1 < this->frame)
+        {
+            candidates.push_back(std::make_pair(record->lastUsedFrame, handle));
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    for (auto it = candidates.begin(); it != candidates.end() && this->residentTextureBytes > this->textureMemoryBudget; it++)
+    {
+        this->evictTexture(this->textures.Get(it->second));
+    }
+}
+
+void ResourceManager::SetPlaceholderTextureUnit(unsigned int textureUnit)
+{
+    std::lock_guard<std::mutex> lock(this->texturesMutex);
+    this->placeholderTextureUnit = textureUnit;
+}
+
+std::shared_ptr<DecodedTexture> ResourceManager::TakeDecodedTexture()
+{
+    std::lock_guard<std::mutex> lock(this->texturesMutex);
+    if (this->decodedTextures.empty())
     {
-        tempTexture = this->textureList[i];
+        return nullptr;
+    }
+    std::shared_ptr<DecodedTexture> decoded = this->decodedTextures.front();
+    this->decodedTextures.pop_front();
+    return decoded;
+}
 
-        if (tempTexture->GetTextureID() == textureID)
+void ResourceManager::FinishTextureUpload(TextureHandle texture, unsigned int textureUnit, size_t byteSize)
+{
+    std::lock_guard<std::mutex> lock(this->texturesMutex);
+    TextureRecord* record = this->textures.Get(texture);
+    if (record == nullptr)
+    {
+        // The texture was unloaded while it was loading
+        if (textureUnit != 0)
         {
-            return tempTexture->GetTextureUnit();
+            this->textureUnitsToDelete.push_back(textureUnit);
         }
+        return;
+    }
+    record->texture->SetTextureUnit(textureUnit);
+    record->pending = false;
+    record->failed = textureUnit == 0;
+    record->byteSize = textureUnit == 0 ? 0 : byteSize;
+    record->lastUsedFrame = this->frame;
+    this->residentTextureBytes += record->byteSize;
+    this->pendingTextureCount--;
+    this->completedTextures.push_back(std::make_pair(texture, textureUnit != 0));
+}
+
+std::vector<unsigned int> ResourceManager::TakeTextureUnitsToDelete()
+{
+    std::lock_guard<std::mutex> lock(this->texturesMutex);
+    std::vector<unsigned int> textureUnits;
+    textureUnits.swap(this->textureUnitsToDelete);
+    return textureUnits;
+}
+
+void ResourceManager::DispatchTextureCallbacks()
+{
+    std::vector<std::pair<TextureCallback, std::pair<TextureHandle, bool>>> callbacks;
+    this->texturesMutex.lock();
+    for (auto it = this->completedTextures.begin(); it != this->completedTextures.end(); it++)
+    {
+        TextureRecord* record = this->textures.Get(it->first);
+        if (record == nullptr)
+        {
+            continue;
+        }
+        for (auto callback = record->callbacks.begin(); callback != record->callbacks.end(); callback++)
+        {
+            callbacks.push_back(std::make_pair(*callback, *it));
+        }
+        record->callbacks.clear();
+    }
+    this->completedTextures.clear();
+    this->texturesMutex.unlock();
+
+    // Callbacks are run without the lock so they can load more textures
+    for (auto it = callbacks.begin(); it != callbacks.end(); it++)
+    {
+        it->first(it->second.first, it->second.second);
+    }
+}
+
+std::shared_ptr<DecodedTexture> ResourceManager::decodeTexture(TextureHandle texture, std::string fileName)
+{
+    std::shared_ptr<DecodedTexture> decoded = std::make_shared<DecodedTexture>();
+    decoded->texture = texture;
+    decoded->succeeded = false;
+    decoded->cooked = false;
+    decoded->width = 0;
+    decoded->height = 0;
+
+    // Cooked textures only need to be read; they are uploaded as-is.
+    std::string cookedFileName = Texture::GetCookedFileName(fileName.c_str());
+    if (this->ReadAsset(cookedFileName, decoded->cookedFile))
+    {
+        decoded->cooked = true;
+        decoded->succeeded = true;
+        return decoded;
+    }
+    FILE* cookedFile = fopen(cookedFileName.c_str(), "rb");
+    if (cookedFile != nullptr)
+    {
+        fseek(cookedFile, 0, SEEK_END);
+        long size = ftell(cookedFile);
+        fseek(cookedFile, 0, SEEK_SET);
+        std::shared_ptr<std::vector<unsigned char>> contents = std::make_shared<std::vector<unsigned char>>();
+        if (size > 0)
+        {
+            contents->resize(size);
+            decoded->cooked = fread(&(*contents)[0], 1, size, cookedFile) == (size_t)size;
+        }
+        fclose(cookedFile);
+        if (decoded->cooked)
+        {
+            decoded->cookedFile.data = &(*contents)[0];
+            decoded->cookedFile.size = contents->size();
+            decoded->cookedFile.owner = contents;
+            decoded->succeeded = true;
+            return decoded;
+        }
+    }
+
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    unsigned char* pixels;
+    AssetPack::Asset asset;
+    if (this->ReadAsset(fileName, asset))
+    {
+        pixels = SOIL_load_image_from_memory(asset.data, (int)asset.size, &width, &height, &channels, SOIL_LOAD_RGBA);
+    }
+    else
+    {
+        pixels = SOIL_load_image(fileName.c_str(), &width, &height, &channels, SOIL_LOAD_RGBA);
+    }
+    if (pixels == nullptr)
+    {
+        printf("Error loading Image.\n");
+        return decoded;
+    }
+    scale_image_RGB_to_NTSC_safe(pixels, width, height, 4);
+
+    // Flip the rows while copying them into staging memory, as
+    // SOIL_FLAG_INVERT_Y would.
+    size_t rowSize = (size_t)width * 4;
+    decoded->data.resize(rowSize * height);
+    for (int y = 0; y < height; y++)
+    {
+        std::memcpy(&decoded->data[rowSize * y], pixels + rowSize * (height - 1 - y), rowSize);
     }
+    SOIL_free_image_data(pixels);
 
-    return 0;
+    decoded->width = width;
+    decoded->height = height;
+    decoded->succeeded = true;
+    return decoded;
 }
@@ -2,39 +2,225 @@
 #define Core_ResourceManager_h
 
 #include "Texture.h"
+#include "DecodedTexture.h"
+#include "ResourceHandles.h"
+#include "AssetPack.h"
+#include <cstddef>
 #include <vector>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <functional>
+#include <mutex>
 #include <memory>
+#include <chrono>
 
 using namespace std;
 
+/**
+ * Loads and owns the game's textures.
+ *
+ * Loading a texture returns a TextureHandle, which resolves to the texture
+ * in constant time and stops resolving once the texture is unloaded, even
+ * if its slot has been reused. File names are only hashed when loading or
+ * with FindTexture, so keep the handle rather than looking it up by name.
+ *
+ * Textures should be loaded with LoadTextureAsync, which decodes the image
+ * on a worker thread and lets the view thread upload it a little at a time
+ * so that loading never stalls a frame. Until a texture has been uploaded,
+ * GetTextureUnit returns a plain white placeholder texture, so sprites
+ * using it can be drawn right away. A callback can be given to find out
+ * when the texture is ready; it is run on the game thread.
+ *
+ * The older integer texture IDs are still supported; each ID is mapped to
+ * a handle when the texture is loaded.
+ *
+ * Textures are kept within a video memory budget. Once the resident
+ * textures outgrow it, the least recently drawn ones that no sprite is
+ * using are evicted from video memory. Their handles stay valid, and an
+ * evicted texture is loaded again in the background as soon as it is
+ * drawn or given to a sprite, showing the placeholder until it is back.
+ *
+ * Loading a file that is already loaded shares the existing texture and
+ * adds a reference to it; it is only unloaded once UnloadTexture has been
+ * called as many times as it was loaded. Even then it is kept for a grace
+ * period, so a GameState that loads the same textures as the one it
+ * replaced gets them back instantly.
+ *
+ * Assets can be bundled into packs with the AssetPacker tool and mounted
+ * with MountAssetPack. Files found in a mounted pack are loaded straight
+ * from its memory mapping rather than opened one by one.
+ */
 class ResourceManager
 {
 public:
+    /**
+     * Called on the game thread once an asynchronously loaded texture is
+     * ready to draw, or failed to load.
+     */
+    typedef std::function<void (TextureHandle texture, bool loaded)> TextureCallback;
+
+    /**
+     * Statistics about the textures resident in video memory.
+     */
+    struct ResidencyStats
+    {
+        size_t budgetBytes;
+        size_t residentBytes;
+        unsigned int residentTextureCount;
+        unsigned long long evictionCount;
+        unsigned long long reloadCount;
+    };
+
+    /**
+     * The video memory budget used until SetTextureMemoryBudget is called.
+     */
+    static const size_t DEFAULT_TEXTURE_MEMORY_BUDGET;
+
+    /**
+     * The grace period used until SetUnloadGracePeriod is called, in
+     * seconds.
+     */
+    static const double DEFAULT_UNLOAD_GRACE_PERIOD;
+
     /**
      * Should NEVER be used. Only public because make_shared requires it.
      */
     ResourceManager();
 
     ~ResourceManager();
-    
+
     /**
      * Initializes the ResorceManager
      */
     static void Initialize();
-    
+
     /**
-     * Retrieves the current instance of the ResourceManager.
+     * Retrieves the current instance of the ResourceManager, creating it if
+     * it hasn't been initialized yet.
      */
     static std::shared_ptr<ResourceManager> GetInstance();
-    
+
     /**
-     * Loads a texture with the given fileName and textureID
+     * Mounts the given asset pack. Textures and sounds found in it are read
+     * from the pack from then on, instead of from their own files; packs
+     * mounted later take precedence over earlier ones.
+     *
+     * Returns false if the pack couldn't be opened or is damaged.
+     */
+    bool MountAssetPack(const std::string& fileName);
+
+    /**
+     * Unmounts every asset pack. Assets already read from them stay valid.
+     */
+    void UnmountAssetPacks();
+
+    /**
+     * Reads the given file from the mounted asset packs, returning false if
+     * none of them contain it. May be called from any thread.
+     */
+    bool ReadAsset(const std::string& fileName, AssetPack::Asset& asset);
+
+    /**
+     * Loads a texture with the given fileName and textureID, immediately,
+     * on the calling thread. That thread must own the OpenGL context, so
+     * this is only usable from the view thread; use LoadTextureAsync
+     * everywhere else.
+     *
+     * If the file is already loaded or loading, under another ID or by
+     * name, its texture is shared, with another reference added, rather
+     * than loaded again. Loading over an ID that is in use releases the
+     * reference taken when it was loaded.
      *
      * @param textureID
      * @param fileName
      */
     void LoadTexture(int textureID, const char* fileName);
-    
+
+    /**
+     * Starts loading the texture with the given file name in the
+     * background and returns its handle. May be called from any thread.
+     *
+     * If the file is already loaded or loading, its existing handle is
+     * returned, with another reference added, and the callback is run once
+     * it is ready.
+     *
+     * @param fileName
+     * @param callback run on the game thread once the texture is ready or
+     * failed to load; may be null.
+     */
+    TextureHandle LoadTextureAsync(const std::string& fileName, TextureCallback callback);
+
+    /**
+     * Starts loading a texture in the background, to be looked up with the
+     * given textureID.
+     *
+     * If the file is already loaded or loading, its texture is shared, as
+     * with the other overload.
+     *
+     * Throws an invalid_argument if a texture with the given ID has already
+     * been loaded or is loading.
+     */
+    TextureHandle LoadTextureAsync(int textureID, const char* fileName, TextureCallback callback);
+
+    /**
+     * Releases a reference to the given texture. Once the last one is
+     * released, no sprite uses the texture, and the grace period has
+     * passed since both, the texture is unloaded on the next frame,
+     * freeing its video memory, and the handle and any copies of it no
+     * longer resolve.
+     */
+    void UnloadTexture(TextureHandle texture);
+
+    /**
+     * Sets how many seconds textures and sounds are kept after their last
+     * reference is released, in case they are loaded again. 0 unloads
+     * them as soon as nothing uses them; textures on the next frame.
+     */
+    void SetUnloadGracePeriod(double seconds);
+
+    /**
+     * Obtains the unload grace period in seconds.
+     */
+    double GetUnloadGracePeriod();
+
+    /**
+     * Obtains the handle of the texture loaded from the given file, or a
+     * null handle if it isn't loaded.
+     */
+    TextureHandle FindTexture(const std::string& fileName);
+
+    /**
+     * Obtains the handle of the texture loaded with the given ID, or a null
+     * handle if there isn't one.
+     */
+    TextureHandle FindTexture(int textureID);
+
+    /**
+     * Obtains whether the given texture has been uploaded and hasn't been
+     * evicted since.
+     */
+    bool IsTextureLoaded(TextureHandle texture);
+
+    /**
+     * Obtains the number of textures, loaded or still loading.
+     */
+    unsigned int GetTextureCount();
+
+    /**
+     * Obtains the number of asynchronous texture loads that haven't
+     * finished uploading yet.
+     */
+    unsigned int GetPendingTextureCount();
+
+    /**
+     * Gets the OpenGL texture unit of the given texture, and marks it as
+     * used this frame. Textures that are still loading give the placeholder
+     * texture; null and stale handles give 0. Evicted textures give the
+     * placeholder and start loading again.
+     */
+    unsigned int GetTextureUnit(TextureHandle texture);
+
     /**
      * Gets the TextureUnit from the TextureID
      *
@@ -42,19 +228,221 @@ public:
      */
     unsigned int GetTextureUnitFromTextureID(int textureID);
 
+    /**
+     * Sets the number of bytes of video memory textures may use before
+     * unused ones are evicted. Textures in use are never evicted, so this
+     * may still be exceeded.
+     */
+    void SetTextureMemoryBudget(size_t bytes);
+
+    /**
+     * Obtains the video memory budget in bytes.
+     */
+    size_t GetTextureMemoryBudget();
+
+    /**
+     * Obtains the current residency statistics.
+     */
+    ResidencyStats GetResidencyStats();
+
+    /**
+     * Records that a sprite is using the given texture, which keeps it from
+     * being evicted, and reloads it if it was.
+     *
+     * Typically this function isn't needed outside the game engine's
+     * core graphics system, and thus it shouldn't be needed by users.
+     */
+    void AddTextureReference(TextureHandle texture);
+
+    /**
+     * Records that a sprite has stopped using the given texture.
+     *
+     * Typically this function isn't needed outside the game engine's
+     * core graphics system, and thus it shouldn't be needed by users.
+     */
+    void RemoveTextureReference(TextureHandle texture);
+
+    /**
+     * Starts a new frame, unloads released textures whose grace period has
+     * passed, then evicts the least recently used textures until the
+     * resident ones fit the budget again. Called by the view thread
+     * before it deletes unloaded textures.
+     *
+     * Typically this function isn't needed outside the game engine's
+     * core graphics system, and thus it shouldn't be needed by users.
+     */
+    void UpdateTextureResidency();
+
+    /**
+     * Sets the texture drawn in place of textures that are still loading.
+     *
+     * Typically this function isn't needed outside the game engine's
+     * core graphics system, and thus it shouldn't be needed by users.
+     */
+    void SetPlaceholderTextureUnit(unsigned int textureUnit);
+
+    /**
+     * Takes the next decoded texture waiting to be uploaded, or null if
+     * there isn't one. Should only be called on the view thread.
+     *
+     * Typically this function isn't needed outside the game engine's
+     * core graphics system, and thus it shouldn't be needed by users.
+     */
+    std::shared_ptr<DecodedTexture> TakeDecodedTexture();
+
+    /**
+     * Records that a decoded texture has been uploaded to the given texture
+     * unit, taking up the given number of bytes of video memory, or failed
+     * to upload if the unit is 0, and queues its callback.
+     *
+     * Typically this function isn't needed outside the game engine's
+     * core graphics system, and thus it shouldn't be needed by users.
+     */
+    void FinishTextureUpload(TextureHandle texture, unsigned int textureUnit, size_t byteSize);
+
+    /**
+     * Takes the OpenGL texture units of unloaded textures, which the view
+     * thread must delete.
+     *
+     * Typically this function isn't needed outside the game engine's
+     * core graphics system, and thus it shouldn't be needed by users.
+     */
+    std::vector<unsigned int> TakeTextureUnitsToDelete();
+
+    /**
+     * Runs the callbacks of every texture that finished loading since the
+     * last call. Called by the engine at the start of each game update.
+     */
+    void DispatchTextureCallbacks();
+
 private:
     ResourceManager(ResourceManager const &other);
     ResourceManager operator=(ResourceManager other);
-    
+
+    /**
+     * Everything known about a loaded or loading texture.
+     */
+    struct TextureRecord
+    {
+        std::shared_ptr<Texture> texture;
+        std::string fileName;
+        int textureID;
+        bool pending;
+        bool failed;
+        size_t byteSize;
+        unsigned long long lastUsedFrame;
+        unsigned int spriteReferences;
+        unsigned int loadReferences;
+        std::chrono::steady_clock::time_point releaseTime;
+        std::vector<TextureCallback> callbacks;
+    };
+
+    /**
+     * Adds a record for the given file and starts decoding it. Must be
+     * called with texturesMutex held.
+     */
+    TextureHandle startLoading(const std::string& fileName, int textureID, TextureCallback callback);
+
+    /**
+     * Adds a load reference to the given texture, reloading it if it was
+     * evicted, and arranges for the callback to run once it's ready. Must be
+     * called with texturesMutex held.
+     */
+    void addLoadReference(TextureHandle texture, TextureCallback callback);
+
     /**
-     * The private instance of the ResourceManager. 
+     * Releases a load reference to the given texture, starting its grace
+     * period if it was the last. Must be called with texturesMutex held.
+     */
+    void releaseLoadReference(TextureHandle texture);
+
+    /**
+     * Looks the given ID up as the given texture, releasing the reference
+     * of whatever it was loaded with before. Must be called with
+     * texturesMutex held.
+     */
+    void mapTextureID(int textureID, TextureHandle texture);
+
+    /**
+     * Decodes the given texture on a worker thread and queues it for the
+     * view thread. Must be called with texturesMutex held.
+     */
+    void decodeInBackground(TextureHandle texture, const std::string& fileName);
+
+    /**
+     * Starts loading the given texture again if it has been evicted. Must
+     * be called with texturesMutex held.
+     */
+    void reloadIfEvicted(TextureHandle texture, TextureRecord* record);
+
+    /**
+     * Frees the video memory of the given texture, keeping its record so it
+     * can be reloaded. Must be called with texturesMutex held.
+     */
+    void evictTexture(TextureRecord* record);
+
+    /**
+     * Unloads the given texture. Must be called with texturesMutex held.
+     */
+    void unloadTexture(TextureHandle texture);
+
+    /**
+     * Reads and decodes the given file, from the asset packs if they have
+     * it, into staging memory. Run on a worker thread.
+     */
+    std::shared_ptr<DecodedTexture> decodeTexture(TextureHandle texture, std::string fileName);
+
+    /**
+     * The private instance of the ResourceManager.
      */
     static std::shared_ptr<ResourceManager> instance;
+    static std::mutex instanceMutex;
+
+    /**
+     * The mounted asset packs, in the order they were mounted.
+     */
+    std::vector<std::shared_ptr<AssetPack>> assetPacks;
+    std::mutex assetPacksMutex;
+
+    /**
+     * Guards every member below.
+     */
+    std::mutex texturesMutex;
+
+    HandleTable<TextureRecord, TextureTag> textures;
+    std::unordered_map<std::string, TextureHandle> texturesByName;
+    std::unordered_map<int, TextureHandle> texturesByID;
+
+    unsigned int placeholderTextureUnit;
+    unsigned int pendingTextureCount;
+
+    /**
+     * The video memory budget, how much of it resident textures take up,
+     * and the current frame, which textures are stamped with when drawn.
+     */
+    size_t textureMemoryBudget;
+    size_t residentTextureBytes;
+    unsigned long long frame;
+    unsigned long long evictionCount;
+    unsigned long long reloadCount;
+    double unloadGracePeriod;
+
+    /**
+     * Decoded textures waiting for the view thread, in the order they
+     * finished decoding.
+     */
+    std::deque<std::shared_ptr<DecodedTexture>> decodedTextures;
+
+    /**
+     * Textures that have finished loading whose callbacks haven't run yet,
+     * and whether they loaded.
+     */
+    std::vector<std::pair<TextureHandle, bool>> completedTextures;
 
     /**
-     * List of textures
+     * Texture units of unloaded textures, waiting for the view thread.
      */
-    vector<std::shared_ptr<Texture>> textureList;
+    std::vector<unsigned int> textureUnitsToDelete;
 };
 
 #endif
@@ -0,0 +1,278 @@
+#include <stdexcept>
+#include "SceneGraph.h"
+
+const SceneGraph::NodeID SceneGraph::ROOT;
+const SceneGraph::NodeID SceneGraph::NO_NODE;
+
+static const unsigned int INVALID_INDEX = 0xFFFFFFFF;
+
+SceneGraph::SceneGraph()
+{
+    LocalTransform rootTransform = { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f };
+    this->parentIndex.push_back(0);
+    this->subtreeSize.push_back(1);
+    this->nodeIds.push_back(SceneGraph::ROOT);
+    this->localTransform.push_back(rootTransform);
+    this->localMatrix.push_back(AffineTransform());
+    this->worldMatrix.push_back(AffineTransform());
+    this->dirty.push_back(0);
+    this->subtreeDirty.push_back(0);
+    this->changed.push_back(0);
+    this->idToIndex.push_back(0);
+}
+
+SceneGraph::~SceneGraph()
+{
+
+}
+
+SceneGraph::NodeID SceneGraph::CreateNode(NodeID parent)
+{
+    std::lock_guard<std::mutex> lock(this->nodesMutex);
+    unsigned int parentIdx = this->indexOf(parent);
+
+    NodeID id;
+    if (this->freeIds.empty())
+    {
+        id = (NodeID)this->idToIndex.size();
+        this->idToIndex.push_back(INVALID_INDEX);
+    }
+    else
+    {
+        id = this->freeIds.back();
+        this->freeIds.pop_back();
+    }
+
+    // The new node goes at the end of its parent's subtree, shifting
+    // everything after it one slot to the right.
+    unsigned int insertAt = parentIdx + this->subtreeSize[parentIdx];
+    LocalTransform transform = { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f };
+    this->parentIndex.insert(this->parentIndex.begin() + insertAt, parentIdx);
+    this->subtreeSize.insert(this->subtreeSize.begin() + insertAt, 1);
+    this->nodeIds.insert(this->nodeIds.begin() + insertAt, id);
+    this->localTransform.insert(this->localTransform.begin() + insertAt, transform);
+    this->localMatrix.insert(this->localMatrix.begin() + insertAt, AffineTransform());
+    this->worldMatrix.insert(this->worldMatrix.begin() + insertAt, AffineTransform());
+    this->dirty.insert(this->dirty.begin() + insertAt, 0);
+    this->subtreeDirty.insert(this->subtreeDirty.begin() + insertAt, 0);
+    this->changed.insert(this->changed.begin() + insertAt, 0);
+
+    for (unsigned int i = insertAt + 1; i < this->nodeIds.size(); i++)
+    {
+        if (this->parentIndex[i] >= insertAt)
+        {
+            this->parentIndex[i]++;
+        }
+        this->idToIndex[this->nodeIds[i]] = i;
+    }
+    this->idToIndex[id] = insertAt;
+
+    for (unsigned int ancestor = parentIdx; ; ancestor = this->parentIndex[ancestor])
+    {
+        this->subtreeSize[ancestor]++;
+        if (ancestor == 0)
+        {
+            break;
+        }
+    }
+
+    this->markDirty(insertAt);
+    return id;
+}
+
+void SceneGraph::DestroyNode(NodeID node)
+{
+    std::lock_guard<std::mutex> lock(this->nodesMutex);
+    unsigned int index = this->indexOf(node);
+    if (index == 0)
+    {
+        throw new std::invalid_argument("The root node of a scene graph cannot be destroyed.");
+    }
+
+    unsigned int count = this->subtreeSize[index];
+    unsigned int end = index + count;
+    for (unsigned int i = index; i < end; i++)
+    {
+        this->idToIndex[this->nodeIds[i]] = INVALID_INDEX;
+        this->freeIds.push_back(this->nodeIds[i]);
+    }
+    for (unsigned int ancestor = this->parentIndex[index]; ; ancestor = this->parentIndex[ancestor])
+    {
+        this->subtreeSize[ancestor] -= count;
+        if (ancestor == 0)
+        {
+            break;
+        }
+    }
+
+    this->parentIndex.erase(this->parentIndex.begin() + index, this->parentIndex.begin() + end);
+    this->subtreeSize.erase(this->subtreeSize.begin() + index, this->subtreeSize.begin() + end);
+    this->nodeIds.erase(this->nodeIds.begin() + index, this->nodeIds.begin() + end);
+    this->localTransform.erase(this->localTransform.begin() + index, this->localTransform.begin() + end);
+    this->localMatrix.erase(this->localMatrix.begin() + index, this->localMatrix.begin() + end);
+    this->worldMatrix.erase(this->worldMatrix.begin() + index, this->worldMatrix.begin() + end);
+    this->dirty.erase(this->dirty.begin() + index, this->dirty.begin() + end);
+    this->subtreeDirty.erase(this->subtreeDirty.begin() + index, this->subtreeDirty.begin() + end);
+    this->changed.erase(this->changed.begin() + index, this->changed.begin() + end);
+
+    for (unsigned int i = index; i < this->nodeIds.size(); i++)
+    {
+        if (this->parentIndex[i] >= end)
+        {
+            this->parentIndex[i] -= count;
+        }
+        this->idToIndex[this->nodeIds[i]] = i;
+    }
+}
+
+void SceneGraph::MoveTo(NodeID node, float x, float y)
+{
+    std::lock_guard<std::mutex> lock(this->nodesMutex);
+    unsigned int index = this->indexOf(node);
+    this->localTransform[index].x = x;
+    this->localTransform[index].y = y;
+    this->markDirty(index);
+}
+
+void SceneGraph::MoveBy(NodeID node, float dx, float dy)
+{
+    std::lock_guard<std::mutex> lock(this->nodesMutex);
+    unsigned int index = this->indexOf(node);
+    this->localTransform[index].x += dx;
+    this->localTransform[index].y += dy;
+    this->markDirty(index);
+}
+
+void SceneGraph::SetRotation(NodeID node, float rotation)
+{
+    std::lock_guard<std::mutex> lock(this->nodesMutex);
+    unsigned int index = this->indexOf(node);
+    this->localTransform[index].rotation = rotation;
+    this->markDirty(index);
+}
+
+void SceneGraph::SetScale(NodeID node, float scaleX, float scaleY)
+{
+    std::lock_guard<std::mutex> lock(this->nodesMutex);
+    unsigned int index = this->indexOf(node);
+    this->localTransform[index].scaleX = scaleX;
+    this->localTransform[index].scaleY = scaleY;
+    this->markDirty(index);
+}
+
+float SceneGraph::GetX(NodeID node)
+{
+    std::lock_guard<std::mutex> lock(this->nodesMutex);
+    return this->localTransform[this->indexOf(node)].x;
+}
+
+float SceneGraph::GetY(NodeID node)
+{
+    std::lock_guard<std::mutex> lock(this->nodesMutex);
+    return this->localTransform[this->indexOf(node)].y;
+}
+
+float SceneGraph::GetRotation(NodeID node)
+{
+    std::lock_guard<std::mutex> lock(this->nodesMutex);
+    return this->localTransform[this->indexOf(node)].rotation;
+}
+
+AffineTransform SceneGraph::GetWorldTransform(NodeID node)
+{
+    std::lock_guard<std::mutex> lock(this->nodesMutex);
+    unsigned int index = this->indexOf(node);
+    this->updateWorldTransforms();
+    return this->worldMatrix[index];
+}
+
+unsigned int SceneGraph::GetNodeCount()
+{
+    std::lock_guard<std::mutex> lock(this->nodesMutex);
+    return (unsigned int)this->nodeIds.size();
+}
+
+void SceneGraph::PrepareToReadWorldTransforms()
+{
+    this->nodesMutex.lock();
+    this->updateWorldTransforms();
+}
+
+const AffineTransform& SceneGraph::ReadWorldTransform(NodeID node)
+{
+    if (node >= this->idToIndex.size() || this->idToIndex[node] == INVALID_INDEX)
+    {
+        return this->identity;
+    }
+    return this->worldMatrix[this->idToIndex[node]];
+}
+
+void SceneGraph::FinishReadingWorldTransforms()
+{
+    this->nodesMutex.unlock();
+}
+
+unsigned int SceneGraph::indexOf(NodeID node)
+{
+    if (node >= this->idToIndex.size() || this->idToIndex[node] == INVALID_INDEX)
+    {
+        throw new std::invalid_argument("A scene graph node was used that doesn't exist.");
+    }
+    return this->idToIndex[node];
+}
+
+void SceneGraph::markDirty(unsigned int index)
+{
+    this->dirty[index] = 1;
+    // Stop at the first ancestor that is already flagged; everything above
+    // it was flagged at the same time.
+    for (unsigned int i = index; !this->subtreeDirty[i]; i = this->parentIndex[i])
+    {
+        this->subtreeDirty[i] = 1;
+        if (i == 0)
+        {
+            break;
+        }
+    }
+}
+
+void SceneGraph::updateWorldTransforms()
+{
+    if (!this->subtreeDirty[0])
+    {
+        return;
+    }
+
+    unsigned int count = (unsigned int)this->nodeIds.size();
+    unsigned int i = 0;
+    while (i < count)
+    {
+        unsigned int parent = this->parentIndex[i];
+        bool parentChanged = (i != 0) && this->changed[parent];
+        if (!this->subtreeDirty[i] && !parentChanged)
+        {
+            // Nothing in this subtree changed, so skip all of it.
+            this->changed[i] = 0;
+            i += this->subtreeSize[i];
+            continue;
+        }
+
+        if (this->dirty[i])
+        {
+            const LocalTransform& local = this->localTransform[i];
+            this->localMatrix[i] = AffineTransform::FromTranslationRotationScale(local.x, local.y, local.rotation, local.scaleX, local.scaleY);
+        }
+        if (this->dirty[i] || parentChanged)
+        {
+            this->worldMatrix[i] = (i == 0) ? this->localMatrix[i] : AffineTransform::Multiply(this->worldMatrix[parent], this->localMatrix[i]);
+            this->changed[i] = 1;
+        }
+        else
+        {
+            this->changed[i] = 0;
+        }
+        this->dirty[i] = 0;
+        this->subtreeDirty[i] = 0;
+        i++;
+    }
+}
@@ -0,0 +1,186 @@
+#ifndef Core_SceneGraph_h
+#define Core_SceneGraph_h
+
+#include <vector>
+#include <mutex>
+#include "AffineTransform.h"
+
+/**
+ * A hierarchy of transform nodes. Each node has a position, rotation, and
+ * scale relative to its parent, and a world transform that combines those
+ * of all its ancestors. Sprites attached to a node are drawn relative to
+ * it, so moving a node moves everything below it.
+ *
+ * Nodes are stored in depth-first order in flat arrays, so a parent always
+ * comes before its children and a subtree is a contiguous range. Changing a
+ * node only marks it dirty; world transforms are recomputed lazily in one
+ * linear pass that skips every subtree without changes.
+ *
+ * Node IDs stay valid while a node exists. IDs of destroyed nodes are
+ * reused by later nodes.
+ */
+class SceneGraph
+{
+public:
+    typedef unsigned int NodeID;
+
+    /**
+     * The ID of the root node, which always exists and cannot be destroyed.
+     */
+    static const NodeID ROOT = 0;
+
+    /**
+     * The ID used to represent "no node".
+     */
+    static const NodeID NO_NODE = 0xFFFFFFFF;
+
+    /**
+     * Creates a scene graph containing only the root node.
+     */
+    SceneGraph();
+
+    /**
+     * Destructor
+     */
+    ~SceneGraph();
+
+    /**
+     * Creates a node with an identity transform as the last child of the
+     * given node and returns its ID.
+     *
+     * Throws an invalid_argument if the parent doesn't exist.
+     */
+    NodeID CreateNode(NodeID parent);
+
+    /**
+     * Destroys the given node and all of its descendants.
+     *
+     * Throws an invalid_argument if the node doesn't exist or is the root.
+     */
+    void DestroyNode(NodeID node);
+
+    /**
+     * Moves the node to the given position relative to its parent.
+     */
+    void MoveTo(NodeID node, float x, float y);
+
+    /**
+     * Moves the node by the given amount relative to its parent.
+     */
+    void MoveBy(NodeID node, float dx, float dy);
+
+    /**
+     * Sets the node's counter-clockwise rotation relative to its parent, in
+     * radians.
+     */
+    void SetRotation(NodeID node, float rotation);
+
+    /**
+     * Sets the node's scale relative to its parent.
+     */
+    void SetScale(NodeID node, float scaleX, float scaleY);
+
+    /**
+     * Obtains the node's x position relative to its parent.
+     */
+    float GetX(NodeID node);
+
+    /**
+     * Obtains the node's y position relative to its parent.
+     */
+    float GetY(NodeID node);
+
+    /**
+     * Obtains the node's rotation relative to its parent.
+     */
+    float GetRotation(NodeID node);
+
+    /**
+     * Obtains the transform from the node's space to world space.
+     */
+    AffineTransform GetWorldTransform(NodeID node);
+
+    /**
+     * Obtains the number of nodes, including the root.
+     */
+    unsigned int GetNodeCount();
+
+    /**
+     * Brings every world transform up to date and locks the graph so that
+     * ReadWorldTransform can be called without further locking. Must be
+     * followed by FinishReadingWorldTransforms.
+     *
+     * Typically this function isn't needed outside the game engine's
+     * core graphics system, and thus it shouldn't be needed by users.
+     */
+    void PrepareToReadWorldTransforms();
+
+    /**
+     * Obtains the world transform of the given node, or the identity if the
+     * node doesn't exist. Only valid between PrepareToReadWorldTransforms
+     * and FinishReadingWorldTransforms.
+     */
+    const AffineTransform& ReadWorldTransform(NodeID node);
+
+    /**
+     * Unlocks the graph after PrepareToReadWorldTransforms.
+     */
+    void FinishReadingWorldTransforms();
+
+private:
+    // Private constructors to disallow access.
+    SceneGraph(SceneGraph const &other);
+    SceneGraph operator=(SceneGraph other);
+
+    /**
+     * A node's transform relative to its parent.
+     */
+    struct LocalTransform
+    {
+        float x;
+        float y;
+        float rotation;
+        float scaleX;
+        float scaleY;
+    };
+
+    /**
+     * Obtains the array index of the given node, throwing an
+     * invalid_argument if it doesn't exist. Must be called with the mutex
+     * held.
+     */
+    unsigned int indexOf(NodeID node);
+
+    /**
+     * Marks the node at the given index as changed and flags every
+     * ancestor as having a changed descendant.
+     */
+    void markDirty(unsigned int index);
+
+    /**
+     * Recomputes the world transform of every node that changed, or whose
+     * ancestor changed, since the last update.
+     */
+    void updateWorldTransforms();
+
+    std::mutex nodesMutex;
+
+    // Per-node data in depth-first order
+    std::vector<unsigned int> parentIndex;
+    std::vector<unsigned int> subtreeSize;
+    std::vector<NodeID> nodeIds;
+    std::vector<LocalTransform> localTransform;
+    std::vector<AffineTransform> localMatrix;
+    std::vector<AffineTransform> worldMatrix;
+    std::vector<unsigned char> dirty;
+    std::vector<unsigned char> subtreeDirty;
+    std::vector<unsigned char> changed;
+
+    // Maps node IDs to their current index in the arrays above
+    std::vector<unsigned int> idToIndex;
+    std::vector<NodeID> freeIds;
+
+    AffineTransform identity;
+};
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef Core_Simd_h
+#define Core_Simd_h
+
+/**
+ * Selects the SIMD instruction set used by the engine's batch kernels.
+ *
+ * Every supported platform builds for x64, so SSE2 is always available
+ * there. CORE_SIMD_SSE is left undefined on anything else and kernels
+ * fall back to their scalar loops.
+ */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CORE_SIMD_SSE 1
+#include <emmintrin.h>
+#endif
+
+/**
+ * The number of floats processed by one SIMD register.
+ */
+#define CORE_SIMD_WIDTH 4
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef Core_SoundAttenuation_h
+#define Core_SoundAttenuation_h
+
+/**
+ * Enumeration of the curves a positional sound's volume falls off with
+ * distance along
+ */
+enum class AttenuationCurve {
+    LINEAR,
+    INVERSE,
+    INVERSE_SQUARE,
+};
+
+/**
+ * How a positional sound's volume falls off with its distance from the
+ * camera's center, in world units.
+ *
+ * The sound is at full volume within minDistance, follows the curve
+ * between minDistance and maxDistance, and is silent beyond maxDistance.
+ */
+struct SoundAttenuation
+{
+    AttenuationCurve curve;
+    float minDistance;
+    float maxDistance;
+};
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef Core_SoundCommand_h
+#define Core_SoundCommand_h
+
+#include <string>
+#include <chrono>
+#include <memory>
+#include <future>
+#include <SFML/System/InputStream.hpp>
+#include "ResourceHandles.h"
+#include "SoundAttenuation.h"
+
+/**
+ * What happens when a sound or music is played before it has finished
+ * loading asynchronously: DEFER plays it as soon as it's ready, and DROP
+ * ignores the play.
+ */
+enum class PendingPlayPolicy {
+    DEFER,
+    DROP,
+};
+
+/**
+ * Enumeration of the operations the SoundManager queues for the SoundView
+ */
+enum class SoundCommandType {
+    LOAD_SOUND,
+    LOAD_MUSIC,
+    LOAD_SOUND_ASYNC,
+    LOAD_MUSIC_ASYNC,
+    UNLOAD_SOUND,
+    UNLOAD_MUSIC,
+    PLAY_SOUND,
+    PLAY_SOUND_AT,
+    PLAY_MUSIC,
+    PAUSE_MUSIC,
+    RESUME_MUSIC,
+    CROSSFADE_MUSIC,
+    SET_MUSIC_LOOP,
+    SET_MUSIC_BUFFER_SECONDS,
+    SET_SOUND_MAX_INSTANCES,
+    SET_SOUND_PRIORITY,
+    SET_SOUND_ATTENUATION,
+    SET_AUDIBILITY_THRESHOLD,
+};
+
+/**
+ * A sound operation queued by the SoundManager on the game thread, to be
+ * carried out by the SoundView on the view thread.
+ */
+struct SoundCommand
+{
+    SoundCommandType type;
+    SoundHandle sound;
+    MusicHandle music;
+
+    /**
+     * The music faded in, for CROSSFADE_MUSIC, which fades out music
+     */
+    MusicHandle otherMusic;
+
+    /**
+     * The file to load, or for music, the stream to read it from instead if
+     * set, how plays before it's loaded are handled, and the promise to fulfil
+     * once it is, for the load commands
+     */
+    std::string filename;
+    std::shared_ptr<sf::InputStream> inputStream;
+    PendingPlayPolicy policy;
+    std::shared_ptr<std::promise<bool>> loaded;
+
+    /**
+     * The setting's new value, for SET_SOUND_MAX_INSTANCES,
+     * SET_SOUND_PRIORITY and SET_MUSIC_LOOP
+     */
+    int value;
+
+    /**
+     * How long to fade for, for CROSSFADE_MUSIC, or how far ahead to decode,
+     * for SET_MUSIC_BUFFER_SECONDS
+     */
+    float seconds;
+
+    /**
+     * How to play the sound, for PLAY_SOUND and PLAY_SOUND_AT. The gain is
+     * also the threshold for SET_AUDIBILITY_THRESHOLD
+     */
+    float gain;
+    float pan;
+    float pitch;
+
+    /**
+     * Where to play the sound in the world, for PLAY_SOUND_AT
+     */
+    float x;
+    float y;
+
+    /**
+     * The sound's new attenuation, for SET_SOUND_ATTENUATION
+     */
+    SoundAttenuation attenuation;
+
+    /**
+     * When the command was queued, to measure how long it waited
+     */
+    std::chrono::steady_clock::time_point queuedTime;
+};
+
+#endif
@@ -1,11 +1,12 @@
+#include <stdexcept>
 #include "SoundManager.h"
-#include <assert.h>
+
+const unsigned int SoundManager::COMMAND_QUEUE_CAPACITY;
 
 std::shared_ptr<SoundManager> SoundManager::instance = nullptr;
 
-SoundManager::SoundManager()
+SoundManager::SoundManager() : commands(SoundManager::COMMAND_QUEUE_CAPACITY), overflowing(false)
 {
-    this->nextId = 0;
 }
 
 std::shared_ptr<SoundManager> SoundManager::GetInstance()
@@ -19,81 +20,429 @@ std::shared_ptr<SoundManager> SoundManager::GetInstance()
 
 void SoundManager::SetView(std::shared_ptr<SoundView> soundView)
 {
-    this->soundView = soundView;
+    std::atomic_store(&this->soundView, soundView);
 }
 
 bool SoundManager::IsViewSet()
 {
-    return this->soundView != nullptr;
+    return std::atomic_load(&this->soundView) != nullptr;
 }
 
-long SoundManager::LoadSound(std::string filename)
+SoundHandle SoundManager::LoadSound(std::string filename)
 {
-    this->assertSoundView();
-    
-    long id = nextId++;
-    if(!this->soundView->LoadSound(id, filename))
+    return this->loadSound(filename, SoundCommandType::LOAD_SOUND, PendingPlayPolicy::DEFER);
+}
+
+MusicHandle SoundManager::LoadMusic(std::string filename)
+{
+    return this->loadMusic(filename, SoundCommandType::LOAD_MUSIC, PendingPlayPolicy::DEFER);
+}
+
+SoundHandle SoundManager::LoadSoundAsync(std::string filename, PendingPlayPolicy policy)
+{
+    return this->loadSound(filename, SoundCommandType::LOAD_SOUND_ASYNC, policy);
+}
+
+MusicHandle SoundManager::LoadMusicAsync(std::string filename, PendingPlayPolicy policy)
+{
+    return this->loadMusic(filename, SoundCommandType::LOAD_MUSIC_ASYNC, policy);
+}
+
+MusicHandle SoundManager::LoadMusicStream(std::string name, std::shared_ptr<sf::InputStream> stream, PendingPlayPolicy policy)
+{
+    return this->loadMusic(name, SoundCommandType::LOAD_MUSIC_ASYNC, policy, stream);
+}
+
+std::vector<SoundHandle> SoundManager::LoadSoundBankAsync(const std::vector<std::string>& filenames, PendingPlayPolicy policy)
+{
+    // Each load is queued before any is carried out, so the view hands the
+    // whole bank to the workers at once
+    std::vector<SoundHandle> bank;
+    bank.reserve(filenames.size());
+    for(auto it = filenames.begin(); it != filenames.end(); it++)
     {
-        return -1;
+        bank.push_back(this->loadSound(*it, SoundCommandType::LOAD_SOUND_ASYNC, policy));
     }
-    return id;
+    return bank;
 }
 
-long SoundManager::LoadMusic(std::string filename)
+std::shared_future<bool> SoundManager::GetSoundLoad(SoundHandle sound)
 {
-    this->assertSoundView();
-    
-    long id = nextId++;
-    if(!this->soundView->LoadMusic(id, filename))
+    if(!this->sounds.Contains(sound))
     {
-        return -1;
+        return SoundManager::failedLoad();
     }
-    return id;
+    return this->soundLoads[sound.GetIndex()];
 }
 
-void SoundManager::UnloadSound(long id)
+std::shared_future<bool> SoundManager::GetMusicLoad(MusicHandle music)
 {
-    this->assertSoundView();
-    
-    this->soundView->UnloadSound(id);
+    if(!this->music.Contains(music))
+    {
+        return SoundManager::failedLoad();
+    }
+    return this->musicLoads[music.GetIndex()];
 }
 
-void SoundManager::UnloadMusic(long id)
+bool SoundManager::IsSoundLoaded(SoundHandle sound)
 {
-    this->assertSoundView();
-    
-    this->soundView->UnloadMusic(id);
+    return this->sounds.Contains(sound) && SoundManager::isLoaded(this->soundLoads[sound.GetIndex()]);
 }
 
-void SoundManager::PlaySound(long id)
+bool SoundManager::IsMusicLoaded(MusicHandle music)
 {
-    this->assertSoundView();
+    return this->music.Contains(music) && SoundManager::isLoaded(this->musicLoads[music.GetIndex()]);
+}
+
+SoundHandle SoundManager::FindSound(std::string filename)
+{
+    auto sound = this->soundsByName.find(filename);
+    return sound == this->soundsByName.end() ? SoundHandle() : sound->second;
+}
+
+MusicHandle SoundManager::FindMusic(std::string filename)
+{
+    auto music = this->musicByName.find(filename);
+    return music == this->musicByName.end() ? MusicHandle() : music->second;
+}
+
+void SoundManager::UnloadSound(SoundHandle sound)
+{
+    std::string* filename = this->sounds.Get(sound);
+    if(filename == nullptr)
+    {
+        return;
+    }
+    auto byName = this->soundsByName.find(*filename);
+    if(byName != this->soundsByName.end() && byName->second == sound)
+    {
+        this->soundsByName.erase(byName);
+    }
+    this->sounds.Remove(sound);
+    this->soundLoads[sound.GetIndex()] = std::shared_future<bool>();
     
-    this->soundView->PlaySound(id);
+    SoundCommand command;
+    command.type = SoundCommandType::UNLOAD_SOUND;
+    command.sound = sound;
+    this->queueCommand(command);
 }
 
-void SoundManager::PlayMusic(long id)
+void SoundManager::UnloadMusic(MusicHandle music)
 {
-    this->assertSoundView();
+    std::string* filename = this->music.Get(music);
+    if(filename == nullptr)
+    {
+        return;
+    }
+    auto byName = this->musicByName.find(*filename);
+    if(byName != this->musicByName.end() && byName->second == music)
+    {
+        this->musicByName.erase(byName);
+    }
+    this->music.Remove(music);
+    this->musicLoads[music.GetIndex()] = std::shared_future<bool>();
     
-    this->soundView->PlayMusic(id);
+    SoundCommand command;
+    command.type = SoundCommandType::UNLOAD_MUSIC;
+    command.music = music;
+    this->queueCommand(command);
+}
+
+void SoundManager::PlaySound(SoundHandle sound, float gain, float pan, float pitch)
+{
+    SoundManager::validatePitch(pitch);
+    if(this->sounds.Contains(sound))
+    {
+        SoundCommand command;
+        command.type = SoundCommandType::PLAY_SOUND;
+        command.sound = sound;
+        command.gain = gain;
+        command.pan = pan;
+        command.pitch = pitch;
+        this->queueCommand(command);
+    }
 }
 
-void SoundManager::PauseMusic(long id)
+void SoundManager::PlaySoundAt(SoundHandle sound, float x, float y, float gain, float pitch)
 {
-    this->assertSoundView();
+    SoundManager::validatePitch(pitch);
+    if(this->sounds.Contains(sound))
+    {
+        SoundCommand command;
+        command.type = SoundCommandType::PLAY_SOUND_AT;
+        command.sound = sound;
+        command.x = x;
+        command.y = y;
+        command.gain = gain;
+        command.pitch = pitch;
+        this->queueCommand(command);
+    }
+}
+
+void SoundManager::SetSoundAttenuation(SoundHandle sound, const SoundAttenuation& attenuation)
+{
+    if(this->sounds.Contains(sound))
+    {
+        SoundCommand command;
+        command.type = SoundCommandType::SET_SOUND_ATTENUATION;
+        command.sound = sound;
+        command.attenuation = attenuation;
+        this->queueCommand(command);
+    }
+}
+
+void SoundManager::SetAudibilityThreshold(float threshold)
+{
+    SoundCommand command;
+    command.type = SoundCommandType::SET_AUDIBILITY_THRESHOLD;
+    command.gain = threshold;
+    this->queueCommand(command);
+}
+
+void SoundManager::SetSoundMaxInstances(SoundHandle sound, unsigned int maxInstances)
+{
+    if(this->sounds.Contains(sound))
+    {
+        SoundCommand command;
+        command.type = SoundCommandType::SET_SOUND_MAX_INSTANCES;
+        command.sound = sound;
+        command.value = (int)maxInstances;
+        this->queueCommand(command);
+    }
+}
+
+void SoundManager::SetSoundPriority(SoundHandle sound, int priority)
+{
+    if(this->sounds.Contains(sound))
+    {
+        SoundCommand command;
+        command.type = SoundCommandType::SET_SOUND_PRIORITY;
+        command.sound = sound;
+        command.value = priority;
+        this->queueCommand(command);
+    }
+}
+
+VoicePool::Stats SoundManager::GetVoiceStats()
+{
+    std::shared_ptr<SoundView> view = std::atomic_load(&this->soundView);
+    if(view == nullptr)
+    {
+        VoicePool::Stats stats = VoicePool::Stats();
+        return stats;
+    }
+    return view->GetVoiceStats();
+}
+
+void SoundManager::PlayMusic(MusicHandle music)
+{
+    if(this->music.Contains(music))
+    {
+        SoundCommand command;
+        command.type = SoundCommandType::PLAY_MUSIC;
+        command.music = music;
+        this->queueCommand(command);
+    }
+}
+
+void SoundManager::PauseMusic(MusicHandle music)
+{
+    if(this->music.Contains(music))
+    {
+        SoundCommand command;
+        command.type = SoundCommandType::PAUSE_MUSIC;
+        command.music = music;
+        this->queueCommand(command);
+    }
+}
+
+void SoundManager::ResumeMusic(MusicHandle music)
+{
+    if(this->music.Contains(music))
+    {
+        SoundCommand command;
+        command.type = SoundCommandType::RESUME_MUSIC;
+        command.music = music;
+        this->queueCommand(command);
+    }
+}
+
+void SoundManager::CrossfadeMusic(MusicHandle from, MusicHandle to, float seconds)
+{
+    if(this->music.Contains(from) || this->music.Contains(to))
+    {
+        // An unknown handle's slot may have been reused, so it's passed on as null
+        SoundCommand command;
+        command.type = SoundCommandType::CROSSFADE_MUSIC;
+        command.music = this->music.Contains(from) ? from : MusicHandle();
+        command.otherMusic = this->music.Contains(to) ? to : MusicHandle();
+        command.seconds = seconds;
+        this->queueCommand(command);
+    }
+}
+
+void SoundManager::SetMusicLoop(MusicHandle music, bool loop)
+{
+    if(this->music.Contains(music))
+    {
+        SoundCommand command;
+        command.type = SoundCommandType::SET_MUSIC_LOOP;
+        command.music = music;
+        command.value = loop ? 1 : 0;
+        this->queueCommand(command);
+    }
+}
+
+void SoundManager::SetMusicBufferSeconds(float seconds)
+{
+    SoundCommand command;
+    command.type = SoundCommandType::SET_MUSIC_BUFFER_SECONDS;
+    command.seconds = seconds;
+    this->queueCommand(command);
+}
+
+MusicStream::Stats SoundManager::GetMusicStats()
+{
+    std::shared_ptr<SoundView> view = std::atomic_load(&this->soundView);
+    if(view == nullptr)
+    {
+        MusicStream::Stats stats = MusicStream::Stats();
+        return stats;
+    }
+    return view->GetMusicStats();
+}
+
+SoundManager::CommandStats SoundManager::GetCommandStats()
+{
+    CommandStats stats;
+    stats.queueDepth = this->commands.GetSize();
+    stats.maxQueueDepth = this->commandStats.GetMaxDepth();
+    stats.queueCapacity = this->commands.GetCapacity();
+    stats.commandCount = this->commandStats.GetTakenCount();
+    stats.fullQueueCount = this->commandStats.GetFullCount();
+    stats.droppedCount = this->commandStats.GetDroppedCount();
+    stats.averageLatencyMilliseconds = this->commandStats.GetAverageLatencyMilliseconds();
+    stats.maxLatencyMilliseconds = this->commandStats.GetMaxLatencyMilliseconds();
+    return stats;
+}
+
+bool SoundManager::TakeCommand(SoundCommand& command)
+{
+    // Nothing is pushed onto the ring while commands overflow, so the ring
+    // always holds the older ones
+    if(this->commands.TryPop(command))
+    {
+        return true;
+    }
+    if(!this->overflowing.load())
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(this->overflowMutex);
+    if(this->overflow.empty())
+    {
+        return false;
+    }
+    command = std::move(this->overflow.front());
+    this->overflow.pop_front();
+    if(this->overflow.empty())
+    {
+        this->overflowing.store(false);
+    }
+    return true;
+}
+
+void SoundManager::RecordCommandLatency(double milliseconds)
+{
+    this->commandStats.RecordLatency(milliseconds);
+}
+
+SoundHandle SoundManager::loadSound(const std::string& filename, SoundCommandType type, PendingPlayPolicy policy)
+{
+    SoundHandle sound = this->sounds.Insert(filename);
+    this->soundsByName[filename] = sound;
     
-    this->soundView->PauseMusic(id);
+    SoundCommand command;
+    command.type = type;
+    command.sound = sound;
+    command.filename = filename;
+    command.policy = policy;
+    command.loaded = std::make_shared<std::promise<bool>>();
+    if(sound.GetIndex() >= this->soundLoads.size())
+    {
+        this->soundLoads.resize(sound.GetIndex() + 1);
+    }
+    this->soundLoads[sound.GetIndex()] = command.loaded->get_future().share();
+    this->queueCommand(command);
+    return sound;
 }
 
-void SoundManager::ResumeMusic(long id)
+MusicHandle SoundManager::loadMusic(const std::string& filename, SoundCommandType type, PendingPlayPolicy policy,
+                                    std::shared_ptr<sf::InputStream> inputStream)
 {
-    this->assertSoundView();
+    MusicHandle music = this->music.Insert(filename);
+    this->musicByName[filename] = music;
     
-    this->soundView->ResumeMusic(id);
+    SoundCommand command;
+    command.type = type;
+    command.music = music;
+    command.filename = filename;
+    command.inputStream = inputStream;
+    command.policy = policy;
+    command.loaded = std::make_shared<std::promise<bool>>();
+    if(music.GetIndex() >= this->musicLoads.size())
+    {
+        this->musicLoads.resize(music.GetIndex() + 1);
+    }
+    this->musicLoads[music.GetIndex()] = command.loaded->get_future().share();
+    this->queueCommand(command);
+    return music;
 }
 
-void SoundManager::assertSoundView()
+bool SoundManager::isLoaded(const std::shared_future<bool>& load)
 {
-    assert(this->soundView != nullptr && "SoundManager method called before it's SoundView was set.");
+    return load.wait_for(std::chrono::seconds(0)) == std::future_status::ready && load.get();
+}
+
+std::shared_future<bool> SoundManager::failedLoad()
+{
+    std::promise<bool> load;
+    load.set_value(false);
+    return load.get_future().share();
+}
+
+void SoundManager::validatePitch(float pitch)
+{
+    if(!(pitch > 0.0f))
+    {
+        throw new std::invalid_argument("SoundManager was given a pitch less than or equal to zero.");
+    }
+}
+
+void SoundManager::queueCommand(SoundCommand& command)
+{
+    command.queuedTime = std::chrono::steady_clock::now();
+    if(this->overflowing.load() || !this->commands.TryPush(std::move(command)))
+    {
+        this->commandStats.RecordFull();
+        // Later commands may depend on anything but a play, such as an
+        // unload that frees its samples, so only plays are dropped. Nothing
+        // takes commands without a view, such as when running headless or
+        // once the view thread has exited, so then everything is.
+        bool droppable = command.type == SoundCommandType::PLAY_SOUND || command.type == SoundCommandType::PLAY_SOUND_AT;
+        if(droppable || !this->IsViewSet())
+        {
+            this->commandStats.RecordDropped();
+            if(command.loaded != nullptr)
+            {
+                command.loaded->set_value(false);
+            }
+            return;
+        }
+        std::lock_guard<std::mutex> lock(this->overflowMutex);
+        this->overflow.push_back(std::move(command));
+        this->overflowing.store(true);
+        return;
+    }
+    this->commandStats.RecordPush(this->commands.GetSize());
 }
@@ -3,7 +3,19 @@
 
 #include <string>
 #include <memory>
+#include <unordered_map>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <mutex>
+#include <future>
 #include "SoundView.h"
+#include "VoicePool.h"
+#include "MusicStream.h"
+#include "ResourceHandles.h"
+#include "SoundCommand.h"
+#include "SpscQueue.h"
+#include "QueueStats.h"
 
 class SoundView;
 
@@ -11,11 +23,46 @@ class SoundView;
  * Manages all sound effects and music for the engine.
  *
  * Use: Load a sound or music file in the manager calling the load methods, then you can call play on it
- * using the returned ID. When the sound effect or music will not be used again call the corresponding unload method.
+ * using the returned handle. When the sound effect or music will not be used again call the corresponding unload method.
+ *
+ * Handles to unloaded sounds and music are ignored, even if the handle's slot has since been reused.
+ *
+ * LoadSound and LoadMusic read the file on the view thread, stalling its frame for large files. The async
+ * variants read them on worker threads instead, loading many files in parallel; such a handle only becomes
+ * playable once its load has finished, which GetSoundLoad and GetMusicLoad report.
+ *
+ * Music is decoded ahead of playback on worker threads, from a mounted asset pack if one has the file, so
+ * reading it never holds up the mix. LoadMusicStream plays music from any other sf::InputStream the same way.
+ *
+ * Every method should be called from the game thread. Nothing is done there: handles are allocated right
+ * away and each operation is queued for the SoundView, which carries it out on the view thread at the start
+ * of its next update. The queue is a bounded lock-free ring and calls never wait on it. If it ever fills up,
+ * plays are dropped, since a late sound effect is worse than a missing one, while everything else waits in
+ * order behind the ring until the view thread takes it.
  */
 class SoundManager
 {
 public:
+    /**
+     * Statistics about the queue of commands waiting for the SoundView.
+     */
+    struct CommandStats
+    {
+        unsigned int queueDepth;
+        unsigned int maxQueueDepth;
+        unsigned int queueCapacity;
+        unsigned long long commandCount;
+        unsigned long long fullQueueCount;
+        unsigned long long droppedCount;
+        double averageLatencyMilliseconds;
+        double maxLatencyMilliseconds;
+    };
+
+    /**
+     * The most commands that can wait for the SoundView at once.
+     */
+    static const unsigned int COMMAND_QUEUE_CAPACITY = 1024;
+
     /**
      * Should NEVER be used. Only public because make_shared requires it.
      */
@@ -26,7 +73,8 @@ public:
     static std::shared_ptr<SoundManager> GetInstance();
     
     /**
-     * Sets the view for this manager to use
+     * Sets the view for this manager to use, or detaches it if null, such as when the view thread exits.
+     * Commands queued while no view is set are dropped once the queue is full.
      */
     void SetView(std::shared_ptr<SoundView> soundView);
     
@@ -36,45 +84,201 @@ public:
     bool IsViewSet();
     
     /**
-     * Loads the sound resource, returning the ID to use to manipulate it, or -1 if the load failed.
+     * Loads the sound resource, returning the handle to use to manipulate it. Returns immediately; the
+     * file is loaded on the view thread, and if it can't be, the handle plays nothing.
      */
-    long LoadSound(std::string filename);
+    SoundHandle LoadSound(std::string filename);
     
     /**
-     * Loads the music resource, returning the ID to use to manipulate it, or -1 if the load failed.
+     * Loads the music resource, returning the handle to use to manipulate it. Returns immediately; the
+     * file is opened on the view thread, and if it can't be, the handle plays nothing.
      */
-    long LoadMusic(std::string filename);
+    MusicHandle LoadMusic(std::string filename);
+
+    /**
+     * Loads the sound resource on a worker thread, returning the handle to use to manipulate it. Plays
+     * before it has loaded are deferred or dropped according to the given policy.
+     */
+    SoundHandle LoadSoundAsync(std::string filename, PendingPlayPolicy policy = PendingPlayPolicy::DEFER);
+
+    /**
+     * Opens the music resource on a worker thread, returning the handle to use to manipulate it. Plays
+     * before it has opened are deferred or dropped according to the given policy.
+     */
+    MusicHandle LoadMusicAsync(std::string filename, PendingPlayPolicy policy = PendingPlayPolicy::DEFER);
+
+    /**
+     * Opens music read from the given stream on a worker thread, returning the handle to use to manipulate
+     * it. The name is only used to find the music again and in errors. The stream is kept until the music
+     * is unloaded, and is only read from one thread at a time.
+     */
+    MusicHandle LoadMusicStream(std::string name, std::shared_ptr<sf::InputStream> stream,
+                                PendingPlayPolicy policy = PendingPlayPolicy::DEFER);
+
+    /**
+     * Loads a bank of sounds on worker threads, each file in parallel with the others, returning their
+     * handles in the same order as the file names.
+     */
+    std::vector<SoundHandle> LoadSoundBankAsync(const std::vector<std::string>& filenames,
+                                                PendingPlayPolicy policy = PendingPlayPolicy::DEFER);
+
+    /**
+     * Obtains a future that becomes ready once the given sound has finished loading, holding whether it
+     * loaded. Unknown handles get a future that is already ready and false.
+     */
+    std::shared_future<bool> GetSoundLoad(SoundHandle sound);
+
+    /**
+     * Obtains a future that becomes ready once the given music has finished opening, holding whether it
+     * opened. Unknown handles get a future that is already ready and false.
+     */
+    std::shared_future<bool> GetMusicLoad(MusicHandle music);
+
+    /**
+     * Returns whether the given sound has finished loading successfully, without waiting.
+     */
+    bool IsSoundLoaded(SoundHandle sound);
+
+    /**
+     * Returns whether the given music has finished opening successfully, without waiting.
+     */
+    bool IsMusicLoaded(MusicHandle music);
     
     /**
-     * Unloads the sound mapped to the given id
+     * Obtains the handle of the sound most recently loaded from the given file, or a null handle.
      */
-    void UnloadSound(long id);
+    SoundHandle FindSound(std::string filename);
     
     /**
-     * Unloads the music mapped to the given id
+     * Obtains the handle of the music most recently loaded from the given file, or a null handle.
      */
-    void UnloadMusic(long id);
+    MusicHandle FindMusic(std::string filename);
     
     /**
-     * Plays the sound that the given ID is mapped to
+     * Unloads the given sound
      */
-    void PlaySound(long id);
+    void UnloadSound(SoundHandle sound);
     
     /**
-     * Plays the music the given ID is mapped to
+     * Unloads the given music
      */
-    void PlayMusic(long id);
+    void UnloadMusic(MusicHandle music);
     
     /**
-     * Resumes the music the given ID is mapped to
+     * Plays the given sound. A sound can overlap itself, up to its maximum number of
+     * instances, after which its oldest instance is restarted. If every voice is busy,
+     * the lowest priority, oldest voice is taken over; if they all have a higher
+     * priority than the sound, the play is dropped.
+     *
+     * The gain scales the sound's volume, the pan places it between -1 (left) and
+     * 1 (right), and the pitch changes its speed, 2 being an octave up.
+     *
+     * Throws an invalid_argument if the pitch is less than or equal to zero.
+     */
+    void PlaySound(SoundHandle sound, float gain = 1.0f, float pan = 0.0f, float pitch = 1.0f);
+
+    /**
+     * Plays the given sound at the given position in the world. Its volume falls off with its distance
+     * from the camera's center according to the sound's attenuation, and it is panned by how far left or
+     * right of the center it is, following the camera as it moves.
+     *
+     * While it's too quiet to hear it is virtualized, costing no voice or mixing time, and it resumes
+     * where it would have been if it comes back into earshot before it would have finished.
+     *
+     * Throws an invalid_argument if the pitch is less than or equal to zero.
+     */
+    void PlaySoundAt(SoundHandle sound, float x, float y, float gain = 1.0f, float pitch = 1.0f);
+
+    /**
+     * Sets how the given sound's volume falls off with distance when played at a position. Defaults to
+     * SoundSpatializer::DEFAULT_ATTENUATION, which is in world units and likely needs to suit the game.
      */
-    void ResumeMusic(long id);
+    void SetSoundAttenuation(SoundHandle sound, const SoundAttenuation& attenuation);
+
+    /**
+     * Sets the gain below which positional sounds are virtualized.
+     */
+    void SetAudibilityThreshold(float threshold);
+
+    /**
+     * Sets how many instances of the given sound may play at once, 0 for no limit.
+     * Defaults to SoundView::DEFAULT_MAX_INSTANCES.
+     */
+    void SetSoundMaxInstances(SoundHandle sound, unsigned int maxInstances);
+
+    /**
+     * Sets the given sound's priority, 0 by default. Higher priority sounds take
+     * voices from lower priority ones when every voice is busy.
+     */
+    void SetSoundPriority(SoundHandle sound, int priority);
+
+    /**
+     * Obtains how many voices are in use, and how many plays have stolen a voice or
+     * been dropped.
+     */
+    VoicePool::Stats GetVoiceStats();
     
     /**
-     * Pauses the music the given ID is mapped to
+     * Plays the given music
      */
-    void PauseMusic(long id);
+    void PlayMusic(MusicHandle music);
     
+    /**
+     * Resumes the given music
+     */
+    void ResumeMusic(MusicHandle music);
+    
+    /**
+     * Pauses the given music
+     */
+    void PauseMusic(MusicHandle music);
+
+    /**
+     * Fades the first music out over the given number of seconds, pausing it once silent, while fading
+     * the second in, both in step so there is no gap between them. The second music starts over if it had
+     * played to the end, and otherwise continues from where it was paused.
+     */
+    void CrossfadeMusic(MusicHandle from, MusicHandle to, float seconds);
+
+    /**
+     * Sets whether the given music starts over once it ends, without a gap. Music doesn't loop by default.
+     */
+    void SetMusicLoop(MusicHandle music, bool loop);
+
+    /**
+     * Sets how many seconds of music are decoded ahead of playback, for music loaded from now on. Larger
+     * buffers ride out longer disk stalls at the cost of memory. Defaults to
+     * MusicStream::DEFAULT_BUFFER_SECONDS.
+     */
+    void SetMusicBufferSeconds(float seconds);
+
+    /**
+     * Obtains how often music ran out of decoded frames, playing silence instead, and how much was decoded.
+     */
+    MusicStream::Stats GetMusicStats();
+
+    /**
+     * Obtains how many commands are waiting for the SoundView, how many have been carried out, and how
+     * long they waited in the queue.
+     */
+    CommandStats GetCommandStats();
+
+    /**
+     * Takes the oldest queued command, returning false if there are none. Should only be called by the
+     * SoundView, on the view thread.
+     *
+     * Typically this function isn't needed outside the game engine's
+     * core sound system, and thus it shouldn't be needed by users.
+     */
+    bool TakeCommand(SoundCommand& command);
+
+    /**
+     * Records that a command was carried out after waiting the given number of milliseconds.
+     *
+     * Typically this function isn't needed outside the game engine's
+     * core sound system, and thus it shouldn't be needed by users.
+     */
+    void RecordCommandLatency(double milliseconds);
     
 private:
     // Private constructors to disallow access.
@@ -82,12 +286,25 @@ private:
     SoundManager operator=(SoundManager other);
     
     /**
-     * The ID to use for the next sound/music
+     * The file name of every loaded sound and music, by handle
+     */
+    HandleTable<std::string, SoundTag> sounds;
+    HandleTable<std::string, MusicTag> music;
+    
+    /**
+     * Handles by file name, so names are only hashed when loading
      */
-    long nextId;
+    std::unordered_map<std::string, SoundHandle> soundsByName;
+    std::unordered_map<std::string, MusicHandle> musicByName;
+
+    /**
+     * The load of every sound and music, indexed by the slot of their handle
+     */
+    std::vector<std::shared_future<bool>> soundLoads;
+    std::vector<std::shared_future<bool>> musicLoads;
     
     /**
-     * The SoundView to use to play sounds/music
+     * The SoundView carrying out commands. Set from the view thread, so only accessed atomically
      */
     std::shared_ptr<SoundView> soundView;
     
@@ -97,9 +314,51 @@ private:
     static std::shared_ptr<SoundManager> instance;
     
     /**
-     * Asserts that the SoundView has been set
+     * Allocates a sound or music handle and queues the given kind of load for it
+     */
+    SoundHandle loadSound(const std::string& filename, SoundCommandType type, PendingPlayPolicy policy);
+    MusicHandle loadMusic(const std::string& filename, SoundCommandType type, PendingPlayPolicy policy,
+                          std::shared_ptr<sf::InputStream> inputStream = nullptr);
+
+    /**
+     * Obtains whether the given load has finished successfully, without waiting
+     */
+    static bool isLoaded(const std::shared_future<bool>& load);
+
+    /**
+     * Obtains a load that has already failed, for unknown handles
+     */
+    static std::shared_future<bool> failedLoad();
+
+    /**
+     * Throws an invalid_argument if the given pitch is less than or equal to zero, or isn't a number
+     */
+    static void validatePitch(float pitch);
+
+    /**
+     * Stamps the given command and queues it. If the queue is full, drops plays, and any command while no view
+     * is set to take it, failing its load if it has one; other commands overflow
+     */
+    void queueCommand(SoundCommand& command);
+
+    /**
+     * Commands from the game thread to the view thread
+     */
+    SpscQueue<SoundCommand> commands;
+
+    /**
+     * Commands that found the queue full but can't be dropped, in order. While any are waiting, later commands
+     * wait behind them rather than overtaking them through the ring. The view thread takes from here once the
+     * ring is empty, so it's guarded by overflowMutex, and overflowing says whether there's anything in it
+     */
+    std::deque<SoundCommand> overflow;
+    std::mutex overflowMutex;
+    std::atomic<bool> overflowing;
+
+    /**
+     * Queue statistics. Latencies are only written by the view thread
      */
-    void assertSoundView();
+    QueueStats commandStats;
 };
 
 #endif
@@ -1,16 +1,28 @@
 #include <stdexcept>
+#include <cmath>
 #include "Sprite.h"
+#include "ResourceManager.h"
 
-Sprite::Sprite(float x, float y, float width, float height, Color color) : x(x), y(y), width(width), height(height), color(color)
+const float Sprite::MAX_DEPTH = 1000.0f;
+
+Sprite::Sprite(float x, float y, float width, float height, Color color) : x(x), y(y), width(width), height(height), color(color), rotation(0.0f), scaleX(1.0f), scaleY(1.0f), pivotX(0.0f), pivotY(0.0f), depth(0.0f), opaque(false), node(SceneGraph::NO_NODE), rotationSine(0.0f), rotationCosine(1.0f)
 {
     this->validateDimensions();
 }
 
-Sprite::Sprite(float width, float height, Color color) : x(0.0f), y(0.0f), width(width), height(height), color(color)
+Sprite::Sprite(float width, float height, Color color) : x(0.0f), y(0.0f), width(width), height(height), color(color), rotation(0.0f), scaleX(1.0f), scaleY(1.0f), pivotX(0.0f), pivotY(0.0f), depth(0.0f), opaque(false), node(SceneGraph::NO_NODE), rotationSine(0.0f), rotationCosine(1.0f)
 {
     this->validateDimensions();
 }
 
+Sprite::~Sprite()
+{
+    if (this->resourceManager != nullptr)
+    {
+        this->resourceManager->RemoveTextureReference(this->texture);
+    }
+}
+
 void Sprite::MoveTo(float x, float y)
 {
     this->x = x;
@@ -47,6 +59,79 @@ void Sprite::ChangeColor(Color color)
     this->color = color;
 }
 
+void Sprite::SetRotation(float rotation)
+{
+    this->rotation = rotation;
+    this->rotationSine = std::sin(rotation);
+    this->rotationCosine = std::cos(rotation);
+}
+
+void Sprite::SetDepth(float depth)
+{
+    if (!(depth >= 0.0f && depth <= MAX_DEPTH))
+    {
+        throw new std::invalid_argument("Sprite was given a depth outside of 0 to MAX_DEPTH.");
+    }
+    this->depth = depth;
+}
+
+void Sprite::SetOpaque(bool opaque)
+{
+    this->opaque = opaque;
+}
+
+void Sprite::SetTexture(TextureHandle texture)
+{
+    if (texture == this->texture)
+    {
+        return;
+    }
+    if (this->resourceManager == nullptr)
+    {
+        this->resourceManager = ResourceManager::GetInstance();
+    }
+    this->resourceManager->RemoveTextureReference(this->texture);
+    this->resourceManager->AddTextureReference(texture);
+    this->texture = texture;
+}
+
+TextureHandle Sprite::GetTexture()
+{
+    return this->texture;
+}
+
+void Sprite::RotateBy(float rotation)
+{
+    this->SetRotation(this->rotation + rotation);
+}
+
+void Sprite::SetScale(float scaleX, float scaleY)
+{
+    this->scaleX = scaleX;
+    this->scaleY = scaleY;
+}
+
+void Sprite::SetPivot(float pivotX, float pivotY)
+{
+    this->pivotX = pivotX;
+    this->pivotY = pivotY;
+}
+
+void Sprite::AttachToNode(SceneGraph::NodeID node)
+{
+    this->node = node;
+}
+
+void Sprite::DetachFromNode()
+{
+    this->node = SceneGraph::NO_NODE;
+}
+
+SceneGraph::NodeID Sprite::GetNode()
+{
+    return this->node;
+}
+
 float Sprite::GetX()
 {
     return this->x;
@@ -72,6 +157,46 @@ Color Sprite::GetColor()
     return this->color;
 }
 
+float Sprite::GetDepth()
+{
+    return this->depth;
+}
+
+bool Sprite::IsOpaque()
+{
+    // Textures may have transparent pixels, so textured sprites are only
+    // opaque if they've been marked so.
+    return this->color.alpha >= 1.0f && (this->texture.IsNull() || this->opaque);
+}
+
+float Sprite::GetRotation()
+{
+    return this->rotation;
+}
+
+float Sprite::GetScaleX()
+{
+    return this->scaleX;
+}
+
+float Sprite::GetScaleY()
+{
+    return this->scaleY;
+}
+
+AffineTransform Sprite::GetLocalTransform()
+{
+    // Rotate and scale about the pivot, which sits at (pivotX, -pivotY) in
+    // the sprite's own space, then move the pivot to where it would be if
+    // the sprite weren't rotated or scaled.
+    AffineTransform transform = AffineTransform::FromTranslationSinCosScale(0.0f, 0.0f, this->rotationSine, this->rotationCosine, this->scaleX, this->scaleY);
+    float pivotX = this->pivotX;
+    float pivotY = -this->pivotY;
+    transform.tx = this->x + pivotX - transform.TransformX(pivotX, pivotY);
+    transform.ty = this->y + pivotY - transform.TransformY(pivotX, pivotY);
+    return transform;
+}
+
 void Sprite::validateDimensions()
 {
     if (this->width < 0)
@@ -86,32 +211,55 @@ void Sprite::validateDimensions()
 
 void Sprite::PutGLVertexInfo(float* vertexBuffer)
 {
-    float left = x;
-    float right = x + width;
-    float top = y;
-    float bottom = y - height;
+    this->PutGLVertexInfo(vertexBuffer, AffineTransform());
+}
+
+void Sprite::PutGLVertexInfo(float* vertexBuffer, const AffineTransform& nodeTransform)
+{
+    AffineTransform transform = AffineTransform::Multiply(nodeTransform, this->GetLocalTransform());
+    float left = 0.0f;
+    float right = width;
+    float top = 0.0f;
+    float bottom = -height;
     // Top/Left
-    vertexBuffer[0] = left;
-    vertexBuffer[1] = top;
-    vertexBuffer[2] = 0.0f;
+    vertexBuffer[0] = transform.TransformX(left, top);
+    vertexBuffer[1] = transform.TransformY(left, top);
+    vertexBuffer[2] = -this->depth;
     vertexBuffer[3] = 1.0f;
     // Top/Right
-    vertexBuffer[4] = right;
-    vertexBuffer[5] = top;
-    vertexBuffer[6] = 0.0f;
+    vertexBuffer[4] = transform.TransformX(right, top);
+    vertexBuffer[5] = transform.TransformY(right, top);
+    vertexBuffer[6] = -this->depth;
     vertexBuffer[7] = 1.0f;
     // Bottom/Right
-    vertexBuffer[8] = right;
-    vertexBuffer[9] = bottom;
-    vertexBuffer[10] = 0.0f;
+    vertexBuffer[8] = transform.TransformX(right, bottom);
+    vertexBuffer[9] = transform.TransformY(right, bottom);
+    vertexBuffer[10] = -this->depth;
     vertexBuffer[11] = 1.0f;
     // Bottom/Left
-    vertexBuffer[12] = left;
-    vertexBuffer[13] = bottom;
-    vertexBuffer[14] = 0.0f;
+    vertexBuffer[12] = transform.TransformX(left, bottom);
+    vertexBuffer[13] = transform.TransformY(left, bottom);
+    vertexBuffer[14] = -this->depth;
     vertexBuffer[15] = 1.0f;
 }
 
+void Sprite::PutGLTexCoordInfo(float* texCoordBuffer)
+{
+    // Textures are stored bottom-up, so the top of the sprite is at v = 1
+    // Top/Left
+    texCoordBuffer[0] = 0.0f;
+    texCoordBuffer[1] = 1.0f;
+    // Top/Right
+    texCoordBuffer[2] = 1.0f;
+    texCoordBuffer[3] = 1.0f;
+    // Bottom/Right
+    texCoordBuffer[4] = 1.0f;
+    texCoordBuffer[5] = 0.0f;
+    // Bottom/Left
+    texCoordBuffer[6] = 0.0f;
+    texCoordBuffer[7] = 0.0f;
+}
+
 void Sprite::PutGLColorInfo(float* colorBuffer)
 {
     float red = this->color.red;
@@ -2,19 +2,44 @@
 #define Core_Sprite_h
 
 #include <assert.h>
+#include <memory>
 #include "Color.h"
+#include "SceneGraph.h"
+#include "AffineTransform.h"
+#include "ResourceHandles.h"
+
+class ResourceManager;
 
 /**
  * Sprites are a 2D rectangle that can be drawn on the scren.
- * They have a position, width, height, and a color.  In the
- * future, support for texturing and more advanced
- * transformations such as rotation will be added.
+ * They have a position, width, height, and a color, and can be
+ * rotated and scaled about a pivot point.  A sprite may also be
+ * textured with a texture loaded by the ResourceManager, which is
+ * stretched over the whole sprite and tinted by its color.
+ *
+ * The position is the top-left corner of the sprite before it
+ * is rotated or scaled.
+ *
+ * A sprite may be attached to a node of the GraphicsManager's SceneGraph,
+ * in which case its position is relative to that node and it follows the
+ * node's translation, rotation, and scale.
  *
- * The position is the top-left corner of the sprite.
+ * Each sprite also has a depth, which decides which sprites are drawn in
+ * front of others. A sprite whose color is fully opaque hides everything
+ * behind it if it's untextured, or if its texture has no transparent pixels
+ * and it's marked with SetOpaque. The graphics view draws those
+ * front-to-back and skips the hidden pixels; translucent sprites are
+ * blended back-to-front.
  */
 class Sprite
 {
 public:
+    /**
+     * The largest depth a sprite can have, matching the far plane of the
+     * graphics view's projection.
+     */
+    static const float MAX_DEPTH;
+
     /**
      * Basic constructor for the sprite class
      *
@@ -29,6 +54,11 @@ public:
      */
     Sprite(float width, float height, Color color);
 
+    /**
+     * Destructor, releasing the sprite's texture.
+     */
+    ~Sprite();
+
     /**
      * Moves the sprite to the given location
      */
@@ -66,6 +96,82 @@ public:
      */
     void ChangeColor(Color color);
 
+    /**
+     * Sets the counter-clockwise rotation of the sprite about its pivot,
+     * in radians.
+     */
+    void SetRotation(float rotation);
+
+    /**
+     * Rotates the sprite counter-clockwise about its pivot by the given
+     * amount, in radians.
+     */
+    void RotateBy(float rotation);
+
+    /**
+     * Sets the scale of the sprite about its pivot.
+     */
+    void SetScale(float scaleX, float scaleY);
+
+    /**
+     * Sets the point the sprite rotates and scales about, as an offset
+     * right and down from its top-left corner. Defaults to (0, 0), the
+     * top-left corner itself; use (width / 2, height / 2) for the center.
+     */
+    void SetPivot(float pivotX, float pivotY);
+
+    /**
+     * Sets the depth of the sprite, from 0 (nearest, the default) to
+     * MAX_DEPTH (farthest). Sprites with a smaller depth are drawn in front
+     * of those with a larger one; sprites at the same depth overlap in no
+     * particular order.
+     *
+     * Throws an invalid_argument if the depth is outside that range.
+     */
+    void SetDepth(float depth);
+
+    /**
+     * Sets whether the sprite's texture has no transparent pixels, so that,
+     * when its color is fully opaque too, it's drawn without blending and
+     * hides what's behind it. Transparent pixels of a texture marked opaque
+     * are drawn as they are, so only mark textures known to have none, such
+     * as ones the TextureCooker wrote as DXT1. Textured sprites aren't
+     * marked opaque unless this is called.
+     */
+    void SetOpaque(bool opaque);
+
+    /**
+     * Textures the sprite with the given texture from the ResourceManager,
+     * or removes its texture if given a null handle. While the texture is
+     * still loading the sprite is drawn untextured.
+     *
+     * A texture used by a sprite is never evicted from video memory.
+     */
+    void SetTexture(TextureHandle texture);
+
+    /**
+     * Obtains the sprite's texture, or a null handle if it isn't textured.
+     */
+    TextureHandle GetTexture();
+
+    /**
+     * Attaches the sprite to the given node of the GraphicsManager's scene
+     * graph, making its position relative to that node.
+     */
+    void AttachToNode(SceneGraph::NodeID node);
+
+    /**
+     * Detaches the sprite from its scene graph node, making its position
+     * absolute again.
+     */
+    void DetachFromNode();
+
+    /**
+     * Obtains the scene graph node the sprite is attached to, or
+     * SceneGraph::NO_NODE if it isn't attached.
+     */
+    SceneGraph::NodeID GetNode();
+
     /**
      * Obtains x
      */
@@ -91,6 +197,38 @@ public:
      */
     Color GetColor();
 
+    /**
+     * Obtains the sprite's depth
+     */
+    float GetDepth();
+
+    /**
+     * Obtains whether the sprite completely hides whatever is behind it.
+     */
+    bool IsOpaque();
+
+    /**
+     * Obtains the sprite's rotation in radians
+     */
+    float GetRotation();
+
+    /**
+     * Obtains the sprite's horizontal scale
+     */
+    float GetScaleX();
+
+    /**
+     * Obtains the sprite's vertical scale
+     */
+    float GetScaleY();
+
+    /**
+     * Obtains the transform from the sprite's own space, where its top-left
+     * corner is the origin and it extends to (width, -height), to the space
+     * of its parent node (or the world if it isn't attached to a node).
+     */
+    AffineTransform GetLocalTransform();
+
     /**
      * Puts OpenGL vertex information into the given array.
      * 
@@ -102,6 +240,15 @@ public:
      */
     void PutGLVertexInfo(float* vertexBuffer);
 
+    /**
+     * Puts OpenGL vertex information into the given array, transforming the
+     * sprite's corners by the given world transform of its node.
+     *
+     * DO NOT CALL THIS METHOD IF THERE IS NOT SPACE FOR 16 ADDITIONAL
+     * VALUES WITHIN THE ARRAY.
+     */
+    void PutGLVertexInfo(float* vertexBuffer, const AffineTransform& nodeTransform);
+
     /**
      * Puts OpenGL color information into the given array.
      *
@@ -113,6 +260,18 @@ public:
      */
     void PutGLColorInfo(float* colorBuffer);
 
+    /**
+     * Puts OpenGL texture coordinate information into the given array,
+     * covering the whole texture.
+     *
+     * DO NOT CALL THIS METHOD IF THERE IS NOT SPACE FOR 8 ADDITIONAL
+     * VALUES WITHIN THE ARRAY.
+     *
+     * Typically this function isn't needed outside the game engine's
+     * core graphics system, and thus it shouldn't be needed by users.
+     */
+    void PutGLTexCoordInfo(float* texCoordBuffer);
+
     /**
      * Puts OpenGL index information into the given array.  It 
      *
@@ -130,6 +289,28 @@ protected:
     float width;
     float height;
     Color color;
+    float rotation;
+    float scaleX;
+    float scaleY;
+    float pivotX;
+    float pivotY;
+    float depth;
+    bool opaque;
+    TextureHandle texture;
+    SceneGraph::NodeID node;
+
+    /**
+     * The ResourceManager holding the sprite's texture reference, kept so
+     * the reference can still be released during shutdown.
+     */
+    std::shared_ptr<ResourceManager> resourceManager;
+
+    /**
+     * The sine and cosine of the rotation, only recomputed when the
+     * rotation changes.
+     */
+    float rotationSine;
+    float rotationCosine;
 
     /**
      * Validates that width and height are greater than zero.
@@ -0,0 +1,146 @@
+#ifndef Core_SpscQueue_h
+#define Core_SpscQueue_h
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/**
+ * A bounded, lock-free queue for passing values from exactly one producer
+ * thread to exactly one consumer thread.
+ *
+ * The queue is a ring of slots allocated once, so pushing and popping
+ * never allocate or block; TryPush fails when the ring is full and TryPop
+ * when it is empty. Each side keeps a cached copy of the other side's
+ * position and only reloads it when the ring looks full or empty, so the
+ * two threads rarely touch the same cache line.
+ */
+template <typename T>
+class SpscQueue final
+{
+public:
+    /**
+     * Creates a queue holding at least the given number of values; the
+     * capacity is rounded up to a power of two.
+     */
+    SpscQueue(unsigned int capacity) : head(0), cachedTail(0), tail(0), cachedHead(0)
+    {
+        size_t size = 1;
+        while (size < capacity)
+        {
+            size *= 2;
+        }
+        this->slots.resize(size);
+        this->mask = size - 1;
+    }
+
+    /**
+     * Copies the given value onto the queue. Returns false if the queue is
+     * full. Only call from the producer thread.
+     */
+    bool TryPush(const T& value)
+    {
+        size_t position;
+        if (!this->reserve(position))
+        {
+            return false;
+        }
+        this->slots[position & this->mask] = value;
+        this->tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Moves the given value onto the queue. Returns false, leaving the value
+     * untouched, if the queue is full. Only call from the producer thread.
+     */
+    bool TryPush(T&& value)
+    {
+        size_t position;
+        if (!this->reserve(position))
+        {
+            return false;
+        }
+        this->slots[position & this->mask] = std::move(value);
+        this->tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Moves the oldest value off the queue into the given value. Returns
+     * false if the queue is empty. Only call from the consumer thread.
+     */
+    bool TryPop(T& value)
+    {
+        size_t position = this->head.load(std::memory_order_relaxed);
+        if (position == this->cachedTail)
+        {
+            this->cachedTail = this->tail.load(std::memory_order_acquire);
+            if (position == this->cachedTail)
+            {
+                return false;
+            }
+        }
+        value = std::move(this->slots[position & this->mask]);
+        this->head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Obtains the number of values in the queue. Only a snapshot when
+     * called while the other thread is using the queue.
+     */
+    unsigned int GetSize() const
+    {
+        size_t position = this->head.load(std::memory_order_acquire);
+        return (unsigned int)(this->tail.load(std::memory_order_acquire) - position);
+    }
+
+    /**
+     * Obtains the most values the queue can hold.
+     */
+    unsigned int GetCapacity() const
+    {
+        return (unsigned int)this->slots.size();
+    }
+
+private:
+    // Private constructors to disallow access.
+    SpscQueue(SpscQueue const &other);
+    SpscQueue operator=(SpscQueue other);
+
+    /**
+     * Obtains the position to write the next value at, if there is room.
+     */
+    bool reserve(size_t& position)
+    {
+        position = this->tail.load(std::memory_order_relaxed);
+        if (position - this->cachedHead >= this->slots.size())
+        {
+            this->cachedHead = this->head.load(std::memory_order_acquire);
+            if (position - this->cachedHead >= this->slots.size())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<T> slots;
+    size_t mask;
+
+    /**
+     * The consumer's position and its copy of the producer's, padded onto
+     * their own cache line, then the same for the producer.
+     */
+    char consumerPadding[64];
+    std::atomic<size_t> head;
+    size_t cachedTail;
+    char producerPadding[64];
+    std::atomic<size_t> tail;
+    size_t cachedHead;
+    char endPadding[64];
+};
+
+#endif
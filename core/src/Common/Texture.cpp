@@ -1,15 +1,45 @@
+#include <cstdio>
 #include "Texture.h"
+#include "SFML/OpenGL.hpp"
+
+#ifndef GL_TEXTURE_COMPRESSED_IMAGE_SIZE
+#define GL_TEXTURE_COMPRESSED_IMAGE_SIZE 0x86A0
+#endif
+#ifndef GL_TEXTURE_COMPRESSED
+#define GL_TEXTURE_COMPRESSED 0x86A1
+#endif
 
 Texture::Texture(int textureID, const char *fileName)
 {
     this->textureID = textureID;
-    this->textureUnit =  SOIL_load_OGL_texture
-    (
-     fileName,
-     SOIL_LOAD_AUTO,
-     SOIL_CREATE_NEW_ID,
-     SOIL_FLAG_MIPMAPS | SOIL_FLAG_INVERT_Y | SOIL_FLAG_NTSC_SAFE_RGB | SOIL_FLAG_COMPRESS_TO_DXT
-     );
+    this->textureUnit = 0;
+
+    // Cooked textures are already flipped, mipmapped, and compressed, so
+    // they are uploaded without any processing.
+    std::string cookedFileName = Texture::GetCookedFileName(fileName);
+    FILE* cookedFile = fopen(cookedFileName.c_str(), "rb");
+    if (cookedFile != nullptr)
+    {
+        fclose(cookedFile);
+        this->textureUnit = SOIL_load_OGL_texture
+        (
+         cookedFileName.c_str(),
+         SOIL_LOAD_AUTO,
+         SOIL_CREATE_NEW_ID,
+         SOIL_FLAG_DDS_LOAD_DIRECT
+         );
+    }
+
+    if (this->textureUnit == 0)
+    {
+        this->textureUnit =  SOIL_load_OGL_texture
+        (
+         fileName,
+         SOIL_LOAD_AUTO,
+         SOIL_CREATE_NEW_ID,
+         SOIL_FLAG_MIPMAPS | SOIL_FLAG_INVERT_Y | SOIL_FLAG_NTSC_SAFE_RGB | SOIL_FLAG_COMPRESS_TO_DXT
+         );
+    }
     
     if(this->textureUnit == 0)
     {
@@ -21,6 +51,23 @@ Texture::Texture(int textureID, const char *fileName)
     }
 }
 
+Texture::Texture(int textureID, const unsigned char* data, size_t size, bool cooked)
+{
+    this->textureID = textureID;
+    unsigned int flags = cooked ? SOIL_FLAG_DDS_LOAD_DIRECT : SOIL_FLAG_MIPMAPS | SOIL_FLAG_INVERT_Y | SOIL_FLAG_NTSC_SAFE_RGB | SOIL_FLAG_COMPRESS_TO_DXT;
+    this->textureUnit = SOIL_load_OGL_texture_from_memory(data, (int)size, SOIL_LOAD_AUTO, SOIL_CREATE_NEW_ID, flags);
+    if (this->textureUnit == 0)
+    {
+        printf("Error loading Image.\n");
+    }
+}
+
+Texture::Texture(int textureID)
+{
+    this->textureID = textureID;
+    this->textureUnit = 0;
+}
+
 Texture::~Texture()
 {
 
@@ -35,3 +82,65 @@ int Texture::GetTextureID()
 {
     return this->textureID;
 }
+
+bool Texture::IsLoaded()
+{
+    return this->textureUnit != 0;
+}
+
+void Texture::SetTextureUnit(unsigned int textureUnit)
+{
+    this->textureUnit = textureUnit;
+}
+
+std::string Texture::GetCookedFileName(const char* fileName)
+{
+    std::string name = fileName;
+    size_t extension = name.find_last_of('.');
+    size_t directory = name.find_last_of("/\\");
+    if (extension == std::string::npos || (directory != std::string::npos && extension < directory))
+    {
+        return name + ".dds";
+    }
+    return name.substr(0, extension) + ".dds";
+}
+
+size_t Texture::MeasureByteSize(unsigned int textureUnit)
+{
+    if (textureUnit == 0)
+    {
+        return 0;
+    }
+    GLint previous = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+    glBindTexture(GL_TEXTURE_2D, textureUnit);
+
+    // Levels past the last mipmap report a width of 0.
+    size_t size = 0;
+    for (GLint level = 0; ; level++)
+    {
+        GLint width = 0;
+        GLint height = 0;
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_WIDTH, &width);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_HEIGHT, &height);
+        if (width == 0 || height == 0)
+        {
+            break;
+        }
+        GLint compressed = GL_FALSE;
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_COMPRESSED, &compressed);
+        if (compressed == GL_TRUE)
+        {
+            GLint compressedSize = 0;
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &compressedSize);
+            size += (size_t)compressedSize;
+        }
+        else
+        {
+            size += (size_t)width * height * 4;
+        }
+    }
+
+    glBindTexture(GL_TEXTURE_2D, (GLuint)previous);
+    return size;
+}
@@ -1,13 +1,41 @@
 #ifndef Core_Texture_h
 #define Core_Texture_h
 
+#include <cstddef>
 #include <functional>
+#include <string>
 #include "ImageLoader/SOIL2.h"
 
+/**
+ * An OpenGL texture loaded from an image file.
+ *
+ * If the TextureCooker tool has cooked the image, the cooked DDS file next
+ * to it (see GetCookedFileName) is uploaded as-is, mipmaps and compression
+ * included. Otherwise the image is decoded, mipmapped, and compressed at
+ * load time, which is much slower. Textures in asset packs are loaded
+ * from memory instead.
+ *
+ * Textures loaded asynchronously through the ResourceManager start out
+ * unloaded, with a texture unit of 0, until the view thread uploads them.
+ */
 class Texture
 {
 public:
+    /**
+     * Loads the given image, or its cooked version if there is one.
+     */
     Texture(int textureID, const char *fileName);
+
+    /**
+     * Loads an image, or a cooked DDS file if cooked is true, from memory.
+     */
+    Texture(int textureID, const unsigned char* data, size_t size, bool cooked);
+
+    /**
+     * Creates a texture that hasn't been loaded yet.
+     */
+    Texture(int textureID);
+
     ~Texture();
 
     Texture(char* filePath);
@@ -15,6 +43,36 @@ public:
     unsigned int GetTextureUnit();
     int GetTextureID();
 
+    /**
+     * Obtains whether the texture has been uploaded to the GPU.
+     */
+    bool IsLoaded();
+
+    /**
+     * Sets the texture unit once an asynchronously loaded texture has been
+     * uploaded.
+     *
+     * Typically this function isn't needed outside the game engine's
+     * core graphics system, and thus it shouldn't be needed by users.
+     */
+    void SetTextureUnit(unsigned int textureUnit);
+
+    /**
+     * Obtains the name of the cooked version of the given image: the same
+     * path with its extension replaced by ".dds".
+     */
+    static std::string GetCookedFileName(const char* fileName);
+
+    /**
+     * Obtains how many bytes of video memory the given OpenGL texture uses,
+     * counting every mipmap level, or 0 for texture unit 0. Must be called
+     * with the OpenGL context active.
+     *
+     * Typically this function isn't needed outside the game engine's
+     * core graphics system, and thus it shouldn't be needed by users.
+     */
+    static size_t MeasureByteSize(unsigned int textureUnit);
+
 
 private:
     Texture();
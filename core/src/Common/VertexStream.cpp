@@ -0,0 +1,135 @@
+#include "VertexStream.h"
+
+const unsigned int VertexStream::FLOATS_PER_QUAD;
+const unsigned int VertexStream::INDICES_PER_QUAD;
+const unsigned int VertexStream::TEXCOORDS_PER_QUAD;
+
+VertexStream::VertexStream() : quadCount(0), quadCapacity(0), textureUnit(0), blended(true)
+{
+
+}
+
+VertexStream::~VertexStream()
+{
+
+}
+
+void VertexStream::Clear()
+{
+    this->quadCount = 0;
+    this->textureUnit = 0;
+    this->blended = true;
+    this->batches.clear();
+}
+
+void VertexStream::SetTexture(unsigned int textureUnit)
+{
+    this->textureUnit = textureUnit;
+}
+
+void VertexStream::SetBlending(bool blended)
+{
+    this->blended = blended;
+}
+
+unsigned int VertexStream::AddQuads(unsigned int count)
+{
+    unsigned int firstQuad = this->quadCount;
+    if (count == 0)
+    {
+        return firstQuad;
+    }
+    if (this->quadCount + count > this->quadCapacity)
+    {
+        unsigned int newCapacity = this->quadCapacity * 2;
+        if (newCapacity < this->quadCount + count)
+        {
+            newCapacity = this->quadCount + count;
+        }
+        this->reserve(newCapacity);
+    }
+    this->quadCount += count;
+
+    if (this->batches.empty() || this->batches.back().textureUnit != this->textureUnit || this->batches.back().blended != this->blended)
+    {
+        Batch batch = { this->textureUnit, this->blended, firstQuad, 0 };
+        this->batches.push_back(batch);
+    }
+    this->batches.back().quadCount += count;
+    return firstQuad;
+}
+
+unsigned int VertexStream::GetQuadCount()
+{
+    return this->quadCount;
+}
+
+float* VertexStream::GetVertexData(unsigned int quad)
+{
+    return &this->vertexData[quad * FLOATS_PER_QUAD];
+}
+
+float* VertexStream::GetColorData(unsigned int quad)
+{
+    return &this->colorData[quad * FLOATS_PER_QUAD];
+}
+
+float* VertexStream::GetTexCoordData(unsigned int quad)
+{
+    return &this->texCoordData[quad * TEXCOORDS_PER_QUAD];
+}
+
+unsigned int VertexStream::GetBatchCount()
+{
+    return (unsigned int)this->batches.size();
+}
+
+unsigned int VertexStream::GetBatchTexture(unsigned int batch)
+{
+    return this->batches[batch].textureUnit;
+}
+
+bool VertexStream::GetBatchBlended(unsigned int batch)
+{
+    return this->batches[batch].blended;
+}
+
+unsigned int VertexStream::GetBatchFirstQuad(unsigned int batch)
+{
+    return this->batches[batch].firstQuad;
+}
+
+unsigned int VertexStream::GetBatchQuadCount(unsigned int batch)
+{
+    return this->batches[batch].quadCount;
+}
+
+unsigned int* VertexStream::GetIndexData()
+{
+    return &this->indexData[0];
+}
+
+void VertexStream::reserve(unsigned int quadCapacity)
+{
+    this->vertexData.resize(quadCapacity * FLOATS_PER_QUAD);
+    this->colorData.resize(quadCapacity * FLOATS_PER_QUAD);
+    this->texCoordData.resize(quadCapacity * TEXCOORDS_PER_QUAD);
+
+    // Quads are always drawn as the same two triangles, so the index data
+    // only has to be written when the stream grows.
+    this->indexData.resize(quadCapacity * INDICES_PER_QUAD);
+    for (unsigned int quad = this->quadCapacity; quad < quadCapacity; quad++)
+    {
+        unsigned int* indices = &this->indexData[quad * INDICES_PER_QUAD];
+        unsigned int dataStartIndex = quad * 4;
+        // TopRight Triangle
+        indices[0] = dataStartIndex;
+        indices[1] = dataStartIndex + 1;
+        indices[2] = dataStartIndex + 2;
+        // BottomLeft Triangle
+        indices[3] = dataStartIndex + 2;
+        indices[4] = dataStartIndex + 3;
+        indices[5] = dataStartIndex;
+    }
+    this->quadCapacity = quadCapacity;
+}
@@ -0,0 +1,165 @@
+#ifndef Core_VertexStream_h
+#define Core_VertexStream_h
+
+#include <vector>
+
+/**
+ * A growable stream of quads in the layout the GraphicsView hands to
+ * OpenGL: 4 vertices per quad, 4 coordinates, 4 color channels, and 2
+ * texture coordinates per vertex, and 6 indices (2 triangles) per quad.
+ *
+ * Producers reserve quads with AddQuads and write straight into the
+ * returned memory, so filling the stream never allocates once it has
+ * grown to the size of a typical frame.
+ *
+ * Quads are grouped into batches that share a texture. Call SetTexture
+ * before AddQuads to choose the texture of the quads that follow;
+ * consecutive quads with the same texture are drawn in a single call.
+ * Untextured quads (texture unit 0) don't need texture coordinates.
+ *
+ * Likewise, SetBlending chooses whether the following quads are alpha
+ * blended. Opaque quads are drawn with blending off and depth writes on so
+ * that quads behind them are rejected by the depth test.
+ */
+class VertexStream
+{
+public:
+    /**
+     * The number of floats each quad occupies in the vertex data.
+     */
+    static const unsigned int FLOATS_PER_QUAD = 16;
+
+    /**
+     * The number of indices each quad occupies in the index data.
+     */
+    static const unsigned int INDICES_PER_QUAD = 6;
+
+    /**
+     * The number of floats each quad occupies in the texture coordinate data.
+     */
+    static const unsigned int TEXCOORDS_PER_QUAD = 8;
+
+    /**
+     * Creates an empty VertexStream.
+     */
+    VertexStream();
+
+    /**
+     * Destructor
+     */
+    ~VertexStream();
+
+    /**
+     * Removes all quads from the stream while keeping its memory.
+     */
+    void Clear();
+
+    /**
+     * Sets the OpenGL texture unit used by quads added after this call, or
+     * 0 for untextured quads.
+     */
+    void SetTexture(unsigned int textureUnit);
+
+    /**
+     * Sets whether quads added after this call are alpha blended. Quads are
+     * blended unless this is called with false.
+     */
+    void SetBlending(bool blended);
+
+    /**
+     * Appends the given number of quads to the end of the stream and
+     * returns the index of the first one. The new quads' contents are
+     * undefined until written.
+     */
+    unsigned int AddQuads(unsigned int count);
+
+    /**
+     * Obtains the number of quads in the stream.
+     */
+    unsigned int GetQuadCount();
+
+    /**
+     * Obtains the vertex data of the given quad. There is space for
+     * FLOATS_PER_QUAD values for each quad from this one to the end of
+     * the stream.
+     */
+    float* GetVertexData(unsigned int quad);
+
+    /**
+     * Obtains the color data of the given quad. There is space for
+     * FLOATS_PER_QUAD values for each quad from this one to the end of
+     * the stream.
+     */
+    float* GetColorData(unsigned int quad);
+
+    /**
+     * Obtains the texture coordinate data of the given quad. There is space
+     * for TEXCOORDS_PER_QUAD values for each quad from this one to the end
+     * of the stream.
+     */
+    float* GetTexCoordData(unsigned int quad);
+
+    /**
+     * Obtains the number of batches of quads sharing a texture and blending.
+     */
+    unsigned int GetBatchCount();
+
+    /**
+     * Obtains the texture unit of the given batch, or 0 if it is untextured.
+     */
+    unsigned int GetBatchTexture(unsigned int batch);
+
+    /**
+     * Obtains whether the given batch is alpha blended.
+     */
+    bool GetBatchBlended(unsigned int batch);
+
+    /**
+     * Obtains the index of the first quad in the given batch.
+     */
+    unsigned int GetBatchFirstQuad(unsigned int batch);
+
+    /**
+     * Obtains the number of quads in the given batch.
+     */
+    unsigned int GetBatchQuadCount(unsigned int batch);
+
+    /**
+     * Obtains index data covering every quad in the stream, suitable for
+     * drawing with GL_TRIANGLES and GL_UNSIGNED_INT.
+     */
+    unsigned int* GetIndexData();
+
+private:
+    // Private constructors to disallow access.
+    VertexStream(VertexStream const &other);
+    VertexStream operator=(VertexStream other);
+
+    /**
+     * Grows the buffers so they can hold at least the given number of quads.
+     */
+    void reserve(unsigned int quadCapacity);
+
+    /**
+     * A run of consecutive quads drawn with the same texture and blending.
+     */
+    struct Batch
+    {
+        unsigned int textureUnit;
+        bool blended;
+        unsigned int firstQuad;
+        unsigned int quadCount;
+    };
+
+    unsigned int quadCount;
+    unsigned int quadCapacity;
+    unsigned int textureUnit;
+    bool blended;
+    std::vector<float> vertexData;
+    std::vector<float> colorData;
+    std::vector<float> texCoordData;
+    std::vector<unsigned int> indexData;
+    std::vector<Batch> batches;
+};
+
+#endif
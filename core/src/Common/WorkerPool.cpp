@@ -0,0 +1,119 @@
+#include "WorkerPool.h"
+
+std::shared_ptr<WorkerPool> WorkerPool::instance = nullptr;
+std::mutex WorkerPool::instanceMutex;
+
+WorkerPool::WorkerPool(unsigned int threadCount) : shouldExit(false)
+{
+    for (unsigned int i = 0; i < threadCount; i++)
+    {
+        this->threads.push_back(std::thread(&WorkerPool::workerLoop, this));
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    this->jobsMutex.lock();
+    this->shouldExit = true;
+    this->jobsMutex.unlock();
+    this->jobsAvailable.notify_all();
+    for (unsigned int i = 0; i < this->threads.size(); i++)
+    {
+        this->threads[i].join();
+    }
+}
+
+std::shared_ptr<WorkerPool> WorkerPool::GetInstance()
+{
+    std::lock_guard<std::mutex> lock(WorkerPool::instanceMutex);
+    if (WorkerPool::instance == nullptr)
+    {
+        unsigned int cores = std::thread::hardware_concurrency();
+        WorkerPool::instance = std::make_shared<WorkerPool>(cores > 1 ? cores - 1 : 1);
+    }
+    return WorkerPool::instance;
+}
+
+void WorkerPool::Submit(Job job)
+{
+    this->jobsMutex.lock();
+    this->jobs.push(job);
+    this->jobsMutex.unlock();
+    this->jobsAvailable.notify_one();
+}
+
+void WorkerPool::ParallelFor(unsigned int count, unsigned int minimumRange, RangeJob job)
+{
+    if (minimumRange == 0)
+    {
+        minimumRange = 1;
+    }
+    unsigned int rangeCount = (unsigned int)this->threads.size() + 1;
+    if (count / minimumRange < rangeCount)
+    {
+        rangeCount = count / minimumRange;
+    }
+    if (rangeCount <= 1)
+    {
+        if (count > 0)
+        {
+            job(0, count);
+        }
+        return;
+    }
+
+    std::mutex doneMutex;
+    std::condition_variable doneCondition;
+    unsigned int remaining = rangeCount - 1;
+    unsigned int rangeSize = count / rangeCount;
+
+    // The workers take every range but the first, which runs on this thread.
+    for (unsigned int range = 1; range < rangeCount; range++)
+    {
+        unsigned int begin = range * rangeSize;
+        unsigned int end = (range == rangeCount - 1) ? count : begin + rangeSize;
+        this->Submit([&, begin, end]()
+        {
+            job(begin, end);
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (--remaining == 0)
+            {
+                doneCondition.notify_one();
+            }
+        });
+    }
+    job(0, rangeSize);
+
+    std::unique_lock<std::mutex> lock(doneMutex);
+    while (remaining > 0)
+    {
+        doneCondition.wait(lock);
+    }
+}
+
+unsigned int WorkerPool::GetThreadCount()
+{
+    return (unsigned int)this->threads.size();
+}
+
+void WorkerPool::workerLoop()
+{
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(this->jobsMutex);
+            while (this->jobs.empty() && !this->shouldExit)
+            {
+                this->jobsAvailable.wait(lock);
+            }
+            if (this->jobs.empty())
+            {
+                return;
+            }
+            job = this->jobs.front();
+            this->jobs.pop();
+        }
+        job();
+    }
+}
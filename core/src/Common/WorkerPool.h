@@ -0,0 +1,84 @@
+#ifndef Core_WorkerPool_h
+#define Core_WorkerPool_h
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+
+/**
+ * A fixed set of worker threads that run jobs submitted from any thread.
+ *
+ * Use Submit for fire-and-forget background work such as decoding assets,
+ * and ParallelFor to split a loop across every core and wait for it.
+ */
+class WorkerPool
+{
+public:
+    typedef std::function<void ()> Job;
+    typedef std::function<void (unsigned int begin, unsigned int end)> RangeJob;
+
+    /**
+     * Should NEVER be used. Only public because make_shared requires it.
+     */
+    WorkerPool(unsigned int threadCount);
+
+    /**
+     * Finishes any queued jobs and joins the worker threads.
+     */
+    ~WorkerPool();
+
+    /**
+     * Returns the shared WorkerPool, creating it with one thread per
+     * hardware core (less the calling thread) on first use.
+     */
+    static std::shared_ptr<WorkerPool> GetInstance();
+
+    /**
+     * Queues a job to be run on a worker thread.
+     */
+    void Submit(Job job);
+
+    /**
+     * Splits [0, count) into contiguous ranges and runs the given job on
+     * each range, using the workers and the calling thread. Returns once
+     * every range has finished.
+     *
+     * @param minimumRange ranges are never made smaller than this, so that
+     * small loops are not split into pieces that cost more to schedule than
+     * to run.
+     */
+    void ParallelFor(unsigned int count, unsigned int minimumRange, RangeJob job);
+
+    /**
+     * Obtains the number of worker threads.
+     */
+    unsigned int GetThreadCount();
+
+private:
+    // Private constructors to disallow access.
+    WorkerPool(WorkerPool const &other);
+    WorkerPool operator=(WorkerPool other);
+
+    /**
+     * The loop run by each worker thread.
+     */
+    void workerLoop();
+
+    std::vector<std::thread> threads;
+    std::queue<Job> jobs;
+    std::mutex jobsMutex;
+    std::condition_variable jobsAvailable;
+    bool shouldExit;
+
+    /**
+     * Static instance for Singleton
+     */
+    static std::shared_ptr<WorkerPool> instance;
+    static std::mutex instanceMutex;
+};
+
+#endif
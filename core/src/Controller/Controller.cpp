@@ -1,7 +1,13 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
 #include "Controller.h"
 #include "GraphicsManager.h"
 #include "InputManager.h"
 #include "SoundManager.h"
+#include "SfmlAudioDevice.h"
+#include "NullAudioDevice.h"
+#include "WavAudioDevice.h"
 
 Controller::Controller()
 {
@@ -9,6 +15,11 @@ Controller::Controller()
     this->viewsCreated = false;
 }
 
+void Controller::SetAudioDevice(std::shared_ptr<AudioDevice> device)
+{
+    this->audioDevice = device;
+}
+
 void Controller::Start()
 {
     // Start the main game loop on a different thread.
@@ -46,14 +57,16 @@ void Controller::gameLoop()
 
 void Controller::viewLoop()
 {
-    std::shared_ptr<sf::RenderWindow> window = std::make_shared<sf::RenderWindow>(sf::VideoMode(640, 480), "Game Engine");
+    // The graphics view depth tests opaque sprites, so ask for a depth buffer
+    sf::ContextSettings settings(24);
+    std::shared_ptr<sf::RenderWindow> window = std::make_shared<sf::RenderWindow>(sf::VideoMode(640, 480), "Game Engine", sf::Style::Default, settings);
     window->setFramerateLimit(1 / this->FRAMERATE);
 
     GraphicsView graphicsView(window); 
     graphicsView.Initialize();
     InputView inputView(window);
     inputView.Initialize();
-    std::shared_ptr<SoundView> soundView = std::make_shared<SoundView>();
+    std::shared_ptr<SoundView> soundView = std::make_shared<SoundView>(this->createAudioDevice());
     soundView->Initialize();
 
     // Actual loop
@@ -72,6 +85,33 @@ void Controller::viewLoop()
         while((getTimeInMilliseconds() - startTime) <= Controller::FRAMERATE)
         { }
     }
+
+    // Nothing carries out sound commands from here on, so the game thread
+    // mustn't wait for room in their queue while it finishes
+    SoundManager::GetInstance()->SetView(nullptr);
+}
+
+std::shared_ptr<AudioDevice> Controller::createAudioDevice()
+{
+    if(this->audioDevice != nullptr)
+    {
+        return this->audioDevice;
+    }
+    const char* setting = std::getenv("ENGINE_AUDIO_DEVICE");
+    std::string device = setting == nullptr ? "" : setting;
+    if(device == "null")
+    {
+        return std::make_shared<NullAudioDevice>();
+    }
+    if(device.compare(0, 4, "wav:") == 0)
+    {
+        return std::make_shared<WavAudioDevice>(device.substr(4));
+    }
+    if(!device.empty() && device != "sfml")
+    {
+        printf("Unknown audio device %s, playing on the sound card.\n", device.c_str());
+    }
+    return std::make_shared<SfmlAudioDevice>();
 }
 
 void Controller::updateViews(GraphicsView* graphicsView, InputView* inputView, std::shared_ptr<SoundView>* soundView)
@@ -86,7 +126,7 @@ void Controller::updateViews(GraphicsView* graphicsView, InputView* inputView, s
 
     graphicsView->Update(controllerPackage->GetGraphicsManager());
     inputView->Update(controllerPackage->GetInputManager());
-    (*soundView)->Update(controllerPackage->GetSoundManager());
+    (*soundView)->Update(controllerPackage->GetSoundManager(), controllerPackage->GetGraphicsManager()->GetCamera());
 }
 
 void Controller::handleEvents(std::shared_ptr<sf::RenderWindow> window, InputView* inputView) {
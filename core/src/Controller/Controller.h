@@ -10,6 +10,7 @@
 #include "GraphicsView.h"
 #include "InputView.h"
 #include "SoundView.h"
+#include "AudioDevice.h"
 #include "GameStateManager.h"
 #include "InitialState.h"
 #include "ControllerPackage.h"
@@ -17,6 +18,10 @@
 /**
  * The class that creates, starts, and updates the Model and Views. Simply call the Start method to create all the objects
  * and start them updating.
+ *
+ * Sound plays on the sound card unless another audio device is set, or the ENGINE_AUDIO_DEVICE environment
+ * variable picks one: "null" renders the mix and throws it away, for machines without audio hardware, and
+ * "wav:<file>" renders it into the given WAV file.
  */
 class Controller : public enable_shared_from_this<Controller>
 {
@@ -30,6 +35,11 @@ public:
      * Starts the game. Initializes systems and starts updating them.
      */
     void Start();
+
+    /**
+     * Sets the device the sound view plays through, overriding ENGINE_AUDIO_DEVICE. Call before Start.
+     */
+    void SetAudioDevice(std::shared_ptr<AudioDevice> device);
     
 private:
     // Private constructors to disallow access.
@@ -66,6 +76,17 @@ private:
      */
     volatile bool viewsCreated;
 
+    /**
+     * The device set to play sound through, or null to pick one when the views are created.
+     */
+    std::shared_ptr<AudioDevice> audioDevice;
+
+    /**
+     * Obtains the device set to play sound through, or else the one ENGINE_AUDIO_DEVICE names, or else the
+     * sound card. Throws an exception if a WAV file can't be created.
+     */
+    std::shared_ptr<AudioDevice> createAudioDevice();
+
     void updateViews(GraphicsView* graphicsView, InputView* inputView, std::shared_ptr<SoundView>* soundView);
 
     /**
@@ -5,7 +5,8 @@ std::weak_ptr<ControllerPackage> ControllerPackage::activeControllerPackage;
 ControllerPackage::ControllerPackage(std::shared_ptr<GraphicsManager> graphicsManager, std::shared_ptr<InputManager> inputManager, std::shared_ptr<SoundManager> soundManager)
 : graphicsManager(graphicsManager),
 inputManager(inputManager),
-soundManager(soundManager)
+soundManager(soundManager),
+resourceManager(ResourceManager::GetInstance())
 {
 
 }
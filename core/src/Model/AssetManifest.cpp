@@ -0,0 +1,41 @@
+#include "AssetManifest.h"
+
+AssetManifest::AssetManifest()
+{
+
+}
+
+void AssetManifest::AddTexture(const std::string& fileName)
+{
+    this->textures.push_back(fileName);
+}
+
+void AssetManifest::AddSound(const std::string& fileName)
+{
+    this->sounds.push_back(fileName);
+}
+
+void AssetManifest::AddMusic(const std::string& fileName)
+{
+    this->music.push_back(fileName);
+}
+
+const std::vector<std::string>& AssetManifest::GetTextures() const
+{
+    return this->textures;
+}
+
+const std::vector<std::string>& AssetManifest::GetSounds() const
+{
+    return this->sounds;
+}
+
+const std::vector<std::string>& AssetManifest::GetMusic() const
+{
+    return this->music;
+}
+
+unsigned int AssetManifest::GetAssetCount() const
+{
+    return (unsigned int)(this->textures.size() + this->sounds.size() + this->music.size());
+}
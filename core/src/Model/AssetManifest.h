@@ -0,0 +1,65 @@
+#ifndef Core_AssetManifest_h
+#define Core_AssetManifest_h
+
+#include <string>
+#include <vector>
+
+/**
+ * The assets a GameState needs, declared up front so the GameStateManager
+ * can load them in the background before the state is initialized.
+ *
+ * List the same file names the state loads in Initialize: textures are
+ * loaded completely, so LoadTextureAsync returns them ready to draw, and
+ * sounds are decoded into the sound view's cache, so LoadSound takes them
+ * from there. Music is opened ahead of time too.
+ */
+class AssetManifest
+{
+public:
+    /**
+     * Creates an empty manifest.
+     */
+    AssetManifest();
+
+    /**
+     * Adds a texture to the manifest.
+     */
+    void AddTexture(const std::string& fileName);
+
+    /**
+     * Adds a sound effect to the manifest.
+     */
+    void AddSound(const std::string& fileName);
+
+    /**
+     * Adds a piece of music to the manifest.
+     */
+    void AddMusic(const std::string& fileName);
+
+    /**
+     * Obtains the textures in the manifest.
+     */
+    const std::vector<std::string>& GetTextures() const;
+
+    /**
+     * Obtains the sound effects in the manifest.
+     */
+    const std::vector<std::string>& GetSounds() const;
+
+    /**
+     * Obtains the music in the manifest.
+     */
+    const std::vector<std::string>& GetMusic() const;
+
+    /**
+     * Obtains the number of assets in the manifest.
+     */
+    unsigned int GetAssetCount() const;
+
+private:
+    std::vector<std::string> textures;
+    std::vector<std::string> sounds;
+    std::vector<std::string> music;
+};
+
+#endif
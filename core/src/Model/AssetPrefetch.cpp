@@ -0,0 +1,140 @@
+#include <chrono>
+#include "AssetPrefetch.h"
+#include "ResourceManager.h"
+#include "SoundManager.h"
+
+AssetPrefetch::AssetPrefetch() : assetCount(0), finishedCount(0), released(false)
+{
+
+}
+
+AssetPrefetch::~AssetPrefetch()
+{
+    this->Release();
+}
+
+void AssetPrefetch::Start(const AssetManifest& manifest)
+{
+    std::shared_ptr<ResourceManager> resourceManager = ResourceManager::GetInstance();
+    this->assetCount = manifest.GetAssetCount();
+
+    // Callbacks hold a weak pointer so an abandoned prefetch can go away
+    // while its textures are still loading.
+    std::weak_ptr<AssetPrefetch> weakThis = this->shared_from_this();
+    const std::vector<std::string>& textureNames = manifest.GetTextures();
+    for (auto it = textureNames.begin(); it != textureNames.end(); it++)
+    {
+        // Textures that are already resident count as finished now, so a
+        // state whose assets are all loaded starts without waiting for the
+        // next dispatch of texture callbacks
+        TextureHandle texture;
+        if (resourceManager->IsTextureLoaded(resourceManager->FindTexture(*it)))
+        {
+            texture = resourceManager->LoadTextureAsync(*it, nullptr);
+            this->finishedCount++;
+        }
+        else
+        {
+            texture = resourceManager->LoadTextureAsync(*it, [weakThis](TextureHandle, bool)
+            {
+                std::shared_ptr<AssetPrefetch> prefetch = weakThis.lock();
+                if (prefetch != nullptr)
+                {
+                    prefetch->finishedCount++;
+                }
+            });
+        }
+        resourceManager->AddTextureReference(texture);
+        this->textures.push_back(texture);
+    }
+
+    // Likewise for sounds already decoded, which the load below takes from
+    // the SoundView's cache
+    std::shared_ptr<SoundManager> soundManager = SoundManager::GetInstance();
+    const std::vector<std::string>& soundNames = manifest.GetSounds();
+    for (auto it = soundNames.begin(); it != soundNames.end(); it++)
+    {
+        bool loaded = soundManager->IsSoundLoaded(soundManager->FindSound(*it));
+        SoundHandle sound = soundManager->LoadSoundAsync(*it);
+        this->sounds.push_back(sound);
+        if (loaded)
+        {
+            this->finishedCount++;
+        }
+        else
+        {
+            this->audioLoads.push_back(soundManager->GetSoundLoad(sound));
+        }
+    }
+    const std::vector<std::string>& musicNames = manifest.GetMusic();
+    for (auto it = musicNames.begin(); it != musicNames.end(); it++)
+    {
+        MusicHandle music = soundManager->LoadMusicAsync(*it);
+        this->music.push_back(music);
+        this->audioLoads.push_back(soundManager->GetMusicLoad(music));
+    }
+    this->pollAudioLoads();
+}
+
+float AssetPrefetch::GetProgress()
+{
+    this->pollAudioLoads();
+    if (this->assetCount == 0)
+    {
+        return 1.0f;
+    }
+    return (float)this->finishedCount.load() / this->assetCount;
+}
+
+bool AssetPrefetch::IsComplete()
+{
+    this->pollAudioLoads();
+    return this->finishedCount.load() >= this->assetCount;
+}
+
+void AssetPrefetch::Release()
+{
+    if (this->released)
+    {
+        return;
+    }
+    this->released = true;
+    std::shared_ptr<ResourceManager> resourceManager = ResourceManager::GetInstance();
+    for (auto it = this->textures.begin(); it != this->textures.end(); it++)
+    {
+        resourceManager->RemoveTextureReference(*it);
+        resourceManager->UnloadTexture(*it);
+    }
+    this->textures.clear();
+
+    std::shared_ptr<SoundManager> soundManager = SoundManager::GetInstance();
+    for (auto it = this->sounds.begin(); it != this->sounds.end(); it++)
+    {
+        soundManager->UnloadSound(*it);
+    }
+    for (auto it = this->music.begin(); it != this->music.end(); it++)
+    {
+        soundManager->UnloadMusic(*it);
+    }
+    this->sounds.clear();
+    this->music.clear();
+    this->audioLoads.clear();
+}
+
+void AssetPrefetch::pollAudioLoads()
+{
+    // Nothing carries out sound commands while no view is set
+    bool viewSet = SoundManager::GetInstance()->IsViewSet();
+    for (auto it = this->audioLoads.begin(); it != this->audioLoads.end();)
+    {
+        if (!viewSet || it->wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            it = this->audioLoads.erase(it);
+            this->finishedCount++;
+        }
+        else
+        {
+            it++;
+        }
+    }
+}
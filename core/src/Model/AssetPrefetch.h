@@ -0,0 +1,83 @@
+#ifndef Core_AssetPrefetch_h
+#define Core_AssetPrefetch_h
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include "AssetManifest.h"
+#include "ResourceHandles.h"
+
+/**
+ * Loads the assets of an AssetManifest in the background and tracks how
+ * far along it is. Used by the GameStateManager to get a state's assets
+ * resident before initializing it.
+ *
+ * Textures are loaded asynchronously through the ResourceManager and kept
+ * from being evicted until Release is called. Sounds are loaded
+ * asynchronously through the SoundManager, which decodes them into the
+ * SoundView's shared cache, so the state loading them again takes the
+ * decoded samples; music is opened the same way. Without a SoundView
+ * nothing would carry those loads out, so they count as finished.
+ */
+class AssetPrefetch : public std::enable_shared_from_this<AssetPrefetch>
+{
+public:
+    /**
+     * Should NEVER be used. Only public because make_shared requires it.
+     */
+    AssetPrefetch();
+
+    /**
+     * Releases the prefetched textures if Release hasn't been called.
+     */
+    ~AssetPrefetch();
+
+    /**
+     * Starts loading every asset in the given manifest. Must be called on
+     * the game thread, as texture completion is reported there.
+     */
+    void Start(const AssetManifest& manifest);
+
+    /**
+     * Obtains the fraction of the assets that have finished loading, from
+     * 0 to 1. Assets that failed to load count as finished. Must be called
+     * on the game thread.
+     */
+    float GetProgress();
+
+    /**
+     * Obtains whether every asset has finished loading. Must be called on
+     * the game thread.
+     */
+    bool IsComplete();
+
+    /**
+     * Releases the prefetch's references to its textures and unloads its
+     * sounds and music, letting them be evicted or unloaded again. Call
+     * once whatever needed them holds its own references.
+     */
+    void Release();
+
+private:
+    // Private constructors to disallow access.
+    AssetPrefetch(AssetPrefetch const &other);
+    AssetPrefetch operator=(AssetPrefetch other);
+
+    /**
+     * Counts the sound and music loads that have finished since the last
+     * call.
+     */
+    void pollAudioLoads();
+
+    std::vector<TextureHandle> textures;
+    std::vector<SoundHandle> sounds;
+    std::vector<MusicHandle> music;
+    std::vector<std::shared_future<bool>> audioLoads;
+    unsigned int assetCount;
+    std::atomic<unsigned int> finishedCount;
+    bool released;
+};
+
+#endif
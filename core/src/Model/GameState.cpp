@@ -1,5 +1,10 @@
 #include "GameState.h"
 
+AssetManifest GameState::GetAssetManifest()
+{
+    return AssetManifest();
+}
+
 void GameState::Initialize(std::shared_ptr<GameStateManager> manager)
 {
     this->manager = manager;
@@ -3,6 +3,7 @@
 
 #include <memory>
 #include "GameStateManager.h"
+#include "AssetManifest.h"
 class GameStateManager;
 
 /**
@@ -19,6 +20,15 @@ class GameStateManager;
 class GameState
 {
 public:
+    /**
+     * Obtains the assets this State needs. The GameStateManager loads them
+     * in the background before calling Initialize, so that Initialize
+     * doesn't stall the game loop. Called before Initialize, so it must not
+     * rely on anything Initialize sets up. Returns an empty manifest unless
+     * overridden.
+     */
+    virtual AssetManifest GetAssetManifest();
+
     /**
      * Initializes the GameState with the given GameStateManager.
      */
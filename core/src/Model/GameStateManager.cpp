@@ -1,3 +1,4 @@
+#include <stdexcept>
 #include "GameStateManager.h"
 
 GameStateManager::GameStateManager()
@@ -13,17 +14,29 @@ void GameStateManager::Initialize(std::shared_ptr<GameState> state)
 
 void GameStateManager::Update()
 {
-    gameStates.top()->Update();
-}
+    // Run the handlers for input that arrived on the view thread since the
+    // last update, before the state sees this tick
+    std::shared_ptr<ControllerPackage> controllerPackage = ControllerPackage::GetActiveControllerPackage().lock();
+    if (controllerPackage != nullptr)
+    {
+        this->dispatchInput(controllerPackage->GetInputManager());
+    }
 
-void GameStateManager::PushState(std::shared_ptr<GameState> state)
-{
-    if(!gameStates.empty())
+    // Let states know about textures that finished loading in the background
+    ResourceManager::GetInstance()->DispatchTextureCallbacks();
+    if (this->pendingTransition != nullptr && this->pendingTransition->prefetch->IsComplete())
     {
-        gameStates.top()->Pause();
+        this->finishTransition();
+    }
+    if (!gameStates.empty() && (this->pendingTransition == nullptr || this->pendingTransition->runCurrentState))
+    {
+        gameStates.top()->Update();
     }
-    gameStates.push(state);
-    gameStates.top()->Initialize(this->shared_from_this());
+}
+
+void GameStateManager::PushState(std::shared_ptr<GameState> state, bool runCurrentState)
+{
+    this->beginTransition(state, false, runCurrentState);
 }
 
 std::shared_ptr<GameState> GameStateManager::PopState()
@@ -39,8 +52,139 @@ std::shared_ptr<GameState> GameStateManager::PopState()
     return top;
 }
 
-void GameStateManager::SwapState(std::shared_ptr<GameState> state)
+void GameStateManager::SwapState(std::shared_ptr<GameState> state, bool runCurrentState)
 {
-    this->PopState();
-    this->PushState(state);
+    this->beginTransition(state, true, runCurrentState);
+}
+
+bool GameStateManager::IsLoading()
+{
+    return this->pendingTransition != nullptr;
+}
+
+float GameStateManager::GetLoadingProgress()
+{
+    if (this->pendingTransition == nullptr)
+    {
+        return 1.0f;
+    }
+    return this->pendingTransition->prefetch->GetProgress();
+}
+
+void GameStateManager::StartInputRecording(const std::string& fileName)
+{
+    this->inputRecorder = nullptr;
+    this->inputRecorder = std::make_shared<InputRecorder>(fileName);
+}
+
+void GameStateManager::StopInputRecording()
+{
+    this->inputRecorder = nullptr;
+}
+
+bool GameStateManager::IsRecordingInput()
+{
+    return this->inputRecorder != nullptr;
+}
+
+bool GameStateManager::StartInputReplay(const std::string& fileName)
+{
+    std::shared_ptr<InputReplay> replay = InputReplay::Open(fileName);
+    if (replay == nullptr)
+    {
+        return false;
+    }
+    this->inputReplay = replay;
+    return true;
+}
+
+void GameStateManager::StopInputReplay()
+{
+    this->inputReplay = nullptr;
+}
+
+bool GameStateManager::IsReplayingInput()
+{
+    return this->inputReplay != nullptr;
+}
+
+void GameStateManager::dispatchInput(std::shared_ptr<InputManager> inputManager)
+{
+    // Recording and replay both start from the state before an update's
+    // events, so the replayed run sees the same state on every update
+    if (this->inputRecorder != nullptr && !this->inputRecorder->IsStarted())
+    {
+        this->inputRecorder->Start(inputManager->GetSnapshot());
+    }
+    if (this->inputReplay != nullptr && this->inputReplay->IsAtStart())
+    {
+        inputManager->RestoreSnapshot(this->inputReplay->GetInitialSnapshot());
+    }
+
+    if (this->inputReplay != nullptr && this->inputReplay->NextTick(this->replayEvents))
+    {
+        inputManager->ReplayEvents(this->replayEvents);
+    }
+    else
+    {
+        this->inputReplay = nullptr;
+        inputManager->DispatchEvents();
+    }
+
+    if (this->inputRecorder != nullptr)
+    {
+        this->inputRecorder->RecordTick(inputManager->GetTickEvents());
+    }
+}
+
+void GameStateManager::beginTransition(std::shared_ptr<GameState> state, bool swap, bool runCurrentState)
+{
+    if (this->pendingTransition != nullptr)
+    {
+        throw new std::invalid_argument("A state was started while another state was still loading.");
+    }
+    this->pendingTransition = std::make_shared<PendingTransition>();
+    this->pendingTransition->state = state;
+    this->pendingTransition->prefetch = std::make_shared<AssetPrefetch>();
+    this->pendingTransition->swap = swap;
+    this->pendingTransition->runCurrentState = runCurrentState;
+    this->pendingTransition->currentStatePaused = false;
+    this->pendingTransition->prefetch->Start(state->GetAssetManifest());
+
+    // States without assets, or whose textures and sounds are all resident
+    // already, start right away as they always have. Music is opened by the
+    // view thread, so it takes at least a tick.
+    if (this->pendingTransition->prefetch->IsComplete())
+    {
+        this->finishTransition();
+    }
+    else if (!runCurrentState && !gameStates.empty())
+    {
+        gameStates.top()->Pause();
+        this->pendingTransition->currentStatePaused = true;
+    }
+}
+
+void GameStateManager::finishTransition()
+{
+    std::shared_ptr<PendingTransition> transition = this->pendingTransition;
+    this->pendingTransition = nullptr;
+    if (!gameStates.empty())
+    {
+        std::shared_ptr<GameState> current = gameStates.top();
+        if (!transition->currentStatePaused)
+        {
+            current->Pause();
+        }
+        if (transition->swap)
+        {
+            current->Destroy();
+            gameStates.pop();
+        }
+    }
+    gameStates.push(transition->state);
+    gameStates.top()->Initialize(this->shared_from_this());
+
+    // The state has loaded its own references to its textures by now
+    transition->prefetch->Release();
 }
@@ -3,9 +3,14 @@
 
 #include <stack>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "ControllerPackage.h"
 #include "GameState.h"
+#include "AssetPrefetch.h"
+#include "InputRecorder.h"
+#include "InputReplay.h"
 class GameState;
 
 /**
@@ -13,6 +18,16 @@ class GameState;
  * including saving old states that remain "underneath" the current state. Allows
  * pushing a state on top of the current, so that it can be resumed when the pushed
  * state is popped, or swapping states if there is no need to return to a state later.
+ *
+ * A state that declares assets in GetAssetManifest isn't started right away when
+ * pushed or swapped in. Its assets are loaded in the background first, and the
+ * transition happens on the first Update after they are all resident. Meanwhile the
+ * current state keeps running, unless asked otherwise, so it can show a loading
+ * screen using GetLoadingProgress.
+ *
+ * The input dispatched each update can be recorded to a file and replayed
+ * from it later in place of the player's input, starting from the same input
+ * state and delivering every event on the same update it was recorded on.
  */
 class GameStateManager : public std::enable_shared_from_this<GameStateManager>
 {
@@ -27,14 +42,21 @@ public:
      */
     void Initialize(std::shared_ptr<GameState> state);
     /**
-     * Updates the current state.
+     * Dispatches the input events queued since the last update, then updates
+     * the current state.
      */
     void Update();
 
     /**
-     * Pauses the current state and starts the given state.
+     * Pauses the current state and starts the given state, once its assets
+     * are loaded.
+     *
+     * @param runCurrentState whether the current state keeps updating while
+     * the given state's assets load; if not, it is paused right away.
+     *
+     * Throws an invalid_argument if another state is still loading.
      */
-    void PushState(std::shared_ptr<GameState> state);
+    void PushState(std::shared_ptr<GameState> state, bool runCurrentState = true);
     
     /**
      * Removes the current state and resumes the previous state.
@@ -42,9 +64,61 @@ public:
     std::shared_ptr<GameState> PopState();
     
     /**
-     * Removes the current state and starts the given state.
+     * Removes the current state and starts the given state, once its assets
+     * are loaded.
+     *
+     * @param runCurrentState whether the current state keeps updating while
+     * the given state's assets load; if not, it is paused right away.
+     *
+     * Throws an invalid_argument if another state is still loading.
      */
-    void SwapState(std::shared_ptr<GameState> state);
+    void SwapState(std::shared_ptr<GameState> state, bool runCurrentState = true);
+
+    /**
+     * Obtains whether a state is waiting for its assets to load.
+     */
+    bool IsLoading();
+
+    /**
+     * Obtains the fraction of the loading state's assets that have loaded,
+     * from 0 to 1, or 1 if no state is loading.
+     */
+    float GetLoadingProgress();
+
+    /**
+     * Starts recording the input dispatched each update into the given file,
+     * from the next update on, replacing any recording in progress.
+     *
+     * Throws an invalid_argument if the file can't be created.
+     */
+    void StartInputRecording(const std::string& fileName);
+
+    /**
+     * Finishes the recording in progress, if any.
+     */
+    void StopInputRecording();
+
+    /**
+     * Obtains whether input is being recorded.
+     */
+    bool IsRecordingInput();
+
+    /**
+     * Dispatches the input recorded in the given file instead of the
+     * player's, from the next update on, until the recording runs out.
+     * @return false if the file isn't an input recording.
+     */
+    bool StartInputReplay(const std::string& fileName);
+
+    /**
+     * Goes back to dispatching the player's input.
+     */
+    void StopInputReplay();
+
+    /**
+     * Obtains whether recorded input is being replayed.
+     */
+    bool IsReplayingInput();
     
 private:
     // Private constructors to disallow access.
@@ -55,6 +129,45 @@ private:
      * Contains the current stack of game states.
      */
     std::stack<std::shared_ptr<GameState>> gameStates;
+
+    /**
+     * A state waiting for its assets, and how it will be started.
+     */
+    struct PendingTransition
+    {
+        std::shared_ptr<GameState> state;
+        std::shared_ptr<AssetPrefetch> prefetch;
+        bool swap;
+        bool runCurrentState;
+        bool currentStatePaused;
+    };
+
+    /**
+     * Starts loading the given state's assets, finishing the transition
+     * immediately if it has none.
+     */
+    void beginTransition(std::shared_ptr<GameState> state, bool swap, bool runCurrentState);
+
+    /**
+     * Pauses or removes the current state and starts the loaded one.
+     */
+    void finishTransition();
+
+    std::shared_ptr<PendingTransition> pendingTransition;
+
+    /**
+     * Dispatches this update's input, live or replayed, and records it.
+     */
+    void dispatchInput(std::shared_ptr<InputManager> inputManager);
+
+    std::shared_ptr<InputRecorder> inputRecorder;
+    std::shared_ptr<InputReplay> inputReplay;
+
+    /**
+     * The events of the update being replayed, kept so they're only
+     * allocated once
+     */
+    std::vector<QueuedInputEvent> replayEvents;
 };
 
 #endif
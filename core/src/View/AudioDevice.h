@@ -0,0 +1,31 @@
+#ifndef Core_AudioDevice_h
+#define Core_AudioDevice_h
+
+class SoundMixer;
+
+/**
+ * Interface for whatever the SoundView's mix is played on.
+ *
+ * A device pulls rendered audio from the mixer, on a thread of its own,
+ * between Start and Stop. SfmlAudioDevice plays it on the sound card;
+ * NullAudioDevice and WavAudioDevice need no audio hardware, so the sound
+ * system can run in tests and benchmarks.
+ */
+class AudioDevice
+{
+public:
+    virtual ~AudioDevice() {}
+
+    /**
+     * Starts pulling audio from the given mixer, which must outlive the
+     * device or be detached from it with Stop.
+     */
+    virtual void Start(SoundMixer& mixer) = 0;
+
+    /**
+     * Stops pulling audio. Once this returns, the mixer is no longer used.
+     */
+    virtual void Stop() = 0;
+};
+
+#endif
@@ -1,10 +1,12 @@
 #include <stdexcept>
 #include <string>
+#include <algorithm>
 #include "GraphicsView.h"
 #include "Sprite.h"
+#include "CachedLayer.h"
 #include "SFML/OpenGL.hpp"
 
-GraphicsView::GraphicsView(std::shared_ptr<sf::Window> window)
+GraphicsView::GraphicsView(std::shared_ptr<sf::Window> window) : textureUploadBudget(2.0)
 {
     this->window = window;
 }
@@ -15,23 +17,36 @@ GraphicsView::~GraphicsView()
 
 void GraphicsView::Initialize()
 {
+    // Faded particles, text, and translucent sprites rely on blending.
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
 
+    // Opaque sprites are drawn front-to-back, so sprites behind them fail
+    // the depth test instead of being overdrawn. LEQUAL keeps sprites at the
+    // same depth drawing over each other in stream order.
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+    glClearDepth(1.0);
+    GraphicsView::CheckOpenGLError("after initializing render state");
+
+    this->textureUploader.Initialize(ResourceManager::GetInstance());
+    GraphicsView::CheckOpenGLError("after initializing texture uploads");
 }
 
 void GraphicsView::Update(std::shared_ptr<GraphicsManager> graphicsManager)
 {
-    // Allocate buffers
-    float* vertexBuffer;
-    float* colorBuffer;
-    unsigned short* indexBuffer;
-    vertexBuffer = new float[4 * 4]; // 4 vertices; 4 coordinates per vertex
-    colorBuffer = new float[4 * 4]; // 4 vertices; 4 channels per vertex
-    indexBuffer = new unsigned short[2 * 3]; // 2 triangles; 3 indices per triangle
-    
+    // Evict textures over the memory budget, then upload a little of any
+    // textures that finished decoding
+    std::shared_ptr<ResourceManager> resourceManager = ResourceManager::GetInstance();
+    resourceManager->UpdateTextureResidency();
+    this->textureUploader.Update(resourceManager, this->textureUploadBudget);
+    GraphicsView::CheckOpenGLError("after uploading textures");
+
     // Clear the screen
     Color clearColor = graphicsManager->GetClearColor();
     glClearColor(clearColor.red, clearColor.green, clearColor.blue, clearColor.alpha);
-    glClear(GL_COLOR_BUFFER_BIT);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     GraphicsView::CheckOpenGLError("after clearing the screen");
     
     // Prepare the matrices
@@ -44,31 +59,216 @@ void GraphicsView::Update(std::shared_ptr<GraphicsManager> graphicsManager)
     glOrtho(left, right, bottom, top, -1.0f, 1000.0f);
     GraphicsView::CheckOpenGLError("after preparing matrices");
     
-    glEnableClientState(GL_VERTEX_ARRAY);
-    glVertexPointer(4, GL_FLOAT, 0, vertexBuffer);
-    glEnableClientState(GL_COLOR_ARRAY);
-    glColorPointer(4, GL_FLOAT, 0, colorBuffer);
-    
+    // Gather every sprite, quad source, and cached layer into one batch
+    std::vector<std::shared_ptr<CachedLayer>> layers = graphicsManager->GetCachedLayers();
+    this->updateCachedLayers(layers, graphicsManager);
+    this->vertexStream.Clear();
+    graphicsManager->FillVertexStream(this->vertexStream);
+    this->overlayStream.Clear();
+    this->addCachedLayerQuads(layers);
+
     // Draw sprites
-    graphicsManager->PrepareToAddSprites();
-    while(graphicsManager->AddSpriteToVCIBuffer(vertexBuffer, colorBuffer, indexBuffer, 0))
-    {
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, indexBuffer);
-    }
+    this->drawVertexStream(this->vertexStream);
     GraphicsView::CheckOpenGLError("after drawing sprites");
+
+    // Draw cached layers on top of everything
+    glDisable(GL_DEPTH_TEST);
+    this->drawVertexStream(this->overlayStream);
+    glEnable(GL_DEPTH_TEST);
+    GraphicsView::CheckOpenGLError("after drawing cached layers");
     
     // Swap the buffers
     this->window->display();
     GraphicsView::CheckOpenGLError("after swapping buffers");
     
-    // release buffer memory
-    delete[] vertexBuffer;
-    delete[] colorBuffer;
-    delete[] indexBuffer;
-    
     GraphicsView::CheckOpenGLError("at end of Update()");
 }
 
+void GraphicsView::updateCachedLayers(std::vector<std::shared_ptr<CachedLayer>>& layers, std::shared_ptr<GraphicsManager> graphicsManager)
+{
+    // Forget the targets of layers that were unregistered
+    for (auto it = this->cachedLayerTargets.begin(); it != this->cachedLayerTargets.end();)
+    {
+        if (std::find(layers.begin(), layers.end(), it->first) == layers.end())
+        {
+            it = this->cachedLayerTargets.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    bool renderedAny = false;
+    for (auto it = layers.begin(); it != layers.end(); it++)
+    {
+        std::shared_ptr<CachedLayer> layer = *it;
+        unsigned long revision = layer->GetRevision();
+        auto target = this->cachedLayerTargets.find(layer);
+        if (target != this->cachedLayerTargets.end() && target->second.revision == revision)
+        {
+            layer->RecordFrame(true);
+            continue;
+        }
+
+        if (target == this->cachedLayerTargets.end())
+        {
+            CachedLayerTarget created;
+            created.renderTexture = std::make_shared<sf::RenderTexture>();
+            if (!created.renderTexture->create(layer->GetPixelWidth(), layer->GetPixelHeight(), true))
+            {
+                throw new std::runtime_error("Could not create the render texture for a cached layer.");
+            }
+            created.textureUnit = 0;
+            created.revision = 0;
+            target = this->cachedLayerTargets.insert(std::make_pair(layer, created)).first;
+        }
+
+        // The render texture has its own context, so its state is set up
+        // every time it is drawn into.
+        sf::RenderTexture& renderTexture = *target->second.renderTexture;
+        renderTexture.setActive(true);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LEQUAL);
+        glViewport(0, 0, layer->GetPixelWidth(), layer->GetPixelHeight());
+        glMatrixMode(GL_PROJECTION);
+        glLoadIdentity();
+        glMatrixMode(GL_MODELVIEW);
+        glLoadIdentity();
+        glOrtho(layer->GetX(), layer->GetX() + layer->GetWidth(), layer->GetY() - layer->GetHeight(), layer->GetY(), -1.0f, 1000.0f);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        this->layerStream.Clear();
+        graphicsManager->FillCachedLayerVertexStream(layer, this->layerStream);
+        this->drawVertexStream(this->layerStream);
+        renderTexture.display();
+        GraphicsView::CheckOpenGLError("after rendering a cached layer");
+
+        target->second.revision = revision;
+        layer->RecordFrame(false);
+        renderedAny = true;
+    }
+
+    if (renderedAny)
+    {
+        this->window->setActive(true);
+    }
+
+    // Look up the GL name of any new layer texture in the window's context.
+    // SFML flips render textures with the texture matrix when binding them,
+    // which the layer quads don't want since their coordinates already
+    // follow OpenGL's bottom-up convention.
+    for (auto it = this->cachedLayerTargets.begin(); it != this->cachedLayerTargets.end(); it++)
+    {
+        if (it->second.textureUnit == 0)
+        {
+            GLint textureUnit = 0;
+            sf::Texture::bind(&it->second.renderTexture->getTexture());
+            glGetIntegerv(GL_TEXTURE_BINDING_2D, &textureUnit);
+            it->second.textureUnit = (unsigned int)textureUnit;
+            glMatrixMode(GL_TEXTURE);
+            glLoadIdentity();
+            glMatrixMode(GL_MODELVIEW);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+    }
+}
+
+void GraphicsView::addCachedLayerQuads(std::vector<std::shared_ptr<CachedLayer>>& layers)
+{
+    for (auto it = layers.begin(); it != layers.end(); it++)
+    {
+        std::shared_ptr<CachedLayer> layer = *it;
+        auto target = this->cachedLayerTargets.find(layer);
+        if (target == this->cachedLayerTargets.end())
+        {
+            continue;
+        }
+        this->overlayStream.SetTexture(target->second.textureUnit);
+        unsigned int quad = this->overlayStream.AddQuads(1);
+
+        float left = layer->GetX();
+        float right = left + layer->GetWidth();
+        float top = layer->GetY();
+        float bottom = top - layer->GetHeight();
+        float* vertexData = this->overlayStream.GetVertexData(quad);
+        float corners[8] = {left, top, right, top, right, bottom, left, bottom};
+        for (int corner = 0; corner < 4; corner++)
+        {
+            vertexData[corner * 4] = corners[corner * 2];
+            vertexData[corner * 4 + 1] = corners[corner * 2 + 1];
+            vertexData[corner * 4 + 2] = 0.0f;
+            vertexData[corner * 4 + 3] = 1.0f;
+        }
+
+        // The texture was rendered bottom-up, so its top row is at v = 1
+        float* texCoordData = this->overlayStream.GetTexCoordData(quad);
+        float texCoords[8] = {0.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < 8; i++)
+        {
+            texCoordData[i] = texCoords[i];
+        }
+
+        float* colorData = this->overlayStream.GetColorData(quad);
+        for (int i = 0; i < 16; i++)
+        {
+            colorData[i] = 1.0f;
+        }
+    }
+}
+
+void GraphicsView::drawVertexStream(VertexStream& stream)
+{
+    if (stream.GetQuadCount() == 0)
+    {
+        return;
+    }
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(4, GL_FLOAT, 0, stream.GetVertexData(0));
+    glEnableClientState(GL_COLOR_ARRAY);
+    glColorPointer(4, GL_FLOAT, 0, stream.GetColorData(0));
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glTexCoordPointer(2, GL_FLOAT, 0, stream.GetTexCoordData(0));
+
+    // One draw call per run of quads sharing a texture
+    unsigned int* indexData = stream.GetIndexData();
+    for (unsigned int batch = 0; batch < stream.GetBatchCount(); batch++)
+    {
+        unsigned int textureUnit = stream.GetBatchTexture(batch);
+        if (textureUnit == 0)
+        {
+            glDisable(GL_TEXTURE_2D);
+        }
+        else
+        {
+            glEnable(GL_TEXTURE_2D);
+            glBindTexture(GL_TEXTURE_2D, textureUnit);
+        }
+        if (stream.GetBatchBlended(batch))
+        {
+            glEnable(GL_BLEND);
+            glDepthMask(GL_FALSE);
+        }
+        else
+        {
+            glDisable(GL_BLEND);
+            glDepthMask(GL_TRUE);
+        }
+        unsigned int firstIndex = stream.GetBatchFirstQuad(batch) * VertexStream::INDICES_PER_QUAD;
+        unsigned int indexCount = stream.GetBatchQuadCount(batch) * VertexStream::INDICES_PER_QUAD;
+        glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, indexData + firstIndex);
+    }
+    glDisable(GL_TEXTURE_2D);
+    glEnable(GL_BLEND);
+
+    // The depth buffer can only be cleared while depth writes are enabled
+    glDepthMask(GL_TRUE);
+}
+
 void GraphicsView::CheckOpenGLError(std::string location)
 {
     GLenum error = glGetError();
@@ -2,14 +2,19 @@
 #define Core_GraphicsView_h
 
 #include <SFML/Window.hpp>
+#include <SFML/Graphics/RenderTexture.hpp>
 #include <functional>
 #include <memory>
+#include <map>
 
 #include "ControllerPackage.h"
 #include "GraphicsManager.h"
 #include "Texture.h"
+#include "VertexStream.h"
+#include "TextureUploader.h"
 
 class string;
+class CachedLayer;
 
 /**
  * Provides a full set of logic for displaying graphics.
@@ -48,6 +53,66 @@ private:
      */
     std::shared_ptr<sf::Window> window;
 
+    /**
+     * The batch every sprite and quad source is written into each frame.
+     * Kept between frames so its buffers are only allocated while growing.
+     */
+    VertexStream vertexStream;
+
+    /**
+     * Uploads asynchronously loaded textures, spending at most
+     * textureUploadBudget milliseconds of each frame on it.
+     */
+    TextureUploader textureUploader;
+    double textureUploadBudget;
+
+    /**
+     * The offscreen target a cached layer was last rendered into, and the
+     * revision of the layer at that time.
+     */
+    struct CachedLayerTarget
+    {
+        std::shared_ptr<sf::RenderTexture> renderTexture;
+        unsigned int textureUnit;
+        unsigned long revision;
+    };
+
+    /**
+     * The offscreen targets of every cached layer drawn last frame.
+     */
+    std::map<std::shared_ptr<CachedLayer>, CachedLayerTarget> cachedLayerTargets;
+
+    /**
+     * The batch a cached layer's contents are written into when it has to
+     * be re-rendered.
+     */
+    VertexStream layerStream;
+
+    /**
+     * Re-renders every cached layer whose contents changed since it was last
+     * drawn, and forgets layers that are no longer registered. Leaves the
+     * window's context active.
+     */
+    void updateCachedLayers(std::vector<std::shared_ptr<CachedLayer>>& layers, std::shared_ptr<GraphicsManager> graphicsManager);
+
+    /**
+     * Quads drawn on top of everything else without depth testing: one
+     * textured quad per cached layer.
+     */
+    VertexStream overlayStream;
+
+    /**
+     * Appends one textured quad per cached layer to the overlay stream.
+     */
+    void addCachedLayerQuads(std::vector<std::shared_ptr<CachedLayer>>& layers);
+
+    /**
+     * Draws every batch of the given vertex stream into the active context
+     * with the current matrices. Opaque batches are drawn with blending off
+     * and depth writes on, blended batches the other way around.
+     */
+    void drawVertexStream(VertexStream& stream);
+
     /**
      * Utility function for checking OpenGL errors
      */
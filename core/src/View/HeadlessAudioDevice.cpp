@@ -0,0 +1,79 @@
+#include "HeadlessAudioDevice.h"
+#include <chrono>
+#include <algorithm>
+
+const unsigned int HeadlessAudioDevice::CHUNK_FRAMES;
+
+HeadlessAudioDevice::HeadlessAudioDevice(double speed) : speed(speed), shouldStop(false), renderedFrameCount(0), renderNanoseconds(0)
+{
+    this->chunk.resize(HeadlessAudioDevice::CHUNK_FRAMES * SoundMixer::CHANNEL_COUNT);
+}
+
+HeadlessAudioDevice::~HeadlessAudioDevice()
+{
+    this->Stop();
+}
+
+void HeadlessAudioDevice::Start(SoundMixer& mixer)
+{
+    this->Stop();
+    this->shouldStop = false;
+    this->thread = std::thread(&HeadlessAudioDevice::renderLoop, this, &mixer);
+}
+
+void HeadlessAudioDevice::Stop()
+{
+    if (this->thread.joinable())
+    {
+        this->shouldStop = true;
+        this->thread.join();
+    }
+}
+
+void HeadlessAudioDevice::Pump(SoundMixer& mixer, unsigned int frameCount)
+{
+    while (frameCount > 0)
+    {
+        unsigned int frames = std::min(frameCount, HeadlessAudioDevice::CHUNK_FRAMES);
+        this->renderChunk(mixer, frames);
+        frameCount -= frames;
+    }
+}
+
+unsigned long long HeadlessAudioDevice::GetRenderedFrameCount()
+{
+    return this->renderedFrameCount.load();
+}
+
+double HeadlessAudioDevice::GetRenderSeconds()
+{
+    return this->renderNanoseconds.load() / 1e9;
+}
+
+void HeadlessAudioDevice::renderLoop(SoundMixer* mixer)
+{
+    // Chunks are scheduled against the start time, so sleeping late doesn't
+    // make the device drift behind
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    unsigned long long frames = 0;
+    while (!this->shouldStop)
+    {
+        this->renderChunk(*mixer, HeadlessAudioDevice::CHUNK_FRAMES);
+        frames += HeadlessAudioDevice::CHUNK_FRAMES;
+        if (this->speed > 0.0)
+        {
+            std::chrono::duration<double> due(frames / (SoundMixer::SAMPLE_RATE * this->speed));
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(due));
+        }
+    }
+}
+
+void HeadlessAudioDevice::renderChunk(SoundMixer& mixer, unsigned int frameCount)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    mixer.Render(this->chunk.data(), frameCount);
+    std::chrono::nanoseconds elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    this->renderNanoseconds += elapsed.count();
+    this->renderedFrameCount += frameCount;
+    this->consume(this->chunk.data(), frameCount);
+}
@@ -0,0 +1,92 @@
+#ifndef Core_HeadlessAudioDevice_h
+#define Core_HeadlessAudioDevice_h
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include "AudioDevice.h"
+#include "SoundMixer.h"
+
+/**
+ * Base for devices that render the mix without audio hardware.
+ *
+ * Started, the device renders the mix a chunk at a time on a thread of its
+ * own and hands each chunk to consume. At a speed of 1 it paces itself to
+ * real time like a sound card; at 2 it runs twice as fast, and at 0 as fast
+ * as the mixer can go, which is what benchmarks want.
+ *
+ * Alternatively, without starting it, Pump renders a given number of frames
+ * on the calling thread, so a test can advance audio deterministically.
+ */
+class HeadlessAudioDevice : public AudioDevice
+{
+public:
+    /**
+     * Frames rendered at a time.
+     */
+    static const unsigned int CHUNK_FRAMES = 512;
+
+    /**
+     * Creates a device rendering at the given multiple of real time, or as
+     * fast as possible if it's 0.
+     */
+    HeadlessAudioDevice(double speed);
+
+    /**
+     * Subclasses must call Stop in their own destructor, so consume isn't
+     * called on a partly destroyed device.
+     */
+    virtual ~HeadlessAudioDevice();
+
+    virtual void Start(SoundMixer& mixer);
+    virtual void Stop();
+
+    /**
+     * Renders the given number of frames from the given mixer on the calling
+     * thread. Only use while the device isn't started.
+     */
+    void Pump(SoundMixer& mixer, unsigned int frameCount);
+
+    /**
+     * Obtains the number of frames rendered so far.
+     */
+    unsigned long long GetRenderedFrameCount();
+
+    /**
+     * Obtains the time spent in the mixer so far, in seconds, to compare with
+     * the audio time rendered.
+     */
+    double GetRenderSeconds();
+
+protected:
+    /**
+     * Does whatever the device does with a chunk of rendered interleaved
+     * stereo samples. Called on the device's thread, or from Pump.
+     */
+    virtual void consume(const float* samples, unsigned int frameCount) = 0;
+
+private:
+    // Private constructors to disallow access.
+    HeadlessAudioDevice(HeadlessAudioDevice const &other);
+    HeadlessAudioDevice operator=(HeadlessAudioDevice other);
+
+    /**
+     * The loop run by the device's thread.
+     */
+    void renderLoop(SoundMixer* mixer);
+
+    /**
+     * Renders and consumes one chunk.
+     */
+    void renderChunk(SoundMixer& mixer, unsigned int frameCount);
+
+    double speed;
+    std::thread thread;
+    std::atomic<bool> shouldStop;
+    std::vector<float> chunk;
+    std::atomic<unsigned long long> renderedFrameCount;
+    std::atomic<unsigned long long> renderNanoseconds;
+};
+
+#endif
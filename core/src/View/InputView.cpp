@@ -10,13 +10,12 @@
 #include "MouseButtonReleaseEvent.h"
 #include "MouseButton.h"
 #include "KeyboardKey.h"
+#include "QueuedInputEvent.h"
 #include <assert.h>
 #include <set>
 #include <vector>
 
-sf::Vector2i MOUSE_ORIGIN = sf::Vector2i(0, 0);
-
-InputView::InputView(std::shared_ptr<sf::Window> window)
+InputView::InputView(std::shared_ptr<sf::Window> window) : hasFocus(true), relativeMotion(window)
 {
     this->window = window;
     this->inputManager = nullptr;
@@ -25,24 +24,31 @@ InputView::InputView(std::shared_ptr<sf::Window> window)
 void InputView::Initialize()
 {
     this->SetMouseInputMode(MouseInputMode::SHOW);
+    this->appliedMouseInputMode = MouseInputMode::SHOW;
+    this->window->setMouseCursorVisible(true);
 }
 
 void InputView::Update(std::shared_ptr<InputManager> inputManager)
 {
+    if (inputManager != this->inputManager && inputManager != nullptr)
+    {
+        // A new manager hasn't seen the cursor move yet
+        sf::Vector2i position = sf::Mouse::getPosition(*(this->window));
+        QueuedInputEvent nativeEvent = QueuedInputEvent();
+        nativeEvent.type = QueuedInputEventType::MOUSE_MOVE;
+        nativeEvent.x = position.x;
+        nativeEvent.y = position.y;
+        nativeEvent.time = std::chrono::steady_clock::now();
+        inputManager->QueueEvent(nativeEvent);
+    }
     this->inputManager = inputManager;
+    this->applyMouseInputMode();
+    this->queueRelativeMotion();
 }
 
 void InputView::SetMouseInputMode(MouseInputMode mode)
 {
     this->mouseInputMode = mode;
-    if (mode == MouseInputMode::SHOW)
-    {
-        this->window->setMouseCursorVisible(true);
-    }
-    else
-    {
-        this->window->setMouseCursorVisible(false);
-    }
 }
 
 MouseInputMode InputView::GetMouseInputMode()
@@ -68,6 +74,14 @@ void InputView::OnSfmlEvent(sf::Event event)
     {
         onSfmlMouseMoved(event.mouseMove);
     }
+    else if (event.type == sf::Event::MouseButtonPressed)
+    {
+        onSfmlMouseButtonPressed(event.mouseButton);
+    }
+    else if (event.type == sf::Event::MouseButtonReleased)
+    {
+        onSfmlMouseButtonReleased(event.mouseButton);
+    }
     else if (event.type == sf::Event::JoystickButtonPressed)
     {
         onSfmlJoystickButtonPressed(event.joystickButton);
@@ -88,18 +102,64 @@ void InputView::OnSfmlEvent(sf::Event event)
     {
         onSfmlTextEntered(event.text);
     }
+    else if (event.type == sf::Event::LostFocus)
+    {
+        onSfmlLostFocus();
+    }
+    else if (event.type == sf::Event::GainedFocus)
+    {
+        onSfmlGainedFocus();
+    }
+}
+
+void InputView::applyMouseInputMode()
+{
+    MouseInputMode mode = this->mouseInputMode;
+    if (mode != this->appliedMouseInputMode)
+    {
+        this->window->setMouseCursorVisible(mode == MouseInputMode::SHOW);
+        this->appliedMouseInputMode = mode;
+    }
+
+    // Another window has the cursor while this one is unfocused
+    bool lock = mode == MouseInputMode::HIDE_AND_LOCK && this->hasFocus;
+    if (lock && !this->relativeMotion.IsStarted())
+    {
+        this->relativeMotion.Start();
+    }
+    else if (!lock && this->relativeMotion.IsStarted())
+    {
+        this->relativeMotion.Stop();
+    }
+}
+
+void InputView::queueRelativeMotion()
+{
+    if (inputManager == nullptr || !this->relativeMotion.IsStarted())
+    {
+        return;
+    }
+    sf::Vector2i motion = this->relativeMotion.Poll();
+    if (motion.x != 0 || motion.y != 0)
+    {
+        QueuedInputEvent nativeEvent = QueuedInputEvent();
+        nativeEvent.type = QueuedInputEventType::MOUSE_RELATIVE_MOVE;
+        nativeEvent.x = motion.x;
+        nativeEvent.y = motion.y;
+        nativeEvent.time = std::chrono::steady_clock::now();
+        this->inputManager->QueueEvent(nativeEvent);
+    }
 }
 
 void InputView::onSfmlKeyPressed(sf::Event::KeyEvent event)
 {
     if (inputManager != nullptr) 
     {
-        KeyboardKey key = InputView::nativeKeyboardKey(event.code);
-        if (inputManager->IsRegisteredEventHandler(key))
-        {
-            KeyboardKeyPressEvent nativeEvent(key);
-            this->inputManager->OnKeyboardKeyPress(nativeEvent);
-        }
+        QueuedInputEvent nativeEvent = QueuedInputEvent();
+        nativeEvent.type = QueuedInputEventType::KEYBOARD_KEY_PRESS;
+        nativeEvent.key = InputView::nativeKeyboardKey(event.code);
+        nativeEvent.time = std::chrono::steady_clock::now();
+        this->inputManager->QueueEvent(nativeEvent);
     }
 }
 
@@ -107,12 +167,11 @@ void InputView::onSfmlKeyReleased(sf::Event::KeyEvent event)
 {
     if (inputManager != nullptr) 
     {
-        KeyboardKey key = InputView::nativeKeyboardKey(event.code);
-        if (inputManager->IsRegisteredEventHandler(key))
-        {
-            KeyboardKeyReleaseEvent event (key);
-            this->inputManager->OnKeyboardKeyRelease(event);
-        }
+        QueuedInputEvent nativeEvent = QueuedInputEvent();
+        nativeEvent.type = QueuedInputEventType::KEYBOARD_KEY_RELEASE;
+        nativeEvent.key = InputView::nativeKeyboardKey(event.code);
+        nativeEvent.time = std::chrono::steady_clock::now();
+        this->inputManager->QueueEvent(nativeEvent);
     }
 }
 
@@ -125,9 +184,13 @@ void InputView::onSfmlMouseButtonPressed(sf::Event::MouseButtonEvent event)
 {
     if (inputManager != nullptr) 
     {
-        MouseButton button = InputView::nativeMouseButton(event.button);
-        MouseButtonPressEvent nativeEvent(event.x, event.y, button);
-        this->inputManager->OnMouseButtonPress(nativeEvent);
+        QueuedInputEvent nativeEvent = QueuedInputEvent();
+        nativeEvent.type = QueuedInputEventType::MOUSE_BUTTON_PRESS;
+        nativeEvent.button = InputView::nativeMouseButton(event.button);
+        nativeEvent.x = event.x;
+        nativeEvent.y = event.y;
+        nativeEvent.time = std::chrono::steady_clock::now();
+        this->inputManager->QueueEvent(nativeEvent);
     }
 }
 
@@ -135,25 +198,48 @@ void InputView::onSfmlMouseButtonReleased(sf::Event::MouseButtonEvent event)
 {
     if (inputManager != nullptr)
     {
-        MouseButton button = InputView::nativeMouseButton(event.button);
-        MouseButtonReleaseEvent nativeEvent(event.x, event.y, button);
-        this->inputManager->OnMouseButtonRelease(nativeEvent);
+        QueuedInputEvent nativeEvent = QueuedInputEvent();
+        nativeEvent.type = QueuedInputEventType::MOUSE_BUTTON_RELEASE;
+        nativeEvent.button = InputView::nativeMouseButton(event.button);
+        nativeEvent.x = event.x;
+        nativeEvent.y = event.y;
+        nativeEvent.time = std::chrono::steady_clock::now();
+        this->inputManager->QueueEvent(nativeEvent);
     }
 }
 
 void InputView::onSfmlMouseMoved(sf::Event::MouseMoveEvent event)
 {
-    if (inputManager != nullptr)
+    // A locked cursor's position means nothing, and the moves back to the
+    // middle of the window aren't the player's; queueRelativeMotion reports
+    // the motion instead, once per frame
+    if (inputManager != nullptr && !this->relativeMotion.IsStarted())
     {
-        MouseEvent nativeEvent(event.x, event.y);
-        this->inputManager->OnMouseInput(nativeEvent);
+        QueuedInputEvent nativeEvent = QueuedInputEvent();
+        nativeEvent.type = QueuedInputEventType::MOUSE_MOVE;
+        nativeEvent.x = event.x;
+        nativeEvent.y = event.y;
+        nativeEvent.time = std::chrono::steady_clock::now();
+        this->inputManager->QueueEvent(nativeEvent);
+    }
+}
+
+void InputView::onSfmlGainedFocus()
+{
+    this->hasFocus = true;
+}
+
+void InputView::onSfmlLostFocus()
+{
+    this->hasFocus = false;
 
-        // Dirty, evil hack to lock the cursor. SFML is working on a native cursor locking
-        // feature beyond SFML 2.2, but for now we have to reset the cursor position manually.
-        if (this->mouseInputMode == MouseInputMode::HIDE_AND_LOCK) 
-        {
-            sf::Mouse::setPosition(MOUSE_ORIGIN, *(this->window));
-        }
+    // Keys and buttons released while unfocused never send release events
+    if (inputManager != nullptr)
+    {
+        QueuedInputEvent nativeEvent = QueuedInputEvent();
+        nativeEvent.type = QueuedInputEventType::FOCUS_LOST;
+        nativeEvent.time = std::chrono::steady_clock::now();
+        this->inputManager->QueueEvent(nativeEvent);
     }
 }
 
@@ -214,13 +300,13 @@ InputState InputView::GetMouseButtonState(MouseButton button)
 
 int InputView::GetMouseX()
 {
-    sf::Vector2i position = sf::Mouse::getPosition();
+    sf::Vector2i position = sf::Mouse::getPosition(*(this->window));
     return position.x;
 }
 
 int InputView::GetMouseY()
 {
-    sf::Vector2i position = sf::Mouse::getPosition();
+    sf::Vector2i position = sf::Mouse::getPosition(*(this->window));
     return position.y;
 }
 
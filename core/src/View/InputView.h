@@ -2,8 +2,10 @@
 #define Core_InputView_h
 
 #include "SFML/Window.hpp"
+#include "RelativeMouseMotion.h"
 #include <set>
 #include <memory>
+#include <atomic>
 
 class InputManager;
 enum class InputState;
@@ -29,7 +31,9 @@ public:
     /**
      * Updates the InputView.
      * @param inputManager InputManager which will receive update information. 
-     * This InputManager will also receive all input events until the next time this function is called.
+     * This InputManager will also receive all input events until the next time this function is called,
+     * queued for it to dispatch on the game thread. While the cursor is locked, the mouse's motion since the
+     * previous call is queued as a single relative motion event.
      */
     void Update(std::shared_ptr<InputManager> inputManager);
 
@@ -70,7 +74,8 @@ public:
      * @param mode one of the following: 
      * * MouseInputMode::SHOW to set the mouse cursor behavior to default (operating system cursor is visible and cursor may freely move between this game window and other windows.
      * * MouseInputMode::HIDE to set the mouse cursor behavior to hidden and unlocked (operating system cursor is not visible within the game window and cursor may freely move between the game window and other windows. This behavior is desirable for menus which draw their own cursor sprite.
-     * * MouseInputMode::HIDE_AND_LOCK to set the mouse cursor behavior to hidden and locked (operating system cursor is not visible within the game window and the cursor is locked to the game window. This behavior is desirable for games which use the mouse in a direct manner, such as for controlling a camera.
+     * * MouseInputMode::HIDE_AND_LOCK to set the mouse cursor behavior to hidden and locked (operating system cursor is not visible within the game window and the cursor is locked to the game window. This behavior is desirable for games which use the mouse in a direct manner, such as for controlling a camera. The cursor's position isn't reported while locked; the mouse's motion is reported as relative motion instead.
+     * May be called from any thread; the mode takes effect on the next Update.
      */
     void SetMouseInputMode(MouseInputMode mode);
 
@@ -85,93 +90,118 @@ private:
     InputView(InputView const &other);
     InputView operator=(InputView other);
 
-    // SFML mouse origin, used for cursor lock hack
-    const sf::Vector2i MOUSE_ORIGIN;
-
     // Game window
     std::shared_ptr<sf::Window> window;
 
     // InputManager which receives input events.
     std::shared_ptr<InputManager> inputManager;
 
-    // Mouse input mode state
-    MouseInputMode mouseInputMode;
+    // Mouse input mode state, as requested and as last applied to the window
+    std::atomic<MouseInputMode> mouseInputMode;
+    MouseInputMode appliedMouseInputMode;
+
+    // Whether the window has focus. The cursor is only locked while it does
+    bool hasFocus;
+
+    // Measures the mouse's motion while the cursor is locked
+    RelativeMouseMotion relativeMotion;
+
+    /**
+     * Applies the requested mouse input mode to the window, locking or unlocking the cursor as needed.
+     */
+    void applyMouseInputMode();
 
     /**
-     * Helper method which handles SFML keyboard key press events. Fires a native engine event to the current InputManger.
+     * Queues the mouse's motion since the previous frame on the current InputManager, if the cursor is locked.
+     */
+    void queueRelativeMotion();
+
+    /**
+     * Helper method which handles SFML keyboard key press events. Queues a native engine event on the current InputManger.
      * @param event An SFML event to handle.
      */
     void onSfmlKeyPressed(sf::Event::KeyEvent event);
 
     /**
-     * Helper method which handles SFML keyboard key release events. Fires a native engine event to the current InputManger.
+     * Helper method which handles SFML keyboard key release events. Queues a native engine event on the current InputManger.
      * @param event An SFML event to handle.
      */
     void onSfmlKeyReleased(sf::Event::KeyEvent event);
 
     /**
      * NOT IMPLEMENTED
-     * Helper method which handles SFML mouse wheel events. Fires a native engine event to the current InputManger.
+     * Helper method which handles SFML mouse wheel events. Queues a native engine event on the current InputManger.
      * @param event An SFML event to handle.
      */
     void onSfmlMouseWheelMoved(sf::Event::MouseWheelEvent event);
 
     /**
-     * Helper method which handles SFML mouse button press events. Fires a native engine event to the current InputManger.
+     * Helper method which handles SFML mouse button press events. Queues a native engine event on the current InputManger.
      * @param event An SFML event to handle.
      */
     void onSfmlMouseButtonPressed(sf::Event::MouseButtonEvent event);
 
     /**
-     * Helper method which handles SFML mouse button release events. Fires a native engine event to the current InputManger.
+     * Helper method which handles SFML mouse button release events. Queues a native engine event on the current InputManger.
      * @param event An SFML event to handle.
      */
     void onSfmlMouseButtonReleased(sf::Event::MouseButtonEvent event);
 
     /**
-     * Helper method which handles SFML mouse cursor motion events. Fires a native engine event to the current InputManger.
+     * Helper method which handles SFML mouse cursor motion events. Queues a native engine event on the current InputManger.
      * @param event An SFML event to handle.
      */
     void onSfmlMouseMoved(sf::Event::MouseMoveEvent event);
 
+    /**
+     * Helper method which handles SFML focus loss events. Queues an event on the current InputManger releasing every
+     * key and button.
+     */
+    void onSfmlLostFocus();
+
+    /**
+     * Helper method which handles SFML focus gain events.
+     */
+    void onSfmlGainedFocus();
+
     /**
      * NOT IMPLEMENTED
-     * Helper method which handles SFML joystick button press events. Fires a native engine event to the current InputManger.
+     * Helper method which handles SFML joystick button press events. Queues a native engine event on the current InputManger.
      * @param event An SFML event to handle.
      */
     void onSfmlJoystickButtonPressed(sf::Event::JoystickButtonEvent event);
 
     /**
      * NOT IMPLEMENTED
-     * Helper method which handles SFML joystick button release events. Fires a native engine event to the current InputManger.
+     * Helper method which handles SFML joystick button release events. Queues a native engine event on the current InputManger.
      * @param event An SFML event to handle.
      */
     void onSfmlJoystickButtonReleased(sf::Event::JoystickButtonEvent event);
 
     /**
      * NOT IMPLEMENTED
-     * Helper method which handles SFML joystick axis motion events. Fires a native engine event to the current InputManger.
+     * Helper method which handles SFML joystick axis motion events. Queues a native engine event on the current InputManger.
      * @param event An SFML event to handle.
      */
     void onSfmlJoystickMoved(sf::Event::JoystickMoveEvent event);
 
     /**
      * NOT IMPLEMENTED
-     * Helper method which handles SFML joystick connect events. Fires a native engine event to the current InputManger.
+     * Helper method which handles SFML joystick connect events. Queues a native engine event on the current InputManger.
      * @param event An SFML event to handle.
      */
     void onSfmlJoystickConnected(sf::Event::JoystickConnectEvent event);
 
     /**
      * NOT IMPLEMENTED
-     * Helper method which handles SFML joystick disconnect events. Fires a native engine event to the current InputManger.
+     * Helper method which handles SFML joystick disconnect events. Queues a native engine event on the current InputManger.
      * @param event An SFML event to handle.
      */
     void onSfmlJoystickDisconnected(sf::Event::JoystickConnectEvent event);
     
     /**
      * NOT IMPLEMENTED
-     * Helper method which handles SFML text entry events. Fires a native engine event to the current InputManger.
+     * Helper method which handles SFML text entry events. Queues a native engine event on the current InputManger.
      * @param event An SFML event to handle.
      */
     void onSfmlTextEntered(sf::Event::TextEvent event);
@@ -0,0 +1,24 @@
+#ifndef Core_MixerSource_h
+#define Core_MixerSource_h
+
+/**
+ * Interface for streamed audio the SoundMixer mixes alongside its voices,
+ * such as music.
+ *
+ * Sources are added to the mixer while they're playing, and called on
+ * whatever thread renders the mix, with the mixer locked.
+ */
+class MixerSource
+{
+public:
+    virtual ~MixerSource() {}
+
+    /**
+     * Adds the source's next frames to the given interleaved stereo output.
+     * Returns false once the source has nothing more to play, which removes
+     * it from the mixer.
+     */
+    virtual bool Mix(float* output, unsigned int frameCount) = 0;
+};
+
+#endif
@@ -0,0 +1,33 @@
+#include "MixerStream.h"
+
+const unsigned int MixerStream::CHUNK_FRAMES;
+
+MixerStream::MixerStream(SoundMixer& mixer) : mixer(mixer)
+{
+    this->mixed.resize(MixerStream::CHUNK_FRAMES * SoundMixer::CHANNEL_COUNT);
+    this->samples.resize(MixerStream::CHUNK_FRAMES * SoundMixer::CHANNEL_COUNT);
+    this->initialize(SoundMixer::CHANNEL_COUNT, SoundMixer::SAMPLE_RATE);
+}
+
+MixerStream::~MixerStream()
+{
+    this->stop();
+}
+
+bool MixerStream::onGetData(Chunk& data)
+{
+    this->mixer.Render(this->mixed.data(), MixerStream::CHUNK_FRAMES);
+
+    // The mixer has already limited the mix to [-1, 1]
+    for (size_t i = 0; i < this->mixed.size(); i++)
+    {
+        this->samples[i] = (sf::Int16)(this->mixed[i] * 32767.0f);
+    }
+    data.samples = this->samples.data();
+    data.sampleCount = this->samples.size();
+    return true;
+}
+
+void MixerStream::onSeek(sf::Time /* timeOffset */)
+{
+}
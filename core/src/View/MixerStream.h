@@ -0,0 +1,56 @@
+#ifndef Core_MixerStream_h
+#define Core_MixerStream_h
+
+#include <vector>
+#include <SFML/Audio/SoundStream.hpp>
+#include "SoundMixer.h"
+
+/**
+ * Plays a SoundMixer's output through a single SFML sound stream, and so a
+ * single OpenAL source however many voices are mixed.
+ *
+ * SFML asks for data from its own streaming thread, so the mixer renders on
+ * that thread.
+ */
+class MixerStream : public sf::SoundStream
+{
+public:
+    /**
+     * Frames rendered each time SFML asks for data. SFML queues three chunks,
+     * so this sets the stream's latency.
+     */
+    static const unsigned int CHUNK_FRAMES = 512;
+
+    /**
+     * Creates a stream playing the given mixer, which must outlive it.
+     */
+    MixerStream(SoundMixer& mixer);
+
+    /**
+     * Stops the stream, so SFML's thread stops rendering before the stream
+     * is destroyed.
+     */
+    ~MixerStream();
+
+protected:
+    /**
+     * Renders the next chunk of the mix.
+     */
+    virtual bool onGetData(Chunk& data);
+
+    /**
+     * Does nothing; the mix has no position to seek to.
+     */
+    virtual void onSeek(sf::Time timeOffset);
+
+private:
+    // Private constructors to disallow access.
+    MixerStream(MixerStream const &other);
+    MixerStream operator=(MixerStream other);
+
+    SoundMixer& mixer;
+    std::vector<float> mixed;
+    std::vector<sf::Int16> samples;
+};
+
+#endif
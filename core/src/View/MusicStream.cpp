@@ -0,0 +1,255 @@
+#include "MusicStream.h"
+#include "SoundMixer.h"
+#include "WorkerPool.h"
+#include <cmath>
+#include <algorithm>
+
+const float MusicStream::DEFAULT_BUFFER_SECONDS = 2.0f;
+
+MusicStream::MusicStream(float bufferSeconds) : channelCount(0), sampleRate(0), loop(false), decodeQueued(false), pendingOffset(0),
+    resamplePosition(0.0), decodedSinceRewind(false), reachedEnd(false), readFrame(0), writeFrame(0), decodedToEnd(false),
+    finished(false), gain(1.0f), targetGain(1.0f), gainStep(0.0f), pauseWhenSilent(false), underrunCount(0),
+    underrunFrameCount(0), decodedFrameCount(0)
+{
+    this->ringFrames = std::max(1u, (unsigned int)(bufferSeconds * SoundMixer::SAMPLE_RATE));
+    this->ring.resize(this->ringFrames * SoundMixer::CHANNEL_COUNT);
+    this->previousFrame[0] = 0.0f;
+    this->previousFrame[1] = 0.0f;
+}
+
+bool MusicStream::OpenFromFile(const std::string& fileName)
+{
+    return this->finishOpening(this->decoder.openFromFile(fileName));
+}
+
+bool MusicStream::OpenFromAsset(const AssetPack::Asset& asset)
+{
+    this->asset = asset;
+    return this->finishOpening(this->decoder.openFromMemory(asset.data, asset.size));
+}
+
+bool MusicStream::OpenFromStream(std::shared_ptr<sf::InputStream> stream)
+{
+    this->inputStream = stream;
+    return this->finishOpening(this->decoder.openFromStream(*stream));
+}
+
+bool MusicStream::finishOpening(bool opened)
+{
+    if (!opened || this->decoder.getChannelCount() == 0)
+    {
+        return false;
+    }
+    this->channelCount = this->decoder.getChannelCount();
+    this->sampleRate = this->decoder.getSampleRate();
+    return true;
+}
+
+void MusicStream::SetLoop(bool loop)
+{
+    this->loop = loop;
+}
+
+void MusicStream::Rewind()
+{
+    std::lock_guard<std::mutex> lock(this->decodeMutex);
+    this->decoder.Rewind();
+    this->pending.clear();
+    this->pendingOffset = 0;
+    this->resamplePosition = 0.0;
+    this->decodedSinceRewind = false;
+    this->reachedEnd = false;
+    this->readFrame = 0;
+    this->writeFrame = 0;
+    this->decodedToEnd = false;
+    this->finished = false;
+}
+
+void MusicStream::FadeTo(float gain, float seconds, bool pauseWhenSilent)
+{
+    std::lock_guard<std::mutex> lock(this->fadeMutex);
+    this->targetGain = gain;
+    this->pauseWhenSilent = pauseWhenSilent;
+    float frames = seconds * SoundMixer::SAMPLE_RATE;
+    if (frames < 1.0f)
+    {
+        this->gain = gain;
+        this->gainStep = 0.0f;
+    }
+    else
+    {
+        this->gainStep = std::fabs(gain - this->gain) / frames;
+    }
+}
+
+bool MusicStream::IsFinished()
+{
+    return this->finished;
+}
+
+void MusicStream::RequestDecode()
+{
+    if (this->decodedToEnd || this->channelCount == 0)
+    {
+        return;
+    }
+    size_t buffered = this->writeFrame.load() - this->readFrame.load();
+    if (buffered > this->ringFrames / 2 || this->decodeQueued.exchange(true))
+    {
+        return;
+    }
+    std::shared_ptr<MusicStream> stream = this->shared_from_this();
+    WorkerPool::GetInstance()->Submit([stream]()
+    {
+        stream->Decode();
+    });
+}
+
+void MusicStream::Decode()
+{
+    std::lock_guard<std::mutex> lock(this->decodeMutex);
+    while (this->channelCount != 0 && this->writePending())
+    {
+        if (this->reachedEnd)
+        {
+            this->decodedToEnd.store(true, std::memory_order_release);
+            break;
+        }
+
+        sf::SoundStream::Chunk chunk;
+        bool more = this->decoder.ReadChunk(chunk);
+        this->convert(chunk.samples, chunk.sampleCount);
+        if (chunk.sampleCount > 0)
+        {
+            this->decodedSinceRewind = true;
+        }
+        if (!more)
+        {
+            // An empty file would otherwise loop forever
+            if (this->loop && this->decodedSinceRewind)
+            {
+                this->decoder.Rewind();
+                this->decodedSinceRewind = false;
+            }
+            else
+            {
+                this->reachedEnd = true;
+            }
+        }
+    }
+    this->decodeQueued = false;
+}
+
+MusicStream::Stats MusicStream::GetStats()
+{
+    Stats stats;
+    stats.underrunCount = this->underrunCount.load();
+    stats.underrunFrameCount = this->underrunFrameCount.load();
+    stats.decodedFrameCount = this->decodedFrameCount.load();
+    return stats;
+}
+
+bool MusicStream::Mix(float* output, unsigned int frameCount)
+{
+    // Checked before the ring, so every frame is visible once it's set
+    bool ended = this->decodedToEnd.load(std::memory_order_acquire);
+    size_t read = this->readFrame.load(std::memory_order_relaxed);
+    size_t available = this->writeFrame.load(std::memory_order_acquire) - read;
+    unsigned int frames = (unsigned int)std::min<size_t>(frameCount, available);
+    if (frames < frameCount && !ended)
+    {
+        this->underrunCount++;
+        this->underrunFrameCount += frameCount - frames;
+    }
+
+    std::lock_guard<std::mutex> lock(this->fadeMutex);
+    for (unsigned int i = 0; i < frames; i++)
+    {
+        if (this->gain < this->targetGain)
+        {
+            this->gain = std::min(this->gain + this->gainStep, this->targetGain);
+        }
+        else if (this->gain > this->targetGain)
+        {
+            this->gain = std::max(this->gain - this->gainStep, this->targetGain);
+        }
+        const float* frame = &this->ring[((read + i) % this->ringFrames) * SoundMixer::CHANNEL_COUNT];
+        output[i * 2] += frame[0] * this->gain;
+        output[i * 2 + 1] += frame[1] * this->gain;
+    }
+    this->readFrame.store(read + frames, std::memory_order_release);
+
+    if (ended && frames == available)
+    {
+        this->finished = true;
+        return false;
+    }
+    return !(this->pauseWhenSilent && this->gain == 0.0f && this->targetGain == 0.0f);
+}
+
+void MusicStream::convert(const sf::Int16* samples, size_t sampleCount)
+{
+    size_t frames = sampleCount / this->channelCount;
+    if (frames == 0)
+    {
+        return;
+    }
+    unsigned int right = std::min(this->channelCount, 2u) - 1;
+    size_t start = this->pending.size();
+
+    if (this->sampleRate == SoundMixer::SAMPLE_RATE)
+    {
+        for (size_t frame = 0; frame < frames; frame++)
+        {
+            this->pending.push_back(samples[frame * this->channelCount] / 32768.0f);
+            this->pending.push_back(samples[frame * this->channelCount + right] / 32768.0f);
+        }
+    }
+    else
+    {
+        // Linear interpolation, where a position below 0 lies between the
+        // previous chunk's last frame and this chunk's first
+        double step = (double)this->sampleRate / SoundMixer::SAMPLE_RATE;
+        double position = this->resamplePosition;
+        while (position + 1.0 < frames)
+        {
+            long index = (long)std::floor(position);
+            float fraction = (float)(position - index);
+            for (unsigned int channel = 0; channel < 2; channel++)
+            {
+                unsigned int offset = channel == 0 ? 0 : right;
+                float from = index < 0 ? this->previousFrame[channel] : samples[index * this->channelCount + offset] / 32768.0f;
+                float to = samples[(index + 1) * this->channelCount + offset] / 32768.0f;
+                this->pending.push_back(from + (to - from) * fraction);
+            }
+            position += step;
+        }
+        this->resamplePosition = position - frames;
+        this->previousFrame[0] = samples[(frames - 1) * this->channelCount] / 32768.0f;
+        this->previousFrame[1] = samples[(frames - 1) * this->channelCount + right] / 32768.0f;
+    }
+    this->decodedFrameCount += (this->pending.size() - start) / 2;
+}
+
+bool MusicStream::writePending()
+{
+    size_t pendingFrames = (this->pending.size() - this->pendingOffset) / 2;
+    size_t write = this->writeFrame.load(std::memory_order_relaxed);
+    size_t space = this->ringFrames - (write - this->readFrame.load(std::memory_order_acquire));
+    size_t frames = std::min(pendingFrames, space);
+    for (size_t i = 0; i < frames; i++)
+    {
+        float* frame = &this->ring[((write + i) % this->ringFrames) * SoundMixer::CHANNEL_COUNT];
+        frame[0] = this->pending[this->pendingOffset + i * 2];
+        frame[1] = this->pending[this->pendingOffset + i * 2 + 1];
+    }
+    this->writeFrame.store(write + frames, std::memory_order_release);
+    this->pendingOffset += frames * 2;
+    if (this->pendingOffset < this->pending.size())
+    {
+        return false;
+    }
+    this->pending.clear();
+    this->pendingOffset = 0;
+    return true;
+}
@@ -0,0 +1,206 @@
+#ifndef Core_MusicStream_h
+#define Core_MusicStream_h
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <SFML/Audio/Music.hpp>
+#include <SFML/System/InputStream.hpp>
+#include "MixerSource.h"
+#include "AssetPack.h"
+
+/**
+ * A piece of music streamed into the SoundMixer.
+ *
+ * The music is decoded ahead of playback into a ring buffer, on the
+ * WorkerPool, so reading the file never happens on the thread rendering
+ * the mix. RequestDecode, called every view update, queues a refill once
+ * half the ring has been played. If the ring runs dry anyway, the missing
+ * frames are played as silence and counted as an underrun.
+ *
+ * The ring holds stereo frames at the mixer's sample rate; music at other
+ * rates is resampled as it's decoded. Looping rewinds the decoder as soon
+ * as it reaches the end, so loops are gapless, and fades are applied per
+ * frame, so a crossfade between two streams mixed in the same block has no
+ * gap either.
+ *
+ * The music can be opened from a file, from an asset pack's mapped memory,
+ * or from any sf::InputStream.
+ */
+class MusicStream : public MixerSource, public std::enable_shared_from_this<MusicStream>
+{
+public:
+    /**
+     * Counters describing how well decoding kept ahead of playback.
+     */
+    struct Stats
+    {
+        unsigned long long underrunCount;
+        unsigned long long underrunFrameCount;
+        unsigned long long decodedFrameCount;
+    };
+
+    /**
+     * How much music is decoded ahead unless set otherwise.
+     */
+    static const float DEFAULT_BUFFER_SECONDS;
+
+    /**
+     * Creates a stream decoding the given number of seconds ahead.
+     */
+    MusicStream(float bufferSeconds);
+
+    /**
+     * Opens the given file, returning false if it can't be decoded.
+     */
+    bool OpenFromFile(const std::string& fileName);
+
+    /**
+     * Opens the given packed file, which the stream keeps mapped, returning
+     * false if it can't be decoded.
+     */
+    bool OpenFromAsset(const AssetPack::Asset& asset);
+
+    /**
+     * Opens the given stream, which the stream keeps, returning false if it
+     * can't be decoded.
+     */
+    bool OpenFromStream(std::shared_ptr<sf::InputStream> stream);
+
+    /**
+     * Sets whether the music starts over once it ends.
+     */
+    void SetLoop(bool loop);
+
+    /**
+     * Goes back to the start of the music. Only call while the stream isn't
+     * being mixed.
+     */
+    void Rewind();
+
+    /**
+     * Changes the stream's gain to the given gain over the given number of
+     * seconds, 0 to change it at once. If pauseWhenSilent is set and the
+     * gain reaches 0, the stream stops being mixed, keeping its position.
+     */
+    void FadeTo(float gain, float seconds, bool pauseWhenSilent);
+
+    /**
+     * Obtains whether every frame of the music has been played.
+     */
+    bool IsFinished();
+
+    /**
+     * Queues decoding on the WorkerPool if half the ring has been played
+     * and no decode is already queued.
+     */
+    void RequestDecode();
+
+    /**
+     * Decodes until the ring is full or the music ends. Runs on a worker,
+     * but can be called directly to fill the ring before playing.
+     */
+    void Decode();
+
+    /**
+     * Obtains the stream's counters.
+     */
+    Stats GetStats();
+
+    /**
+     * Adds the next frames from the ring to the output.
+     */
+    virtual bool Mix(float* output, unsigned int frameCount);
+
+private:
+    // Private constructors to disallow access.
+    MusicStream(MusicStream const &other);
+    MusicStream operator=(MusicStream other);
+
+    /**
+     * sf::Music used only for its decoder; it's never played.
+     */
+    class Decoder : public sf::Music
+    {
+    public:
+        bool ReadChunk(Chunk& chunk)
+        {
+            return this->onGetData(chunk);
+        }
+
+        void Rewind()
+        {
+            this->onSeek(sf::Time::Zero);
+        }
+    };
+
+    /**
+     * Reads the decoder's format once it's opened.
+     */
+    bool finishOpening(bool opened);
+
+    /**
+     * Converts decoded samples to stereo at the mixer's rate, appending them
+     * to the pending frames.
+     */
+    void convert(const sf::Int16* samples, size_t sampleCount);
+
+    /**
+     * Writes as many pending frames into the ring as fit, returning whether
+     * they all did.
+     */
+    bool writePending();
+
+    /**
+     * What the decoder reads from, declared before it so they outlive it
+     */
+    AssetPack::Asset asset;
+    std::shared_ptr<sf::InputStream> inputStream;
+    Decoder decoder;
+
+    unsigned int channelCount;
+    unsigned int sampleRate;
+    std::atomic<bool> loop;
+
+    /**
+     * Decoding state, guarded by decodeMutex. Pending frames were decoded but
+     * didn't fit in the ring yet. Resampling carries a position relative to
+     * the next chunk and the previous chunk's last frame between chunks
+     */
+    std::mutex decodeMutex;
+    std::atomic<bool> decodeQueued;
+    std::vector<float> pending;
+    size_t pendingOffset;
+    double resamplePosition;
+    float previousFrame[2];
+    bool decodedSinceRewind;
+    bool reachedEnd;
+
+    /**
+     * The ring of decoded stereo frames. Written by the decoder, read by the
+     * mixer; positions only ever increase
+     */
+    std::vector<float> ring;
+    size_t ringFrames;
+    std::atomic<size_t> readFrame;
+    std::atomic<size_t> writeFrame;
+    std::atomic<bool> decodedToEnd;
+    std::atomic<bool> finished;
+
+    /**
+     * Fade state, changed by the view thread and applied by the mixer
+     */
+    std::mutex fadeMutex;
+    float gain;
+    float targetGain;
+    float gainStep;
+    bool pauseWhenSilent;
+
+    std::atomic<unsigned long long> underrunCount;
+    std::atomic<unsigned long long> underrunFrameCount;
+    std::atomic<unsigned long long> decodedFrameCount;
+};
+
+#endif
@@ -0,0 +1,15 @@
+#include "NullAudioDevice.h"
+
+NullAudioDevice::NullAudioDevice(double speed) : HeadlessAudioDevice(speed)
+{
+
+}
+
+NullAudioDevice::~NullAudioDevice()
+{
+    this->Stop();
+}
+
+void NullAudioDevice::consume(const float* /* samples */, unsigned int /* frameCount */)
+{
+}
@@ -0,0 +1,28 @@
+#ifndef Core_NullAudioDevice_h
+#define Core_NullAudioDevice_h
+
+#include "HeadlessAudioDevice.h"
+
+/**
+ * Renders the mix and throws it away, for running the sound system where
+ * there is no audio device, and for measuring the mixer.
+ */
+class NullAudioDevice : public HeadlessAudioDevice
+{
+public:
+    /**
+     * Creates a device rendering at the given multiple of real time, or as
+     * fast as possible if it's 0.
+     */
+    NullAudioDevice(double speed = 1.0);
+
+    /**
+     * Stops the device's thread.
+     */
+    ~NullAudioDevice();
+
+protected:
+    virtual void consume(const float* samples, unsigned int frameCount);
+};
+
+#endif
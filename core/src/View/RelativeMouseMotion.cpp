@@ -0,0 +1,174 @@
+#include "RelativeMouseMotion.h"
+#include <cmath>
+
+#ifdef CORE_XINPUT2
+#include <X11/Xlib.h>
+#include <X11/extensions/XInput2.h>
+#endif
+
+RelativeMouseMotion::RelativeMouseMotion(std::shared_ptr<sf::Window> window) : window(window), started(false), raw(false), remainderX(0.0), remainderY(0.0)
+{
+#ifdef CORE_XINPUT2
+    this->display = nullptr;
+    this->xinputOpcode = 0;
+#endif
+}
+
+RelativeMouseMotion::~RelativeMouseMotion()
+{
+    this->Stop();
+}
+
+void RelativeMouseMotion::Start()
+{
+    if (this->started)
+    {
+        return;
+    }
+    this->started = true;
+    this->remainderX = 0.0;
+    this->remainderY = 0.0;
+#ifdef CORE_XINPUT2
+    this->raw = this->startRaw();
+#endif
+    this->recenter();
+}
+
+void RelativeMouseMotion::Stop()
+{
+    if (!this->started)
+    {
+        return;
+    }
+    this->started = false;
+#ifdef CORE_XINPUT2
+    if (this->display != nullptr)
+    {
+        XCloseDisplay(this->display);
+        this->display = nullptr;
+    }
+#endif
+    this->raw = false;
+}
+
+bool RelativeMouseMotion::IsStarted() const
+{
+    return this->started;
+}
+
+bool RelativeMouseMotion::IsRaw() const
+{
+    return this->raw;
+}
+
+sf::Vector2i RelativeMouseMotion::Poll()
+{
+    if (!this->started)
+    {
+        return sf::Vector2i(0, 0);
+    }
+    if (!this->raw)
+    {
+        return this->recenter();
+    }
+
+#ifdef CORE_XINPUT2
+    this->readRaw();
+#endif
+    // Moving the cursor doesn't make raw motion, so it can be put back
+    // without affecting the measurement
+    this->recenter();
+    sf::Vector2i motion((int)std::trunc(this->remainderX), (int)std::trunc(this->remainderY));
+    this->remainderX -= motion.x;
+    this->remainderY -= motion.y;
+    return motion;
+}
+
+sf::Vector2i RelativeMouseMotion::getCenter()
+{
+    sf::Vector2u size = this->window->getSize();
+    return sf::Vector2i((int)size.x / 2, (int)size.y / 2);
+}
+
+sf::Vector2i RelativeMouseMotion::recenter()
+{
+    sf::Vector2i center = this->getCenter();
+    sf::Vector2i offset = sf::Mouse::getPosition(*(this->window)) - center;
+    if (offset.x != 0 || offset.y != 0)
+    {
+        sf::Mouse::setPosition(center, *(this->window));
+    }
+    return offset;
+}
+
+#ifdef CORE_XINPUT2
+bool RelativeMouseMotion::startRaw()
+{
+    this->display = XOpenDisplay(nullptr);
+    if (this->display == nullptr)
+    {
+        return false;
+    }
+
+    // Raw events from master devices need XInput 2.1
+    int event;
+    int error;
+    int major = 2;
+    int minor = 1;
+    if (!XQueryExtension(this->display, "XInputExtension", &this->xinputOpcode, &event, &error) ||
+        XIQueryVersion(this->display, &major, &minor) != Success || (major == 2 && minor < 1))
+    {
+        XCloseDisplay(this->display);
+        this->display = nullptr;
+        return false;
+    }
+
+    // Raw events are only ever sent to the root window
+    unsigned char maskBits[XIMaskLen(XI_RawMotion)] = {};
+    XISetMask(maskBits, XI_RawMotion);
+    XIEventMask mask;
+    mask.deviceid = XIAllMasterDevices;
+    mask.mask_len = sizeof(maskBits);
+    mask.mask = maskBits;
+    XISelectEvents(this->display, DefaultRootWindow(this->display), &mask, 1);
+    XFlush(this->display);
+    return true;
+}
+
+void RelativeMouseMotion::readRaw()
+{
+    while (XPending(this->display) > 0)
+    {
+        XEvent event;
+        XNextEvent(this->display, &event);
+        XGenericEventCookie* cookie = &event.xcookie;
+        if (cookie->type != GenericEvent || cookie->extension != this->xinputOpcode || !XGetEventData(this->display, cookie))
+        {
+            continue;
+        }
+        if (cookie->evtype == XI_RawMotion)
+        {
+            // Values are only sent for the axes that moved, in axis order
+            const XIRawEvent* rawEvent = (const XIRawEvent*)cookie->data;
+            const double* value = rawEvent->raw_values;
+            for (int axis = 0; axis < rawEvent->valuators.mask_len * 8; axis++)
+            {
+                if (!XIMaskIsSet(rawEvent->valuators.mask, axis))
+                {
+                    continue;
+                }
+                if (axis == 0)
+                {
+                    this->remainderX += *value;
+                }
+                else if (axis == 1)
+                {
+                    this->remainderY += *value;
+                }
+                value++;
+            }
+        }
+        XFreeEventData(this->display, cookie);
+    }
+}
+#endif
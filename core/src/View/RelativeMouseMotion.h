@@ -0,0 +1,111 @@
+#ifndef Core_RelativeMouseMotion_h
+#define Core_RelativeMouseMotion_h
+
+#include "SFML/Window.hpp"
+#include <memory>
+
+#ifdef CORE_XINPUT2
+struct _XDisplay;
+#endif
+
+/**
+ * Measures how far the mouse moves between frames while the cursor is
+ * locked to the window, such as for mouse-look.
+ *
+ * When built with XInput2 (CORE_XINPUT2, which premake defines on Linux
+ * if its headers are installed), the motion is read from raw motion
+ * events, on an X connection of its own, once per frame. Raw motion is what the device
+ * reported, before pointer acceleration and with fractions of a pixel kept
+ * until they add up, and isn't stopped by the edge of the screen. However
+ * often the mouse reports, SFML's event loop sees none of it.
+ *
+ * Otherwise, or if the X server lacks XInput2, the motion is how far the
+ * cursor has strayed from the middle of the window since the previous frame.
+ * Either way, the cursor is put back in the middle of the window at most
+ * once per frame, so it never leaves the window.
+ */
+class RelativeMouseMotion final
+{
+public:
+    /**
+     * Creates an instance measuring motion over the given window, which
+     * hasn't started yet.
+     */
+    RelativeMouseMotion(std::shared_ptr<sf::Window> window);
+
+    /**
+     * Stops measuring.
+     */
+    ~RelativeMouseMotion();
+
+    /**
+     * Starts measuring, moving the cursor to the middle of the window.
+     */
+    void Start();
+
+    /**
+     * Stops measuring, leaving the cursor where it is.
+     */
+    void Stop();
+
+    /**
+     * Obtains whether motion is being measured.
+     */
+    bool IsStarted() const;
+
+    /**
+     * Obtains whether the motion is read from the platform's raw mouse
+     * input, rather than from the cursor.
+     */
+    bool IsRaw() const;
+
+    /**
+     * Obtains the motion since Start or the previous call, in pixels, and
+     * brings the cursor back to the middle of the window. Should be called
+     * once per frame.
+     */
+    sf::Vector2i Poll();
+
+private:
+    // Private constructors to disallow access.
+    RelativeMouseMotion(RelativeMouseMotion const &other);
+    RelativeMouseMotion operator=(RelativeMouseMotion other);
+
+    /**
+     * Obtains the middle of the window, relative to its top left.
+     */
+    sf::Vector2i getCenter();
+
+    /**
+     * Moves the cursor back to the middle of the window if it isn't there,
+     * returning how far it was from it.
+     */
+    sf::Vector2i recenter();
+
+#ifdef CORE_XINPUT2
+    /**
+     * Selects raw motion events on a new X connection, returning false if
+     * the server doesn't support them.
+     */
+    bool startRaw();
+
+    /**
+     * Reads every raw motion event received since the previous call into
+     * the remainders.
+     */
+    void readRaw();
+
+    _XDisplay* display;
+    int xinputOpcode;
+#endif
+
+    std::shared_ptr<sf::Window> window;
+    bool started;
+    bool raw;
+
+    // Motion not yet reported, as raw motion comes in fractions of a pixel
+    double remainderX;
+    double remainderY;
+};
+
+#endif
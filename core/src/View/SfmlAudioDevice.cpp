@@ -0,0 +1,24 @@
+#include "SfmlAudioDevice.h"
+
+SfmlAudioDevice::SfmlAudioDevice()
+{
+
+}
+
+SfmlAudioDevice::~SfmlAudioDevice()
+{
+    this->Stop();
+}
+
+void SfmlAudioDevice::Start(SoundMixer& mixer)
+{
+    this->Stop();
+    this->stream.reset(new MixerStream(mixer));
+    this->stream->play();
+}
+
+void SfmlAudioDevice::Stop()
+{
+    // The stream stops its thread when destroyed
+    this->stream.reset();
+}
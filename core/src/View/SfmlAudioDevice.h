@@ -0,0 +1,36 @@
+#ifndef Core_SfmlAudioDevice_h
+#define Core_SfmlAudioDevice_h
+
+#include <memory>
+#include "AudioDevice.h"
+#include "MixerStream.h"
+
+/**
+ * Plays the mix on the sound card through a MixerStream, and so through
+ * SFML and OpenAL.
+ */
+class SfmlAudioDevice : public AudioDevice
+{
+public:
+    /**
+     * Creates a device that isn't playing anything yet.
+     */
+    SfmlAudioDevice();
+
+    /**
+     * Stops the stream if it's still playing.
+     */
+    ~SfmlAudioDevice();
+
+    virtual void Start(SoundMixer& mixer);
+    virtual void Stop();
+
+private:
+    // Private constructors to disallow access.
+    SfmlAudioDevice(SfmlAudioDevice const &other);
+    SfmlAudioDevice operator=(SfmlAudioDevice other);
+
+    std::unique_ptr<MixerStream> stream;
+};
+
+#endif
@@ -0,0 +1,407 @@
+#include "SoundMixer.h"
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SOUND_MIXER_SSE
+#include <xmmintrin.h>
+#endif
+
+const unsigned int SoundMixer::SAMPLE_RATE;
+const unsigned int SoundMixer::CHANNEL_COUNT;
+const unsigned int SoundMixer::BLOCK_FRAMES;
+const float SoundMixer::DEFAULT_LIMITER_THRESHOLD = 0.9f;
+const float SoundMixer::MIN_PITCH = 1.0f / 64.0f;
+
+namespace
+{
+    /**
+     * How much of the way back to unity the limiter's gain recovers each
+     * block, giving a release time of roughly 100ms.
+     */
+    const float LIMITER_RELEASE = 0.056f;
+
+    /**
+     * Adds the given mono or stereo samples to the interleaved stereo
+     * output, scaling each channel by a gain that starts at left/right and
+     * changes by leftStep/rightStep every frame.
+     */
+    void accumulate(float* output, const float* source, unsigned int frameCount, unsigned int channelCount,
+                    float left, float right, float leftStep, float rightStep)
+    {
+        unsigned int frame = 0;
+#ifdef SOUND_MIXER_SSE
+        if (channelCount == 1)
+        {
+            // Four mono frames fill two stereo vectors
+            __m128 gains0 = _mm_setr_ps(left, right, left + leftStep, right + rightStep);
+            __m128 gains1 = _mm_add_ps(gains0, _mm_setr_ps(2 * leftStep, 2 * rightStep, 2 * leftStep, 2 * rightStep));
+            __m128 step = _mm_setr_ps(4 * leftStep, 4 * rightStep, 4 * leftStep, 4 * rightStep);
+            for (; frame + 4 <= frameCount; frame += 4)
+            {
+                __m128 mono = _mm_loadu_ps(source + frame);
+                __m128 low = _mm_unpacklo_ps(mono, mono);
+                __m128 high = _mm_unpackhi_ps(mono, mono);
+                float* out = output + frame * 2;
+                _mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), _mm_mul_ps(low, gains0)));
+                _mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_mul_ps(high, gains1)));
+                gains0 = _mm_add_ps(gains0, step);
+                gains1 = _mm_add_ps(gains1, step);
+            }
+        }
+        else
+        {
+            __m128 gains = _mm_setr_ps(left, right, left + leftStep, right + rightStep);
+            __m128 step = _mm_setr_ps(2 * leftStep, 2 * rightStep, 2 * leftStep, 2 * rightStep);
+            for (; frame + 2 <= frameCount; frame += 2)
+            {
+                float* out = output + frame * 2;
+                __m128 stereo = _mm_loadu_ps(source + frame * 2);
+                _mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), _mm_mul_ps(stereo, gains)));
+                gains = _mm_add_ps(gains, step);
+            }
+        }
+#endif
+        for (; frame < frameCount; frame++)
+        {
+            float leftGain = left + leftStep * frame;
+            float rightGain = right + rightStep * frame;
+            if (channelCount == 1)
+            {
+                output[frame * 2] += source[frame] * leftGain;
+                output[frame * 2 + 1] += source[frame] * rightGain;
+            }
+            else
+            {
+                output[frame * 2] += source[frame * 2] * leftGain;
+                output[frame * 2 + 1] += source[frame * 2 + 1] * rightGain;
+            }
+        }
+    }
+
+    /**
+     * Obtains the largest absolute sample in the given samples.
+     */
+    float findPeak(const float* samples, unsigned int sampleCount)
+    {
+        float peak = 0.0f;
+        unsigned int sample = 0;
+#ifdef SOUND_MIXER_SSE
+        __m128 signMask = _mm_set1_ps(-0.0f);
+        __m128 peaks = _mm_setzero_ps();
+        for (; sample + 4 <= sampleCount; sample += 4)
+        {
+            peaks = _mm_max_ps(peaks, _mm_andnot_ps(signMask, _mm_loadu_ps(samples + sample)));
+        }
+        float lanes[4];
+        _mm_storeu_ps(lanes, peaks);
+        peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#endif
+        for (; sample < sampleCount; sample++)
+        {
+            peak = std::max(peak, std::fabs(samples[sample]));
+        }
+        return peak;
+    }
+
+    /**
+     * Scales the given samples by a gain ramping from start by step per
+     * sample, clamping the result to [-1, 1].
+     */
+    void applyGain(float* samples, unsigned int sampleCount, float start, float step)
+    {
+        unsigned int sample = 0;
+#ifdef SOUND_MIXER_SSE
+        __m128 gains = _mm_setr_ps(start, start + step, start + 2 * step, start + 3 * step);
+        __m128 increment = _mm_set1_ps(4 * step);
+        __m128 minimum = _mm_set1_ps(-1.0f);
+        __m128 maximum = _mm_set1_ps(1.0f);
+        for (; sample + 4 <= sampleCount; sample += 4)
+        {
+            __m128 scaled = _mm_mul_ps(_mm_loadu_ps(samples + sample), gains);
+            _mm_storeu_ps(samples + sample, _mm_min_ps(_mm_max_ps(scaled, minimum), maximum));
+            gains = _mm_add_ps(gains, increment);
+        }
+#endif
+        for (; sample < sampleCount; sample++)
+        {
+            float scaled = samples[sample] * (start + step * sample);
+            samples[sample] = std::min(std::max(scaled, -1.0f), 1.0f);
+        }
+    }
+}
+
+SoundMixer::SoundMixer(unsigned int voiceCount) : masterGain(1.0f), limiterThreshold(SoundMixer::DEFAULT_LIMITER_THRESHOLD), limiterGain(1.0f)
+{
+    this->voices.resize(voiceCount);
+    for (auto it = this->voices.begin(); it != this->voices.end(); it++)
+    {
+        it->position = 0.0;
+        it->gain = 1.0f;
+        it->pan = 0.0f;
+        it->pitch = 1.0f;
+        it->leftGain = 0.0f;
+        it->rightGain = 0.0f;
+        it->rampStarted = false;
+    }
+    this->scratch.resize(SoundMixer::BLOCK_FRAMES * SoundMixer::CHANNEL_COUNT);
+}
+
+std::shared_ptr<SoundMixer::Samples> SoundMixer::ConvertBuffer(const sf::SoundBuffer& buffer)
+{
+    std::shared_ptr<Samples> samples = std::make_shared<Samples>();
+    unsigned int sourceChannels = buffer.getChannelCount();
+    if (sourceChannels == 0)
+    {
+        return nullptr;
+    }
+    samples->channelCount = std::min(sourceChannels, SoundMixer::CHANNEL_COUNT);
+    samples->sampleRate = buffer.getSampleRate();
+    samples->frameCount = buffer.getSampleCount() / sourceChannels;
+    samples->data.resize(samples->frameCount * samples->channelCount);
+
+    const sf::Int16* source = buffer.getSamples();
+    for (size_t frame = 0; frame < samples->frameCount; frame++)
+    {
+        for (unsigned int channel = 0; channel < samples->channelCount; channel++)
+        {
+            samples->data[frame * samples->channelCount + channel] = source[frame * sourceChannels + channel] / 32768.0f;
+        }
+    }
+    return samples;
+}
+
+void SoundMixer::Start(unsigned int voice, std::shared_ptr<const Samples> samples, float gain, float pan, float pitch, double startFrame)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    Voice& started = this->voices[voice];
+    started.samples = samples;
+    started.position = startFrame;
+    started.gain = gain;
+    started.pan = pan;
+    started.pitch = SoundMixer::clampPitch(pitch);
+    started.rampStarted = false;
+}
+
+void SoundMixer::Stop(unsigned int voice)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->voices[voice].samples = nullptr;
+}
+
+bool SoundMixer::IsPlaying(unsigned int voice)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->voices[voice].samples != nullptr;
+}
+
+void SoundMixer::GetActiveVoices(std::vector<bool>& active)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    active.resize(this->voices.size());
+    for (size_t i = 0; i < this->voices.size(); i++)
+    {
+        active[i] = this->voices[i].samples != nullptr;
+    }
+}
+
+double SoundMixer::GetPosition(unsigned int voice)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->voices[voice].position;
+}
+
+void SoundMixer::SetVoiceGain(unsigned int voice, float gain)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->voices[voice].gain = gain;
+}
+
+void SoundMixer::SetVoicePan(unsigned int voice, float pan)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->voices[voice].pan = pan;
+}
+
+void SoundMixer::SetVoicePitch(unsigned int voice, float pitch)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->voices[voice].pitch = SoundMixer::clampPitch(pitch);
+}
+
+unsigned int SoundMixer::GetVoiceCount()
+{
+    return (unsigned int)this->voices.size();
+}
+
+void SoundMixer::AddSource(std::shared_ptr<MixerSource> source)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (std::find(this->sources.begin(), this->sources.end(), source) == this->sources.end())
+    {
+        this->sources.push_back(source);
+    }
+}
+
+void SoundMixer::RemoveSource(const std::shared_ptr<MixerSource>& source)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->sources.erase(std::remove(this->sources.begin(), this->sources.end(), source), this->sources.end());
+}
+
+bool SoundMixer::HasSource(const std::shared_ptr<MixerSource>& source)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return std::find(this->sources.begin(), this->sources.end(), source) != this->sources.end();
+}
+
+void SoundMixer::SetMasterGain(float gain)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->masterGain = gain;
+}
+
+void SoundMixer::SetLimiterThreshold(float threshold)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->limiterThreshold = threshold;
+}
+
+float SoundMixer::GetLimiterGain()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->limiterGain;
+}
+
+void SoundMixer::Render(float* output, unsigned int frameCount)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    while (frameCount > 0)
+    {
+        unsigned int blockFrames = std::min(frameCount, SoundMixer::BLOCK_FRAMES);
+        std::fill(output, output + blockFrames * SoundMixer::CHANNEL_COUNT, 0.0f);
+        for (auto it = this->voices.begin(); it != this->voices.end(); it++)
+        {
+            if (it->samples != nullptr)
+            {
+                this->mixVoice(*it, output, blockFrames);
+            }
+        }
+        for (auto it = this->sources.begin(); it != this->sources.end();)
+        {
+            if ((*it)->Mix(output, blockFrames))
+            {
+                it++;
+            }
+            else
+            {
+                it = this->sources.erase(it);
+            }
+        }
+        this->limit(output, blockFrames);
+        output += blockFrames * SoundMixer::CHANNEL_COUNT;
+        frameCount -= blockFrames;
+    }
+}
+
+void SoundMixer::mixVoice(Voice& voice, float* output, unsigned int frameCount)
+{
+    const Samples& samples = *voice.samples;
+    unsigned int channelCount = samples.channelCount;
+    double step = (double)voice.pitch * samples.sampleRate / SoundMixer::SAMPLE_RATE;
+
+    // Unresampled voices are mixed straight from their samples
+    const float* source;
+    unsigned int frames;
+    if (step == 1.0 && voice.position == std::floor(voice.position))
+    {
+        size_t position = (size_t)voice.position;
+        frames = (unsigned int)std::min<size_t>(frameCount, samples.frameCount - std::min(position, samples.frameCount));
+        source = samples.data.data() + position * channelCount;
+        voice.position += frames;
+    }
+    else
+    {
+        float* resampled = this->scratch.data();
+        for (frames = 0; frames < frameCount; frames++)
+        {
+            size_t index = (size_t)voice.position;
+            if (index >= samples.frameCount)
+            {
+                break;
+            }
+            float fraction = (float)(voice.position - index);
+            const float* current = samples.data.data() + index * channelCount;
+            for (unsigned int channel = 0; channel < channelCount; channel++)
+            {
+                float next = index + 1 < samples.frameCount ? current[channel + channelCount] : 0.0f;
+                resampled[frames * channelCount + channel] = current[channel] + (next - current[channel]) * fraction;
+            }
+            voice.position += step;
+        }
+        source = resampled;
+    }
+
+    float left;
+    float right;
+    SoundMixer::panGains(voice, left, right);
+    if (!voice.rampStarted)
+    {
+        voice.leftGain = left;
+        voice.rightGain = right;
+        voice.rampStarted = true;
+    }
+    accumulate(output, source, frames, channelCount, voice.leftGain, voice.rightGain,
+               (left - voice.leftGain) / frameCount, (right - voice.rightGain) / frameCount);
+    voice.leftGain = left;
+    voice.rightGain = right;
+
+    if (voice.position >= samples.frameCount)
+    {
+        voice.samples = nullptr;
+    }
+}
+
+void SoundMixer::limit(float* output, unsigned int frameCount)
+{
+    unsigned int sampleCount = frameCount * SoundMixer::CHANNEL_COUNT;
+    float peak = findPeak(output, sampleCount) * this->masterGain;
+
+    // Clamp down to the block's peak right away, then recover gradually
+    float target = peak > this->limiterThreshold ? this->limiterThreshold / peak : 1.0f;
+    float gain = target;
+    if (target > this->limiterGain)
+    {
+        gain = std::min(target, this->limiterGain + (1.0f - this->limiterGain) * LIMITER_RELEASE);
+    }
+
+    // Reductions apply from the block's first sample so its peak is held to
+    // the threshold; recovery ramps across the block to avoid clicks
+    float end = gain * this->masterGain;
+    float start = gain < this->limiterGain ? end : this->limiterGain * this->masterGain;
+    applyGain(output, sampleCount, start, (end - start) / sampleCount);
+    this->limiterGain = gain;
+}
+
+void SoundMixer::panGains(const Voice& voice, float& left, float& right)
+{
+    float pan = std::min(std::max(voice.pan, -1.0f), 1.0f);
+    if (voice.samples->channelCount == 1)
+    {
+        // Constant power, so a mono sound is as loud wherever it's panned
+        float angle = (pan + 1.0f) * 0.785398163f;
+        left = voice.gain * std::cos(angle);
+        right = voice.gain * std::sin(angle);
+    }
+    else
+    {
+        // Stereo sounds are balanced, attenuating the far channel
+        left = voice.gain * std::min(1.0f, 1.0f - pan);
+        right = voice.gain * std::min(1.0f, 1.0f + pan);
+    }
+}
+
+float SoundMixer::clampPitch(float pitch)
+{
+    return pitch >= SoundMixer::MIN_PITCH ? pitch : SoundMixer::MIN_PITCH;
+}
@@ -0,0 +1,214 @@
+#ifndef Core_SoundMixer_h
+#define Core_SoundMixer_h
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <SFML/Audio/SoundBuffer.hpp>
+#include "MixerSource.h"
+
+/**
+ * Mixes every playing sound effect into one stereo float stream.
+ *
+ * Each voice plays a sound's samples with its own gain, pan and pitch; pitch
+ * is applied by resampling with linear interpolation. Voices are summed with
+ * SSE where the compiler targets it, then the master gain and a peak limiter
+ * keep the result within [-1, 1]. Streamed sources such as music are mixed
+ * in with the voices.
+ *
+ * The mixer doesn't play anything itself. Render fills a buffer, which a
+ * MixerStream feeds to the sound card, or which can be inspected directly
+ * when running without audio. Voices may be started and stopped from one
+ * thread while another renders.
+ */
+class SoundMixer
+{
+public:
+    /**
+     * A sound's samples, converted to float once when the sound is loaded.
+     * Mono sounds stay mono; anything with more channels keeps its first two.
+     */
+    struct Samples
+    {
+        std::vector<float> data;
+        unsigned int channelCount;
+        unsigned int sampleRate;
+        size_t frameCount;
+    };
+
+    static const unsigned int SAMPLE_RATE = 44100;
+    static const unsigned int CHANNEL_COUNT = 2;
+
+    /**
+     * The level the limiter holds peaks to unless set otherwise.
+     */
+    static const float DEFAULT_LIMITER_THRESHOLD;
+
+    /**
+     * The lowest pitch a voice plays at; lower pitches, which would never
+     * reach the end of the samples or play them backwards, are raised to it.
+     */
+    static const float MIN_PITCH;
+
+    /**
+     * Creates a mixer with the given number of voices, all stopped.
+     */
+    SoundMixer(unsigned int voiceCount);
+
+    /**
+     * Converts a decoded sound buffer's samples for the mixer.
+     */
+    static std::shared_ptr<Samples> ConvertBuffer(const sf::SoundBuffer& buffer);
+
+    /**
+     * Starts playing the given samples on the given voice from the given
+     * frame, replacing whatever it was playing. A pan of -1 is fully left
+     * and 1 fully right; a pitch of 2 plays twice as fast, and is at least
+     * MIN_PITCH.
+     */
+    void Start(unsigned int voice, std::shared_ptr<const Samples> samples, float gain, float pan, float pitch, double startFrame);
+
+    /**
+     * Stops the given voice.
+     */
+    void Stop(unsigned int voice);
+
+    /**
+     * Obtains whether the given voice is still playing.
+     */
+    bool IsPlaying(unsigned int voice);
+
+    /**
+     * Fills the given vector with whether each voice is still playing,
+     * resizing it to the number of voices. Takes the lock once for every
+     * voice, where IsPlaying takes it per voice.
+     */
+    void GetActiveVoices(std::vector<bool>& active);
+
+    /**
+     * Obtains the frame of its samples the given voice has reached.
+     */
+    double GetPosition(unsigned int voice);
+
+    /**
+     * Changes the gain, pan or pitch of a playing voice. Gain and pan changes
+     * are ramped over the next block to avoid clicks. The pitch is at least
+     * MIN_PITCH.
+     */
+    void SetVoiceGain(unsigned int voice, float gain);
+    void SetVoicePan(unsigned int voice, float pan);
+    void SetVoicePitch(unsigned int voice, float pitch);
+
+    /**
+     * Obtains the number of voices.
+     */
+    unsigned int GetVoiceCount();
+
+    /**
+     * Adds a source to mix until it's removed or runs out. Adding a source
+     * that's already being mixed does nothing.
+     */
+    void AddSource(std::shared_ptr<MixerSource> source);
+
+    /**
+     * Stops mixing the given source. Once this returns, the source isn't
+     * being mixed on any thread.
+     */
+    void RemoveSource(const std::shared_ptr<MixerSource>& source);
+
+    /**
+     * Obtains whether the given source is being mixed.
+     */
+    bool HasSource(const std::shared_ptr<MixerSource>& source);
+
+    /**
+     * Sets the gain applied to the mix before the limiter.
+     */
+    void SetMasterGain(float gain);
+
+    /**
+     * Sets the level the limiter holds peaks to, between 0 and 1.
+     */
+    void SetLimiterThreshold(float threshold);
+
+    /**
+     * Obtains the gain the limiter is currently applying, 1 when it isn't
+     * reducing anything.
+     */
+    float GetLimiterGain();
+
+    /**
+     * Mixes the given number of frames of every playing voice into the
+     * given buffer of interleaved stereo samples, overwriting it, and
+     * advances the voices.
+     */
+    void Render(float* output, unsigned int frameCount);
+
+private:
+    // Private constructors to disallow access.
+    SoundMixer(SoundMixer const &other);
+    SoundMixer operator=(SoundMixer other);
+
+    struct Voice
+    {
+        std::shared_ptr<const Samples> samples;
+        double position;
+        float gain;
+        float pan;
+        float pitch;
+
+        /**
+         * The left and right gains used at the end of the last block, which
+         * the next block ramps from. Unset until the voice's first block.
+         */
+        float leftGain;
+        float rightGain;
+        bool rampStarted;
+    };
+
+    /**
+     * Frames mixed at a time; the limiter reacts once per block.
+     */
+    static const unsigned int BLOCK_FRAMES = 256;
+
+    /**
+     * Mixes one block of the given voice into the output, stopping it if it
+     * reaches the end of its samples.
+     */
+    void mixVoice(Voice& voice, float* output, unsigned int frameCount);
+
+    /**
+     * Applies the master gain and limiter to one mixed block.
+     */
+    void limit(float* output, unsigned int frameCount);
+
+    /**
+     * Obtains the left and right gains for the given gain and pan.
+     */
+    static void panGains(const Voice& voice, float& left, float& right);
+
+    /**
+     * Obtains the given pitch raised to MIN_PITCH if it's lower, or isn't a
+     * number.
+     */
+    static float clampPitch(float pitch);
+
+    std::vector<Voice> voices;
+    std::vector<std::shared_ptr<MixerSource>> sources;
+
+    /**
+     * Resampled samples of the voice being mixed
+     */
+    std::vector<float> scratch;
+
+    float masterGain;
+    float limiterThreshold;
+    float limiterGain;
+
+    /**
+     * Guards the voices and settings against Render on another thread
+     */
+    std::mutex mutex;
+};
+
+#endif
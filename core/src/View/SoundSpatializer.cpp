@@ -0,0 +1,186 @@
+#include "SoundSpatializer.h"
+#include <cmath>
+#include <algorithm>
+
+const float SoundSpatializer::DEFAULT_AUDIBILITY_THRESHOLD = 0.001f;
+const SoundAttenuation SoundSpatializer::DEFAULT_ATTENUATION = { AttenuationCurve::INVERSE, 1.0f, 100.0f };
+
+SoundSpatializer::SoundSpatializer(VoicePool& voices) : voices(voices), audibilityThreshold(SoundSpatializer::DEFAULT_AUDIBILITY_THRESHOLD),
+    listenerX(0.0f), listenerY(0.0f), listenerHalfWidth(1.0f)
+{
+
+}
+
+void SoundSpatializer::Play(SoundHandle sound, std::shared_ptr<const SoundMixer::Samples> samples, unsigned int maxInstances, int priority,
+                            const SoundAttenuation& attenuation, float x, float y, float gain, float pitch)
+{
+    PositionalPlay play;
+    play.sound = sound;
+    play.samples = samples;
+    play.maxInstances = maxInstances;
+    play.priority = priority;
+    play.attenuation = attenuation;
+    play.x = x;
+    play.y = y;
+    play.gain = gain;
+    play.pitch = pitch;
+    play.play.voice = 0;
+    play.play.startOrder = 0;
+    play.position = 0.0;
+    play.positionTime = std::chrono::steady_clock::now();
+
+    // Sounds out of earshot never take a voice, and audible ones that can't
+    // get one wait for a voice to free up
+    float placedGain;
+    float pan;
+    this->place(play, placedGain, pan);
+    if (placedGain >= this->audibilityThreshold)
+    {
+        play.play = this->voices.Play(sound, samples, maxInstances, priority, placedGain, pan, pitch);
+    }
+    play.isVirtual = play.play.startOrder == 0;
+    this->plays.push_back(play);
+}
+
+void SoundSpatializer::Stop(SoundHandle sound)
+{
+    for (auto it = this->plays.begin(); it != this->plays.end();)
+    {
+        if (it->sound == sound)
+        {
+            this->voices.StopPlay(it->play);
+            it = this->plays.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+}
+
+void SoundSpatializer::Update(std::shared_ptr<Camera> camera)
+{
+    this->listenerX = camera->GetX();
+    this->listenerY = camera->GetY();
+    this->listenerHalfWidth = camera->GetWidth() / 2.0f;
+
+    // Resuming only takes free voices, so plays that steal each other's
+    // voices don't keep trading them back
+    unsigned int freeVoiceCount = this->voices.GetFreeVoiceCount();
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < this->plays.size();)
+    {
+        PositionalPlay& play = this->plays[i];
+        bool finished = false;
+        if (!play.isVirtual)
+        {
+            if (this->voices.IsPlaying(play.play))
+            {
+                play.position = this->voices.GetPosition(play.play);
+                play.positionTime = now;
+            }
+            else if (this->voices.IsStolen(play.play))
+            {
+                play.isVirtual = true;
+            }
+            else
+            {
+                finished = true;
+            }
+        }
+        double position = play.isVirtual ? SoundSpatializer::estimatePosition(play, now) : play.position;
+        if (finished || position >= play.samples->frameCount)
+        {
+            this->plays[i] = this->plays.back();
+            this->plays.pop_back();
+            continue;
+        }
+
+        float gain;
+        float pan;
+        this->place(play, gain, pan);
+        bool audible = gain >= this->audibilityThreshold;
+        if (!play.isVirtual && !audible)
+        {
+            this->voices.StopPlay(play.play);
+            play.isVirtual = true;
+        }
+        else if (!play.isVirtual)
+        {
+            this->voices.SetGainAndPan(play.play, gain, pan);
+        }
+        else if (audible && freeVoiceCount > 0)
+        {
+            VoicePool::PlayId resumed = this->voices.Play(play.sound, play.samples, play.maxInstances, play.priority,
+                                                          gain, pan, play.pitch, position);
+            if (resumed.startOrder != 0)
+            {
+                play.play = resumed;
+                play.isVirtual = false;
+                play.position = position;
+                play.positionTime = now;
+                freeVoiceCount--;
+            }
+        }
+        i++;
+    }
+}
+
+void SoundSpatializer::SetAudibilityThreshold(float threshold)
+{
+    this->audibilityThreshold = threshold;
+}
+
+unsigned int SoundSpatializer::GetPlayCount()
+{
+    return (unsigned int)this->plays.size();
+}
+
+unsigned int SoundSpatializer::GetVirtualPlayCount()
+{
+    unsigned int count = 0;
+    for (auto it = this->plays.begin(); it != this->plays.end(); it++)
+    {
+        if (it->isVirtual)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+float SoundSpatializer::Attenuate(const SoundAttenuation& attenuation, float distance)
+{
+    if (distance <= attenuation.minDistance)
+    {
+        return 1.0f;
+    }
+    if (distance >= attenuation.maxDistance)
+    {
+        return 0.0f;
+    }
+    switch (attenuation.curve)
+    {
+    case AttenuationCurve::LINEAR:
+        return (attenuation.maxDistance - distance) / (attenuation.maxDistance - attenuation.minDistance);
+    case AttenuationCurve::INVERSE:
+        return attenuation.minDistance / distance;
+    case AttenuationCurve::INVERSE_SQUARE:
+        return (attenuation.minDistance * attenuation.minDistance) / (distance * distance);
+    }
+    return 1.0f;
+}
+
+void SoundSpatializer::place(const PositionalPlay& play, float& gain, float& pan)
+{
+    float dx = play.x - this->listenerX;
+    float dy = play.y - this->listenerY;
+    gain = play.gain * SoundSpatializer::Attenuate(play.attenuation, std::sqrt(dx * dx + dy * dy));
+    pan = this->listenerHalfWidth > 0.0f ? std::min(std::max(dx / this->listenerHalfWidth, -1.0f), 1.0f) : 0.0f;
+}
+
+double SoundSpatializer::estimatePosition(const PositionalPlay& play, std::chrono::steady_clock::time_point now)
+{
+    std::chrono::duration<double> elapsed = now - play.positionTime;
+    return play.position + elapsed.count() * play.samples->sampleRate * play.pitch;
+}
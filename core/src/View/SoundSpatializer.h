@@ -0,0 +1,135 @@
+#ifndef Core_SoundSpatializer_h
+#define Core_SoundSpatializer_h
+
+#include <vector>
+#include <memory>
+#include <chrono>
+#include "ResourceHandles.h"
+#include "SoundAttenuation.h"
+#include "SoundMixer.h"
+#include "VoicePool.h"
+#include "Camera.h"
+
+/**
+ * Plays sounds at positions in the world, heard from the camera's center.
+ *
+ * Each update, every positional play's gain is attenuated by its distance
+ * from the camera's center and it is panned by how far left or right of the
+ * center it is, a sound at the edge of the camera being fully to that side.
+ *
+ * A play too quiet to hear is virtualized: its voice is given back to the
+ * VoicePool, so it costs no mixing, and only its position in the sound is
+ * tracked, by the time that passes. If it becomes audible again before it
+ * would have finished, it takes a voice again and resumes where it would
+ * have been. A play whose voice is stolen is virtualized the same way.
+ */
+class SoundSpatializer
+{
+public:
+    /**
+     * The gain below which a play is virtualized unless set otherwise, about
+     * -60dB.
+     */
+    static const float DEFAULT_AUDIBILITY_THRESHOLD;
+
+    /**
+     * The attenuation of sounds that haven't been given one: full volume
+     * within 1 world unit, falling off inversely to silence at 100.
+     */
+    static const SoundAttenuation DEFAULT_ATTENUATION;
+
+    /**
+     * Creates a spatializer playing on the given pool, which must outlive it.
+     */
+    SoundSpatializer(VoicePool& voices);
+
+    /**
+     * Plays the given sound's samples at the given world position.
+     */
+    void Play(SoundHandle sound, std::shared_ptr<const SoundMixer::Samples> samples, unsigned int maxInstances, int priority,
+              const SoundAttenuation& attenuation, float x, float y, float gain, float pitch);
+
+    /**
+     * Stops every positional play of the given sound, virtual or not.
+     */
+    void Stop(SoundHandle sound);
+
+    /**
+     * Moves the listener to the given camera's center, then updates every
+     * play's gain and pan, virtualizing and resuming plays as they become
+     * inaudible and audible.
+     */
+    void Update(std::shared_ptr<Camera> camera);
+
+    /**
+     * Sets the gain below which a play is virtualized.
+     */
+    void SetAudibilityThreshold(float threshold);
+
+    /**
+     * Obtains the number of positional plays, and how many of them are
+     * virtual.
+     */
+    unsigned int GetPlayCount();
+    unsigned int GetVirtualPlayCount();
+
+    /**
+     * Obtains the gain the given attenuation gives a sound at the given
+     * distance.
+     */
+    static float Attenuate(const SoundAttenuation& attenuation, float distance);
+
+private:
+    // Private constructors to disallow access.
+    SoundSpatializer(SoundSpatializer const &other);
+    SoundSpatializer operator=(SoundSpatializer other);
+
+    struct PositionalPlay
+    {
+        SoundHandle sound;
+        std::shared_ptr<const SoundMixer::Samples> samples;
+        unsigned int maxInstances;
+        int priority;
+        SoundAttenuation attenuation;
+        float x;
+        float y;
+        float gain;
+        float pitch;
+
+        /**
+         * The play on a voice, unless the play is virtual
+         */
+        VoicePool::PlayId play;
+        bool isVirtual;
+
+        /**
+         * The frame the play was last known to be at, and when. Virtual
+         * plays work out where they'd be from these
+         */
+        double position;
+        std::chrono::steady_clock::time_point positionTime;
+    };
+
+    /**
+     * Obtains the gain and pan of the given play from where the listener is.
+     */
+    void place(const PositionalPlay& play, float& gain, float& pan);
+
+    /**
+     * Obtains the frame the given virtual play would have reached by now.
+     */
+    static double estimatePosition(const PositionalPlay& play, std::chrono::steady_clock::time_point now);
+
+    VoicePool& voices;
+    std::vector<PositionalPlay> plays;
+    float audibilityThreshold;
+
+    /**
+     * The camera's center and half its width, as of the last update
+     */
+    float listenerX;
+    float listenerY;
+    float listenerHalfWidth;
+};
+
+#endif
@@ -1,75 +1,590 @@
 #include "SoundView.h"
+#include "ResourceManager.h"
+#include "WorkerPool.h"
+#include "SfmlAudioDevice.h"
+#include <cstdio>
+#include <chrono>
 
-SoundView::SoundView()
+const unsigned int SoundView::DEFAULT_MAX_INSTANCES;
+
+SoundView::SoundView() : mixer(VoicePool::DEFAULT_VOICE_COUNT), voices(mixer), device(std::make_shared<SfmlAudioDevice>()), spatializer(voices),
+    musicBufferSeconds(MusicStream::DEFAULT_BUFFER_SECONDS), voiceStats(), musicStats(), unloadedMusicStats()
 {
     
 }
 
-void SoundView::Initialize()
+SoundView::SoundView(std::shared_ptr<AudioDevice> device) : mixer(VoicePool::DEFAULT_VOICE_COUNT), voices(mixer), device(device), spatializer(voices),
+    musicBufferSeconds(MusicStream::DEFAULT_BUFFER_SECONDS), voiceStats(), musicStats(), unloadedMusicStats()
 {
     
 }
 
-void SoundView::Update(std::shared_ptr<SoundManager> soundManager)
+SoundView::~SoundView()
+{
+    this->device->Stop();
+}
+
+void SoundView::Initialize()
+{
+    this->device->Start(this->mixer);
+}
+
+void SoundView::Update(std::shared_ptr<SoundManager> soundManager, std::shared_ptr<Camera> camera)
 {
     if(!soundManager->IsViewSet())
     {
         soundManager->SetView(this->shared_from_this());
     }
+
+    // Bounded by the queue's capacity so a game thread that keeps queueing
+    // can't hold up the rest of the view thread's frame
+    SoundCommand command;
+    for(unsigned int i = 0; i < SoundManager::COMMAND_QUEUE_CAPACITY && soundManager->TakeCommand(command); i++)
+    {
+        std::chrono::duration<double, std::milli> latency = std::chrono::steady_clock::now() - command.queuedTime;
+        this->execute(command);
+        soundManager->RecordCommandLatency(latency.count());
+    }
+    this->finishLoads();
+    this->spatializer.Update(camera);
+
+    MusicStream::Stats musicStats = this->unloadedMusicStats;
+    for(auto slot = this->musicSlots.begin(); slot != this->musicSlots.end(); slot++)
+    {
+        if(slot->stream != nullptr)
+        {
+            slot->stream->RequestDecode();
+            MusicStream::Stats streamStats = slot->stream->GetStats();
+            musicStats.underrunCount += streamStats.underrunCount;
+            musicStats.underrunFrameCount += streamStats.underrunFrameCount;
+            musicStats.decodedFrameCount += streamStats.decodedFrameCount;
+        }
+    }
+
+    VoicePool::Stats stats = this->voices.GetStats();
+    stats.virtualVoiceCount = this->spatializer.GetVirtualPlayCount();
+    {
+        std::lock_guard<std::mutex> lock(this->statsMutex);
+        this->voiceStats = stats;
+        this->musicStats = musicStats;
+    }
+    this->soundSampleCache.Collect(ResourceManager::GetInstance()->GetUnloadGracePeriod());
+}
+
+VoicePool::Stats SoundView::GetVoiceStats()
+{
+    std::lock_guard<std::mutex> lock(this->statsMutex);
+    return this->voiceStats;
+}
+
+MusicStream::Stats SoundView::GetMusicStats()
+{
+    std::lock_guard<std::mutex> lock(this->statsMutex);
+    return this->musicStats;
+}
+
+void SoundView::execute(const SoundCommand& command)
+{
+    switch(command.type)
+    {
+    case SoundCommandType::LOAD_SOUND:
+        this->loadSound(command);
+        break;
+    case SoundCommandType::LOAD_MUSIC:
+        this->loadMusic(command);
+        break;
+    case SoundCommandType::LOAD_SOUND_ASYNC:
+        this->loadSoundAsync(command);
+        break;
+    case SoundCommandType::LOAD_MUSIC_ASYNC:
+        this->loadMusicAsync(command);
+        break;
+    case SoundCommandType::UNLOAD_SOUND:
+        this->unloadSound(command.sound);
+        break;
+    case SoundCommandType::UNLOAD_MUSIC:
+        this->unloadMusic(command.music);
+        break;
+    case SoundCommandType::PLAY_SOUND:
+        this->playSound(command.sound, command.gain, command.pan, command.pitch);
+        break;
+    case SoundCommandType::PLAY_SOUND_AT:
+        this->playSoundAt(command.sound, command.x, command.y, command.gain, command.pitch);
+        break;
+    case SoundCommandType::PLAY_MUSIC:
+    case SoundCommandType::RESUME_MUSIC:
+        this->setMusicPlaying(command.music, true);
+        break;
+    case SoundCommandType::PAUSE_MUSIC:
+        this->setMusicPlaying(command.music, false);
+        break;
+    case SoundCommandType::CROSSFADE_MUSIC:
+        this->crossfadeMusic(command.music, command.otherMusic, command.seconds);
+        break;
+    case SoundCommandType::SET_MUSIC_LOOP:
+        if(command.music.GetIndex() < this->musicSlots.size())
+        {
+            MusicSlot& slot = this->musicSlots[command.music.GetIndex()];
+            slot.loop = command.value != 0;
+            if(slot.stream != nullptr)
+            {
+                slot.stream->SetLoop(slot.loop);
+            }
+        }
+        break;
+    case SoundCommandType::SET_MUSIC_BUFFER_SECONDS:
+        this->musicBufferSeconds = command.seconds;
+        break;
+    case SoundCommandType::SET_SOUND_MAX_INSTANCES:
+        if(command.sound.GetIndex() < this->soundSlots.size())
+        {
+            this->soundSlots[command.sound.GetIndex()].maxInstances = (unsigned int)command.value;
+        }
+        break;
+    case SoundCommandType::SET_SOUND_PRIORITY:
+        if(command.sound.GetIndex() < this->soundSlots.size())
+        {
+            this->soundSlots[command.sound.GetIndex()].priority = command.value;
+        }
+        break;
+    case SoundCommandType::SET_SOUND_ATTENUATION:
+        if(command.sound.GetIndex() < this->soundSlots.size())
+        {
+            this->soundSlots[command.sound.GetIndex()].attenuation = command.attenuation;
+        }
+        break;
+    case SoundCommandType::SET_AUDIBILITY_THRESHOLD:
+        this->spatializer.SetAudibilityThreshold(command.gain);
+        break;
+    }
+}
+
+void SoundView::loadSound(const SoundCommand& command)
+{
+    unsigned int index = command.sound.GetIndex();
+    if(index >= this->soundSlots.size())
+    {
+        this->soundSlots.resize(index + 1);
+    }
+    // Settings apply even if the load fails, so the slot is always reset
+    SoundSlot& slot = this->soundSlots[index];
+    // A slot is only reused once its sound is unloaded, but samples it still
+    // holds are released rather than leaked
+    if(slot.samples != nullptr)
+    {
+        this->soundSampleCache.Release(slot.filename);
+    }
+    slot.samples = this->soundSampleCache.Acquire(command.filename, SoundView::loadSoundSamples);
+    slot.filename = command.filename;
+    slot.maxInstances = SoundView::DEFAULT_MAX_INSTANCES;
+    slot.priority = 0;
+    slot.attenuation = SoundSpatializer::DEFAULT_ATTENUATION;
+    slot.loading = false;
+    slot.policy = command.policy;
+    slot.decode = std::shared_future<std::shared_ptr<SoundMixer::Samples>>();
+    slot.deferredPlays.clear();
+    slot.loaded = nullptr;
+    if(slot.samples == nullptr)
+    {
+        printf("Error loading sound %s.\n", command.filename.c_str());
+    }
+    command.loaded->set_value(slot.samples != nullptr);
+}
+
+void SoundView::loadSoundAsync(const SoundCommand& command)
+{
+    unsigned int index = command.sound.GetIndex();
+    if(index >= this->soundSlots.size())
+    {
+        this->soundSlots.resize(index + 1);
+    }
+    SoundSlot& slot = this->soundSlots[index];
+    if(slot.samples != nullptr)
+    {
+        this->soundSampleCache.Release(slot.filename);
+    }
+    slot.samples = this->soundSampleCache.AcquireCached(command.filename);
+    slot.filename = command.filename;
+    slot.maxInstances = SoundView::DEFAULT_MAX_INSTANCES;
+    slot.priority = 0;
+    slot.attenuation = SoundSpatializer::DEFAULT_ATTENUATION;
+    slot.policy = command.policy;
+    slot.decode = std::shared_future<std::shared_ptr<SoundMixer::Samples>>();
+    slot.deferredPlays.clear();
+    slot.loaded = nullptr;
+    if(slot.samples != nullptr)
+    {
+        slot.loading = false;
+        command.loaded->set_value(true);
+        return;
+    }
+
+    auto decode = this->soundDecodes.find(command.filename);
+    if(decode != this->soundDecodes.end())
+    {
+        slot.decode = decode->second;
+    }
+    else
+    {
+        std::shared_ptr<std::promise<std::shared_ptr<SoundMixer::Samples>>> result = make_shared<std::promise<std::shared_ptr<SoundMixer::Samples>>>();
+        std::string filename = command.filename;
+        slot.decode = result->get_future().share();
+        this->soundDecodes[filename] = slot.decode;
+        WorkerPool::GetInstance()->Submit([result, filename]()
+        {
+            result->set_value(SoundView::loadSoundSamples(filename));
+        });
+    }
+    slot.loading = true;
+    slot.deferredSound = command.sound;
+    slot.loaded = command.loaded;
+    this->loadingSounds.push_back(index);
+}
+
+std::shared_ptr<SoundMixer::Samples> SoundView::loadSoundSamples(const std::string& filename)
+{
+    sf::SoundBuffer buff;
+    AssetPack::Asset asset;
+    if(ResourceManager::GetInstance()->ReadAsset(filename, asset))
+    {
+        if(!buff.loadFromMemory(asset.data, asset.size))
+        {
+            return nullptr;
+        }
+    }
+    else if(!buff.loadFromFile(filename))
+    {
+        return nullptr;
+    }
+    return SoundMixer::ConvertBuffer(buff);
+}
+
+void SoundView::loadMusic(const SoundCommand& command)
+{
+    unsigned int index = command.music.GetIndex();
+    if(index >= this->musicSlots.size())
+    {
+        this->musicSlots.resize(index + 1);
+    }
+    MusicSlot& slot = this->musicSlots[index];
+    slot.stream = SoundView::openMusic(command.filename, command.inputStream, this->musicBufferSeconds);
+    slot.filename = command.filename;
+    slot.loop = false;
+    slot.loading = false;
+    slot.policy = command.policy;
+    slot.open = std::shared_future<std::shared_ptr<MusicStream>>();
+    slot.playWhenOpened = false;
+    slot.loaded = nullptr;
+    if(slot.stream == nullptr)
+    {
+        printf("Error loading music %s.\n", command.filename.c_str());
+    }
+    command.loaded->set_value(slot.stream != nullptr);
+}
+
+void SoundView::loadMusicAsync(const SoundCommand& command)
+{
+    unsigned int index = command.music.GetIndex();
+    if(index >= this->musicSlots.size())
+    {
+        this->musicSlots.resize(index + 1);
+    }
+    std::shared_ptr<std::promise<std::shared_ptr<MusicStream>>> result = make_shared<std::promise<std::shared_ptr<MusicStream>>>();
+    std::string filename = command.filename;
+    std::shared_ptr<sf::InputStream> inputStream = command.inputStream;
+    float bufferSeconds = this->musicBufferSeconds;
+    WorkerPool::GetInstance()->Submit([result, filename, inputStream, bufferSeconds]()
+    {
+        result->set_value(SoundView::openMusic(filename, inputStream, bufferSeconds));
+    });
+
+    MusicSlot& slot = this->musicSlots[index];
+    slot.stream = nullptr;
+    slot.filename = command.filename;
+    slot.loop = false;
+    slot.loading = true;
+    slot.policy = command.policy;
+    slot.open = result->get_future().share();
+    slot.playWhenOpened = false;
+    slot.loaded = command.loaded;
+    this->loadingMusic.push_back(index);
 }
 
-bool SoundView::LoadSound(long id, std::string filename)
+std::shared_ptr<MusicStream> SoundView::openMusic(const std::string& filename, std::shared_ptr<sf::InputStream> inputStream,
+                                                  float bufferSeconds)
 {
-    std::shared_ptr<sf::SoundBuffer> buff = make_shared<sf::SoundBuffer>();
-    if(!buff->loadFromFile(filename))
+    std::shared_ptr<MusicStream> stream = make_shared<MusicStream>(bufferSeconds);
+    AssetPack::Asset asset;
+    if(inputStream != nullptr)
+    {
+        if(!stream->OpenFromStream(inputStream))
+        {
+            return nullptr;
+        }
+    }
+    else if(ResourceManager::GetInstance()->ReadAsset(filename, asset))
+    {
+        if(!stream->OpenFromAsset(asset))
+        {
+            return nullptr;
+        }
+    }
+    else if(!stream->OpenFromFile(filename))
     {
-        return false;
+        return nullptr;
     }
-    std::shared_ptr<sf::Sound> sound = make_shared<sf::Sound>();
-    sound->setBuffer(*buff);
-    this->soundMap[id] = sound;
-    this->soundBuffers[id] = buff;
-    return true;
+    // Filled now so the first play doesn't wait on a worker
+    stream->Decode();
+    return stream;
 }
 
-bool SoundView::LoadMusic(long id, std::string filename)
+void SoundView::finishLoads()
 {
-    std::shared_ptr<sf::Music> music = make_shared<sf::Music>();
-    if(!music->openFromFile(filename))
+    // Finished slots are swapped out of the list as they're found
+    for(unsigned int i = 0; i < this->loadingSounds.size();)
+    {
+        SoundSlot& slot = this->soundSlots[this->loadingSounds[i]];
+        if(slot.loading && slot.decode.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            i++;
+            continue;
+        }
+        this->loadingSounds[i] = this->loadingSounds.back();
+        this->loadingSounds.pop_back();
+        if(!slot.loading)
+        {
+            continue;
+        }
+
+        std::shared_ptr<SoundMixer::Samples> samples = slot.decode.get();
+        slot.loading = false;
+        slot.decode = std::shared_future<std::shared_ptr<SoundMixer::Samples>>();
+        if(samples != nullptr)
+        {
+            slot.samples = this->soundSampleCache.Insert(slot.filename, samples);
+            for(auto play = slot.deferredPlays.begin(); play != slot.deferredPlays.end(); play++)
+            {
+                if(play->positional)
+                {
+                    this->spatializer.Play(slot.deferredSound, slot.samples, slot.maxInstances, slot.priority, slot.attenuation,
+                                           play->x, play->y, play->gain, play->pitch);
+                }
+                else
+                {
+                    this->voices.Play(slot.deferredSound, slot.samples, slot.maxInstances, slot.priority, play->gain, play->pan, play->pitch);
+                }
+            }
+        }
+        else
+        {
+            printf("Error loading sound %s.\n", slot.filename.c_str());
+        }
+        slot.deferredPlays.clear();
+        slot.loaded->set_value(samples != nullptr);
+        slot.loaded = nullptr;
+    }
+
+    // Every slot waiting on a finished decode has taken its result by now
+    for(auto it = this->soundDecodes.begin(); it != this->soundDecodes.end();)
+    {
+        if(it->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            it = this->soundDecodes.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    for(unsigned int i = 0; i < this->loadingMusic.size();)
+    {
+        MusicSlot& slot = this->musicSlots[this->loadingMusic[i]];
+        if(slot.loading && slot.open.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            i++;
+            continue;
+        }
+        this->loadingMusic[i] = this->loadingMusic.back();
+        this->loadingMusic.pop_back();
+        if(!slot.loading)
+        {
+            continue;
+        }
+
+        slot.stream = slot.open.get();
+        slot.loading = false;
+        slot.open = std::shared_future<std::shared_ptr<MusicStream>>();
+        if(slot.stream == nullptr)
+        {
+            printf("Error loading music %s.\n", slot.filename.c_str());
+        }
+        else
+        {
+            slot.stream->SetLoop(slot.loop);
+            if(slot.playWhenOpened)
+            {
+                this->startStream(slot.stream);
+            }
+        }
+        slot.loaded->set_value(slot.stream != nullptr);
+        slot.loaded = nullptr;
+    }
+}
+
+void SoundView::unloadSound(SoundHandle sound)
+{
+    unsigned int index = sound.GetIndex();
+    if(index >= this->soundSlots.size())
+    {
+        return;
+    }
+    SoundSlot& slot = this->soundSlots[index];
+    if(slot.loading)
+    {
+        // The decode can't be cancelled; its result is simply not used
+        slot.loading = false;
+        slot.decode = std::shared_future<std::shared_ptr<SoundMixer::Samples>>();
+        slot.deferredPlays.clear();
+        slot.loaded->set_value(false);
+        slot.loaded = nullptr;
+    }
+    if(slot.samples != nullptr)
     {
-        return false;
+        this->voices.Stop(sound);
+        this->spatializer.Stop(sound);
+        slot.samples = nullptr;
+        this->soundSampleCache.Release(slot.filename);
     }
-    this->musicMap[id] = music;
-    return true;
+    slot.filename.clear();
 }
 
-void SoundView::UnloadSound(long id)
+void SoundView::unloadMusic(MusicHandle music)
 {
-    this->soundMap.erase(id);
-    this->soundBuffers.erase(id);
+    unsigned int index = music.GetIndex();
+    if(index >= this->musicSlots.size())
+    {
+        return;
+    }
+    MusicSlot& slot = this->musicSlots[index];
+    if(slot.loading)
+    {
+        slot.loading = false;
+        slot.open = std::shared_future<std::shared_ptr<MusicStream>>();
+        slot.loaded->set_value(false);
+        slot.loaded = nullptr;
+    }
+    if(slot.stream != nullptr)
+    {
+        // A decode still queued keeps the stream alive until it's done
+        this->mixer.RemoveSource(slot.stream);
+        MusicStream::Stats stats = slot.stream->GetStats();
+        this->unloadedMusicStats.underrunCount += stats.underrunCount;
+        this->unloadedMusicStats.underrunFrameCount += stats.underrunFrameCount;
+        this->unloadedMusicStats.decodedFrameCount += stats.decodedFrameCount;
+        slot.stream = nullptr;
+    }
 }
 
-void SoundView::UnloadMusic(long id)
+void SoundView::playSound(SoundHandle sound, float gain, float pan, float pitch)
 {
-    this->musicMap.erase(id);
+    unsigned int index = sound.GetIndex();
+    if(index >= this->soundSlots.size())
+    {
+        return;
+    }
+    SoundSlot& slot = this->soundSlots[index];
+    if(slot.samples != nullptr)
+    {
+        this->voices.Play(sound, slot.samples, slot.maxInstances, slot.priority, gain, pan, pitch);
+    }
+    else if(slot.loading && slot.policy == PendingPlayPolicy::DEFER)
+    {
+        // Plays past the instance limit would only restart each other
+        if(slot.maxInstances == 0 || slot.deferredPlays.size() < slot.maxInstances)
+        {
+            DeferredPlay play = { gain, pan, pitch, false, 0.0f, 0.0f };
+            slot.deferredPlays.push_back(play);
+        }
+    }
 }
 
-void SoundView::PlaySound(long id)
+void SoundView::playSoundAt(SoundHandle sound, float x, float y, float gain, float pitch)
 {
-    this->soundMap[id]->play();
+    unsigned int index = sound.GetIndex();
+    if(index >= this->soundSlots.size())
+    {
+        return;
+    }
+    SoundSlot& slot = this->soundSlots[index];
+    if(slot.samples != nullptr)
+    {
+        this->spatializer.Play(sound, slot.samples, slot.maxInstances, slot.priority, slot.attenuation, x, y, gain, pitch);
+    }
+    else if(slot.loading && slot.policy == PendingPlayPolicy::DEFER)
+    {
+        if(slot.maxInstances == 0 || slot.deferredPlays.size() < slot.maxInstances)
+        {
+            DeferredPlay play = { gain, 0.0f, pitch, true, x, y };
+            slot.deferredPlays.push_back(play);
+        }
+    }
 }
 
-void SoundView::PlayMusic(long id)
+void SoundView::setMusicPlaying(MusicHandle music, bool playing)
 {
-    this->musicMap[id]->play();
+    unsigned int index = music.GetIndex();
+    if(index >= this->musicSlots.size())
+    {
+        return;
+    }
+    MusicSlot& slot = this->musicSlots[index];
+    if(slot.stream != nullptr)
+    {
+        if(playing)
+        {
+            this->startStream(slot.stream);
+        }
+        else
+        {
+            this->mixer.RemoveSource(slot.stream);
+        }
+    }
+    else if(slot.loading && slot.policy == PendingPlayPolicy::DEFER)
+    {
+        slot.playWhenOpened = playing;
+    }
 }
 
-void SoundView::PauseMusic(long id)
+void SoundView::crossfadeMusic(MusicHandle from, MusicHandle to, float seconds)
 {
-    this->musicMap[id]->pause();
+    if(!to.IsNull() && to.GetIndex() < this->musicSlots.size() && this->musicSlots[to.GetIndex()].stream != nullptr)
+    {
+        std::shared_ptr<MusicStream> stream = this->musicSlots[to.GetIndex()].stream;
+        if(!this->mixer.HasSource(stream))
+        {
+            if(stream->IsFinished())
+            {
+                stream->Rewind();
+            }
+            stream->FadeTo(0.0f, 0.0f, false);
+        }
+        stream->FadeTo(1.0f, seconds, false);
+        this->mixer.AddSource(stream);
+    }
+    if(!from.IsNull() && from.GetIndex() < this->musicSlots.size() && this->musicSlots[from.GetIndex()].stream != nullptr)
+    {
+        this->musicSlots[from.GetIndex()].stream->FadeTo(0.0f, seconds, true);
+    }
 }
 
-void SoundView::ResumeMusic(long id)
+void SoundView::startStream(const std::shared_ptr<MusicStream>& stream)
 {
-    this->musicMap[id]->play();
+    // A stream that played to the end has left the mixer, so it's safe to rewind
+    if(!this->mixer.HasSource(stream) && stream->IsFinished())
+    {
+        stream->Rewind();
+    }
+    stream->FadeTo(1.0f, 0.0f, false);
+    this->mixer.AddSource(stream);
 }
@@ -3,6 +3,19 @@
 
 #include "ControllerPackage.h"
 #include "SoundManager.h"
+#include "ResourceHandles.h"
+#include "AssetPack.h"
+#include "ResourceCache.h"
+#include "VoicePool.h"
+#include "SoundMixer.h"
+#include "MusicStream.h"
+#include "AudioDevice.h"
+#include "SoundSpatializer.h"
+#include "Camera.h"
+#include "SoundCommand.h"
+#include <vector>
+#include <mutex>
+#include <future>
 #include <unordered_map>
 #include <SFML/Audio.hpp>
 #include <string>
@@ -12,85 +25,270 @@ class SoundManager;
 
 /**
  * Provides a full set of logic for achieving sound effects. Basically just wraps SFML's audio functionality.
+ *
+ * Sound effects are played on a shared VoicePool and mixed in software by a SoundMixer into one output stream
+ * played on an AudioDevice, the sound card unless another device is given,
+ * so a sound can overlap itself up to its instance limit and hundreds of effects cost a single OpenAL source.
+ * Sounds played at a position are placed relative to the camera by a SoundSpatializer.
+ * Music is decoded ahead on the WorkerPool by a MusicStream per track and mixed in with the sound effects, so a
+ * slow disk delays decoding rather than playback, and tracks can be crossfaded without a gap.
+ *
+ * Everything is driven by the commands the SoundManager queues on the game thread, which are carried out here
+ * on the view thread at the start of each update. Async loads are handed to the WorkerPool and finish in a later
+ * update. A sound or music that fails to load is logged and leaves its slot empty, so commands for it do nothing.
  */
 class SoundView : public std::enable_shared_from_this<SoundView>
 {
 public:
+    /**
+     * How many voices a sound may play on at once unless set otherwise.
+     */
+    static const unsigned int DEFAULT_MAX_INSTANCES = 4;
+
     /**
      * Constructs a SoundView given a controller package.
      */
     SoundView();
+
+    /**
+     * Constructs a SoundView playing sound effects on the given device, such
+     * as a NullAudioDevice where there is no audio hardware.
+     */
+    SoundView(std::shared_ptr<AudioDevice> device);
+
+    /**
+     * Stops the audio device, so it stops using the mixer.
+     */
+    ~SoundView();
     
     /**
-     * Initializes the SoundView.
+     * Initializes the SoundView, starting the audio device.
      */
     void Initialize();
     
     /**
-     * Updates this SoundView with the given SoundManager
+     * Updates this SoundView with the given SoundManager, carrying out the
+     * commands it has queued, placing positional sounds relative to the given
+     * camera and freeing sound buffers that have gone unused for the grace
+     * period
      */
-    void Update(std::shared_ptr<SoundManager> soundManager);
-    
+    void Update(std::shared_ptr<SoundManager> soundManager, std::shared_ptr<Camera> camera);
+
     /**
-     * Loads and stores a sound from the given filename and the given ID
+     * Obtains the voice pool's counters as of the last update. Safe to call
+     * from any thread
      */
-    bool LoadSound(long id, std::string filename);
-    
+    VoicePool::Stats GetVoiceStats();
+
     /**
-     * Loads and stores a music from the given filename and the given ID
+     * Obtains the music streams' counters, summed, as of the last update. Safe
+     * to call from any thread
      */
-    bool LoadMusic(long id, std::string filename);
+    MusicStream::Stats GetMusicStats();
     
+private:
+    // Private constructors to disallow access.
+    SoundView(SoundView const &other);
+    SoundView operator=(SoundView other);
+
     /**
-     * Unloads the sound mapped to the given id
+     * Carries out a command queued by the SoundManager
      */
-    void UnloadSound(long id);
+    void execute(const SoundCommand& command);
     
     /**
-     * Unloads the music mapped to the given id
+     * Loads a sound on the view thread, reading it from a mounted asset pack
+     * if one contains it. Sounds loaded from the same file share one set of
+     * decoded samples
      */
-    void UnloadMusic(long id);
-    
+    void loadSound(const SoundCommand& command);
+
     /**
-     * Plays the sound mapped to the given ID
+     * Starts decoding a sound on a worker thread, sharing a decode already
+     * running for the same file
      */
-    void PlaySound(long id);
+    void loadSoundAsync(const SoundCommand& command);
     
     /**
-     * Plays the music mapped to the given ID
+     * Opens a music on the view thread, streaming it from the command's input
+     * stream if it has one, otherwise from a mounted asset pack if one
+     * contains it
      */
-    void PlayMusic(long id);
+    void loadMusic(const SoundCommand& command);
+
+    /**
+     * Starts opening a music on a worker thread
+     */
+    void loadMusicAsync(const SoundCommand& command);
+
+    /**
+     * Makes the sounds and music whose worker has finished playable, playing
+     * any deferred plays, and fulfils their load promises
+     */
+    void finishLoads();
     
     /**
-     * Pauses the music mapped to the given ID
+     * Unloads the given sound
      */
-    void PauseMusic(long id);
+    void unloadSound(SoundHandle sound);
     
     /**
-     * Resumes the music mapped to the given ID
+     * Unloads the given music
      */
-    void ResumeMusic(long id);
+    void unloadMusic(MusicHandle music);
     
-private:
-    // Private constructors to disallow access.
-    SoundView(SoundView const &other);
-    SoundView operator=(SoundView other);
+    /**
+     * Plays the given sound on a free voice, or one stolen from a lower priority
+     * sound. Plays of a sound still loading are deferred or dropped
+     */
+    void playSound(SoundHandle sound, float gain, float pan, float pitch);
+
+    /**
+     * Plays the given sound at the given world position, deferring or dropping
+     * it like playSound while the sound is loading
+     */
+    void playSoundAt(SoundHandle sound, float x, float y, float gain, float pitch);
+
+    /**
+     * Plays or pauses the given music. Music still opening plays once it has
+     * opened if its policy defers plays
+     */
+    void setMusicPlaying(MusicHandle music, bool playing);
+
+    /**
+     * Fades the first music out over the given number of seconds, pausing it
+     * once silent, while fading the second in from silence, or from where it
+     * is if it's already playing
+     */
+    void crossfadeMusic(MusicHandle from, MusicHandle to, float seconds);
+
+    /**
+     * Starts mixing the given stream at full gain, from the start if it had
+     * played to the end
+     */
+    void startStream(const std::shared_ptr<MusicStream>& stream);
     
     /**
-     * The map from ID to Music objects
+     * A play of a sound that was still loading
+     */
+    struct DeferredPlay
+    {
+        float gain;
+        float pan;
+        float pitch;
+        bool positional;
+        float x;
+        float y;
+    };
+
+    /**
+     * A loaded sound effect and how it is played
+     */
+    struct SoundSlot
+    {
+        std::shared_ptr<SoundMixer::Samples> samples;
+        std::string filename;
+        unsigned int maxInstances;
+        int priority;
+        SoundAttenuation attenuation;
+
+        /**
+         * While a worker decodes the sound, its result, and the plays made
+         * meanwhile if they're deferred
+         */
+        bool loading;
+        PendingPlayPolicy policy;
+        std::shared_future<std::shared_ptr<SoundMixer::Samples>> decode;
+        SoundHandle deferredSound;
+        std::vector<DeferredPlay> deferredPlays;
+        std::shared_ptr<std::promise<bool>> loaded;
+    };
+
+    /**
+     * Sound effects, indexed by the slot of their handle
+     */
+    std::vector<SoundSlot> soundSlots;
+
+    /**
+     * An opened music and whether it loops, and while a worker opens it, its
+     * result and whether it should start playing once opened
+     */
+    struct MusicSlot
+    {
+        std::shared_ptr<MusicStream> stream;
+        std::string filename;
+        bool loop;
+        bool loading;
+        PendingPlayPolicy policy;
+        std::shared_future<std::shared_ptr<MusicStream>> open;
+        bool playWhenOpened;
+        std::shared_ptr<std::promise<bool>> loaded;
+    };
+
+    /**
+     * Music, indexed by the slot of their handle. The SoundManager validates
+     * handles before passing them on, so only the slot is needed.
+     */
+    std::vector<MusicSlot> musicSlots;
+
+    /**
+     * The slots of sounds and music a worker is loading
+     */
+    std::vector<unsigned int> loadingSounds;
+    std::vector<unsigned int> loadingMusic;
+
+    /**
+     * Decodes running on workers by file name, so a file loaded several times
+     * at once is only decoded once
      */
-    std::unordered_map<long, std::shared_ptr<sf::Music>> musicMap;
+    std::unordered_map<std::string, std::shared_future<std::shared_ptr<SoundMixer::Samples>>> soundDecodes;
     
     /**
-     * The map from ID to Sound objects
+     * Mixes every sound effect, the voices deciding which of its voices each
+     * plays on, and the device playing the mix
      */
-    std::unordered_map<long, std::shared_ptr<sf::Sound>> soundMap;
+    SoundMixer mixer;
+    VoicePool voices;
+    std::shared_ptr<AudioDevice> device;
 
+    /**
+     * Plays sounds at world positions on the voices
+     */
+    SoundSpatializer spatializer;
+
+    /**
+     * How far ahead music opened from now on is decoded
+     */
+    float musicBufferSeconds;
+
+    /**
+     * The voice pool's and music streams' counters, copied after each update
+     * for other threads. Unloaded streams' counters are kept in the totals
+     */
+    VoicePool::Stats voiceStats;
+    MusicStream::Stats musicStats;
+    MusicStream::Stats unloadedMusicStats;
+    std::mutex statsMutex;
+
+    /**
+     * Decoded samples, shared by every sound loaded from the same file and
+     * kept for the ResourceManager's grace period once unused
+     */
+    ResourceCache<SoundMixer::Samples> soundSampleCache;
+
+    /**
+     * Decodes a sound's samples, from a mounted asset pack if one has it.
+     * Safe to call from a worker thread
+     */
+    static std::shared_ptr<SoundMixer::Samples> loadSoundSamples(const std::string& filename);
 
     /**
-     * Vector of sound buffer references
+     * Opens a music from the given stream, or if there is none, from a mounted
+     * asset pack if one has the file, and decodes its first buffer. Returns
+     * null if it can't be opened. Safe to call from a worker thread
      */
-    std::unordered_map<long, std::shared_ptr<sf::SoundBuffer>> soundBuffers;
+    static std::shared_ptr<MusicStream> openMusic(const std::string& filename, std::shared_ptr<sf::InputStream> inputStream,
+                                                  float bufferSeconds);
 };
 
 #endif
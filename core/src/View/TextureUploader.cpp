@@ -0,0 +1,213 @@
+#include <chrono>
+#include <cstring>
+#include "TextureUploader.h"
+
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#endif
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW 0x88E0
+#endif
+#ifndef GL_WRITE_ONLY
+#define GL_WRITE_ONLY 0x88B9
+#endif
+#ifndef GL_GENERATE_MIPMAP
+#define GL_GENERATE_MIPMAP 0x8191
+#endif
+#ifndef GL_CLAMP_TO_EDGE
+#define GL_CLAMP_TO_EDGE 0x812F
+#endif
+
+const size_t TextureUploader::STRIP_BYTES;
+
+TextureUploader::TextureUploader() :
+    genBuffers(nullptr),
+    deleteBuffers(nullptr),
+    bindBuffer(nullptr),
+    bufferData(nullptr),
+    mapBuffer(nullptr),
+    unmapBuffer(nullptr),
+    pixelBuffersSupported(false),
+    pixelBuffer(0),
+    placeholderTexture(0),
+    currentTexture(0),
+    rowsUploaded(0),
+    uploadedByteCount(0)
+{
+
+}
+
+TextureUploader::~TextureUploader()
+{
+    if (this->pixelBuffer != 0)
+    {
+        this->deleteBuffers(1, &this->pixelBuffer);
+    }
+}
+
+void TextureUploader::Initialize(std::shared_ptr<ResourceManager> resourceManager)
+{
+    if (SOIL_GL_ExtensionSupported("GL_ARB_pixel_buffer_object"))
+    {
+        this->genBuffers = (GenBuffersProc)SOIL_GL_GetProcAddress("glGenBuffersARB");
+        this->deleteBuffers = (DeleteBuffersProc)SOIL_GL_GetProcAddress("glDeleteBuffersARB");
+        this->bindBuffer = (BindBufferProc)SOIL_GL_GetProcAddress("glBindBufferARB");
+        this->bufferData = (BufferDataProc)SOIL_GL_GetProcAddress("glBufferDataARB");
+        this->mapBuffer = (MapBufferProc)SOIL_GL_GetProcAddress("glMapBufferARB");
+        this->unmapBuffer = (UnmapBufferProc)SOIL_GL_GetProcAddress("glUnmapBufferARB");
+        this->pixelBuffersSupported = this->genBuffers != nullptr && this->deleteBuffers != nullptr && this->bindBuffer != nullptr &&
+            this->bufferData != nullptr && this->mapBuffer != nullptr && this->unmapBuffer != nullptr;
+    }
+    if (this->pixelBuffersSupported)
+    {
+        this->genBuffers(1, &this->pixelBuffer);
+    }
+
+    // Textures that are still loading are drawn as plain white, so sprites
+    // show up in their own color until their texture arrives.
+    const unsigned char white[4] = { 255, 255, 255, 255 };
+    glGenTextures(1, &this->placeholderTexture);
+    glBindTexture(GL_TEXTURE_2D, this->placeholderTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    resourceManager->SetPlaceholderTextureUnit(this->placeholderTexture);
+}
+
+void TextureUploader::Update(std::shared_ptr<ResourceManager> resourceManager, double budgetMilliseconds)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<unsigned int> textureUnitsToDelete = resourceManager->TakeTextureUnitsToDelete();
+    if (!textureUnitsToDelete.empty())
+    {
+        glDeleteTextures((GLsizei)textureUnitsToDelete.size(), &textureUnitsToDelete[0]);
+    }
+
+    while (true)
+    {
+        if (this->current == nullptr)
+        {
+            this->current = resourceManager->TakeDecodedTexture();
+            if (this->current == nullptr)
+            {
+                break;
+            }
+        }
+        if (this->uploadNextStrip(resourceManager))
+        {
+            this->current = nullptr;
+        }
+
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() >= budgetMilliseconds)
+        {
+            break;
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+unsigned long long TextureUploader::GetUploadedByteCount()
+{
+    return this->uploadedByteCount;
+}
+
+bool TextureUploader::uploadNextStrip(std::shared_ptr<ResourceManager> resourceManager)
+{
+    DecodedTexture& texture = *this->current;
+    if (!texture.succeeded)
+    {
+        resourceManager->FinishTextureUpload(texture.texture, 0, 0);
+        return true;
+    }
+
+    // Cooked textures are compressed and mipmapped already, which makes
+    // them small enough to upload in one go.
+    if (texture.cooked)
+    {
+        unsigned int textureUnit = SOIL_load_OGL_texture_from_memory(texture.cookedFile.data, (int)texture.cookedFile.size, SOIL_LOAD_AUTO, SOIL_CREATE_NEW_ID, SOIL_FLAG_DDS_LOAD_DIRECT);
+        this->uploadedByteCount += texture.cookedFile.size;
+        resourceManager->FinishTextureUpload(texture.texture, textureUnit, Texture::MeasureByteSize(textureUnit));
+        return true;
+    }
+
+    if (this->currentTexture == 0)
+    {
+        glGenTextures(1, &this->currentTexture);
+        glBindTexture(GL_TEXTURE_2D, this->currentTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texture.width, texture.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        this->rowsUploaded = 0;
+    }
+    else
+    {
+        glBindTexture(GL_TEXTURE_2D, this->currentTexture);
+    }
+
+    size_t rowSize = (size_t)texture.width * 4;
+    int rowCount = (int)(STRIP_BYTES / rowSize);
+    if (rowCount < 1)
+    {
+        rowCount = 1;
+    }
+    if (rowCount > texture.height - this->rowsUploaded)
+    {
+        rowCount = texture.height - this->rowsUploaded;
+    }
+    bool lastStrip = this->rowsUploaded + rowCount == texture.height;
+
+    // Mipmaps are generated by the driver when the base level changes, so
+    // only turn that on for the last strip.
+    if (lastStrip)
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE);
+    }
+
+    const unsigned char* pixels = &texture.data[rowSize * this->rowsUploaded];
+    size_t size = rowSize * rowCount;
+    if (this->pixelBuffersSupported)
+    {
+        this->uploadRowsWithPixelBuffer(this->rowsUploaded, rowCount, pixels, size);
+    }
+    else
+    {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, this->rowsUploaded, texture.width, rowCount, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    }
+    this->rowsUploaded += rowCount;
+    this->uploadedByteCount += size;
+
+    if (!lastStrip)
+    {
+        return false;
+    }
+    resourceManager->FinishTextureUpload(texture.texture, this->currentTexture, Texture::MeasureByteSize(this->currentTexture));
+    this->currentTexture = 0;
+    this->rowsUploaded = 0;
+    return true;
+}
+
+void TextureUploader::uploadRowsWithPixelBuffer(int firstRow, int rowCount, const unsigned char* pixels, size_t size)
+{
+    this->bindBuffer(GL_PIXEL_UNPACK_BUFFER, this->pixelBuffer);
+
+    // Orphan the previous contents so the driver doesn't have to wait for
+    // the last transfer to finish before the buffer can be written.
+    this->bufferData(GL_PIXEL_UNPACK_BUFFER, (ptrdiff_t)size, nullptr, GL_STREAM_DRAW);
+    void* mapped = this->mapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+    if (mapped != nullptr)
+    {
+        std::memcpy(mapped, pixels, size);
+        this->unmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, firstRow, this->current->width, rowCount, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        this->bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    else
+    {
+        this->bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, firstRow, this->current->width, rowCount, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    }
+}
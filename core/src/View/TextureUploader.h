@@ -0,0 +1,103 @@
+#ifndef Core_TextureUploader_h
+#define Core_TextureUploader_h
+
+#include <memory>
+#include <cstddef>
+#include "SFML/OpenGL.hpp"
+#include "ResourceManager.h"
+#include "DecodedTexture.h"
+
+/**
+ * Uploads textures decoded by the ResourceManager's workers to the GPU on
+ * the view thread, within a time budget each frame.
+ *
+ * Large textures are uploaded a strip of rows at a time, so a single big
+ * image is spread across several frames instead of causing a hitch. Where
+ * pixel buffer objects are supported, each strip is copied into one and
+ * the driver transfers it to the texture asynchronously.
+ */
+class TextureUploader
+{
+public:
+    /**
+     * Creates a TextureUploader. Initialize must be called on the view
+     * thread before it is used.
+     */
+    TextureUploader();
+
+    /**
+     * Destructor
+     */
+    ~TextureUploader();
+
+    /**
+     * Checks for pixel buffer object support and creates the placeholder
+     * texture. Must be called with the OpenGL context active.
+     */
+    void Initialize(std::shared_ptr<ResourceManager> resourceManager);
+
+    /**
+     * Deletes the textures the ResourceManager has unloaded, then uploads
+     * decoded textures until they run out or the given number of
+     * milliseconds have passed. At least one strip is uploaded per call
+     * while there is work, so loading always makes progress.
+     */
+    void Update(std::shared_ptr<ResourceManager> resourceManager, double budgetMilliseconds);
+
+    /**
+     * Obtains the total number of bytes uploaded so far.
+     */
+    unsigned long long GetUploadedByteCount();
+
+private:
+    // Private constructors to disallow access.
+    TextureUploader(TextureUploader const &other);
+    TextureUploader operator=(TextureUploader other);
+
+    /**
+     * Uploads the next strip of the current texture, or the whole texture
+     * if it was cooked. Returns true once the texture is finished.
+     */
+    bool uploadNextStrip(std::shared_ptr<ResourceManager> resourceManager);
+
+    /**
+     * Copies the given rows into the pixel buffer and from there into the
+     * current texture.
+     */
+    void uploadRowsWithPixelBuffer(int firstRow, int rowCount, const unsigned char* pixels, size_t size);
+
+    /**
+     * The most bytes uploaded as a single strip.
+     */
+    static const size_t STRIP_BYTES = 256 * 1024;
+
+    typedef void (APIENTRY *GenBuffersProc)(GLsizei count, GLuint* buffers);
+    typedef void (APIENTRY *DeleteBuffersProc)(GLsizei count, const GLuint* buffers);
+    typedef void (APIENTRY *BindBufferProc)(GLenum target, GLuint buffer);
+    typedef void (APIENTRY *BufferDataProc)(GLenum target, ptrdiff_t size, const GLvoid* data, GLenum usage);
+    typedef GLvoid* (APIENTRY *MapBufferProc)(GLenum target, GLenum access);
+    typedef GLboolean (APIENTRY *UnmapBufferProc)(GLenum target);
+
+    GenBuffersProc genBuffers;
+    DeleteBuffersProc deleteBuffers;
+    BindBufferProc bindBuffer;
+    BufferDataProc bufferData;
+    MapBufferProc mapBuffer;
+    UnmapBufferProc unmapBuffer;
+
+    bool pixelBuffersSupported;
+    GLuint pixelBuffer;
+    GLuint placeholderTexture;
+
+    /**
+     * The texture being uploaded, the OpenGL texture it is going into, and
+     * how many of its rows have been uploaded.
+     */
+    std::shared_ptr<DecodedTexture> current;
+    GLuint currentTexture;
+    int rowsUploaded;
+
+    unsigned long long uploadedByteCount;
+};
+
+#endif
@@ -0,0 +1,180 @@
+#include "VoicePool.h"
+
+const unsigned int VoicePool::DEFAULT_VOICE_COUNT;
+
+VoicePool::VoicePool(SoundMixer& mixer) : mixer(mixer), nextStartOrder(1), playCount(0), stolenVoiceCount(0), droppedPlayCount(0)
+{
+    this->voices.resize(mixer.GetVoiceCount());
+    for (unsigned int i = 0; i < this->voices.size(); i++)
+    {
+        this->voices[i].index = i;
+        this->voices[i].priority = 0;
+        this->voices[i].startOrder = 0;
+    }
+    this->activeVoices.resize(this->voices.size());
+}
+
+VoicePool::PlayId VoicePool::Play(SoundHandle sound, std::shared_ptr<const SoundMixer::Samples> samples, unsigned int maxInstances, int priority,
+                                   float gain, float pan, float pitch, double startFrame)
+{
+    PlayId play;
+    play.voice = 0;
+    play.startOrder = 0;
+    this->refreshActiveVoices();
+    Voice* voice = this->chooseVoice(sound, maxInstances, priority);
+    if (voice == nullptr)
+    {
+        this->droppedPlayCount++;
+        return play;
+    }
+    if (isActive(*voice))
+    {
+        this->stolenVoiceCount++;
+    }
+    voice->owner = sound;
+    voice->priority = priority;
+    voice->startOrder = this->nextStartOrder++;
+    this->mixer.Start(voice->index, samples, gain, pan, pitch, startFrame);
+    this->playCount++;
+    play.voice = voice->index;
+    play.startOrder = voice->startOrder;
+    return play;
+}
+
+bool VoicePool::IsPlaying(PlayId play)
+{
+    return play.startOrder != 0 && this->voices[play.voice].startOrder == play.startOrder &&
+        this->voices[play.voice].owner != SoundHandle() && this->mixer.IsPlaying(play.voice);
+}
+
+bool VoicePool::IsStolen(PlayId play)
+{
+    return play.startOrder != 0 && this->voices[play.voice].startOrder != play.startOrder;
+}
+
+double VoicePool::GetPosition(PlayId play)
+{
+    return this->mixer.GetPosition(play.voice);
+}
+
+void VoicePool::SetGainAndPan(PlayId play, float gain, float pan)
+{
+    if (this->IsPlaying(play))
+    {
+        this->mixer.SetVoiceGain(play.voice, gain);
+        this->mixer.SetVoicePan(play.voice, pan);
+    }
+}
+
+void VoicePool::StopPlay(PlayId play)
+{
+    if (this->IsPlaying(play))
+    {
+        this->mixer.Stop(play.voice);
+        this->voices[play.voice].owner = SoundHandle();
+    }
+}
+
+void VoicePool::Stop(SoundHandle sound)
+{
+    for (auto it = this->voices.begin(); it != this->voices.end(); it++)
+    {
+        if (it->owner == sound)
+        {
+            this->mixer.Stop(it->index);
+            it->owner = SoundHandle();
+        }
+    }
+}
+
+unsigned int VoicePool::GetFreeVoiceCount()
+{
+    this->refreshActiveVoices();
+    unsigned int count = 0;
+    for (auto it = this->voices.begin(); it != this->voices.end(); it++)
+    {
+        if (!isActive(*it))
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+VoicePool::Stats VoicePool::GetStats()
+{
+    Stats stats;
+    stats.voiceCount = (unsigned int)this->voices.size();
+    stats.activeVoiceCount = 0;
+    this->refreshActiveVoices();
+    for (auto it = this->voices.begin(); it != this->voices.end(); it++)
+    {
+        if (isActive(*it))
+        {
+            stats.activeVoiceCount++;
+        }
+    }
+    stats.playCount = this->playCount;
+    stats.stolenVoiceCount = this->stolenVoiceCount;
+    stats.droppedPlayCount = this->droppedPlayCount;
+    stats.virtualVoiceCount = 0;
+    return stats;
+}
+
+void VoicePool::refreshActiveVoices()
+{
+    this->mixer.GetActiveVoices(this->activeVoices);
+}
+
+bool VoicePool::isActive(const Voice& voice)
+{
+    return this->activeVoices[voice.index];
+}
+
+VoicePool::Voice* VoicePool::chooseVoice(SoundHandle sound, unsigned int maxInstances, int priority)
+{
+    // Expects the active voices to have just been refreshed
+    // A sound at its instance limit restarts its own oldest voice
+    unsigned int instances = 0;
+    Voice* oldestInstance = nullptr;
+    Voice* freeVoice = nullptr;
+    Voice* victim = nullptr;
+    for (auto it = this->voices.begin(); it != this->voices.end(); it++)
+    {
+        if (!isActive(*it))
+        {
+            if (freeVoice == nullptr)
+            {
+                freeVoice = &*it;
+            }
+            continue;
+        }
+        if (it->owner == sound)
+        {
+            instances++;
+            if (oldestInstance == nullptr || it->startOrder < oldestInstance->startOrder)
+            {
+                oldestInstance = &*it;
+            }
+        }
+        if (victim == nullptr || it->priority < victim->priority ||
+            (it->priority == victim->priority && it->startOrder < victim->startOrder))
+        {
+            victim = &*it;
+        }
+    }
+
+    if (maxInstances != 0 && instances >= maxInstances)
+    {
+        return oldestInstance;
+    }
+    if (freeVoice != nullptr)
+    {
+        return freeVoice;
+    }
+    if (victim != nullptr && victim->priority <= priority)
+    {
+        return victim;
+    }
+    return nullptr;
+}
@@ -0,0 +1,151 @@
+#ifndef Core_VoicePool_h
+#define Core_VoicePool_h
+
+#include <vector>
+#include <memory>
+#include "ResourceHandles.h"
+#include "SoundMixer.h"
+
+/**
+ * Decides which of a SoundMixer's voices each sound effect is played on.
+ *
+ * Playing a sound picks a voice instead of restarting a sound object of
+ * its own, so the same sound can overlap itself and the number of voices
+ * being mixed stays bounded.
+ *
+ * Each sound may have at most maxInstances voices at a time; playing it
+ * again restarts its oldest one. When every voice is busy, the voice with
+ * the lowest priority, and among those the oldest, is stolen, as long as
+ * its priority isn't higher than the new sound's. Otherwise the new play
+ * is dropped.
+ */
+class VoicePool
+{
+public:
+    /**
+     * Counters describing how the pool has been used.
+     */
+    struct Stats
+    {
+        unsigned int voiceCount;
+        unsigned int activeVoiceCount;
+        unsigned long long playCount;
+        unsigned long long stolenVoiceCount;
+        unsigned long long droppedPlayCount;
+        unsigned int virtualVoiceCount;
+    };
+
+    /**
+     * Identifies one play of a sound on one voice, so it can be adjusted
+     * until the voice is reused. A startOrder of 0 means the play was dropped.
+     */
+    struct PlayId
+    {
+        unsigned int voice;
+        unsigned long long startOrder;
+    };
+
+    /**
+     * Voices are only mixed, not OpenAL sources, so there can be plenty.
+     */
+    static const unsigned int DEFAULT_VOICE_COUNT = 256;
+
+    /**
+     * Creates a pool over every voice of the given mixer, which must outlive it.
+     */
+    VoicePool(SoundMixer& mixer);
+
+    /**
+     * Plays the given sound's samples on a voice with the given gain, pan and
+     * pitch, starting from the given frame. Returns the play, whose startOrder
+     * is 0 if it was dropped.
+     */
+    PlayId Play(SoundHandle sound, std::shared_ptr<const SoundMixer::Samples> samples, unsigned int maxInstances, int priority,
+                float gain, float pan, float pitch, double startFrame = 0.0);
+
+    /**
+     * Obtains whether the given play is still playing on its voice.
+     */
+    bool IsPlaying(PlayId play);
+
+    /**
+     * Obtains whether the given play's voice was taken over by another play
+     * before it finished.
+     */
+    bool IsStolen(PlayId play);
+
+    /**
+     * Obtains the frame of its samples the given play has reached.
+     */
+    double GetPosition(PlayId play);
+
+    /**
+     * Changes the gain and pan of the given play, if it is still playing.
+     */
+    void SetGainAndPan(PlayId play, float gain, float pan);
+
+    /**
+     * Stops the given play, if it is still playing.
+     */
+    void StopPlay(PlayId play);
+
+    /**
+     * Stops every voice playing the given sound.
+     */
+    void Stop(SoundHandle sound);
+
+    /**
+     * Obtains the number of voices not playing anything.
+     */
+    unsigned int GetFreeVoiceCount();
+
+    /**
+     * Obtains the pool's counters. The pool has no virtual voices of its own,
+     * so virtualVoiceCount is left at 0.
+     */
+    Stats GetStats();
+
+private:
+    // Private constructors to disallow access.
+    VoicePool(VoicePool const &other);
+    VoicePool operator=(VoicePool other);
+
+    struct Voice
+    {
+        unsigned int index;
+        SoundHandle owner;
+        int priority;
+        unsigned long long startOrder;
+    };
+
+    /**
+     * Queries the mixer for which voices are still playing, all at once.
+     */
+    void refreshActiveVoices();
+
+    /**
+     * Obtains whether the given voice was playing at the last refresh.
+     */
+    bool isActive(const Voice& voice);
+
+    /**
+     * Picks the voice to play a new sound on, or null to drop it.
+     */
+    Voice* chooseVoice(SoundHandle sound, unsigned int maxInstances, int priority);
+
+    SoundMixer& mixer;
+    std::vector<Voice> voices;
+
+    /**
+     * Whether each voice was playing at the last refresh, kept between
+     * queries to avoid reallocating.
+     */
+    std::vector<bool> activeVoices;
+
+    unsigned long long nextStartOrder;
+    unsigned long long playCount;
+    unsigned long long stolenVoiceCount;
+    unsigned long long droppedPlayCount;
+};
+
+#endif
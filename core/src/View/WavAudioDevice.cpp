@@ -0,0 +1,80 @@
+#include "WavAudioDevice.h"
+#include <stdexcept>
+
+namespace
+{
+    /**
+     * Appends the given value to the buffer in little endian order.
+     */
+    void putLittleEndian(std::vector<unsigned char>& buffer, unsigned int value, unsigned int byteCount)
+    {
+        for (unsigned int i = 0; i < byteCount; i++)
+        {
+            buffer.push_back((unsigned char)(value >> (i * 8)));
+        }
+    }
+
+    void putTag(std::vector<unsigned char>& buffer, const char* tag)
+    {
+        buffer.insert(buffer.end(), tag, tag + 4);
+    }
+}
+
+WavAudioDevice::WavAudioDevice(const std::string& fileName, double speed) : HeadlessAudioDevice(speed), dataSize(0)
+{
+    this->file = fopen(fileName.c_str(), "wb");
+    if (this->file == nullptr)
+    {
+        throw new std::invalid_argument("Could not create WAV file " + fileName);
+    }
+    this->writeHeader(0);
+}
+
+WavAudioDevice::~WavAudioDevice()
+{
+    this->Stop();
+    fclose(this->file);
+}
+
+void WavAudioDevice::Stop()
+{
+    HeadlessAudioDevice::Stop();
+    fseek(this->file, 0, SEEK_SET);
+    this->writeHeader(this->dataSize);
+    fseek(this->file, 0, SEEK_END);
+    fflush(this->file);
+}
+
+void WavAudioDevice::consume(const float* samples, unsigned int frameCount)
+{
+    // The mixer has already limited the mix to [-1, 1]
+    unsigned int sampleCount = frameCount * SoundMixer::CHANNEL_COUNT;
+    this->bytes.clear();
+    for (unsigned int i = 0; i < sampleCount; i++)
+    {
+        short sample = (short)(samples[i] * 32767.0f);
+        putLittleEndian(this->bytes, (unsigned short)sample, 2);
+    }
+    fwrite(this->bytes.data(), 1, this->bytes.size(), this->file);
+    this->dataSize += (unsigned int)this->bytes.size();
+}
+
+void WavAudioDevice::writeHeader(unsigned int dataSize)
+{
+    unsigned int blockAlign = SoundMixer::CHANNEL_COUNT * 2;
+    std::vector<unsigned char> header;
+    putTag(header, "RIFF");
+    putLittleEndian(header, 36 + dataSize, 4);
+    putTag(header, "WAVE");
+    putTag(header, "fmt ");
+    putLittleEndian(header, 16, 4);
+    putLittleEndian(header, 1, 2);
+    putLittleEndian(header, SoundMixer::CHANNEL_COUNT, 2);
+    putLittleEndian(header, SoundMixer::SAMPLE_RATE, 4);
+    putLittleEndian(header, SoundMixer::SAMPLE_RATE * blockAlign, 4);
+    putLittleEndian(header, blockAlign, 2);
+    putLittleEndian(header, 16, 2);
+    putTag(header, "data");
+    putLittleEndian(header, dataSize, 4);
+    fwrite(header.data(), 1, header.size(), this->file);
+}
@@ -0,0 +1,50 @@
+#ifndef Core_WavAudioDevice_h
+#define Core_WavAudioDevice_h
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "HeadlessAudioDevice.h"
+
+/**
+ * Renders the mix into a 16-bit stereo WAV file, to listen to or compare
+ * what the mixer produced without audio hardware.
+ *
+ * The file is valid after every Stop, so a test driving the device with
+ * Pump should call Stop before reading it.
+ */
+class WavAudioDevice : public HeadlessAudioDevice
+{
+public:
+    /**
+     * Creates the given file and a device rendering into it at the given
+     * multiple of real time, or as fast as possible if it's 0. Throws an
+     * exception if the file can't be created.
+     */
+    WavAudioDevice(const std::string& fileName, double speed = 1.0);
+
+    /**
+     * Stops the device's thread and closes the file.
+     */
+    ~WavAudioDevice();
+
+    /**
+     * Stops rendering and brings the file's header up to date.
+     */
+    virtual void Stop();
+
+protected:
+    virtual void consume(const float* samples, unsigned int frameCount);
+
+private:
+    /**
+     * Writes the RIFF header for the given number of sample bytes.
+     */
+    void writeHeader(unsigned int dataSize);
+
+    FILE* file;
+    unsigned int dataSize;
+    std::vector<unsigned char> bytes;
+};
+
+#endif
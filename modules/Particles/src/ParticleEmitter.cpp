@@ -0,0 +1,402 @@
+#include <stdexcept>
+#include <cstring>
+#include <algorithm>
+#include "ParticleEmitter.h"
+#include "VertexStream.h"
+#include "Sprite.h"
+#include "Simd.h"
+
+#ifdef CORE_SIMD_SSE
+namespace
+{
+    /**
+     * Writes the given corner of four consecutive quads, given each of the
+     * corner's components for the four of them.
+     */
+    void putCorners(float* quads, unsigned int corner, __m128 x, __m128 y, __m128 z, __m128 w)
+    {
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        _mm_storeu_ps(quads + corner * 4, x);
+        _mm_storeu_ps(quads + VertexStream::FLOATS_PER_QUAD + corner * 4, y);
+        _mm_storeu_ps(quads + 2 * VertexStream::FLOATS_PER_QUAD + corner * 4, z);
+        _mm_storeu_ps(quads + 3 * VertexStream::FLOATS_PER_QUAD + corner * 4, w);
+    }
+
+    /**
+     * Writes the colors of four consecutive quads, the same at every corner.
+     */
+    void putColors(float* quads, __m128 red, __m128 green, __m128 blue, __m128 alpha)
+    {
+        _MM_TRANSPOSE4_PS(red, green, blue, alpha);
+        __m128 colors[4] = {red, green, blue, alpha};
+        for (unsigned int quad = 0; quad < 4; quad++)
+        {
+            float* quadColors = quads + quad * VertexStream::FLOATS_PER_QUAD;
+            _mm_storeu_ps(quadColors, colors[quad]);
+            _mm_storeu_ps(quadColors + 4, colors[quad]);
+            _mm_storeu_ps(quadColors + 8, colors[quad]);
+            _mm_storeu_ps(quadColors + 12, colors[quad]);
+        }
+    }
+}
+#endif
+
+ParticleEmitter::ParticleEmitter(unsigned int maxParticles)
+: maxParticles(maxParticles),
+liveCount(0),
+x(0.0f),
+y(0.0f),
+emissionRate(0.0f),
+pendingEmission(0.0f),
+pendingBurst(0),
+minimumLifetime(1.0f),
+maximumLifetime(1.0f),
+minimumVelocityX(0.0f),
+minimumVelocityY(0.0f),
+maximumVelocityX(0.0f),
+maximumVelocityY(0.0f),
+accelerationX(0.0f),
+accelerationY(0.0f),
+startColor(1.0f, 1.0f, 1.0f, 1.0f),
+endColor(1.0f, 1.0f, 1.0f, 0.0f),
+size(0.01f),
+depth(0.0f),
+quadCount(0),
+publishedQuadCount(0)
+{
+    if (maxParticles == 0)
+    {
+        throw new std::invalid_argument("An emitter must be able to hold at least one particle.");
+    }
+    unsigned int paddedSize = (maxParticles + CORE_SIMD_WIDTH - 1) / CORE_SIMD_WIDTH * CORE_SIMD_WIDTH;
+    this->positionX.resize(paddedSize, 0.0f);
+    this->positionY.resize(paddedSize, 0.0f);
+    this->velocityX.resize(paddedSize, 0.0f);
+    this->velocityY.resize(paddedSize, 0.0f);
+    this->red.resize(paddedSize, 0.0f);
+    this->green.resize(paddedSize, 0.0f);
+    this->blue.resize(paddedSize, 0.0f);
+    this->alpha.resize(paddedSize, 0.0f);
+    this->redRate.resize(paddedSize, 0.0f);
+    this->greenRate.resize(paddedSize, 0.0f);
+    this->blueRate.resize(paddedSize, 0.0f);
+    this->alphaRate.resize(paddedSize, 0.0f);
+    this->lifetime.resize(paddedSize, 0.0f);
+    this->vertexData.resize(paddedSize * VertexStream::FLOATS_PER_QUAD);
+    this->colorData.resize(paddedSize * VertexStream::FLOATS_PER_QUAD);
+    this->publishedVertexData.resize(paddedSize * VertexStream::FLOATS_PER_QUAD);
+    this->publishedColorData.resize(paddedSize * VertexStream::FLOATS_PER_QUAD);
+}
+
+ParticleEmitter::~ParticleEmitter()
+{
+
+}
+
+void ParticleEmitter::MoveTo(float x, float y)
+{
+    this->x = x;
+    this->y = y;
+}
+
+void ParticleEmitter::SetEmissionRate(float particlesPerSecond)
+{
+    this->emissionRate = particlesPerSecond;
+}
+
+void ParticleEmitter::SetLifetime(float minimum, float maximum)
+{
+    if (minimum <= 0.0f || maximum < minimum)
+    {
+        throw new std::invalid_argument("Particle lifetimes must be positive and the minimum cannot exceed the maximum.");
+    }
+    this->minimumLifetime = minimum;
+    this->maximumLifetime = maximum;
+}
+
+void ParticleEmitter::SetVelocity(float minimumX, float minimumY, float maximumX, float maximumY)
+{
+    this->minimumVelocityX = minimumX;
+    this->minimumVelocityY = minimumY;
+    this->maximumVelocityX = maximumX;
+    this->maximumVelocityY = maximumY;
+}
+
+void ParticleEmitter::SetAcceleration(float x, float y)
+{
+    this->accelerationX = x;
+    this->accelerationY = y;
+}
+
+void ParticleEmitter::SetColors(Color startColor, Color endColor)
+{
+    this->startColor = startColor;
+    this->endColor = endColor;
+}
+
+void ParticleEmitter::SetSize(float size)
+{
+    this->size = size;
+}
+
+void ParticleEmitter::SetDepth(float depth)
+{
+    if (!(depth >= 0.0f && depth <= Sprite::MAX_DEPTH))
+    {
+        throw new std::invalid_argument("Particle emitter was given a depth outside of 0 to Sprite::MAX_DEPTH.");
+    }
+    this->depth = depth;
+}
+
+void ParticleEmitter::Emit(unsigned int count)
+{
+    this->pendingBurst += count;
+}
+
+void ParticleEmitter::Update(float elapsedSeconds)
+{
+    this->pendingEmission += this->emissionRate * elapsedSeconds;
+    unsigned int continuous = (unsigned int)this->pendingEmission;
+    this->pendingEmission -= (float)continuous;
+    this->spawn(continuous + this->pendingBurst);
+    this->pendingBurst = 0;
+
+    this->integrate(elapsedSeconds);
+    this->compact();
+    this->buildQuads();
+}
+
+void ParticleEmitter::Publish()
+{
+    this->vertexData.swap(this->publishedVertexData);
+    this->colorData.swap(this->publishedColorData);
+    std::swap(this->quadCount, this->publishedQuadCount);
+}
+
+unsigned int ParticleEmitter::GetLiveParticleCount()
+{
+    return this->liveCount;
+}
+
+unsigned int ParticleEmitter::GetMaxParticles()
+{
+    return this->maxParticles;
+}
+
+void ParticleEmitter::spawn(unsigned int count)
+{
+    if (count > this->maxParticles - this->liveCount)
+    {
+        count = this->maxParticles - this->liveCount;
+    }
+
+    std::uniform_real_distribution<float> lifetimeDistribution(this->minimumLifetime, this->maximumLifetime);
+    std::uniform_real_distribution<float> velocityXDistribution(this->minimumVelocityX, this->maximumVelocityX);
+    std::uniform_real_distribution<float> velocityYDistribution(this->minimumVelocityY, this->maximumVelocityY);
+    float redChange = this->endColor.red - this->startColor.red;
+    float greenChange = this->endColor.green - this->startColor.green;
+    float blueChange = this->endColor.blue - this->startColor.blue;
+    float alphaChange = this->endColor.alpha - this->startColor.alpha;
+
+    unsigned int end = this->liveCount + count;
+    for (unsigned int i = this->liveCount; i < end; i++)
+    {
+        float particleLifetime = lifetimeDistribution(this->random);
+        float inverseLifetime = 1.0f / particleLifetime;
+        this->positionX[i] = this->x;
+        this->positionY[i] = this->y;
+        this->velocityX[i] = velocityXDistribution(this->random);
+        this->velocityY[i] = velocityYDistribution(this->random);
+        this->red[i] = this->startColor.red;
+        this->green[i] = this->startColor.green;
+        this->blue[i] = this->startColor.blue;
+        this->alpha[i] = this->startColor.alpha;
+        this->redRate[i] = redChange * inverseLifetime;
+        this->greenRate[i] = greenChange * inverseLifetime;
+        this->blueRate[i] = blueChange * inverseLifetime;
+        this->alphaRate[i] = alphaChange * inverseLifetime;
+        this->lifetime[i] = particleLifetime;
+    }
+    this->liveCount = end;
+}
+
+void ParticleEmitter::integrate(float elapsedSeconds)
+{
+    if (this->liveCount == 0)
+    {
+        return;
+    }
+    float dt = elapsedSeconds;
+    float dvx = this->accelerationX * dt;
+    float dvy = this->accelerationY * dt;
+    float* px = &this->positionX[0];
+    float* py = &this->positionY[0];
+    float* vx = &this->velocityX[0];
+    float* vy = &this->velocityY[0];
+    float* r = &this->red[0];
+    float* g = &this->green[0];
+    float* b = &this->blue[0];
+    float* a = &this->alpha[0];
+    float* dr = &this->redRate[0];
+    float* dg = &this->greenRate[0];
+    float* db = &this->blueRate[0];
+    float* da = &this->alphaRate[0];
+    float* life = &this->lifetime[0];
+
+    // Padding lanes past liveCount are simulated too; they are never drawn.
+    unsigned int paddedCount = (this->liveCount + CORE_SIMD_WIDTH - 1) / CORE_SIMD_WIDTH * CORE_SIMD_WIDTH;
+#ifdef CORE_SIMD_SSE
+    __m128 dtVector = _mm_set1_ps(dt);
+    __m128 dvxVector = _mm_set1_ps(dvx);
+    __m128 dvyVector = _mm_set1_ps(dvy);
+    for (unsigned int i = 0; i < paddedCount; i += CORE_SIMD_WIDTH)
+    {
+        __m128 newVx = _mm_add_ps(_mm_loadu_ps(vx + i), dvxVector);
+        __m128 newVy = _mm_add_ps(_mm_loadu_ps(vy + i), dvyVector);
+        _mm_storeu_ps(vx + i, newVx);
+        _mm_storeu_ps(vy + i, newVy);
+        _mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(newVx, dtVector)));
+        _mm_storeu_ps(py + i, _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(newVy, dtVector)));
+        _mm_storeu_ps(r + i, _mm_add_ps(_mm_loadu_ps(r + i), _mm_mul_ps(_mm_loadu_ps(dr + i), dtVector)));
+        _mm_storeu_ps(g + i, _mm_add_ps(_mm_loadu_ps(g + i), _mm_mul_ps(_mm_loadu_ps(dg + i), dtVector)));
+        _mm_storeu_ps(b + i, _mm_add_ps(_mm_loadu_ps(b + i), _mm_mul_ps(_mm_loadu_ps(db + i), dtVector)));
+        _mm_storeu_ps(a + i, _mm_add_ps(_mm_loadu_ps(a + i), _mm_mul_ps(_mm_loadu_ps(da + i), dtVector)));
+        _mm_storeu_ps(life + i, _mm_sub_ps(_mm_loadu_ps(life + i), dtVector));
+    }
+#else
+    for (unsigned int i = 0; i < paddedCount; i++)
+    {
+        vx[i] += dvx;
+        vy[i] += dvy;
+        px[i] += vx[i] * dt;
+        py[i] += vy[i] * dt;
+        r[i] += dr[i] * dt;
+        g[i] += dg[i] * dt;
+        b[i] += db[i] * dt;
+        a[i] += da[i] * dt;
+        life[i] -= dt;
+    }
+#endif
+}
+
+void ParticleEmitter::compact()
+{
+    unsigned int i = 0;
+    while (i < this->liveCount)
+    {
+        if (this->lifetime[i] <= 0.0f)
+        {
+            // Swap-remove: the last live particle fills the hole. It is
+            // checked on the next iteration since it may have died too.
+            this->liveCount--;
+            this->moveParticle(this->liveCount, i);
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
+void ParticleEmitter::moveParticle(unsigned int from, unsigned int to)
+{
+    this->positionX[to] = this->positionX[from];
+    this->positionY[to] = this->positionY[from];
+    this->velocityX[to] = this->velocityX[from];
+    this->velocityY[to] = this->velocityY[from];
+    this->red[to] = this->red[from];
+    this->green[to] = this->green[from];
+    this->blue[to] = this->blue[from];
+    this->alpha[to] = this->alpha[from];
+    this->redRate[to] = this->redRate[from];
+    this->greenRate[to] = this->greenRate[from];
+    this->blueRate[to] = this->blueRate[from];
+    this->alphaRate[to] = this->alphaRate[from];
+    this->lifetime[to] = this->lifetime[from];
+}
+
+void ParticleEmitter::buildQuads()
+{
+    this->quadCount = this->liveCount;
+    if (this->liveCount == 0)
+    {
+        return;
+    }
+    float halfSize = this->size / 2.0f;
+    float z = -this->depth;
+    float* vertexBuffer = &this->vertexData[0];
+    float* colorBuffer = &this->colorData[0];
+#ifdef CORE_SIMD_SSE
+    // Four particles at a time. The quads of the padding lanes past
+    // liveCount are built too, as the buffers have room for them, but
+    // they're never published.
+    __m128 halfSizeVector = _mm_set1_ps(halfSize);
+    __m128 zVector = _mm_set1_ps(z);
+    __m128 one = _mm_set1_ps(1.0f);
+    for (unsigned int i = 0; i < this->liveCount; i += CORE_SIMD_WIDTH)
+    {
+        __m128 x = _mm_loadu_ps(&this->positionX[i]);
+        __m128 y = _mm_loadu_ps(&this->positionY[i]);
+        __m128 left = _mm_sub_ps(x, halfSizeVector);
+        __m128 right = _mm_add_ps(x, halfSizeVector);
+        __m128 top = _mm_add_ps(y, halfSizeVector);
+        __m128 bottom = _mm_sub_ps(y, halfSizeVector);
+        // Top/Left, Top/Right, Bottom/Right, Bottom/Left, as in Sprite
+        float* quads = vertexBuffer + i * VertexStream::FLOATS_PER_QUAD;
+        putCorners(quads, 0, left, top, zVector, one);
+        putCorners(quads, 1, right, top, zVector, one);
+        putCorners(quads, 2, right, bottom, zVector, one);
+        putCorners(quads, 3, left, bottom, zVector, one);
+
+        putColors(colorBuffer + i * VertexStream::FLOATS_PER_QUAD, _mm_loadu_ps(&this->red[i]), _mm_loadu_ps(&this->green[i]),
+                  _mm_loadu_ps(&this->blue[i]), _mm_loadu_ps(&this->alpha[i]));
+    }
+#else
+    for (unsigned int i = 0; i < this->liveCount; i++)
+    {
+        float left = this->positionX[i] - halfSize;
+        float right = this->positionX[i] + halfSize;
+        float top = this->positionY[i] + halfSize;
+        float bottom = this->positionY[i] - halfSize;
+        // Top/Left, Top/Right, Bottom/Right, Bottom/Left, as in Sprite
+        vertexBuffer[0] = left;
+        vertexBuffer[1] = top;
+        vertexBuffer[2] = z;
+        vertexBuffer[3] = 1.0f;
+        vertexBuffer[4] = right;
+        vertexBuffer[5] = top;
+        vertexBuffer[6] = z;
+        vertexBuffer[7] = 1.0f;
+        vertexBuffer[8] = right;
+        vertexBuffer[9] = bottom;
+        vertexBuffer[10] = z;
+        vertexBuffer[11] = 1.0f;
+        vertexBuffer[12] = left;
+        vertexBuffer[13] = bottom;
+        vertexBuffer[14] = z;
+        vertexBuffer[15] = 1.0f;
+        vertexBuffer += VertexStream::FLOATS_PER_QUAD;
+
+        for (unsigned int vertex = 0; vertex < 4; vertex++)
+        {
+            colorBuffer[0] = this->red[i];
+            colorBuffer[1] = this->green[i];
+            colorBuffer[2] = this->blue[i];
+            colorBuffer[3] = this->alpha[i];
+            colorBuffer += 4;
+        }
+    }
+#endif
+}
+
+void ParticleEmitter::PutGLQuads(VertexStream& stream)
+{
+    if (this->publishedQuadCount == 0)
+    {
+        return;
+    }
+    unsigned int firstQuad = stream.AddQuads(this->publishedQuadCount);
+    size_t byteCount = this->publishedQuadCount * VertexStream::FLOATS_PER_QUAD * sizeof(float);
+    std::memcpy(stream.GetVertexData(firstQuad), &this->publishedVertexData[0], byteCount);
+    std::memcpy(stream.GetColorData(firstQuad), &this->publishedColorData[0], byteCount);
+}
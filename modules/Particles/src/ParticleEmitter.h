@@ -0,0 +1,207 @@
+#ifndef Particles_ParticleEmitter_h
+#define Particles_ParticleEmitter_h
+
+#include <vector>
+#include <random>
+#include "Color.h"
+
+class VertexStream;
+
+/**
+ * Spawns and simulates a pool of square, untextured particles.
+ *
+ * Particles are stored as a structure of arrays (one array per component)
+ * so the simulation runs four particles per SIMD instruction, and dead
+ * particles are removed by swapping the last live particle into their
+ * slot so the live particles always occupy [0, GetLiveParticleCount()).
+ *
+ * Emitters are owned and updated by a ParticleSystem. Settings may only be
+ * changed from the game thread, between updates; they take effect on the
+ * next update. Each update also builds the emitter's quads into a buffer of
+ * its own, which the ParticleSystem then publishes for the view thread, so
+ * drawing never reads the settings or the particle pool.
+ */
+class ParticleEmitter
+{
+public:
+    /**
+     * Creates an emitter at the origin that can hold up to the given number
+     * of live particles. Particles that would exceed the limit are dropped.
+     * Throws an invalid_argument if maxParticles is 0.
+     */
+    ParticleEmitter(unsigned int maxParticles);
+
+    /**
+     * Destructor
+     */
+    ~ParticleEmitter();
+
+    /**
+     * Moves the point new particles are spawned from.
+     */
+    void MoveTo(float x, float y);
+
+    /**
+     * Sets how many particles are spawned each second. Zero disables
+     * continuous emission; bursts can still be requested with Emit.
+     */
+    void SetEmissionRate(float particlesPerSecond);
+
+    /**
+     * Sets the range each new particle's lifetime, in seconds, is picked from.
+     */
+    void SetLifetime(float minimum, float maximum);
+
+    /**
+     * Sets the range each new particle's initial velocity is picked from,
+     * in world units per second.
+     */
+    void SetVelocity(float minimumX, float minimumY, float maximumX, float maximumY);
+
+    /**
+     * Sets the acceleration applied to every particle, such as gravity.
+     */
+    void SetAcceleration(float x, float y);
+
+    /**
+     * Sets the color particles are spawned with and the color they fade to
+     * by the end of their lifetime.
+     */
+    void SetColors(Color startColor, Color endColor);
+
+    /**
+     * Sets the width and height of every particle.
+     */
+    void SetSize(float size);
+
+    /**
+     * Sets the depth every particle is drawn at, from 0 (nearest, the
+     * default) to Sprite::MAX_DEPTH (farthest), as for sprites: opaque
+     * sprites nearer than it hide the particles.
+     * Throws an invalid_argument if the depth is outside that range.
+     */
+    void SetDepth(float depth);
+
+    /**
+     * Requests that the given number of particles be spawned on the next
+     * update, in addition to continuous emission.
+     */
+    void Emit(unsigned int count);
+
+    /**
+     * Spawns due particles, advances every particle by the given time,
+     * removes the ones whose lifetime has run out and builds the quads of
+     * the rest, to be published.
+     *
+     * Should be called only by ParticleSystem.
+     */
+    void Update(float elapsedSeconds);
+
+    /**
+     * Makes the quads built by the last update the ones drawn.
+     *
+     * Should be called only by ParticleSystem, while it keeps the view
+     * thread from drawing.
+     */
+    void Publish();
+
+    /**
+     * Appends one quad per particle, as of the last published update, to
+     * the given stream.
+     *
+     * Should be called only by ParticleSystem.
+     */
+    void PutGLQuads(VertexStream& stream);
+
+    /**
+     * Obtains the number of live particles.
+     */
+    unsigned int GetLiveParticleCount();
+
+    /**
+     * Obtains the maximum number of live particles.
+     */
+    unsigned int GetMaxParticles();
+
+private:
+    // Private constructors to disallow access.
+    ParticleEmitter(ParticleEmitter const &other);
+    ParticleEmitter operator=(ParticleEmitter other);
+
+    /**
+     * Spawns up to the given number of particles at the emitter's position.
+     */
+    void spawn(unsigned int count);
+
+    /**
+     * Advances the position, velocity, color, and remaining lifetime of
+     * every live particle.
+     */
+    void integrate(float elapsedSeconds);
+
+    /**
+     * Removes every particle whose lifetime has run out.
+     */
+    void compact();
+
+    /**
+     * Copies the particle in slot "from" into slot "to".
+     */
+    void moveParticle(unsigned int from, unsigned int to);
+
+    /**
+     * Expands every live particle into a quad in the unpublished buffers.
+     */
+    void buildQuads();
+
+    unsigned int maxParticles;
+    unsigned int liveCount;
+
+    // Emitter settings
+    float x;
+    float y;
+    float emissionRate;
+    float pendingEmission;
+    unsigned int pendingBurst;
+    float minimumLifetime;
+    float maximumLifetime;
+    float minimumVelocityX;
+    float minimumVelocityY;
+    float maximumVelocityX;
+    float maximumVelocityY;
+    float accelerationX;
+    float accelerationY;
+    Color startColor;
+    Color endColor;
+    float size;
+    float depth;
+
+    // Particle pool, one array per component. Each array is padded to a
+    // multiple of the SIMD width so the kernels never need a scalar tail.
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> velocityX;
+    std::vector<float> velocityY;
+    std::vector<float> red;
+    std::vector<float> green;
+    std::vector<float> blue;
+    std::vector<float> alpha;
+    std::vector<float> redRate;
+    std::vector<float> greenRate;
+    std::vector<float> blueRate;
+    std::vector<float> alphaRate;
+    std::vector<float> lifetime;
+
+    // Quads in the layout of a VertexStream, built by the game side and
+    // swapped with the published ones, which only the view thread reads
+    std::vector<float> vertexData;
+    std::vector<float> colorData;
+    unsigned int quadCount;
+    std::vector<float> publishedVertexData;
+    std::vector<float> publishedColorData;
+    unsigned int publishedQuadCount;
+
+    std::minstd_rand random;
+};
+
+#endif
@@ -0,0 +1,76 @@
+#include <algorithm>
+#include "ParticleSystem.h"
+#include "WorkerPool.h"
+
+ParticleSystem::ParticleSystem()
+{
+
+}
+
+ParticleSystem::~ParticleSystem()
+{
+
+}
+
+std::shared_ptr<ParticleEmitter> ParticleSystem::CreateEmitter(unsigned int maxParticles)
+{
+    std::shared_ptr<ParticleEmitter> emitter = std::make_shared<ParticleEmitter>(maxParticles);
+    this->emittersMutex.lock();
+    this->emitters.push_back(emitter);
+    this->emittersMutex.unlock();
+    return emitter;
+}
+
+void ParticleSystem::RemoveEmitter(std::shared_ptr<ParticleEmitter> emitter)
+{
+    this->emittersMutex.lock();
+    this->emitters.erase(std::remove(this->emitters.begin(), this->emitters.end(), emitter), this->emitters.end());
+    this->emittersMutex.unlock();
+}
+
+void ParticleSystem::Update(float elapsedSeconds)
+{
+    this->emittersMutex.lock();
+    this->updatingEmitters = this->emitters;
+    this->emittersMutex.unlock();
+
+    std::vector<std::shared_ptr<ParticleEmitter>>& emitters = this->updatingEmitters;
+    WorkerPool::GetInstance()->ParallelFor((unsigned int)emitters.size(), 1, [&emitters, elapsedSeconds](unsigned int begin, unsigned int end)
+    {
+        for (unsigned int i = begin; i < end; i++)
+        {
+            emitters[i]->Update(elapsedSeconds);
+        }
+    });
+
+    // Publishing only swaps buffers, so drawing is held up for next to no time
+    this->emittersMutex.lock();
+    for (unsigned int i = 0; i < emitters.size(); i++)
+    {
+        emitters[i]->Publish();
+    }
+    this->emittersMutex.unlock();
+    emitters.clear();
+}
+
+unsigned int ParticleSystem::GetLiveParticleCount()
+{
+    unsigned int count = 0;
+    this->emittersMutex.lock();
+    for (unsigned int i = 0; i < this->emitters.size(); i++)
+    {
+        count += this->emitters[i]->GetLiveParticleCount();
+    }
+    this->emittersMutex.unlock();
+    return count;
+}
+
+void ParticleSystem::PutGLQuads(VertexStream& stream)
+{
+    this->emittersMutex.lock();
+    for (unsigned int i = 0; i < this->emitters.size(); i++)
+    {
+        this->emitters[i]->PutGLQuads(stream);
+    }
+    this->emittersMutex.unlock();
+}
@@ -0,0 +1,87 @@
+#ifndef Particles_ParticleSystem_h
+#define Particles_ParticleSystem_h
+
+#include <vector>
+#include <mutex>
+#include <memory>
+#include "QuadSource.h"
+#include "ParticleEmitter.h"
+
+/**
+ * Owns a set of ParticleEmitters, updates them in parallel and draws all
+ * of their particles as part of the sprite batch.
+ *
+ * Use: create a ParticleSystem, add emitters to it and register it with
+ * the GraphicsManager as a QuadSource. Call Update once per game tick.
+ * Everything but PutGLQuads, including the emitters' settings, belongs to
+ * the game thread; the view thread only draws what Update last published.
+ *
+ *     particles = std::make_shared<ParticleSystem>();
+ *     std::shared_ptr<ParticleEmitter> sparks = particles->CreateEmitter(10000);
+ *     graphicsManager->RegisterQuadSource(particles);
+ */
+class ParticleSystem : public QuadSource
+{
+public:
+    /**
+     * Creates a ParticleSystem without any emitters.
+     */
+    ParticleSystem();
+
+    /**
+     * Destructor
+     */
+    virtual ~ParticleSystem();
+
+    /**
+     * Creates an emitter that can hold up to the given number of live
+     * particles and adds it to this system.
+     */
+    std::shared_ptr<ParticleEmitter> CreateEmitter(unsigned int maxParticles);
+
+    /**
+     * Removes the given emitter and all of its particles from this system.
+     */
+    void RemoveEmitter(std::shared_ptr<ParticleEmitter> emitter);
+
+    /**
+     * Advances every emitter by the given time. Emitters are spread across
+     * the WorkerPool, so each one is updated by a single thread. Drawing
+     * carries on from the previous update meanwhile, only waiting while the
+     * new quads are published.
+     */
+    void Update(float elapsedSeconds);
+
+    /**
+     * Obtains the number of live particles across all emitters.
+     */
+    unsigned int GetLiveParticleCount();
+
+    /**
+     * Appends every live particle to the given stream.
+     *
+     * Typically this function isn't needed outside the game engine's
+     * core graphics system, and thus it shouldn't be needed by users.
+     */
+    virtual void PutGLQuads(VertexStream& stream);
+
+private:
+    // Private constructors to disallow access.
+    ParticleSystem(ParticleSystem const &other);
+    ParticleSystem operator=(ParticleSystem other);
+
+    /**
+     * Guards the emitter list and the emitters' published quads, which are
+     * drawn from the view thread.
+     */
+    std::mutex emittersMutex;
+    std::vector<std::shared_ptr<ParticleEmitter>> emitters;
+
+    /**
+     * The emitters being updated, copied so the list needn't stay locked.
+     * Kept between updates only to reuse its memory.
+     */
+    std::vector<std::shared_ptr<ParticleEmitter>> updatingEmitters;
+};
+
+#endif
@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include "SFML/OpenGL.hpp"
+#include "GlyphAtlas.h"
+
+// Glyphs are inset by this many pixels inside their cell so that linear
+// filtering never samples a neighbouring glyph.
+static const unsigned int CELL_PADDING = 1;
+
+GlyphAtlas::GlyphAtlas(unsigned int pageSize, unsigned int cellSize)
+: font(nullptr),
+pageSize(pageSize),
+cellSize(cellSize),
+cellsPerRow(0),
+textureUnit(0),
+frame(1),
+revision(0),
+hitCount(0),
+missCount(0),
+evictionCount(0),
+failureCount(0)
+{
+    if (cellSize <= 2 * CELL_PADDING)
+    {
+        throw new std::invalid_argument("Glyph atlas cells must be larger than their padding on both sides.");
+    }
+    if (cellSize > pageSize)
+    {
+        throw new std::invalid_argument("Glyph atlas cells cannot be larger than the atlas page.");
+    }
+    this->cellsPerRow = pageSize / cellSize;
+    this->cells.resize(this->cellsPerRow * this->cellsPerRow);
+    this->cellPixels.resize(cellSize * cellSize * 4);
+    this->clear();
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+    if (this->textureUnit != 0)
+    {
+        glDeleteTextures(1, &this->textureUnit);
+    }
+}
+
+void GlyphAtlas::SetFont(const sf::Font* font)
+{
+    this->font = font;
+    this->clear();
+}
+
+void GlyphAtlas::BeginFrame()
+{
+    this->frame++;
+}
+
+bool GlyphAtlas::Acquire(const GlyphKey& key, GlyphInfo& info)
+{
+    auto found = this->glyphCells.find(key);
+    if (found != this->glyphCells.end())
+    {
+        this->hitCount++;
+        this->Touch(found->second);
+        info = this->cells[found->second].info;
+        return true;
+    }
+
+    this->missCount++;
+    if (this->font == nullptr)
+    {
+        this->failureCount++;
+        return false;
+    }
+    const sf::Glyph& glyph = this->font->getGlyph(key.codePoint, key.characterSize, key.bold);
+    unsigned int usable = this->cellSize - 2 * CELL_PADDING;
+    unsigned int cellIndex;
+    if ((unsigned int)glyph.textureRect.width > usable || (unsigned int)glyph.textureRect.height > usable || !this->allocateCell(cellIndex))
+    {
+        this->failureCount++;
+        return false;
+    }
+
+    Cell& cell = this->cells[cellIndex];
+    float cellX = (float)((cellIndex % this->cellsPerRow) * this->cellSize + CELL_PADDING);
+    float cellY = (float)((cellIndex / this->cellsPerRow) * this->cellSize + CELL_PADDING);
+    float page = (float)this->pageSize;
+    cell.used = true;
+    cell.key = key;
+    cell.fontTextureRect = glyph.textureRect;
+    cell.info.cell = cellIndex;
+    cell.info.left = (float)glyph.bounds.left;
+    cell.info.top = (float)glyph.bounds.top;
+    cell.info.width = (float)glyph.bounds.width;
+    cell.info.height = (float)glyph.bounds.height;
+    cell.info.advance = (float)glyph.advance;
+    cell.info.u0 = cellX / page;
+    cell.info.v0 = cellY / page;
+    cell.info.u1 = (cellX + glyph.textureRect.width) / page;
+    cell.info.v1 = (cellY + glyph.textureRect.height) / page;
+    this->lru.push_front(cellIndex);
+    cell.lruPosition = this->lru.begin();
+    cell.lastUsedFrame = this->frame;
+    this->glyphCells[key] = cellIndex;
+    this->pendingCells.push_back(cellIndex);
+
+    info = cell.info;
+    return true;
+}
+
+void GlyphAtlas::Touch(unsigned int cell)
+{
+    Cell& touched = this->cells[cell];
+    touched.lastUsedFrame = this->frame;
+    this->lru.splice(this->lru.begin(), this->lru, touched.lruPosition);
+}
+
+void GlyphAtlas::Upload()
+{
+    if (this->textureUnit == 0)
+    {
+        std::vector<sf::Uint8> empty(this->pageSize * this->pageSize * 4, 0);
+        glGenTextures(1, &this->textureUnit);
+        glBindTexture(GL_TEXTURE_2D, this->textureUnit);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, this->pageSize, this->pageSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, &empty[0]);
+    }
+    if (this->pendingCells.empty())
+    {
+        return;
+    }
+
+    // Reading a font page back from the GPU is expensive, so each character
+    // size is read once for all of its new glyphs.
+    std::map<unsigned int, std::vector<unsigned int>> cellsBySize;
+    for (unsigned int i = 0; i < this->pendingCells.size(); i++)
+    {
+        unsigned int cell = this->pendingCells[i];
+        cellsBySize[this->cells[cell].key.characterSize].push_back(cell);
+    }
+    this->pendingCells.clear();
+
+    glBindTexture(GL_TEXTURE_2D, this->textureUnit);
+    for (auto it = cellsBySize.begin(); it != cellsBySize.end(); it++)
+    {
+        sf::Image fontPage = this->font->getTexture(it->first).copyToImage();
+        const sf::Uint8* fontPixels = fontPage.getPixelsPtr();
+        unsigned int fontWidth = fontPage.getSize().x;
+        for (unsigned int i = 0; i < it->second.size(); i++)
+        {
+            const Cell& cell = this->cells[it->second[i]];
+            const sf::IntRect& source = cell.fontTextureRect;
+            std::fill(this->cellPixels.begin(), this->cellPixels.end(), 0);
+            for (int row = 0; row < source.height; row++)
+            {
+                const sf::Uint8* sourceRow = fontPixels + ((source.top + row) * fontWidth + source.left) * 4;
+                sf::Uint8* destinationRow = &this->cellPixels[((row + CELL_PADDING) * this->cellSize + CELL_PADDING) * 4];
+                std::copy(sourceRow, sourceRow + source.width * 4, destinationRow);
+            }
+            unsigned int cellX = (cell.info.cell % this->cellsPerRow) * this->cellSize;
+            unsigned int cellY = (cell.info.cell / this->cellsPerRow) * this->cellSize;
+            glTexSubImage2D(GL_TEXTURE_2D, 0, cellX, cellY, this->cellSize, this->cellSize, GL_RGBA, GL_UNSIGNED_BYTE, &this->cellPixels[0]);
+        }
+    }
+}
+
+unsigned int GlyphAtlas::GetTextureUnit()
+{
+    return this->textureUnit;
+}
+
+unsigned long GlyphAtlas::GetRevision()
+{
+    return this->revision;
+}
+
+unsigned long GlyphAtlas::GetHitCount()
+{
+    return this->hitCount;
+}
+
+unsigned long GlyphAtlas::GetMissCount()
+{
+    return this->missCount;
+}
+
+unsigned long GlyphAtlas::GetEvictionCount()
+{
+    return this->evictionCount;
+}
+
+unsigned long GlyphAtlas::GetFailureCount()
+{
+    return this->failureCount;
+}
+
+bool GlyphAtlas::allocateCell(unsigned int& cell)
+{
+    if (!this->freeCells.empty())
+    {
+        cell = this->freeCells.back();
+        this->freeCells.pop_back();
+        return true;
+    }
+
+    unsigned int victim = this->lru.back();
+    Cell& evicted = this->cells[victim];
+    if (evicted.lastUsedFrame == this->frame)
+    {
+        // Everything is on screen this frame; nothing can be evicted.
+        return false;
+    }
+    this->lru.pop_back();
+    this->glyphCells.erase(evicted.key);
+    evicted.used = false;
+    this->evictionCount++;
+    this->revision++;
+    cell = victim;
+    return true;
+}
+
+void GlyphAtlas::clear()
+{
+    this->glyphCells.clear();
+    this->lru.clear();
+    this->pendingCells.clear();
+    this->freeCells.clear();
+    for (unsigned int i = (unsigned int)this->cells.size(); i > 0; i--)
+    {
+        this->cells[i - 1].used = false;
+        this->freeCells.push_back(i - 1);
+    }
+    this->revision++;
+}
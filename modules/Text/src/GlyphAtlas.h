@@ -0,0 +1,206 @@
+#ifndef Text_GlyphAtlas_h
+#define Text_GlyphAtlas_h
+
+#include <SFML/Graphics/Font.hpp>
+#include <unordered_map>
+#include <vector>
+#include <list>
+
+/**
+ * Identifies one rasterized glyph of the atlas's font.
+ */
+struct GlyphKey
+{
+    sf::Uint32 codePoint;
+    unsigned int characterSize;
+    bool bold;
+
+    bool operator==(const GlyphKey& other) const
+    {
+        return codePoint == other.codePoint && characterSize == other.characterSize && bold == other.bold;
+    }
+};
+
+/**
+ * Hash function so GlyphKeys can be used in unordered containers.
+ */
+struct GlyphKeyHash
+{
+    size_t operator()(const GlyphKey& key) const
+    {
+        return (size_t)key.codePoint * 2654435761u ^ (size_t)(key.characterSize << 1 | (key.bold ? 1 : 0));
+    }
+};
+
+/**
+ * Where a glyph lives in the atlas and how to place it, in pixels relative
+ * to the pen position on the baseline (y grows downwards).
+ */
+struct GlyphInfo
+{
+    unsigned int cell;
+    float left;
+    float top;
+    float width;
+    float height;
+    float advance;
+    float u0;
+    float v0;
+    float u1;
+    float v1;
+};
+
+/**
+ * A single OpenGL texture page, divided into equal square cells, that holds
+ * glyphs rasterized on demand from an sf::Font.
+ *
+ * When every cell is taken, the least recently used glyph is evicted to
+ * make room, except for glyphs already used in the current frame. Every
+ * eviction bumps the atlas revision, so callers that cached texture
+ * coordinates know to look them up again.
+ *
+ * All methods must be called on the view thread, since rasterizing and
+ * uploading glyphs needs the OpenGL context.
+ */
+class GlyphAtlas
+{
+public:
+    /**
+     * Creates an atlas of pageSize x pageSize pixels split into cells of
+     * cellSize x cellSize pixels. Glyphs larger than a cell can't be drawn.
+     * Throws an invalid_argument if a cell doesn't fit in the page or has
+     * no room inside its padding.
+     */
+    GlyphAtlas(unsigned int pageSize, unsigned int cellSize);
+
+    /**
+     * Destroys the atlas texture.
+     */
+    ~GlyphAtlas();
+
+    /**
+     * Sets the font glyphs are rasterized from, evicting every glyph.
+     */
+    void SetFont(const sf::Font* font);
+
+    /**
+     * Starts a new frame. Glyphs used during the frame are protected from
+     * eviction until the next call.
+     */
+    void BeginFrame();
+
+    /**
+     * Finds the given glyph, rasterizing it into a free or evicted cell if
+     * necessary, and marks it as used this frame.
+     *
+     * Returns false if the glyph can't be placed: it is larger than a cell,
+     * no font is set, or every cell is in use this frame.
+     */
+    bool Acquire(const GlyphKey& key, GlyphInfo& info);
+
+    /**
+     * Marks the glyph in the given cell as used this frame, without a
+     * lookup. Only valid for cells obtained since the last revision change.
+     */
+    void Touch(unsigned int cell);
+
+    /**
+     * Uploads every glyph rasterized since the last call to the texture.
+     */
+    void Upload();
+
+    /**
+     * Obtains the OpenGL texture unit of the atlas, or 0 before the first
+     * upload.
+     */
+    unsigned int GetTextureUnit();
+
+    /**
+     * Obtains a number that changes whenever a glyph is evicted.
+     */
+    unsigned long GetRevision();
+
+    /**
+     * Obtains the number of lookups that found their glyph in the atlas.
+     */
+    unsigned long GetHitCount();
+
+    /**
+     * Obtains the number of lookups that had to rasterize their glyph.
+     */
+    unsigned long GetMissCount();
+
+    /**
+     * Obtains the number of glyphs evicted to make room for others.
+     */
+    unsigned long GetEvictionCount();
+
+    /**
+     * Obtains the number of glyphs that couldn't be placed at all.
+     */
+    unsigned long GetFailureCount();
+
+private:
+    // Private constructors to disallow access.
+    GlyphAtlas(GlyphAtlas const &other);
+    GlyphAtlas operator=(GlyphAtlas other);
+
+    /**
+     * What each cell holds.
+     */
+    struct Cell
+    {
+        bool used;
+        GlyphKey key;
+        GlyphInfo info;
+        sf::IntRect fontTextureRect;
+        unsigned long lastUsedFrame;
+        std::list<unsigned int>::iterator lruPosition;
+    };
+
+    /**
+     * Finds a cell for a new glyph, evicting the least recently used glyph
+     * if there are no free cells. Returns false if every cell is in use
+     * this frame.
+     */
+    bool allocateCell(unsigned int& cell);
+
+    /**
+     * Evicts every glyph and returns every cell to the free list.
+     */
+    void clear();
+
+    const sf::Font* font;
+    unsigned int pageSize;
+    unsigned int cellSize;
+    unsigned int cellsPerRow;
+    unsigned int textureUnit;
+    unsigned long frame;
+    unsigned long revision;
+
+    std::vector<Cell> cells;
+    std::vector<unsigned int> freeCells;
+    std::unordered_map<GlyphKey, unsigned int, GlyphKeyHash> glyphCells;
+
+    /**
+     * Cells ordered from most to least recently used.
+     */
+    std::list<unsigned int> lru;
+
+    /**
+     * Cells rasterized but not yet uploaded.
+     */
+    std::vector<unsigned int> pendingCells;
+
+    /**
+     * Staging memory for one cell's pixels.
+     */
+    std::vector<sf::Uint8> cellPixels;
+
+    unsigned long hitCount;
+    unsigned long missCount;
+    unsigned long evictionCount;
+    unsigned long failureCount;
+};
+
+#endif
@@ -0,0 +1,161 @@
+#include "ShapedTextCache.h"
+
+ShapedTextCache::ShapedTextCache(unsigned int maxEntries)
+: font(nullptr),
+maxEntries(maxEntries),
+frame(0),
+hitCount(0),
+missCount(0)
+{
+
+}
+
+ShapedTextCache::~ShapedTextCache()
+{
+
+}
+
+void ShapedTextCache::SetFont(const sf::Font* font)
+{
+    this->font = font;
+    this->entries.clear();
+}
+
+void ShapedTextCache::BeginFrame()
+{
+    this->frame++;
+}
+
+const ShapedText& ShapedTextCache::Shape(const std::u32string& text, unsigned int characterSize, bool bold, GlyphAtlas& atlas)
+{
+    std::u32string key;
+    key.reserve(text.size() + 2);
+    key.push_back((char32_t)characterSize);
+    key.push_back(bold ? U'b' : U'r');
+    key.append(text);
+
+    auto found = this->entries.find(key);
+    if (found != this->entries.end())
+    {
+        this->hitCount++;
+        ShapedText& shaped = found->second;
+        if (shaped.revision != atlas.GetRevision())
+        {
+            this->resolve(shaped, atlas);
+        }
+        else
+        {
+            for (unsigned int i = 0; i < shaped.glyphs.size(); i++)
+            {
+                if (shaped.glyphs[i].placed)
+                {
+                    atlas.Touch(shaped.glyphs[i].info.cell);
+                }
+            }
+        }
+        shaped.lastUsedFrame = this->frame;
+        return shaped;
+    }
+
+    this->missCount++;
+    if (this->entries.size() >= this->maxEntries)
+    {
+        this->trim();
+    }
+    ShapedText& shaped = this->entries[key];
+    this->shape(shaped, text, characterSize, bold, atlas);
+    shaped.lastUsedFrame = this->frame;
+    return shaped;
+}
+
+unsigned long ShapedTextCache::GetHitCount()
+{
+    return this->hitCount;
+}
+
+unsigned long ShapedTextCache::GetMissCount()
+{
+    return this->missCount;
+}
+
+void ShapedTextCache::shape(ShapedText& shaped, const std::u32string& text, unsigned int characterSize, bool bold, GlyphAtlas& atlas)
+{
+    shaped.glyphs.clear();
+    shaped.placedCount = 0;
+    if (this->font == nullptr)
+    {
+        shaped.revision = atlas.GetRevision();
+        return;
+    }
+
+    float penX = 0.0f;
+    float penY = 0.0f;
+    float lineSpacing = (float)this->font->getLineSpacing(characterSize);
+    sf::Uint32 previous = 0;
+    for (unsigned int i = 0; i < text.size(); i++)
+    {
+        sf::Uint32 codePoint = (sf::Uint32)text[i];
+        if (codePoint == '\n')
+        {
+            penX = 0.0f;
+            penY += lineSpacing;
+            previous = 0;
+            continue;
+        }
+        penX += (float)this->font->getKerning(previous, codePoint, characterSize);
+        previous = codePoint;
+
+        // Whitespace has no pixels, so it only moves the pen.
+        const sf::Glyph& fontGlyph = this->font->getGlyph(codePoint, characterSize, bold);
+        if (fontGlyph.bounds.width == 0 || fontGlyph.bounds.height == 0)
+        {
+            penX += (float)fontGlyph.advance;
+            continue;
+        }
+
+        ShapedGlyph glyph;
+        glyph.key.codePoint = codePoint;
+        glyph.key.characterSize = characterSize;
+        glyph.key.bold = bold;
+        glyph.penX = penX;
+        glyph.penY = penY;
+        glyph.placed = atlas.Acquire(glyph.key, glyph.info);
+        if (glyph.placed)
+        {
+            shaped.placedCount++;
+        }
+        penX += (float)fontGlyph.advance;
+        shaped.glyphs.push_back(glyph);
+    }
+    shaped.revision = atlas.GetRevision();
+}
+
+void ShapedTextCache::resolve(ShapedText& shaped, GlyphAtlas& atlas)
+{
+    shaped.placedCount = 0;
+    for (unsigned int i = 0; i < shaped.glyphs.size(); i++)
+    {
+        ShapedGlyph& glyph = shaped.glyphs[i];
+        glyph.placed = atlas.Acquire(glyph.key, glyph.info);
+        if (glyph.placed)
+        {
+            shaped.placedCount++;
+        }
+    }
+    shaped.revision = atlas.GetRevision();
+}
+
+void ShapedTextCache::trim()
+{
+    for (auto it = this->entries.begin(); it != this->entries.end(); )
+    {
+        if (it->second.lastUsedFrame + 1 < this->frame)
+        {
+            it = this->entries.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+}
@@ -0,0 +1,116 @@
+#ifndef Text_ShapedTextCache_h
+#define Text_ShapedTextCache_h
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "GlyphAtlas.h"
+
+/**
+ * One glyph of a shaped string: where its pen position is, relative to the
+ * start of the string's baseline, and where it lives in the atlas.
+ */
+struct ShapedGlyph
+{
+    GlyphKey key;
+    float penX;
+    float penY;
+    bool placed;
+    GlyphInfo info;
+};
+
+/**
+ * A string laid out into glyphs, with the atlas revision its texture
+ * coordinates were resolved against.
+ */
+struct ShapedText
+{
+    std::vector<ShapedGlyph> glyphs;
+    unsigned int placedCount;
+    unsigned long revision;
+    unsigned long lastUsedFrame;
+};
+
+/**
+ * Caches the layout of strings, keyed by their content, character size and
+ * style, so that a string drawn every frame is only shaped once.
+ *
+ * Cached texture coordinates are reused as long as the atlas hasn't evicted
+ * anything; otherwise the glyphs are looked up again without redoing the
+ * layout. Strings not drawn in the last two frames are dropped once the
+ * cache grows past its limit.
+ */
+class ShapedTextCache
+{
+public:
+    /**
+     * Creates a cache that starts dropping unused strings once it holds more
+     * than the given number.
+     */
+    ShapedTextCache(unsigned int maxEntries);
+
+    /**
+     * Destructor
+     */
+    ~ShapedTextCache();
+
+    /**
+     * Sets the font used for kerning and line spacing, dropping every
+     * cached string.
+     */
+    void SetFont(const sf::Font* font);
+
+    /**
+     * Starts a new frame.
+     */
+    void BeginFrame();
+
+    /**
+     * Obtains the layout of the given string, shaping it or refreshing its
+     * texture coordinates if needed, and marks its glyphs as used this frame.
+     */
+    const ShapedText& Shape(const std::u32string& text, unsigned int characterSize, bool bold, GlyphAtlas& atlas);
+
+    /**
+     * Obtains the number of Shape calls answered from the cache.
+     */
+    unsigned long GetHitCount();
+
+    /**
+     * Obtains the number of Shape calls that laid out a new string.
+     */
+    unsigned long GetMissCount();
+
+private:
+    // Private constructors to disallow access.
+    ShapedTextCache(ShapedTextCache const &other);
+    ShapedTextCache operator=(ShapedTextCache other);
+
+    /**
+     * Lays out the given string from scratch.
+     */
+    void shape(ShapedText& shaped, const std::u32string& text, unsigned int characterSize, bool bold, GlyphAtlas& atlas);
+
+    /**
+     * Looks up every glyph of a shaped string in the atlas again.
+     */
+    void resolve(ShapedText& shaped, GlyphAtlas& atlas);
+
+    /**
+     * Drops strings that weren't used in the current or previous frame.
+     */
+    void trim();
+
+    const sf::Font* font;
+    unsigned int maxEntries;
+    unsigned long frame;
+    unsigned long hitCount;
+    unsigned long missCount;
+
+    /**
+     * Shaped strings keyed by character size, style and content.
+     */
+    std::unordered_map<std::u32string, ShapedText> entries;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#include "TextLabel.h"
+
+TextLabel::TextLabel(std::shared_ptr<std::mutex> rendererMutex, float x, float y, unsigned int characterSize, Color color)
+: rendererMutex(rendererMutex),
+x(x),
+y(y),
+characterSize(characterSize),
+scale(1.0f),
+bold(false),
+color(color),
+visible(true)
+{
+
+}
+
+TextLabel::~TextLabel()
+{
+
+}
+
+void TextLabel::SetText(const sf::String& text)
+{
+    std::u32string converted;
+    converted.reserve(text.getSize());
+    for (auto it = text.begin(); it != text.end(); it++)
+    {
+        converted.push_back((char32_t)*it);
+    }
+    std::lock_guard<std::mutex> lock(*this->rendererMutex);
+    this->text.swap(converted);
+}
+
+void TextLabel::MoveTo(float x, float y)
+{
+    std::lock_guard<std::mutex> lock(*this->rendererMutex);
+    this->x = x;
+    this->y = y;
+}
+
+void TextLabel::SetCharacterSize(unsigned int characterSize)
+{
+    std::lock_guard<std::mutex> lock(*this->rendererMutex);
+    this->characterSize = characterSize;
+}
+
+void TextLabel::SetScale(float scale)
+{
+    std::lock_guard<std::mutex> lock(*this->rendererMutex);
+    this->scale = scale;
+}
+
+void TextLabel::SetBold(bool bold)
+{
+    std::lock_guard<std::mutex> lock(*this->rendererMutex);
+    this->bold = bold;
+}
+
+void TextLabel::ChangeColor(Color color)
+{
+    std::lock_guard<std::mutex> lock(*this->rendererMutex);
+    this->color = color;
+}
+
+void TextLabel::SetVisible(bool visible)
+{
+    std::lock_guard<std::mutex> lock(*this->rendererMutex);
+    this->visible = visible;
+}
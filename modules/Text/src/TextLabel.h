@@ -0,0 +1,89 @@
+#ifndef Text_TextLabel_h
+#define Text_TextLabel_h
+
+#include <string>
+#include <mutex>
+#include <memory>
+#include <SFML/System/String.hpp>
+#include "Color.h"
+
+/**
+ * A string drawn by a TextRenderer at a position in the world.
+ *
+ * The position is the left end of the first line's baseline. Glyphs are
+ * rasterized at the label's character size, in pixels, and drawn with each
+ * pixel covering "scale" world units.
+ */
+class TextLabel
+{
+public:
+    /**
+     * Should NEVER be used. Only public because make_shared requires it.
+     * Use TextRenderer::CreateLabel instead.
+     */
+    TextLabel(std::shared_ptr<std::mutex> rendererMutex, float x, float y, unsigned int characterSize, Color color);
+
+    /**
+     * Destructor
+     */
+    ~TextLabel();
+
+    /**
+     * Sets the string to draw. Newlines start a new line.
+     */
+    void SetText(const sf::String& text);
+
+    /**
+     * Moves the label to the given location
+     */
+    void MoveTo(float x, float y);
+
+    /**
+     * Sets the character size in pixels
+     */
+    void SetCharacterSize(unsigned int characterSize);
+
+    /**
+     * Sets the number of world units covered by one pixel of a glyph
+     */
+    void SetScale(float scale);
+
+    /**
+     * Sets whether the label is drawn in bold
+     */
+    void SetBold(bool bold);
+
+    /**
+     * Changes the color of the label
+     */
+    void ChangeColor(Color color);
+
+    /**
+     * Sets whether the label is drawn at all
+     */
+    void SetVisible(bool visible);
+
+private:
+    // Private constructors to disallow access.
+    TextLabel(TextLabel const &other);
+    TextLabel operator=(TextLabel other);
+
+    friend class TextRenderer;
+
+    /**
+     * The owning renderer's mutex, held while the label is read or written.
+     * Shared so a label may outlive its renderer.
+     */
+    std::shared_ptr<std::mutex> rendererMutex;
+
+    std::u32string text;
+    float x;
+    float y;
+    unsigned int characterSize;
+    float scale;
+    bool bold;
+    Color color;
+    bool visible;
+};
+
+#endif
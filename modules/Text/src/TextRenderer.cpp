@@ -0,0 +1,116 @@
+#include <algorithm>
+#include "TextRenderer.h"
+#include "VertexStream.h"
+
+TextRenderer::TextRenderer() : labelsMutex(std::make_shared<std::mutex>()), fontLoaded(false), atlas(1024, 64), shapedTextCache(4096)
+{
+
+}
+
+TextRenderer::~TextRenderer()
+{
+
+}
+
+bool TextRenderer::LoadFont(const std::string& filename)
+{
+    std::lock_guard<std::mutex> lock(*this->labelsMutex);
+    this->fontLoaded = this->font.loadFromFile(filename);
+    this->atlas.SetFont(this->fontLoaded ? &this->font : nullptr);
+    this->shapedTextCache.SetFont(this->fontLoaded ? &this->font : nullptr);
+    return this->fontLoaded;
+}
+
+std::shared_ptr<TextLabel> TextRenderer::CreateLabel(float x, float y, unsigned int characterSize, Color color)
+{
+    std::shared_ptr<TextLabel> label = std::make_shared<TextLabel>(this->labelsMutex, x, y, characterSize, color);
+    std::lock_guard<std::mutex> lock(*this->labelsMutex);
+    this->labels.push_back(label);
+    return label;
+}
+
+void TextRenderer::RemoveLabel(std::shared_ptr<TextLabel> label)
+{
+    std::lock_guard<std::mutex> lock(*this->labelsMutex);
+    this->labels.erase(std::remove(this->labels.begin(), this->labels.end(), label), this->labels.end());
+}
+
+GlyphAtlas& TextRenderer::GetGlyphAtlas()
+{
+    return this->atlas;
+}
+
+ShapedTextCache& TextRenderer::GetShapedTextCache()
+{
+    return this->shapedTextCache;
+}
+
+void TextRenderer::PutGLQuads(VertexStream& stream)
+{
+    std::lock_guard<std::mutex> lock(*this->labelsMutex);
+    if (!this->fontLoaded)
+    {
+        return;
+    }
+
+    // Creates the atlas texture on first use so the batch has a texture.
+    this->atlas.Upload();
+    this->atlas.BeginFrame();
+    this->shapedTextCache.BeginFrame();
+    stream.SetTexture(this->atlas.GetTextureUnit());
+
+    for (unsigned int i = 0; i < this->labels.size(); i++)
+    {
+        const TextLabel& label = *this->labels[i];
+        if (!label.visible || label.text.empty())
+        {
+            continue;
+        }
+        const ShapedText& shaped = this->shapedTextCache.Shape(label.text, label.characterSize, label.bold, this->atlas);
+        if (shaped.placedCount == 0)
+        {
+            continue;
+        }
+
+        unsigned int quad = stream.AddQuads(shaped.placedCount);
+        float* vertexBuffer = stream.GetVertexData(quad);
+        float* colorBuffer = stream.GetColorData(quad);
+        float* texCoordBuffer = stream.GetTexCoordData(quad);
+        float scale = label.scale;
+        for (unsigned int g = 0; g < shaped.glyphs.size(); g++)
+        {
+            const ShapedGlyph& glyph = shaped.glyphs[g];
+            if (!glyph.placed)
+            {
+                continue;
+            }
+            // Glyph metrics grow downwards from the baseline; the world
+            // grows upwards.
+            float left = label.x + (glyph.penX + glyph.info.left) * scale;
+            float top = label.y - (glyph.penY + glyph.info.top) * scale;
+            float right = left + glyph.info.width * scale;
+            float bottom = top - glyph.info.height * scale;
+            float corners[8] = { left, top, right, top, right, bottom, left, bottom };
+            float texCoords[8] = { glyph.info.u0, glyph.info.v0, glyph.info.u1, glyph.info.v0, glyph.info.u1, glyph.info.v1, glyph.info.u0, glyph.info.v1 };
+            for (unsigned int vertex = 0; vertex < 4; vertex++)
+            {
+                vertexBuffer[0] = corners[vertex * 2];
+                vertexBuffer[1] = corners[vertex * 2 + 1];
+                vertexBuffer[2] = 0.0f;
+                vertexBuffer[3] = 1.0f;
+                vertexBuffer += 4;
+                colorBuffer[0] = label.color.red;
+                colorBuffer[1] = label.color.green;
+                colorBuffer[2] = label.color.blue;
+                colorBuffer[3] = label.color.alpha;
+                colorBuffer += 4;
+                texCoordBuffer[0] = texCoords[vertex * 2];
+                texCoordBuffer[1] = texCoords[vertex * 2 + 1];
+                texCoordBuffer += 2;
+            }
+        }
+    }
+
+    // Glyphs rasterized above are uploaded before the batch is drawn.
+    this->atlas.Upload();
+}
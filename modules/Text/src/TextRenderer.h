@@ -0,0 +1,96 @@
+#ifndef Text_TextRenderer_h
+#define Text_TextRenderer_h
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <SFML/Graphics/Font.hpp>
+#include "QuadSource.h"
+#include "GlyphAtlas.h"
+#include "ShapedTextCache.h"
+#include "TextLabel.h"
+
+/**
+ * Draws TextLabels as textured quads in the sprite batch.
+ *
+ * Glyphs are rasterized on demand into a single GlyphAtlas page shared by
+ * every label, so all of a renderer's text is drawn in one batch no matter
+ * how many labels it has or how often they change.
+ *
+ * Use: create a TextRenderer, load a font, create labels and register the
+ * renderer with the GraphicsManager as a QuadSource.
+ *
+ *     text = std::make_shared<TextRenderer>();
+ *     text->LoadFont("font.ttf");
+ *     std::shared_ptr<TextLabel> score = text->CreateLabel(-0.9f, 0.9f, 24, Color(1.0f, 1.0f, 1.0f));
+ *     score->SetScale(0.004f);
+ *     graphicsManager->RegisterQuadSource(text);
+ */
+class TextRenderer : public QuadSource
+{
+public:
+    /**
+     * Creates a TextRenderer with a 1024x1024 atlas of 64x64 pixel cells,
+     * enough for 256 distinct glyphs of up to 62 pixels.
+     */
+    TextRenderer();
+
+    /**
+     * Destructor
+     */
+    virtual ~TextRenderer();
+
+    /**
+     * Loads the font used by every label, returning false if it couldn't be
+     * loaded.
+     */
+    bool LoadFont(const std::string& filename);
+
+    /**
+     * Creates an empty label drawn by this renderer.
+     */
+    std::shared_ptr<TextLabel> CreateLabel(float x, float y, unsigned int characterSize, Color color);
+
+    /**
+     * Stops drawing the given label.
+     */
+    void RemoveLabel(std::shared_ptr<TextLabel> label);
+
+    /**
+     * Obtains the atlas, e.g. to read its hit, miss, and eviction counters.
+     */
+    GlyphAtlas& GetGlyphAtlas();
+
+    /**
+     * Obtains the shaped string cache, e.g. to read its hit and miss counters.
+     */
+    ShapedTextCache& GetShapedTextCache();
+
+    /**
+     * Appends one quad per visible glyph of every label to the given stream.
+     *
+     * Typically this function isn't needed outside the game engine's
+     * core graphics system, and thus it shouldn't be needed by users.
+     */
+    virtual void PutGLQuads(VertexStream& stream);
+
+private:
+    // Private constructors to disallow access.
+    TextRenderer(TextRenderer const &other);
+    TextRenderer operator=(TextRenderer other);
+
+    /**
+     * Guards the labels, font, and caches, which are changed on the game
+     * thread and drawn from the view thread. Labels share it, so they can
+     * still lock it after the renderer is destroyed.
+     */
+    std::shared_ptr<std::mutex> labelsMutex;
+    std::vector<std::shared_ptr<TextLabel>> labels;
+    sf::Font font;
+    bool fontLoaded;
+    GlyphAtlas atlas;
+    ShapedTextCache shapedTextCache;
+};
+
+#endif
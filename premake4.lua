@@ -22,6 +22,12 @@ solution "Engine"
             "sfml-window",
 	    "soil2-linux"
         }
+    -- Raw mouse motion needs XInput2, whose headers not every setup has
+    if os.get() == "linux" and os.isfile("/usr/include/X11/extensions/XInput2.h") then
+        configuration {"linux", "gmake" }
+            defines {"CORE_XINPUT2"}
+            links {"Xi", "X11"}
+    end
     -- Mac OSX
     configuration {"macosx"}
         platforms {"Universal64"}
@@ -85,6 +91,7 @@ project "Core"
         "core/src/**",
         "game/src",
         "game/src/**",
+        "modules/*/src",
         "modules/*/src/**"
     }
     libdirs {
@@ -119,6 +126,7 @@ project "Game"
         "core/src/**",
         "game/src",
         "game/src/**",
+        "modules/*/src",
         "modules/*/src/**"
     }
     libdirs {
@@ -134,13 +142,87 @@ for i = 1,table.getn(moduleNames) do
     project (moduleNames[i])
         kind "StaticLib"
         language "C++"
-        includedirs {"modules/**"}
+        includedirs {
+            "core/include",
+            "core/src",
+            "core/src/**",
+            "modules/**"
+        }
         files {
             "modules/" .. moduleNames[i] .. "/src/**.h",
             "modules/" .. moduleNames[i] .. "/src/**.cpp"
         }
 end
 
+-- Tools
+project "TextureCooker"
+    kind "ConsoleApp"
+    language "C++"
+    files {
+        "tools/TextureCooker/src/**.h",
+        "tools/TextureCooker/src/**.cpp"
+    }
+    includedirs {
+        "core/include",
+        "tools/TextureCooker/src"
+    }
+    libdirs {
+        "core/lib"
+    }
+    configuration {"macosx"}
+        links {
+            "OpenGL.framework",
+            "soil2-mac"
+        }
+
+project "AssetPacker"
+    kind "ConsoleApp"
+    language "C++"
+    files {
+        "tools/AssetPacker/src/**.h",
+        "tools/AssetPacker/src/**.cpp",
+        "core/src/Common/AssetPackFormat.h",
+        "core/src/Common/LZ4Block.h",
+        "core/src/Common/LZ4Block.cpp"
+    }
+    includedirs {
+        "core/src/Common",
+        "tools/AssetPacker/src"
+    }
+
+-- Tests
+project "Tests"
+    kind "ConsoleApp"
+    language "C++"
+    files {
+        "tests/src/**.h",
+        "tests/src/**.cpp",
+        "core/src/View/MixerSource.h",
+        "core/src/View/SoundMixer.h",
+        "core/src/View/SoundMixer.cpp",
+        "core/src/View/AudioDevice.h",
+        "core/src/View/HeadlessAudioDevice.h",
+        "core/src/View/HeadlessAudioDevice.cpp",
+        "core/src/View/WavAudioDevice.h",
+        "core/src/View/WavAudioDevice.cpp",
+        "core/src/Common/KeyboardKey.h",
+        "core/src/Common/MouseButton.h",
+        "core/src/Common/QueuedInputEvent.h",
+        "core/src/Common/InputSnapshot.h",
+        "core/src/Common/InputSnapshot.cpp",
+        "core/src/Common/InputRecordingFormat.h",
+        "core/src/Common/InputRecorder.h",
+        "core/src/Common/InputRecorder.cpp",
+        "core/src/Common/InputReplay.h",
+        "core/src/Common/InputReplay.cpp"
+    }
+    includedirs {
+        "core/include",
+        "core/src/Common",
+        "core/src/View",
+        "tests/src"
+    }
+
 if _ACTION == "clean" then
     if os.get() == "windows" then
         os.execute("python scripts/clean.py")
@@ -0,0 +1,178 @@
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "InputRecorder.h"
+#include "InputReplay.h"
+#include "InputSnapshot.h"
+#include "QueuedInputEvent.h"
+#include "Tests.h"
+
+namespace
+{
+    const char* FILE_NAME = "InputRecordingTests.inp";
+
+    QueuedInputEvent createEvent(QueuedInputEventType type, KeyboardKey key, MouseButton button, int x, int y)
+    {
+        QueuedInputEvent event = {};
+        event.type = type;
+        event.key = key;
+        event.button = button;
+        event.x = x;
+        event.y = y;
+        return event;
+    }
+
+    QueuedInputEvent createKeyEvent(QueuedInputEventType type, KeyboardKey key)
+    {
+        return createEvent(type, key, MouseButton::MOUSE_1, 0, 0);
+    }
+
+    QueuedInputEvent createMouseEvent(QueuedInputEventType type, int x, int y)
+    {
+        return createEvent(type, KeyboardKey::KEYBOARD_UNKNOWN, MouseButton::MOUSE_1, x, y);
+    }
+
+    /**
+     * Obtains whether the replayed event matches the recorded one in every
+     * field the recording keeps for its type.
+     */
+    bool isSameEvent(const QueuedInputEvent& replayed, const QueuedInputEvent& recorded)
+    {
+        if (replayed.type != recorded.type)
+        {
+            return false;
+        }
+        switch (recorded.type)
+        {
+        case QueuedInputEventType::KEYBOARD_KEY_PRESS:
+        case QueuedInputEventType::KEYBOARD_KEY_RELEASE:
+            return replayed.key == recorded.key;
+        case QueuedInputEventType::MOUSE_BUTTON_PRESS:
+        case QueuedInputEventType::MOUSE_BUTTON_RELEASE:
+            return replayed.button == recorded.button && replayed.x == recorded.x && replayed.y == recorded.y;
+        case QueuedInputEventType::MOUSE_MOVE:
+        case QueuedInputEventType::MOUSE_RELATIVE_MOVE:
+            return replayed.x == recorded.x && replayed.y == recorded.y;
+        default:
+            return true;
+        }
+    }
+
+    std::vector<unsigned char> readFile(const std::string& fileName)
+    {
+        std::vector<unsigned char> bytes;
+        FILE* file = fopen(fileName.c_str(), "rb");
+        if (file == nullptr)
+        {
+            return bytes;
+        }
+        unsigned char buffer[4096];
+        size_t count;
+        while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        {
+            bytes.insert(bytes.end(), buffer, buffer + count);
+        }
+        fclose(file);
+        return bytes;
+    }
+
+    void writeFile(const std::string& fileName, const std::vector<unsigned char>& bytes)
+    {
+        FILE* file = fopen(fileName.c_str(), "wb");
+        if (file != nullptr)
+        {
+            fwrite(bytes.data(), 1, bytes.size(), file);
+            fclose(file);
+        }
+    }
+
+    void testRoundTrip()
+    {
+        InputSnapshot initial;
+        initial.Apply(createKeyEvent(QueuedInputEventType::KEYBOARD_KEY_PRESS, KeyboardKey::KEYBOARD_A));
+        initial.Apply(createMouseEvent(QueuedInputEventType::MOUSE_MOVE, -5, 70000));
+
+        // Relative moves come between cursor moves, which stay relative to
+        // the cursor; the last tick ends with one so cutting off its final
+        // byte leaves it incomplete
+        std::vector<std::vector<QueuedInputEvent>> ticks(5);
+        ticks[0].push_back(createKeyEvent(QueuedInputEventType::KEYBOARD_KEY_PRESS, KeyboardKey::KEYBOARD_UNKNOWN));
+        ticks[0].push_back(createMouseEvent(QueuedInputEventType::MOUSE_MOVE, 100, -3000));
+        ticks[2].push_back(createMouseEvent(QueuedInputEventType::MOUSE_RELATIVE_MOVE, 7, -3));
+        ticks[2].push_back(createMouseEvent(QueuedInputEventType::MOUSE_RELATIVE_MOVE, -200, 100000));
+        ticks[2].push_back(createEvent(QueuedInputEventType::MOUSE_BUTTON_PRESS, KeyboardKey::KEYBOARD_UNKNOWN, MouseButton::MOUSE_2, 101, -3001));
+        ticks[3].push_back(createKeyEvent(QueuedInputEventType::KEYBOARD_KEY_RELEASE, KeyboardKey::KEYBOARD_UNKNOWN));
+        ticks[3].push_back(createMouseEvent(QueuedInputEventType::FOCUS_LOST, 0, 0));
+        ticks[4].push_back(createKeyEvent(QueuedInputEventType::KEYBOARD_KEY_RELEASE, KeyboardKey::KEYBOARD_A));
+        ticks[4].push_back(createMouseEvent(QueuedInputEventType::MOUSE_RELATIVE_MOVE, 1, -100000));
+        {
+            InputRecorder recorder(FILE_NAME);
+            recorder.Start(initial);
+            for (auto it = ticks.begin(); it != ticks.end(); it++)
+            {
+                recorder.RecordTick(*it);
+            }
+            CHECK(recorder.GetTickCount() == ticks.size());
+        }
+
+        std::shared_ptr<InputReplay> replay = InputReplay::Open(FILE_NAME);
+        CHECK(replay != nullptr);
+        if (replay == nullptr)
+        {
+            return;
+        }
+        const InputSnapshot& replayedInitial = replay->GetInitialSnapshot();
+        CHECK(replayedInitial.IsKeyDown(KeyboardKey::KEYBOARD_A));
+        CHECK(replayedInitial.GetKeysDown().count() == 1 && replayedInitial.GetMouseButtonsDown().none());
+        CHECK(replayedInitial.GetMouseX() == -5 && replayedInitial.GetMouseY() == 70000);
+
+        InputSnapshot snapshot = replayedInitial;
+        std::vector<QueuedInputEvent> events;
+        for (size_t tick = 0; tick < ticks.size(); tick++)
+        {
+            CHECK(replay->NextTick(events));
+            CHECK(events.size() == ticks[tick].size());
+            snapshot.BeginTick();
+            for (size_t i = 0; i < events.size() && i < ticks[tick].size(); i++)
+            {
+                CHECK(isSameEvent(events[i], ticks[tick][i]));
+                snapshot.Apply(events[i]);
+            }
+            if (tick == 2)
+            {
+                CHECK(snapshot.GetMouseDeltaX() == -193 && snapshot.GetMouseDeltaY() == 99997);
+                CHECK(snapshot.GetMouseX() == 101 && snapshot.GetMouseY() == -3001);
+            }
+        }
+        CHECK(!replay->NextTick(events));
+        CHECK(replay->GetTickCount() == ticks.size());
+
+        // A recording cut off mid-tick replays every complete tick, and the
+        // unknown key presses never reach the snapshot
+        std::vector<unsigned char> bytes = readFile(FILE_NAME);
+        CHECK(!bytes.empty());
+        bytes.pop_back();
+        writeFile(FILE_NAME, bytes);
+        replay = InputReplay::Open(FILE_NAME);
+        CHECK(replay != nullptr);
+        if (replay != nullptr)
+        {
+            size_t tickCount = 0;
+            while (replay->NextTick(events))
+            {
+                tickCount++;
+            }
+            CHECK(tickCount == ticks.size() - 1);
+            CHECK(events.empty());
+            CHECK(!replay->NextTick(events));
+        }
+        CHECK(snapshot.GetKeysDown().none());
+        remove(FILE_NAME);
+    }
+}
+
+void Tests::RunInputRecordingTests()
+{
+    testRoundTrip();
+}
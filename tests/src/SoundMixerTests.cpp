@@ -0,0 +1,124 @@
+#include <cmath>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "SoundMixer.h"
+#include "Tests.h"
+
+namespace
+{
+    const float TOLERANCE = 1e-4f;
+
+    /**
+     * Creates mono samples at the mixer's rate holding the given level.
+     */
+    std::shared_ptr<SoundMixer::Samples> createConstant(float level, size_t frameCount)
+    {
+        std::shared_ptr<SoundMixer::Samples> samples = std::make_shared<SoundMixer::Samples>();
+        samples->channelCount = 1;
+        samples->sampleRate = SoundMixer::SAMPLE_RATE;
+        samples->frameCount = frameCount;
+        samples->data.assign(frameCount, level);
+        return samples;
+    }
+
+    /**
+     * Renders the given number of frames from the mixer into a new buffer.
+     */
+    std::vector<float> render(SoundMixer& mixer, unsigned int frameCount)
+    {
+        std::vector<float> output(frameCount * SoundMixer::CHANNEL_COUNT);
+        mixer.Render(output.data(), frameCount);
+        return output;
+    }
+
+    bool isNear(float value, float expected)
+    {
+        return std::fabs(value - expected) < TOLERANCE;
+    }
+
+    void testGainAndPan()
+    {
+        SoundMixer mixer(2);
+        std::shared_ptr<SoundMixer::Samples> samples = createConstant(0.25f, 4096);
+
+        // Hard left puts all of a mono voice's gain in the left channel
+        mixer.Start(0, samples, 0.5f, -1.0f, 1.0f, 0.0);
+        std::vector<float> output = render(mixer, 1000);
+        bool left = true;
+        for (size_t frame = 0; frame < 1000; frame++)
+        {
+            left = left && isNear(output[frame * 2], 0.125f) && isNear(output[frame * 2 + 1], 0.0f);
+        }
+        CHECK(left);
+
+        // Centered, constant power splits it evenly at -3dB
+        mixer.Start(0, samples, 0.5f, 0.0f, 1.0f, 0.0);
+        output = render(mixer, 512);
+        float centered = 0.125f * std::sqrt(0.5f);
+        CHECK(isNear(output[0], centered) && isNear(output[1], centered));
+        CHECK(isNear(output[511 * 2], centered) && isNear(output[511 * 2 + 1], centered));
+        CHECK(isNear(mixer.GetLimiterGain(), 1.0f));
+    }
+
+    void testVoiceEnds()
+    {
+        SoundMixer mixer(1);
+        mixer.Start(0, createConstant(0.5f, 300), 1.0f, 0.0f, 1.0f, 0.0);
+        std::vector<float> output = render(mixer, 512);
+        CHECK(!mixer.IsPlaying(0));
+        std::vector<bool> active;
+        mixer.GetActiveVoices(active);
+        CHECK(active.size() == 1 && !active[0]);
+        CHECK(output[299 * 2] > 0.0f);
+        CHECK(output[300 * 2] == 0.0f && output[511 * 2 + 1] == 0.0f);
+    }
+
+    void testPitchIsClamped()
+    {
+        // Zero and negative pitches play at MIN_PITCH rather than never
+        // ending or reading before the samples
+        SoundMixer mixer(2);
+        mixer.Start(0, createConstant(0.5f, 4), 1.0f, 0.0f, 0.0f, 0.0);
+        mixer.Start(1, createConstant(0.5f, 4), 1.0f, 0.0f, 1.0f, 0.0);
+        mixer.SetVoicePitch(1, -1.0f);
+        render(mixer, 512);
+        CHECK(!mixer.IsPlaying(0) && !mixer.IsPlaying(1));
+    }
+
+    void testLimiterHoldsPeaks()
+    {
+        // Four centered voices at full gain, doubled by the master gain,
+        // peak at about 1.41 before the limiter
+        SoundMixer mixer(4);
+        std::shared_ptr<SoundMixer::Samples> samples = createConstant(0.25f, 4096);
+        for (unsigned int voice = 0; voice < 4; voice++)
+        {
+            mixer.Start(voice, samples, 1.0f, 0.0f, 1.0f, 0.0);
+        }
+        mixer.SetMasterGain(2.0f);
+        std::vector<float> output = render(mixer, 2048);
+
+        float peak = 0.0f;
+        for (auto it = output.begin(); it != output.end(); it++)
+        {
+            peak = std::max(peak, std::fabs(*it));
+        }
+        CHECK(peak <= SoundMixer::DEFAULT_LIMITER_THRESHOLD + TOLERANCE);
+        CHECK(isNear(output[0], SoundMixer::DEFAULT_LIMITER_THRESHOLD));
+        CHECK(mixer.GetLimiterGain() < 1.0f);
+
+        // A lower threshold takes effect on the next block
+        mixer.SetLimiterThreshold(0.5f);
+        output = render(mixer, 512);
+        CHECK(isNear(output[0], 0.5f) && isNear(output[511 * 2 + 1], 0.5f));
+    }
+}
+
+void Tests::RunSoundMixerTests()
+{
+    testGainAndPan();
+    testVoiceEnds();
+    testPitchIsClamped();
+    testLimiterHoldsPeaks();
+}
@@ -0,0 +1,25 @@
+#ifndef Tests_Tests_h
+#define Tests_Tests_h
+
+/**
+ * Records a failed check, with the expression and where it is, unless the
+ * given condition holds. Checks don't stop the test they're in.
+ */
+#define CHECK(condition) Tests::Check((condition), #condition, __FILE__, __LINE__)
+
+namespace Tests
+{
+    /**
+     * Prints and counts the given check if it failed. Use CHECK instead.
+     */
+    void Check(bool passed, const char* condition, const char* file, int line);
+
+    /**
+     * Each of these runs the tests for one part of the engine.
+     */
+    void RunSoundMixerTests();
+    void RunWavAudioDeviceTests();
+    void RunInputRecordingTests();
+}
+
+#endif
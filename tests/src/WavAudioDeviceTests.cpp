@@ -0,0 +1,112 @@
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include "SoundMixer.h"
+#include "WavAudioDevice.h"
+#include "Tests.h"
+
+namespace
+{
+    const char* FILE_NAME = "WavAudioDeviceTests.wav";
+    const unsigned int HEADER_SIZE = 44;
+
+    std::vector<unsigned char> readFile(const std::string& fileName)
+    {
+        std::vector<unsigned char> bytes;
+        FILE* file = fopen(fileName.c_str(), "rb");
+        if (file == nullptr)
+        {
+            return bytes;
+        }
+        unsigned char buffer[4096];
+        size_t count;
+        while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        {
+            bytes.insert(bytes.end(), buffer, buffer + count);
+        }
+        fclose(file);
+        return bytes;
+    }
+
+    unsigned int getLittleEndian(const std::vector<unsigned char>& bytes, size_t offset, unsigned int byteCount)
+    {
+        unsigned int value = 0;
+        for (unsigned int i = 0; i < byteCount; i++)
+        {
+            value |= (unsigned int)bytes[offset + i] << (i * 8);
+        }
+        return value;
+    }
+
+    bool hasTag(const std::vector<unsigned char>& bytes, size_t offset, const char* tag)
+    {
+        return std::memcmp(&bytes[offset], tag, 4) == 0;
+    }
+
+    /**
+     * Checks that the file is a 16-bit stereo WAV at the mixer's rate
+     * holding exactly the given number of frames.
+     */
+    void checkFile(const std::vector<unsigned char>& bytes, unsigned int frameCount)
+    {
+        unsigned int dataSize = frameCount * SoundMixer::CHANNEL_COUNT * 2;
+        CHECK(bytes.size() == HEADER_SIZE + dataSize);
+        if (bytes.size() < HEADER_SIZE)
+        {
+            return;
+        }
+        CHECK(hasTag(bytes, 0, "RIFF") && hasTag(bytes, 8, "WAVE") && hasTag(bytes, 12, "fmt ") && hasTag(bytes, 36, "data"));
+        CHECK(getLittleEndian(bytes, 4, 4) == 36 + dataSize);
+        CHECK(getLittleEndian(bytes, 16, 4) == 16);
+        CHECK(getLittleEndian(bytes, 20, 2) == 1);
+        CHECK(getLittleEndian(bytes, 22, 2) == SoundMixer::CHANNEL_COUNT);
+        CHECK(getLittleEndian(bytes, 24, 4) == SoundMixer::SAMPLE_RATE);
+        CHECK(getLittleEndian(bytes, 28, 4) == SoundMixer::SAMPLE_RATE * SoundMixer::CHANNEL_COUNT * 2);
+        CHECK(getLittleEndian(bytes, 32, 2) == SoundMixer::CHANNEL_COUNT * 2);
+        CHECK(getLittleEndian(bytes, 34, 2) == 16);
+        CHECK(getLittleEndian(bytes, 40, 4) == dataSize);
+    }
+
+    void testRoundTrip()
+    {
+        std::shared_ptr<SoundMixer::Samples> samples = std::make_shared<SoundMixer::Samples>();
+        samples->channelCount = 1;
+        samples->sampleRate = SoundMixer::SAMPLE_RATE;
+        samples->frameCount = 4096;
+        samples->data.assign(samples->frameCount, 0.5f);
+
+        SoundMixer mixer(1);
+        mixer.Start(0, samples, 1.0f, -1.0f, 1.0f, 0.0);
+        {
+            // The header is brought up to date by every Stop, and rendering
+            // afterwards appends to the samples
+            WavAudioDevice device(FILE_NAME, 0.0);
+            device.Stop();
+            std::vector<unsigned char> bytes = readFile(FILE_NAME);
+            checkFile(bytes, 0);
+
+            device.Pump(mixer, 300);
+            device.Stop();
+            bytes = readFile(FILE_NAME);
+            checkFile(bytes, 300);
+            if (bytes.size() >= HEADER_SIZE + 4)
+            {
+                CHECK((short)getLittleEndian(bytes, HEADER_SIZE, 2) == 16383);
+                CHECK((short)getLittleEndian(bytes, HEADER_SIZE + 2, 2) == 0);
+            }
+
+            device.Pump(mixer, 700);
+            device.Stop();
+            checkFile(readFile(FILE_NAME), 1000);
+        }
+        checkFile(readFile(FILE_NAME), 1000);
+        remove(FILE_NAME);
+    }
+}
+
+void Tests::RunWavAudioDeviceTests()
+{
+    testRoundTrip();
+}
@@ -0,0 +1,37 @@
+#include <cstdio>
+#include "Tests.h"
+
+namespace
+{
+    int failureCount = 0;
+}
+
+void Tests::Check(bool passed, const char* condition, const char* file, int line)
+{
+    if (!passed)
+    {
+        printf("%s:%d: check failed: %s\n", file, line, condition);
+        failureCount++;
+    }
+}
+
+/**
+ * Runs every engine test that doesn't need a window or audio hardware.
+ * Returns nonzero if any check failed, so scripts can run it as is.
+ *
+ * Usage: Tests
+ */
+int main()
+{
+    Tests::RunSoundMixerTests();
+    Tests::RunWavAudioDeviceTests();
+    Tests::RunInputRecordingTests();
+
+    if (failureCount > 0)
+    {
+        printf("%d checks failed\n", failureCount);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
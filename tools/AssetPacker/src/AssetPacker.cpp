@@ -0,0 +1,238 @@
+#include <cstdio>
+#include <algorithm>
+#include "AssetPacker.h"
+#include "AssetPackFormat.h"
+#include "LZ4Block.h"
+
+namespace
+{
+    /**
+     * Writes a little endian 32 bit value.
+     */
+    void writeUInt32(FILE* file, uint32_t value)
+    {
+        unsigned char bytes[4] = {
+            (unsigned char)(value & 0xFF),
+            (unsigned char)((value >> 8) & 0xFF),
+            (unsigned char)((value >> 16) & 0xFF),
+            (unsigned char)((value >> 24) & 0xFF)
+        };
+        fwrite(bytes, 1, 4, file);
+    }
+
+    /**
+     * Writes a little endian 64 bit value.
+     */
+    void writeUInt64(FILE* file, uint64_t value)
+    {
+        writeUInt32(file, (uint32_t)(value & 0xFFFFFFFF));
+        writeUInt32(file, (uint32_t)(value >> 32));
+    }
+
+    /**
+     * Rounds the given offset up to the pack's alignment.
+     */
+    uint64_t align(uint64_t offset)
+    {
+        return (offset + AssetPackFormat::ALIGNMENT - 1) / AssetPackFormat::ALIGNMENT * AssetPackFormat::ALIGNMENT;
+    }
+}
+
+AssetPacker::AssetPacker() : compressionEnabled(false)
+{
+
+}
+
+AssetPacker::~AssetPacker()
+{
+
+}
+
+void AssetPacker::SetCompressionEnabled(bool enabled)
+{
+    this->compressionEnabled = enabled;
+}
+
+bool AssetPacker::AddFile(const std::string& fileName)
+{
+    FILE* input = fopen(fileName.c_str(), "rb");
+    if (input == nullptr)
+    {
+        this->errorMessage = "Couldn't open " + fileName;
+        return false;
+    }
+    fseek(input, 0, SEEK_END);
+    long size = ftell(input);
+    fseek(input, 0, SEEK_SET);
+
+    File file;
+    file.name = AssetPacker::NormalizeName(fileName);
+    file.size = size < 0 ? 0 : (unsigned long long)size;
+    file.compressed = false;
+    file.data.resize((size_t)file.size);
+    bool read = file.data.empty() || fread(&file.data[0], 1, file.data.size(), input) == file.data.size();
+    fclose(input);
+    if (!read)
+    {
+        this->errorMessage = "Couldn't read " + fileName;
+        return false;
+    }
+
+    // Only keep the compressed version if it saves at least an eighth, as
+    // uncompressed files are read in place without any copying.
+    if (this->compressionEnabled && !file.data.empty())
+    {
+        std::vector<unsigned char> compressed(LZ4Block::GetMaxCompressedSize(file.data.size()));
+        size_t compressedSize = LZ4Block::Compress(&file.data[0], file.data.size(), &compressed[0], compressed.size());
+        if (compressedSize != 0 && compressedSize < file.data.size() - file.data.size() / 8)
+        {
+            compressed.resize(compressedSize);
+            file.data.swap(compressed);
+            file.compressed = true;
+        }
+    }
+    this->files.push_back(file);
+    return true;
+}
+
+bool AssetPacker::Write(const std::string& outputFileName)
+{
+    std::sort(this->files.begin(), this->files.end(), [](const File& first, const File& second)
+    {
+        return first.name < second.name;
+    });
+    for (size_t i = 1; i < this->files.size(); i++)
+    {
+        if (this->files[i].name == this->files[i - 1].name)
+        {
+            this->errorMessage = this->files[i].name + " was added more than once";
+            return false;
+        }
+    }
+
+    // Header, index, names, then the aligned data of every file
+    uint64_t headerSize = 4 * 4 + 8 * 3;
+    uint64_t entrySize = 8 * 3 + 4 * 4;
+    uint64_t indexOffset = headerSize;
+    uint64_t namesOffset = indexOffset + entrySize * this->files.size();
+    uint64_t namesSize = 0;
+    for (auto it = this->files.begin(); it != this->files.end(); it++)
+    {
+        namesSize += it->name.size();
+    }
+    std::vector<uint64_t> dataOffsets;
+    uint64_t offset = namesOffset + namesSize;
+    for (auto it = this->files.begin(); it != this->files.end(); it++)
+    {
+        offset = align(offset);
+        dataOffsets.push_back(offset);
+        offset += it->data.size();
+    }
+
+    FILE* output = fopen(outputFileName.c_str(), "wb");
+    if (output == nullptr)
+    {
+        this->errorMessage = "Couldn't open " + outputFileName + " for writing";
+        return false;
+    }
+
+    writeUInt32(output, AssetPackFormat::MAGIC);
+    writeUInt32(output, AssetPackFormat::VERSION);
+    writeUInt32(output, (uint32_t)this->files.size());
+    writeUInt32(output, AssetPackFormat::ALIGNMENT);
+    writeUInt64(output, indexOffset);
+    writeUInt64(output, namesOffset);
+    writeUInt64(output, namesSize);
+
+    uint32_t nameOffset = 0;
+    for (size_t i = 0; i < this->files.size(); i++)
+    {
+        const File& file = this->files[i];
+        writeUInt64(output, dataOffsets[i]);
+        writeUInt64(output, file.data.size());
+        writeUInt64(output, file.size);
+        writeUInt32(output, nameOffset);
+        writeUInt32(output, (uint32_t)file.name.size());
+        writeUInt32(output, file.compressed ? AssetPackFormat::FLAG_LZ4 : 0);
+        writeUInt32(output, 0);
+        nameOffset += (uint32_t)file.name.size();
+    }
+    for (auto it = this->files.begin(); it != this->files.end(); it++)
+    {
+        fwrite(it->name.data(), 1, it->name.size(), output);
+    }
+
+    uint64_t position = namesOffset + namesSize;
+    const unsigned char padding[AssetPackFormat::ALIGNMENT] = { 0 };
+    for (size_t i = 0; i < this->files.size(); i++)
+    {
+        fwrite(padding, 1, (size_t)(dataOffsets[i] - position), output);
+        if (!this->files[i].data.empty())
+        {
+            fwrite(&this->files[i].data[0], 1, this->files[i].data.size(), output);
+        }
+        position = dataOffsets[i] + this->files[i].data.size();
+    }
+
+    bool failed = ferror(output) != 0;
+    if (fclose(output) != 0 || failed)
+    {
+        this->errorMessage = "Couldn't write " + outputFileName;
+        return false;
+    }
+    return true;
+}
+
+unsigned int AssetPacker::GetFileCount()
+{
+    return (unsigned int)this->files.size();
+}
+
+unsigned int AssetPacker::GetCompressedFileCount()
+{
+    unsigned int count = 0;
+    for (auto it = this->files.begin(); it != this->files.end(); it++)
+    {
+        if (it->compressed)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+unsigned long long AssetPacker::GetTotalSize()
+{
+    unsigned long long size = 0;
+    for (auto it = this->files.begin(); it != this->files.end(); it++)
+    {
+        size += it->size;
+    }
+    return size;
+}
+
+unsigned long long AssetPacker::GetStoredSize()
+{
+    unsigned long long size = 0;
+    for (auto it = this->files.begin(); it != this->files.end(); it++)
+    {
+        size += it->data.size();
+    }
+    return size;
+}
+
+std::string AssetPacker::NormalizeName(const std::string& fileName)
+{
+    std::string normalized = fileName;
+    std::replace(normalized.begin(), normalized.end(), '\\', '/');
+    while (normalized.compare(0, 2, "./") == 0)
+    {
+        normalized.erase(0, 2);
+    }
+    return normalized;
+}
+
+std::string AssetPacker::GetErrorMessage()
+{
+    return this->errorMessage;
+}
@@ -0,0 +1,96 @@
+#ifndef AssetPacker_AssetPacker_h
+#define AssetPacker_AssetPacker_h
+
+#include <string>
+#include <vector>
+
+/**
+ * Bundles asset files into a single pack file that the engine's
+ * ResourceManager can mount and load from without opening each file.
+ *
+ * Each file is stored under its path as given, normalized the same way as
+ * AssetPack::NormalizeName, so the game keeps loading it by the same name.
+ * With compression enabled, files that shrink enough are stored as LZ4
+ * blocks; already compressed formats such as PNG and OGG are left as they
+ * are, so they can still be read in place.
+ */
+class AssetPacker
+{
+public:
+    /**
+     * Creates an AssetPacker with compression disabled.
+     */
+    AssetPacker();
+
+    /**
+     * Destructor
+     */
+    ~AssetPacker();
+
+    /**
+     * Sets whether files are LZ4 compressed when it saves space.
+     */
+    void SetCompressionEnabled(bool enabled);
+
+    /**
+     * Reads the given file to be added to the pack.
+     *
+     * Returns false and sets the error message if it couldn't be read.
+     */
+    bool AddFile(const std::string& fileName);
+
+    /**
+     * Writes every added file to the given pack.
+     *
+     * Returns false and sets the error message if it couldn't be written
+     * or the same file was added twice.
+     */
+    bool Write(const std::string& outputFileName);
+
+    /**
+     * Obtains the number of files added so far, and how many of them were
+     * compressed.
+     */
+    unsigned int GetFileCount();
+    unsigned int GetCompressedFileCount();
+
+    /**
+     * Obtains the total size of the added files, and what they take up in
+     * the pack.
+     */
+    unsigned long long GetTotalSize();
+    unsigned long long GetStoredSize();
+
+    /**
+     * Obtains the name a file is stored under. Must match
+     * AssetPack::NormalizeName.
+     */
+    static std::string NormalizeName(const std::string& fileName);
+
+    /**
+     * Obtains a description of why the last call to AddFile or Write failed.
+     */
+    std::string GetErrorMessage();
+
+private:
+    // Private constructors to disallow access.
+    AssetPacker(AssetPacker const &other);
+    AssetPacker operator=(AssetPacker other);
+
+    /**
+     * A file to be packed, already compressed if that was worthwhile.
+     */
+    struct File
+    {
+        std::string name;
+        unsigned long long size;
+        bool compressed;
+        std::vector<unsigned char> data;
+    };
+
+    std::vector<File> files;
+    bool compressionEnabled;
+    std::string errorMessage;
+};
+
+#endif
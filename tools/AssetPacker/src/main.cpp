@@ -0,0 +1,48 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "AssetPacker.h"
+
+/**
+ * Packs every file given on the command line into a single asset pack,
+ * which the game can mount with ResourceManager::MountAssetPack.
+ *
+ * Usage: AssetPacker [-c] output.pak file [more files...]
+ *
+ * With -c, files are LZ4 compressed where that saves space.
+ */
+int main(int argc, char** argv)
+{
+    int first = 1;
+    bool compress = false;
+    if (argc > 1 && std::strcmp(argv[1], "-c") == 0)
+    {
+        compress = true;
+        first++;
+    }
+    if (argc - first < 2)
+    {
+        printf("Usage: %s [-c] output.pak file [more files...]\n", argv[0]);
+        return 1;
+    }
+
+    AssetPacker packer;
+    packer.SetCompressionEnabled(compress);
+    std::string output = argv[first];
+    for (int i = first + 1; i < argc; i++)
+    {
+        if (!packer.AddFile(argv[i]))
+        {
+            printf("Error: %s\n", packer.GetErrorMessage().c_str());
+            return 1;
+        }
+    }
+    if (!packer.Write(output))
+    {
+        printf("Error: %s\n", packer.GetErrorMessage().c_str());
+        return 1;
+    }
+    printf("Packed %u files (%u compressed) into %s: %llu bytes stored for %llu bytes of assets\n",
+        packer.GetFileCount(), packer.GetCompressedFileCount(), output.c_str(), packer.GetStoredSize(), packer.GetTotalSize());
+    return 0;
+}
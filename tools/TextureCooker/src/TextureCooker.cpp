@@ -0,0 +1,277 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "TextureCooker.h"
+#include "ImageLoader/SOIL2.h"
+
+// Image processing helpers exported by SOIL2's static library. Their
+// headers aren't shipped with the engine, so they're declared here.
+extern "C"
+{
+    int scale_image_RGB_to_NTSC_safe(unsigned char* orig, int width, int height, int channels);
+    int up_scale_image(const unsigned char* const orig, int width, int height, int channels, unsigned char* resampled, int resampled_width, int resampled_height);
+    int mipmap_image(const unsigned char* const orig, int width, int height, int channels, unsigned char* resampled, int block_size_x, int block_size_y);
+    unsigned char* convert_image_to_DXT1(const unsigned char* const uncompressed, int width, int height, int channels, int* out_size);
+    unsigned char* convert_image_to_DXT5(const unsigned char* const uncompressed, int width, int height, int channels, int* out_size);
+}
+
+namespace
+{
+    // DDS header flags
+    const unsigned int DDSD_CAPS = 0x1;
+    const unsigned int DDSD_HEIGHT = 0x2;
+    const unsigned int DDSD_WIDTH = 0x4;
+    const unsigned int DDSD_PIXELFORMAT = 0x1000;
+    const unsigned int DDSD_MIPMAPCOUNT = 0x20000;
+    const unsigned int DDSD_LINEARSIZE = 0x80000;
+    const unsigned int DDPF_FOURCC = 0x4;
+    const unsigned int DDSCAPS_COMPLEX = 0x8;
+    const unsigned int DDSCAPS_TEXTURE = 0x1000;
+    const unsigned int DDSCAPS_MIPMAP = 0x400000;
+
+    /**
+     * Writes a little endian 32 bit value.
+     */
+    void writeUInt32(FILE* file, unsigned int value)
+    {
+        unsigned char bytes[4] = {
+            (unsigned char)(value & 0xFF),
+            (unsigned char)((value >> 8) & 0xFF),
+            (unsigned char)((value >> 16) & 0xFF),
+            (unsigned char)((value >> 24) & 0xFF)
+        };
+        fwrite(bytes, 1, 4, file);
+    }
+
+    /**
+     * Obtains the smallest power of two that is at least the given value.
+     */
+    int nextPowerOfTwo(int value)
+    {
+        int power = 1;
+        while (power < value)
+        {
+            power *= 2;
+        }
+        return power;
+    }
+}
+
+TextureCooker::TextureCooker()
+{
+
+}
+
+TextureCooker::~TextureCooker()
+{
+
+}
+
+bool TextureCooker::Cook(const std::string& sourceFileName, const std::string& outputFileName)
+{
+    int sourceWidth = 0;
+    int sourceHeight = 0;
+    int channels = 0;
+    unsigned char* pixels = SOIL_load_image(sourceFileName.c_str(), &sourceWidth, &sourceHeight, &channels, SOIL_LOAD_AUTO);
+    if (pixels == nullptr)
+    {
+        this->errorMessage = "Couldn't load " + sourceFileName + ": " + SOIL_last_result();
+        return false;
+    }
+
+    // Flip the image so its first row is the bottom one, as OpenGL expects
+    // (what SOIL_FLAG_INVERT_Y did at load time).
+    int rowSize = sourceWidth * channels;
+    std::vector<unsigned char> row(rowSize);
+    for (int y = 0; y < sourceHeight / 2; y++)
+    {
+        unsigned char* top = pixels + y * rowSize;
+        unsigned char* bottom = pixels + (sourceHeight - 1 - y) * rowSize;
+        std::memcpy(&row[0], top, rowSize);
+        std::memcpy(top, bottom, rowSize);
+        std::memcpy(bottom, &row[0], rowSize);
+    }
+    scale_image_RGB_to_NTSC_safe(pixels, sourceWidth, sourceHeight, channels);
+
+    // Images whose alpha channel is fully opaque don't need DXT5
+    bool hasAlpha = false;
+    if (channels == 2 || channels == 4)
+    {
+        int pixelCount = sourceWidth * sourceHeight;
+        for (int i = 0; i < pixelCount && !hasAlpha; i++)
+        {
+            hasAlpha = pixels[i * channels + channels - 1] != 255;
+        }
+    }
+
+    // Mipmapping needs power of two dimensions
+    int width = nextPowerOfTwo(sourceWidth);
+    int height = nextPowerOfTwo(sourceHeight);
+    std::vector<unsigned char> level((size_t)width * height * channels);
+    if (width != sourceWidth || height != sourceHeight)
+    {
+        up_scale_image(pixels, sourceWidth, sourceHeight, channels, &level[0], width, height);
+    }
+    else
+    {
+        std::memcpy(&level[0], pixels, level.size());
+    }
+    SOIL_free_image_data(pixels);
+
+    std::vector<MipLevel> levels;
+    std::vector<unsigned char> nextLevel;
+    while (true)
+    {
+        if (!this->compressLevel(&level[0], width, height, channels, hasAlpha, levels))
+        {
+            return false;
+        }
+        if (width == 1 && height == 1)
+        {
+            break;
+        }
+        int blockWidth = width > 1 ? 2 : 1;
+        int blockHeight = height > 1 ? 2 : 1;
+        nextLevel.resize((size_t)(width / blockWidth) * (height / blockHeight) * channels);
+        mipmap_image(&level[0], width, height, channels, &nextLevel[0], blockWidth, blockHeight);
+        width /= blockWidth;
+        height /= blockHeight;
+        level.swap(nextLevel);
+    }
+
+    if (!this->writeDDS(outputFileName, hasAlpha, levels))
+    {
+        return false;
+    }
+    return this->writeMetadata(outputFileName, sourceFileName, sourceWidth, sourceHeight, channels, hasAlpha, levels);
+}
+
+std::string TextureCooker::GetCookedFileName(const std::string& sourceFileName)
+{
+    size_t extension = sourceFileName.find_last_of('.');
+    size_t directory = sourceFileName.find_last_of("/\\");
+    if (extension == std::string::npos || (directory != std::string::npos && extension < directory))
+    {
+        return sourceFileName + ".dds";
+    }
+    return sourceFileName.substr(0, extension) + ".dds";
+}
+
+std::string TextureCooker::GetErrorMessage()
+{
+    return this->errorMessage;
+}
+
+bool TextureCooker::compressLevel(const unsigned char* pixels, int width, int height, int channels, bool hasAlpha, std::vector<MipLevel>& levels)
+{
+    int size = 0;
+    unsigned char* compressed;
+    if (hasAlpha)
+    {
+        compressed = convert_image_to_DXT5(pixels, width, height, channels, &size);
+    }
+    else
+    {
+        compressed = convert_image_to_DXT1(pixels, width, height, channels, &size);
+    }
+    if (compressed == nullptr)
+    {
+        this->errorMessage = "Couldn't compress a " + std::to_string(width) + "x" + std::to_string(height) + " mipmap level";
+        return false;
+    }
+
+    MipLevel mipLevel;
+    mipLevel.width = width;
+    mipLevel.height = height;
+    mipLevel.data.assign(compressed, compressed + size);
+    levels.push_back(mipLevel);
+    SOIL_free_image_data(compressed);
+    return true;
+}
+
+bool TextureCooker::writeDDS(const std::string& outputFileName, bool hasAlpha, std::vector<MipLevel>& levels)
+{
+    FILE* file = fopen(outputFileName.c_str(), "wb");
+    if (file == nullptr)
+    {
+        this->errorMessage = "Couldn't open " + outputFileName + " for writing";
+        return false;
+    }
+
+    fwrite("DDS ", 1, 4, file);
+    writeUInt32(file, 124);
+    writeUInt32(file, DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE);
+    writeUInt32(file, levels[0].height);
+    writeUInt32(file, levels[0].width);
+    writeUInt32(file, (unsigned int)levels[0].data.size());
+    writeUInt32(file, 0);
+    writeUInt32(file, (unsigned int)levels.size());
+    for (int i = 0; i < 11; i++)
+    {
+        writeUInt32(file, 0);
+    }
+
+    // Pixel format
+    writeUInt32(file, 32);
+    writeUInt32(file, DDPF_FOURCC);
+    fwrite(hasAlpha ? "DXT5" : "DXT1", 1, 4, file);
+    for (int i = 0; i < 5; i++)
+    {
+        writeUInt32(file, 0);
+    }
+
+    // Capabilities
+    writeUInt32(file, DDSCAPS_COMPLEX | DDSCAPS_TEXTURE | DDSCAPS_MIPMAP);
+    for (int i = 0; i < 4; i++)
+    {
+        writeUInt32(file, 0);
+    }
+
+    for (auto it = levels.begin(); it != levels.end(); it++)
+    {
+        fwrite(&it->data[0], 1, it->data.size(), file);
+    }
+
+    bool failed = ferror(file) != 0;
+    if (fclose(file) != 0 || failed)
+    {
+        this->errorMessage = "Couldn't write " + outputFileName;
+        return false;
+    }
+    return true;
+}
+
+bool TextureCooker::writeMetadata(const std::string& outputFileName, const std::string& sourceFileName, int sourceWidth, int sourceHeight, int channels, bool hasAlpha, std::vector<MipLevel>& levels)
+{
+    std::string metadataFileName = outputFileName + ".meta";
+    FILE* file = fopen(metadataFileName.c_str(), "w");
+    if (file == nullptr)
+    {
+        this->errorMessage = "Couldn't open " + metadataFileName + " for writing";
+        return false;
+    }
+
+    size_t totalSize = 0;
+    for (auto it = levels.begin(); it != levels.end(); it++)
+    {
+        totalSize += it->data.size();
+    }
+    fprintf(file, "source: %s\n", sourceFileName.c_str());
+    fprintf(file, "sourceWidth: %d\n", sourceWidth);
+    fprintf(file, "sourceHeight: %d\n", sourceHeight);
+    fprintf(file, "sourceChannels: %d\n", channels);
+    fprintf(file, "width: %d\n", levels[0].width);
+    fprintf(file, "height: %d\n", levels[0].height);
+    fprintf(file, "format: %s\n", hasAlpha ? "DXT5" : "DXT1");
+    fprintf(file, "mipLevels: %d\n", (int)levels.size());
+    fprintf(file, "bytes: %lu\n", (unsigned long)totalSize);
+    fprintf(file, "flippedY: 1\n");
+
+    bool failed = ferror(file) != 0;
+    if (fclose(file) != 0 || failed)
+    {
+        this->errorMessage = "Couldn't write " + metadataFileName;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,86 @@
+#ifndef TextureCooker_TextureCooker_h
+#define TextureCooker_TextureCooker_h
+
+#include <string>
+#include <vector>
+
+/**
+ * Converts source images (PNG, JPG, TGA, BMP, ...) into DDS files that the
+ * engine can upload to the GPU without any further processing.
+ *
+ * Cooking performs the same work the engine's Texture class used to do at
+ * load time, ahead of time: the image is flipped vertically, made NTSC
+ * safe, resized to a power of two, given a full mipmap chain, and
+ * compressed to DXT1 (images without alpha) or DXT5 (images with alpha).
+ *
+ * Next to every cooked texture a ".meta" text file is written describing
+ * the source image and the cooked result.
+ */
+class TextureCooker
+{
+public:
+    /**
+     * Creates a TextureCooker.
+     */
+    TextureCooker();
+
+    /**
+     * Destructor
+     */
+    ~TextureCooker();
+
+    /**
+     * Cooks the given source image into the given DDS file, writing the
+     * metadata to outputFileName + ".meta".
+     *
+     * Returns false and sets the error message if the image couldn't be
+     * loaded or the output couldn't be written.
+     */
+    bool Cook(const std::string& sourceFileName, const std::string& outputFileName);
+
+    /**
+     * Obtains the name the engine looks for a cooked version of the given
+     * source image under: the same path with its extension replaced by
+     * ".dds". Must match Texture::GetCookedFileName.
+     */
+    static std::string GetCookedFileName(const std::string& sourceFileName);
+
+    /**
+     * Obtains a description of why the last call to Cook failed.
+     */
+    std::string GetErrorMessage();
+
+private:
+    // Private constructors to disallow access.
+    TextureCooker(TextureCooker const &other);
+    TextureCooker operator=(TextureCooker other);
+
+    /**
+     * One level of the mipmap chain, already compressed.
+     */
+    struct MipLevel
+    {
+        int width;
+        int height;
+        std::vector<unsigned char> data;
+    };
+
+    /**
+     * Compresses the given uncompressed image and appends it to the chain.
+     */
+    bool compressLevel(const unsigned char* pixels, int width, int height, int channels, bool hasAlpha, std::vector<MipLevel>& levels);
+
+    /**
+     * Writes the mipmap chain as a DDS file.
+     */
+    bool writeDDS(const std::string& outputFileName, bool hasAlpha, std::vector<MipLevel>& levels);
+
+    /**
+     * Writes the metadata sidecar file.
+     */
+    bool writeMetadata(const std::string& outputFileName, const std::string& sourceFileName, int sourceWidth, int sourceHeight, int channels, bool hasAlpha, std::vector<MipLevel>& levels);
+
+    std::string errorMessage;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#include <cstdio>
+#include <string>
+#include "TextureCooker.h"
+
+/**
+ * Cooks every image given on the command line into a DDS file next to it,
+ * where the engine's Texture class will find it.
+ *
+ * Usage: TextureCooker image.png [more images...]
+ */
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printf("Usage: %s image [more images...]\n", argv[0]);
+        return 1;
+    }
+
+    TextureCooker cooker;
+    int failures = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string source = argv[i];
+        std::string output = TextureCooker::GetCookedFileName(source);
+        if (cooker.Cook(source, output))
+        {
+            printf("Cooked %s -> %s\n", source.c_str(), output.c_str());
+        }
+        else
+        {
+            printf("Error: %s\n", cooker.GetErrorMessage().c_str());
+            failures++;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}